@@ -0,0 +1,76 @@
+#pragma once
+#include "MappedFile.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// One file inside an archive
+struct ArchiveEntry {
+    std::string name;       // Relative path with '/' separators
+    uint64_t offset;        // From the start of the archive, ALIGNMENT-aligned
+    uint64_t storedSize;    // Bytes in the archive
+    uint64_t size;          // Bytes once decompressed
+    uint32_t flags;
+};
+
+// Packed asset archive, opened once and memory-mapped. Layout: header, blobs
+// each aligned to ALIGNMENT, then the table of contents. Uncompressed blobs
+// are handed out as pointers straight into the mapping, so a decoder reads
+// them without any copy or file open. Safe to read from several threads.
+class AssetArchive {
+public:
+    static const uint32_t FLAG_LZ4 = 1;
+    static const uint32_t ALIGNMENT = 64;
+
+    AssetArchive();
+    ~AssetArchive();
+
+    bool Open(const std::wstring& filename);
+    void Close();
+    bool IsOpen() const { return m_File.IsOpen(); }
+
+    const ArchiveEntry* Find(const std::string& name) const;
+    uint32_t GetEntryCount() const { return (uint32_t)m_Entries.size(); }
+    const ArchiveEntry& GetEntry(uint32_t index) const { return m_Entries[index]; }
+
+    // Bytes of an entry. Stored entries point into the mapping and scratch is
+    // untouched; LZ4 entries are decoded into scratch. Valid while the archive
+    // stays open and scratch is not reused.
+    bool GetData(const ArchiveEntry& entry, std::vector<uint8_t>& scratch, const uint8_t*& pData, size_t& size) const;
+    bool Read(const std::string& name, std::vector<uint8_t>& scratch, const uint8_t*& pData, size_t& size) const;
+
+private:
+    bool ReadTableOfContents();
+
+    MappedFile m_File;
+    std::vector<ArchiveEntry> m_Entries;
+    std::unordered_map<std::string, uint32_t> m_Lookup;
+};
+
+// Builds archives offline; see tools/AssetPacker.cpp
+class AssetArchiveWriter {
+public:
+    AssetArchiveWriter();
+
+    // Blobs are LZ4-compressed when asked and it saves at least an eighth;
+    // already-compressed formats such as PNG are usually left stored
+    bool AddFile(const std::string& name, const std::wstring& filename, bool bCompress = true);
+    void AddData(const std::string& name, const uint8_t* pData, size_t size, bool bCompress = true);
+
+    bool Save(const std::string& filename) const;
+
+    uint32_t GetEntryCount() const { return (uint32_t)m_Entries.size(); }
+    uint64_t GetStoredSize() const;
+    uint64_t GetRawSize() const;
+
+private:
+    struct PendingEntry {
+        std::string name;
+        std::vector<uint8_t> data;
+        uint64_t size;
+        uint32_t flags;
+    };
+
+    std::vector<PendingEntry> m_Entries;
+};
\ No newline at end of file
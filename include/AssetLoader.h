@@ -0,0 +1,135 @@
+#pragma once
+#include "ImageDecoder.h"
+#include "Sprite.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+class Renderer;
+class TextureAtlas;
+class AssetArchive;
+
+enum class AssetState {
+    QUEUED,     // Waiting for a worker to read and decode it
+    DECODED,    // Pixels are on the CPU, GPU upload pending
+    RESIDENT,   // Ready to use
+    FAILED      // Missing or undecodable file
+};
+
+// A file requested from AssetLoader, shared by every caller that asked for it.
+// State changes on the loader's threads; the sprite is only touched by
+// AssetLoader::Update, so it is safe to draw from the render thread.
+class Asset {
+public:
+    AssetState GetState() const { return m_State.load(std::memory_order_acquire); }
+    bool IsResident() const { return GetState() == AssetState::RESIDENT; }
+    bool IsFailed() const { return GetState() == AssetState::FAILED; }
+    const std::wstring& GetFilename() const { return m_Filename; }
+
+    // Can be drawn at any time; it shows the placeholder texture until resident
+    Sprite* GetSprite() { return &m_Sprite; }
+
+    // Pixels of CPU-only assets such as brush tips, valid once resident.
+    // Sprite pixels are released after upload.
+    const Image& GetImage() const { return m_Image; }
+
+private:
+    friend class AssetLoader;
+
+    Asset(const std::wstring& filename, bool bUpload);
+
+    std::wstring m_Filename;
+    bool m_bUpload;
+    std::atomic<AssetState> m_State;
+    Image m_Image;
+    Sprite m_Sprite;
+
+    // Where the pixels went: an atlas region, or a texture of its own
+    std::string m_AtlasName;
+    uint32_t m_TextureId;
+    bool m_bUnloaded;
+};
+
+using AssetHandle = std::shared_ptr<Asset>;
+
+// Reads and decodes images on a worker pool so startup does not wait on disk.
+// Load calls return immediately with a handle; Update, called once per frame
+// on the render thread, uploads finished images within a byte budget so a
+// large library streams in over several frames without hitching. Load and
+// Unload belong to one thread, which may be other than the one calling
+// Update; only Update touches the renderer and atlas.
+class AssetLoader {
+public:
+    static const size_t DEFAULT_UPLOAD_BUDGET = 8 * 1024 * 1024;
+
+    // Sprites that fit are packed into pAtlas when one is given, otherwise
+    // each gets its own texture. workerCount of 0 uses every hardware thread but one.
+    AssetLoader(Renderer* pRenderer, TextureAtlas* pAtlas = nullptr, uint32_t workerCount = 0);
+    ~AssetLoader();
+
+    bool Initialize();
+    void Cleanup();
+
+    // Queue a file; asking for the same file again returns the same handle.
+    // The placeholder size is used until the real size is known; a file
+    // already requested keeps the size it was first asked for.
+    AssetHandle LoadSprite(const std::wstring& filename, float placeholderWidth = 64.0f, float placeholderHeight = 64.0f);
+    AssetHandle LoadBrushTip(const std::wstring& filename);
+
+    // Look files up in a packed archive before the filesystem, by their
+    // relative path with '/' separators. Set before queuing loads.
+    void SetArchive(const AssetArchive* pArchive) { m_pArchive = pArchive; }
+
+    // Forget an asset; its texture or atlas space is released by the next Update
+    void Unload(const AssetHandle& asset);
+
+    // Upload decoded sprites until uploadBudget bytes have been sent; at least
+    // one is uploaded per call so oversized images still progress. Returns the
+    // number of assets finished.
+    uint32_t Update(size_t uploadBudget = DEFAULT_UPLOAD_BUDGET);
+
+    // Block until the file has been decoded (or failed); uploads still happen in Update
+    void Wait(const AssetHandle& asset);
+    void WaitAll();
+
+    // Assets not yet resident or failed
+    uint32_t GetPendingCount() const { return m_PendingCount.load(); }
+    uint32_t GetWorkerCount() const { return m_WorkerCount; }
+    uint32_t GetPlaceholderTexture() const { return m_PlaceholderTextureId; }
+
+private:
+    AssetHandle Load(const std::wstring& filename, bool bUpload, float placeholderWidth, float placeholderHeight);
+    std::unordered_map<std::wstring, AssetHandle>& GetAssetMap(bool bUpload) { return bUpload ? m_Sprites : m_BrushTips; }
+    bool Finalize(Asset& asset);
+    void Release(Asset& asset);
+    bool Decode(Asset& asset, std::vector<uint8_t>& scratch) const;
+    void WorkerMain();
+
+    Renderer* m_pRenderer;
+    TextureAtlas* m_pAtlas;
+    const AssetArchive* m_pArchive;
+    uint32_t m_PlaceholderTextureId;
+
+    // Every requested file, by name; touched only by the owning thread
+    std::unordered_map<std::wstring, AssetHandle> m_Sprites;
+    std::unordered_map<std::wstring, AssetHandle> m_BrushTips;
+    std::atomic<uint32_t> m_PendingCount;
+
+    // Worker pool
+    uint32_t m_WorkerCount;
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCondition;
+    std::condition_variable m_DoneCondition;
+    std::deque<AssetHandle> m_Queue;    // Waiting for a worker
+    std::deque<AssetHandle> m_Decoded;  // Waiting for Update
+    std::deque<AssetHandle> m_Unloaded; // Waiting for Update to release them
+    uint32_t m_ActiveWorkers;
+    bool m_bShutdown;
+};
\ No newline at end of file
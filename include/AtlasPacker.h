@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+struct AtlasRect {
+    uint32_t x, y;
+    uint32_t width, height;
+};
+
+// MaxRects bin packer (best short side fit) for one atlas page. Supports
+// incremental insertion, freeing rectangles for reuse, and re-reserving
+// known placements when a baked atlas is loaded. Freed space is not merged
+// with its neighbours straight away; the free list is rebuilt from the used
+// rectangles when an insertion would otherwise fail or the list has grown
+// well past its size at the last rebuild.
+class AtlasPacker {
+public:
+    AtlasPacker(uint32_t width, uint32_t height);
+
+    void Reset();
+
+    // Find space for a width x height rectangle. Returns false if it does not fit.
+    bool Insert(uint32_t width, uint32_t height, AtlasRect& rect);
+
+    // Mark a known placement as used. Returns false if it overlaps used space.
+    bool Reserve(const AtlasRect& rect);
+
+    // Return a previously inserted or reserved rectangle to the free space
+    void Free(const AtlasRect& rect);
+
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+    uint64_t GetUsedArea() const { return m_UsedArea; }
+    uint32_t GetFreeRectCount() const { return (uint32_t)m_FreeRects.size(); }
+    float GetOccupancy() const { return (float)m_UsedArea / ((float)m_Width * m_Height); }
+
+private:
+    bool FindPosition(uint32_t width, uint32_t height, AtlasRect& rect) const;
+    void Place(const AtlasRect& rect);
+    void Rebuild();
+    bool SplitFreeRect(const AtlasRect& freeRect, const AtlasRect& usedRect);
+    void PruneFreeRects();
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint64_t m_UsedArea;
+    std::vector<AtlasRect> m_UsedRects;
+    std::vector<AtlasRect> m_FreeRects;
+    std::vector<AtlasRect> m_NewFreeRects;
+
+    // Freed since the last rebuild, and the free list size at that point
+    uint32_t m_FreedCount;
+    uint64_t m_FreedArea;
+    uint32_t m_CleanFreeRectCount;
+};
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// How a layer combines with what is below it. All modes work on
+// premultiplied RGBA and a fully transparent source leaves the destination
+// unchanged, so empty layer tiles can be skipped.
+enum class LayerBlendMode {
+    NORMAL,     // Source over
+    MULTIPLY,
+    SCREEN,
+    OVERLAY,    // Multiply or screen depending on the destination
+    ADD,        // Linear dodge, clamped
+    ERASE       // Removes destination alpha where the source is opaque
+};
+
+const char* GetBlendModeName(LayerBlendMode mode);
+
+// Blend count premultiplied RGBA8 pixels of pSrc, scaled by opacity, onto
+// pDst. SSE2 does four pixels at a time on x86/x64; the scalar path matches
+// it to within rounding.
+void BlendPixels(LayerBlendMode mode, float opacity, const uint8_t* pSrc, uint8_t* pDst, size_t count);
\ No newline at end of file
@@ -1,5 +1,11 @@
 #pragma once
 #include "PressureBrush.h"
+#include "Canvas.h"
+#include "UndoHistory.h"
+#include "StrokeSmoother.h"
+#include "PenPredictor.h"
+#include "InputEventRing.h"
+#include "ParallelDabRenderer.h"
 #include <vector>
 #include <memory>
 #include <map>
@@ -19,23 +25,95 @@ public:
     void SetCurrentBrush(const std::string& name);
     PressureBrush* GetCurrentBrush() { return m_pCurrentBrush; }
 
-    // Drawing operations
+    // Strokes are painted into this canvas; null paints nothing. Changing
+    // canvas clears the undo history.
+    void SetCanvas(Canvas* pCanvas);
+    Canvas* GetCanvas() { return m_pCanvas; }
+
+    // Drawing operations. Samples are timestamped on arrival unless the
+    // device time is passed in (steady_clock milliseconds).
     void StartStroke(float x, float y, float pressure);
+    void StartStroke(float x, float y, float pressure, double timeMs);
     void ContinueStroke(float x, float y, float pressure);
+    void ContinueStroke(float x, float y, float pressure, double timeMs);
     void EndStroke();
+    bool IsDrawing() const { return m_bDrawing; }
+
+    // Drive strokes from a pen event, as the tablet callback does: contact
+    // starts or continues a stroke, lifting ends it, and tilt goes to the
+    // brush. Other events are ignored, since Windows also turns pen input
+    // into mouse messages.
+    void ProcessInput(const InputEvent& event);
+
+    // Each stroke is one undo state. Undo and redo end a stroke in progress.
+    bool Undo();
+    bool Redo();
+    bool CanUndo() const { return m_History.CanUndo(); }
+    bool CanRedo() const { return m_History.CanRedo(); }
+    UndoHistory& GetHistory() { return m_History; }
+
+    // Dabs stamped into the canvas since Initialize
+    uint64_t GetDabCount() const { return m_DabCount; }
+
+    // Threads stamping each batch of dabs, split by canvas tile; the result
+    // is identical for any count. 0 uses every hardware thread, 1 stamps on
+    // the calling thread. Initialize uses every hardware thread.
+    void SetDabThreads(uint32_t threadCount);
+    // Stamp batches as jobs on the engine's job system instead, sharing its
+    // threads; null goes back to threads of its own
+    void SetJobSystem(JobSystem* pJobSystem);
+    uint32_t GetDabThreads() const { return m_pDabRenderer ? m_pDabRenderer->GetThreadCount() : 1; }
+    ParallelDabRenderer* GetDabRenderer() { return m_pDabRenderer.get(); }
     
+    // Input smoothing: lookahead of 0 (off) to 3 samples; see StrokeSmoother.
+    // Latency is the delay smoothing added to the current or last stroke.
+    void SetSmoothing(uint32_t lookahead) { m_Smoother.SetLookahead(lookahead); }
+    uint32_t GetSmoothing() const { return m_Smoother.GetLookahead(); }
+    const StrokeLatency& GetStrokeLatency() const { return m_Smoother.GetLatency(); }
+
+    // Prediction: each frame UpdatePreview redraws the preview canvas with
+    // the samples smoothing still holds back plus predictionMs of predicted
+    // pen motion. The tail never touches the main canvas, so it is simply
+    // replaced once the real samples arrive. 0 turns prediction off.
+    void SetPreviewCanvas(Canvas* pCanvas) { m_pPreviewCanvas = pCanvas; }
+    Canvas* GetPreviewCanvas() { return m_pPreviewCanvas; }
+    void SetPrediction(double predictionMs) { m_PredictionMs = predictionMs > 0.0 ? predictionMs : 0.0; }
+    double GetPrediction() const { return m_PredictionMs; }
+    void UpdatePreview();
+
     // Configuration
     void SetColor(float r, float g, float b, float a = 1.0f);
     void SetOpacity(float opacity) { m_Opacity = opacity; }
     float GetOpacity() const { return m_Opacity; }
+    void SetTilt(float tiltX, float tiltY);  // Forwarded to the current brush
 
 private:
+    // Turn smoothed curve points into dabs and stamp them as one batch
+    void PaintCurve();
+    void SetDabRenderer(ParallelDabRenderer* pRenderer);   // Takes ownership; null stamps serially
+    static double GetTimeMs();
+
     std::vector<std::unique_ptr<PressureBrush>> m_Brushes;
     std::map<std::string, PressureBrush*> m_BrushMap;
     PressureBrush* m_pCurrentBrush;
+    Canvas* m_pCanvas;
     
     float m_LastX, m_LastY;
     bool m_bDrawing;
+
+    StrokeSmoother m_Smoother;
+    std::vector<StrokeSample> m_Curve;
+    std::vector<Dab> m_Dabs;
+    uint64_t m_DabCount;
+    std::unique_ptr<ParallelDabRenderer> m_pDabRenderer;
+
+    UndoHistory m_History;
+    std::vector<Canvas::TileChange> m_TileChanges;
+
+    PenPredictor m_Predictor;
+    Canvas* m_pPreviewCanvas;
+    double m_PredictionMs;
+    bool m_bPreviewDrawn;
     
     // Current drawing properties
     float m_ColorR, m_ColorG, m_ColorB, m_ColorA;
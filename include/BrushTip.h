@@ -0,0 +1,82 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include "DabRasterizer.h"
+
+struct Image;
+
+// A tip stamped at one diameter and rotation: size x size coverage bytes
+struct TipMask {
+    uint32_t size;
+    uint32_t angleStep;
+    std::vector<uint8_t> pixels;
+};
+
+// Greyscale brush tip with a mip chain and a cache of resampled masks, so a
+// stroke of same-sized dabs resamples the texture once rather than per dab.
+// Masks are keyed by whole-pixel diameter and the angle quantised to
+// ANGLE_STEPS; the least recently used are evicted past the byte budget.
+class BrushTip {
+public:
+    static const uint32_t ANGLE_STEPS = 64;
+    static const uint32_t MAX_SIZE = 2048;
+    static const size_t DEFAULT_CACHE_BUDGET = 16 * 1024 * 1024;
+
+    BrushTip();
+    ~BrushTip();
+
+    // Straight-alpha RGBA. A tip with any transparency uses its alpha as
+    // coverage; an opaque one is read as dark-on-light (black paints).
+    // Returns false for an empty image. Clears the cache.
+    bool SetTexture(const Image& image);
+    bool SetTexture(const uint8_t* pPixels, uint32_t width, uint32_t height);
+    void Clear();
+    bool IsEmpty() const { return m_Levels.empty(); }
+
+    // Mask for a dab of this diameter rotated by angle radians. The pointer
+    // stays valid until the next GetMask (or EndBatch), SetTexture or Clear.
+    const TipMask* GetMask(float diameter, float angle);
+
+    // Stamp for the dab: its mask centred on it, corner snapped to whole
+    // pixels. Radius and angle pick the mask; hardness is ignored.
+    void MakeStamp(const Dab& dab, DabStamp& stamp);
+
+    // Nothing is evicted between BeginBatch and EndBatch, so every mask
+    // handed out in between stays valid until EndBatch
+    void BeginBatch() { m_bHold = true; }
+    void EndBatch();
+
+    void SetCacheBudget(size_t bytes);
+    size_t GetCacheBudget() const { return m_CacheBudget; }
+    size_t GetCacheBytes() const { return m_CacheBytes; }
+    size_t GetCachedMaskCount() const { return m_Cache.size(); }
+    uint64_t GetHitCount() const { return m_Hits; }
+    uint64_t GetMissCount() const { return m_Misses; }
+    void ResetStats() { m_Hits = m_Misses = 0; }
+
+private:
+    // One greyscale mip level
+    struct Level {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+    };
+
+    // Bilinear resample of the smallest level still at least size across
+    void BuildMask(TipMask& mask) const;
+    void Evict();
+
+    std::vector<Level> m_Levels;
+
+    // Most recently used at the front
+    std::list<TipMask> m_Cache;
+    std::unordered_map<uint32_t, std::list<TipMask>::iterator> m_CacheIndex;
+    size_t m_CacheBudget;
+    size_t m_CacheBytes;
+    uint64_t m_Hits;
+    uint64_t m_Misses;
+    bool m_bHold;
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+
+// Paint surface split into TILE_SIZE x TILE_SIZE tiles of premultiplied
+// RGBA8. Tiles are allocated the first time they are painted, so a large
+// mostly-empty canvas costs almost nothing; unallocated tiles read as
+// transparent. No GPU involved: upload with ReadPixels and the dirty rect.
+// Tiles are reference counted and copied on write, so history can keep old
+// versions of a tile without copying the ones that never change.
+class Canvas {
+public:
+    static const uint32_t TILE_SIZE = 64;
+    static const uint32_t TILE_BYTES = TILE_SIZE * TILE_SIZE * 4;
+
+    typedef std::shared_ptr<uint8_t[]> TilePtr;
+
+    // A tile's contents on the other side of a change; null is unallocated
+    struct TileChange {
+        uint32_t index;     // tileY * GetTilesX() + tileX
+        TilePtr tile;
+    };
+
+    Canvas(uint32_t width, uint32_t height);
+    ~Canvas();
+
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+    uint32_t GetTilesX() const { return m_TilesX; }
+    uint32_t GetTilesY() const { return m_TilesY; }
+
+    // Tile pixels, rows of TILE_SIZE * 4 bytes. GetTile returns null for
+    // tiles that were never painted. The non-const accessors are writes: a
+    // tile shared with history is copied first.
+    const uint8_t* GetTile(uint32_t tileX, uint32_t tileY) const;
+    uint8_t* GetTile(uint32_t tileX, uint32_t tileY);
+    uint8_t* GetOrCreateTile(uint32_t tileX, uint32_t tileY);
+    uint32_t GetAllocatedTileCount() const { return m_AllocatedTiles; }
+
+    // Release every tile
+    void Clear();
+
+    // Between BeginChange and EndChange the first write to each tile saves
+    // the version it replaces, so EndChange costs O(tiles written) however
+    // large the canvas is
+    void BeginChange();
+    void EndChange(std::vector<TileChange>& changes);
+    bool IsChanging() const { return m_bChanging; }
+
+    // Exchange the canvas tiles with the ones in changes. Applying the
+    // changes from EndChange undoes the edit and leaves what redoes it.
+    void SwapTiles(std::vector<TileChange>& changes);
+
+    // Copy a region out as premultiplied RGBA8; rowPitch is in bytes
+    void ReadPixels(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t* pDst, uint32_t rowPitch) const;
+
+    // Union of the areas painted since ClearDirty; x1 and y1 are exclusive
+    void MarkDirty(int x0, int y0, int x1, int y1);
+    bool GetDirtyRect(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height) const;
+    void ClearDirty();
+
+private:
+    // Write access to a tile: records it for the open change and copies it
+    // if history still shares it
+    uint8_t* GetWritableTile(size_t index, bool bCreate);
+    void SaveTile(size_t index);
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_TilesX;
+    uint32_t m_TilesY;
+    std::vector<TilePtr> m_Tiles;
+    uint32_t m_AllocatedTiles;
+
+    bool m_bChanging;
+    std::vector<uint8_t> m_TileSaved;   // Per tile, set once saved in m_Changes
+    std::vector<TileChange> m_Changes;
+
+    bool m_bDirty;
+    int m_DirtyX0, m_DirtyY0, m_DirtyX1, m_DirtyY1;
+};
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+#include <d3d11_4.h>
+#include <wrl/client.h>
+#include "RenderBackend.h"
+#include "RingBufferAllocator.h"
+#include "GeometryArena.h"
+#include "SpriteInstance.h"
+#include "GraphicsDevice.h"
+#include <vector>
+
+// Dynamic D3D11 buffer mapped with WRITE_DISCARD / WRITE_NO_OVERWRITE
+class D3D11RingBufferStorage : public RingBufferStorage {
+public:
+    D3D11RingBufferStorage(GraphicsDevice* pGraphicsDevice, UINT bindFlags);
+
+    bool Create(size_t sizeInBytes) override;
+    void* Map(bool discard) override;
+    void Unmap() override;
+
+    ID3D11Buffer* GetBuffer() const { return m_pBuffer.Get(); }
+    ID3D11Buffer* const* GetAddressOf() const { return m_pBuffer.GetAddressOf(); }
+    void Reset() { m_pBuffer.Reset(); }
+
+private:
+    GraphicsDevice* m_pGraphicsDevice;
+    VertexFormat m_VertexFormat;
+    UINT m_BindFlags;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_pBuffer;
+};
+
+class D3D11RenderBackend : public RenderBackend {
+public:
+    D3D11RenderBackend(GraphicsDevice* pGraphicsDevice, VertexFormat vertexFormat = VertexFormat::STANDARD);
+    ~D3D11RenderBackend() override;
+
+    bool Initialize() override;
+    void Cleanup() override;
+    VertexFormat GetVertexFormat() const override { return m_VertexFormat; }
+    void BeginFrame() override;
+
+    uint32_t CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) override;
+    void DestroyTexture(uint32_t textureId) override;
+    bool UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                       const uint8_t* pPixels, uint32_t rowPitch) override;
+
+    bool AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) override;
+    void Submit(const uint16_t* pIndices, uint32_t indexCount,
+                const DrawRun* pRuns, uint32_t runCount) override;
+
+    bool AppendInstances(uint32_t count, SpriteInstance*& pInstances) override;
+    void SubmitInstances(BlendMode blendMode, uint32_t textureId) override;
+
+    void DrawIndexed(const Vertex* pVertices, uint32_t vertexCount,
+                     const uint32_t* pIndices, uint32_t indexCount,
+                     BlendMode blendMode) override;
+
+private:
+    void BindPipeline(BlendMode blendMode, uint32_t textureId);
+    void SetBlendState(BlendMode blendMode);
+    void BindTexture(uint32_t textureId);
+
+    bool CreateShaders();
+    bool CreateInputLayout();
+    bool CreateInstancedShader();
+    bool CreateVertexBuffer();
+    bool CreateIndexBuffer();
+    bool CreateConstantBuffers();
+    bool CreateBlendStates();
+    bool CreateSamplerState();
+
+    GraphicsDevice* m_pGraphicsDevice;
+    VertexFormat m_VertexFormat;
+
+    // Shaders
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> m_pVertexShader;
+    Microsoft::WRL::ComPtr<ID3D11PixelShader> m_pPixelShader;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_pInputLayout;
+    Microsoft::WRL::ComPtr<ID3D11VertexShader> m_pInstancedVertexShader;
+    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_pInstancedInputLayout;
+
+    // Buffers
+    D3D11RingBufferStorage m_VertexStorage;
+    D3D11RingBufferStorage m_IndexStorage;
+    RingBufferAllocator m_VertexRing;
+    RingBufferAllocator m_IndexRing;
+    GeometryArena m_Arena;
+
+    // Instanced sprite stream, mapped while a batch is being built
+    D3D11RingBufferStorage m_InstanceStorage;
+    RingBufferAllocator m_InstanceRing;
+    SpriteInstance* m_pInstances;
+    uint32_t m_FirstInstance;
+    uint32_t m_InstanceCapacity;
+    uint32_t m_InstanceCount;
+    bool m_bInstancesMapped;
+    Microsoft::WRL::ComPtr<ID3D11Buffer> m_pConstantBuffer;
+
+    // Blend states for transparency
+    Microsoft::WRL::ComPtr<ID3D11BlendState> m_pBlendState;
+    Microsoft::WRL::ComPtr<ID3D11BlendState> m_pPremultipliedBlendState;
+
+    // Texture table indexed by sort key texture id; slot 0 is WHITE_TEXTURE
+    std::vector<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> m_Textures;
+    std::vector<uint32_t> m_FreeTextures;
+    Microsoft::WRL::ComPtr<ID3D11SamplerState> m_pSamplerState;
+};
\ No newline at end of file
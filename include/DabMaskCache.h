@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include "DabRasterizer.h"
+
+// A round dab's coverage, rasterised once and reused
+struct DabMask {
+    uint32_t key;
+    uint32_t size;      // size x size bytes, 255 = full coverage
+    int32_t offset;     // Top-left corner relative to the dab's whole-pixel centre
+    std::vector<uint8_t> pixels;
+};
+
+// Pre-rasterised round tips, so stamping a dab is a masked blend instead of
+// a falloff per pixel. Dabs are quantised: diameter to 1/SIZE_STEPS pixel,
+// hardness to 1/HARDNESS_STEPS and the centre to 1/SUBPIXEL_STEPS pixel on
+// each axis, one mask per sub-pixel phase so strokes stay smooth. Masks are
+// built on first use and the least recently used are evicted past the byte
+// budget. Dabs larger than MAX_RADIUS are left to RasterizeDab: their masks
+// would rarely be reused and cost as much to build as to stamp.
+class DabMaskCache {
+public:
+    static const uint32_t SIZE_STEPS = 4;
+    static const uint32_t HARDNESS_STEPS = 64;
+    static const uint32_t SUBPIXEL_STEPS = 4;
+    static constexpr float MAX_RADIUS = 64.0f;
+    static const size_t DEFAULT_CACHE_BUDGET = 8 * 1024 * 1024;
+
+    DabMaskCache();
+    ~DabMaskCache();
+
+    // Mask for the dab and the canvas pixel its top-left corner lands on;
+    // null for dabs that are not cached. The pointer stays valid until the
+    // next GetMask (or EndBatch) or Clear.
+    const DabMask* GetMask(const Dab& dab, int& originX, int& originY);
+
+    // Stamp for the dab: its cached mask, or the plain round falloff for
+    // dabs that are not cached
+    void MakeStamp(const Dab& dab, DabStamp& stamp);
+
+    // Nothing is evicted between BeginBatch and EndBatch, so every mask
+    // handed out in between stays valid until EndBatch
+    void BeginBatch() { m_bHold = true; }
+    void EndBatch();
+
+    void Clear();
+    void SetCacheBudget(size_t bytes);
+    size_t GetCacheBudget() const { return m_CacheBudget; }
+    size_t GetCacheBytes() const { return m_CacheBytes; }
+    size_t GetCachedMaskCount() const { return m_Cache.size(); }
+    uint64_t GetHitCount() const { return m_Hits; }
+    uint64_t GetMissCount() const { return m_Misses; }
+    void ResetStats() { m_Hits = m_Misses = 0; }
+
+private:
+    void Evict();
+
+    // Most recently used at the front
+    std::list<DabMask> m_Cache;
+    std::unordered_map<uint32_t, std::list<DabMask>::iterator> m_CacheIndex;
+    size_t m_CacheBudget;
+    size_t m_CacheBytes;
+    uint64_t m_Hits;
+    uint64_t m_Misses;
+    bool m_bHold;
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class Canvas;
+
+enum class DabMode : uint8_t {
+    PAINT,      // Source-over the colour
+    ERASE,      // Remove alpha * coverage of the canvas; the colour is ignored
+    SMUDGE      // Drag the colour a SmudgeBuffer carries; see RasterizeSmudgeDab
+};
+
+// One brush stamp: a round tip with a radial falloff
+struct Dab {
+    float x, y;         // Centre in canvas pixels
+    float radius;
+    float hardness;     // 0 fades from the centre, 1 is solid with a 1-pixel antialiased edge
+    float opacity;      // Flow of this stamp, 0..1
+    float r, g, b, a;   // Straight-alpha colour, 0..1
+    float angle = 0.0f; // Tip rotation in radians, for textured tips
+    DabMode mode = DabMode::PAINT;
+};
+
+// Colour a smudge stroke picks up and carries: size x size premultiplied
+// RGBA floats (0..255) centred on the dab, so it moves with the brush
+struct SmudgeBuffer {
+    uint32_t size;
+    std::vector<float> pixels;
+    bool loaded;        // False until the first dab of the stroke picks up colour
+
+    SmudgeBuffer() : size(0), loaded(false) {}
+    void Reset(uint32_t newSize) {
+        size = newSize;
+        pixels.assign((size_t)size * size * 4, 0.0f);
+        loaded = false;
+    }
+};
+
+// Coverage of a pixel at distance from the dab centre: 1 inside
+// radius * hardness, then a smoothstep down to 0 at the radius
+float DabFalloff(float distance, float radius, float hardness);
+
+// Source-over the dab into the canvas, allocating tiles it touches. Pixels
+// are sampled at their centres. SSE2 evaluates the falloff and blend four
+// pixels at a time on x86/x64; the scalar path matches it to within rounding.
+// ERASE dabs only touch tiles that are already allocated; SMUDGE dabs are
+// skipped.
+void RasterizeDab(Canvas& canvas, const Dab& dab);
+
+// Stamp a maskSize x maskSize coverage mask (255 = full coverage) centred on
+// the dab, its corner snapped to whole pixels; radius and hardness are
+// ignored. Used for textured tips, see BrushTip.
+void RasterizeMaskedDab(Canvas& canvas, const Dab& dab, const uint8_t* pMask, uint32_t maskSize);
+
+// As RasterizeMaskedDab with the mask's top-left corner at a given canvas
+// pixel. Tiles under all-zero parts of the mask are not touched.
+void RasterizeMask(Canvas& canvas, const Dab& dab, const uint8_t* pMask, uint32_t maskSize, int originX, int originY);
+
+// Rasterise the round falloff into a maskSize x maskSize coverage mask, the
+// centre given in mask pixels; see DabMaskCache
+void RasterizeDabMask(float radius, float hardness, float centerX, float centerY, uint8_t* pMask, uint32_t maskSize);
+
+// A dab set up to be stamped one canvas tile at a time. Stamping the tiles
+// in any order, each tile's dabs in batch order, gives exactly the pixels
+// RasterizeDab and RasterizeMask do, since they are built on the same calls.
+struct DabStamp {
+    Dab dab;
+    const uint8_t* pMask;   // Null for the round falloff
+    uint32_t maskSize;
+    int originX, originY;   // Mask top-left corner in canvas pixels
+    int x0, y0, x1, y1;     // Pixels it can touch, set by PrepareStamp; x1 and y1 exclusive
+};
+
+// Compute the stamp's bounds; false if it paints nothing (or is a smudge)
+bool PrepareStamp(const Canvas& canvas, DabStamp& stamp);
+
+// Whether a tile within the bounds needs stamping: round dabs skip the
+// corners of their bounds, masks skip tiles under all-zero mask bytes
+bool StampTouchesTile(const DabStamp& stamp, int tileX, int tileY);
+
+// Blend the part of the stamp inside one tile into its pixels. Touches
+// nothing but pTile, so different tiles can be stamped concurrently.
+void StampTile(const DabStamp& stamp, uint8_t* pTile, int tileX, int tileY);
+
+// Prepare the stamp and stamp every tile it touches, in tile order, on the
+// calling thread
+void RasterizeStamp(Canvas& canvas, DabStamp& stamp);
+
+// Smudge with the round falloff. The first dab after buffer.Reset loads the
+// canvas under it into the buffer; every later dab mixes pickup * coverage
+// of the canvas into the carried colour, then blends the canvas toward it by
+// coverage. 0 drags the first colour along the whole stroke; higher rates
+// let it fade into whatever the brush passes over.
+void RasterizeSmudgeDab(Canvas& canvas, const Dab& dab, SmudgeBuffer& buffer, float pickup);
+
+// Stamp a batch of dabs in order
+void RasterizeDabs(Canvas& canvas, const Dab* pDabs, size_t count);
\ No newline at end of file
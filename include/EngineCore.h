@@ -3,7 +3,13 @@
 #include <wrl/client.h>
 #include "GraphicsDevice.h"
 #include "Renderer.h"
+#include "AssetLoader.h"
 #include "InputManager.h"
+#include "JobSystem.h"
+#include "RenderThread.h"
+#include "FrameTimer.h"
+#include <functional>
+#include <atomic>
 
 class EngineCore {
 public:
@@ -14,17 +20,68 @@ public:
     void Run();
     void Shutdown();
 
+    // Called at a fixed rate with the step in seconds, zero or more times
+    // per frame before the frame callback, on the main thread
+    void RegisterUpdateCallback(std::function<void(double)> callback) { m_UpdateCallback = callback; }
+
+    // Called once per frame on the main thread. Drawing is recorded into the
+    // frame's command list and replayed on the render thread while the next
+    // frame is built; the renderer and graphics device belong to the render
+    // thread from Initialize until Shutdown.
+    void RegisterFrameCallback(std::function<void()> callback) { m_FrameCallback = callback; }
+
+    // Called once from Initialize, set before it: the last point where the
+    // main thread may use the renderer, to create the textures its frames
+    // will draw and update through the command list
+    void RegisterRendererCallback(std::function<void(Renderer&)> callback) { m_RendererCallback = callback; }
+    RenderCommandList& GetCommandList() { return m_pRenderThread->GetCommandList(); }
+    RenderThread* GetRenderThread() { return m_pRenderThread.get(); }
+
+    // How far real time is past the last fixed update, as a fraction of a
+    // step: draw state interpolated this far from the previous update to
+    // the latest, so motion is smooth at any frame rate
+    float GetInterpolation() const { return m_FrameTimer.GetAlpha(); }
+
+    // Pacing: 0 fps is uncapped; with vsync off as well, frames run as fast
+    // as they can, for benchmarking. Defaults are 120 Hz updates, no cap and
+    // vsync on. Per-frame timings are kept in the frame timer.
+    void SetFixedStep(double stepSeconds) { m_FrameTimer.SetFixedStep(stepSeconds); }
+    void SetFrameRateCap(double fps) { m_FrameTimer.SetTargetFps(fps); }
+    void SetVSync(bool bVSync) { m_bVSync.store(bVSync, std::memory_order_relaxed); }
+    const FrameTimer& GetFrameTimer() const { return m_FrameTimer; }
+
+    // Jobs queued against the frame counter finish before the frame is
+    // flushed, so the frame callback can fan work out and leave it running.
+    // Main-thread jobs run each frame before the callback.
+    JobSystem* GetJobSystem() { return m_pJobSystem.get(); }
+    JobCounter& GetFrameJobs() { return m_FrameJobs; }
+
     // Getters for subsystems
     GraphicsDevice* GetGraphicsDevice() { return m_pGraphicsDevice.get(); }
     Renderer* GetRenderer() { return m_pRenderer.get(); }
+    AssetLoader* GetAssetLoader() { return m_pAssetLoader.get(); }
     InputManager* GetInputManager() { return m_pInputManager.get(); }
 
 private:
     static LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
+    void PumpMessages();
 
+    std::unique_ptr<JobSystem> m_pJobSystem;
+    JobCounter m_FrameJobs;
     std::unique_ptr<GraphicsDevice> m_pGraphicsDevice;
     std::unique_ptr<Renderer> m_pRenderer;
+    std::unique_ptr<AssetLoader> m_pAssetLoader;
     std::unique_ptr<InputManager> m_pInputManager;
+    std::unique_ptr<RenderThread> m_pRenderThread;
+    std::function<void()> m_FrameCallback;
+    std::function<void(double)> m_UpdateCallback;
+    std::function<void(Renderer&)> m_RendererCallback;
+    FrameTimer m_FrameTimer;
+    std::atomic<bool> m_bVSync;     // Read by the render thread at present
+
+    // Window size from WM_SIZE, width << 16 | height, applied by the render
+    // thread at the start of its next frame; 0 when there is none
+    std::atomic<uint32_t> m_PendingSize;
 
     HINSTANCE m_hInstance;
     HWND m_hwnd;
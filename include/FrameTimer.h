@@ -0,0 +1,117 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// How one frame went, from its BeginFrame to the next
+struct FrameTiming {
+    double frameMs;     // Whole frame, start to start
+    double workMs;      // BeginFrame to EndFrame
+    double waitMs;      // Spent in EndFrame waiting for the next frame to be due
+    double spinMs;      // The part of waitMs spent spinning rather than asleep
+    double lateMs;      // How far past its due time the next frame started
+    uint32_t updates;   // Fixed steps run this frame
+    float alpha;        // Interpolation factor it rendered with
+};
+
+// Summary of the recorded frames; jitter is the standard deviation
+struct FrameStats {
+    uint32_t frames;
+    double meanMs;
+    double jitterMs;
+    double p99Ms;
+    double maxMs;
+    double meanWaitMs;
+    double meanSpinMs;
+    uint64_t droppedSteps;  // Since construction
+};
+
+// Drives a fixed-timestep loop: each frame BeginFrame turns the real time
+// since the last frame into a number of fixed simulation steps, and the
+// time left over in the accumulator becomes the interpolation factor for
+// rendering between the last two simulated states. Time is kept in integer
+// nanoseconds, so the step count never drifts from the clock.
+//
+// With a frame-rate cap EndFrame waits until the next frame is due. It
+// sleeps until just short of the deadline, asking for less than it needs by
+// the learned overshoot of an OS sleep, and yields only through a short
+// window at the end, so pacing is precise without burning a core.
+// Deadlines advance by exactly one period, so frames do not drift; a frame
+// more than a period late starts the schedule again rather than racing to
+// catch up.
+class FrameTimer {
+public:
+    static const uint32_t HISTORY_SIZE = 512;
+
+    FrameTimer();
+    ~FrameTimer();
+
+    // Simulation rate; defaults to 120 Hz. Steps beyond maxStepsPerFrame in
+    // one frame are dropped so a stall does not turn into a spiral of ever
+    // longer catch-up frames.
+    void SetFixedStep(double stepSeconds);
+    double GetFixedStep() const { return (double)m_StepNs * 1e-9; }
+    void SetMaxStepsPerFrame(uint32_t maxSteps) { m_MaxSteps = maxSteps > 0 ? maxSteps : 1; }
+
+    // 0 runs uncapped, for benchmarking
+    void SetTargetFps(double fps);
+    double GetTargetFps() const { return m_PeriodNs > 0 ? 1e9 / (double)m_PeriodNs : 0.0; }
+
+    // Forget the previous frame, so the next one does not count the time
+    // spent before the loop started
+    void Reset();
+
+    // Start of a frame: returns how many fixed steps to run
+    uint32_t BeginFrame();
+
+    // End of a frame: wait until the next is due, if capped
+    void EndFrame();
+
+    // Real seconds since the previous frame, and the fraction of a step
+    // (0..1) the simulation is behind real time
+    double GetDeltaSeconds() const { return (double)m_DeltaNs * 1e-9; }
+    float GetAlpha() const { return (float)((double)m_AccumulatorNs / (double)m_StepNs); }
+
+    uint64_t GetFrameCount() const { return m_FrameCount; }
+    uint64_t GetStepCount() const { return m_StepCount; }
+
+    // Completed frames, newest last; at most HISTORY_SIZE are kept
+    size_t GetHistoryCount() const;
+    const FrameTiming& GetHistory(size_t index) const;
+    FrameStats GetStats() const;
+
+private:
+    static int64_t GetTimeNs();
+    void SleepUntil(int64_t deadlineNs);
+    void SleepFor(int64_t durationNs);
+
+    int64_t m_StepNs;
+    uint32_t m_MaxSteps;
+    int64_t m_PeriodNs;
+
+    int64_t m_FrameStartNs;     // 0 before the first frame
+    int64_t m_DeadlineNs;
+    int64_t m_DeltaNs;
+    int64_t m_AccumulatorNs;
+    uint64_t m_FrameCount;
+    uint64_t m_StepCount;
+
+    // The frame in progress, and the ring of finished ones
+    FrameTiming m_Current;
+    std::vector<FrameTiming> m_History;
+    size_t m_HistoryNext;
+    size_t m_HistoryCount;
+    uint64_t m_DroppedSteps;
+
+    // How much longer than asked the last few OS sleeps took; the estimate
+    // is a high percentile, so a preempted sleep does not inflate it
+    static const uint32_t OVERSHOOT_SAMPLES = 32;
+    int64_t m_OvershootNs[OVERSHOOT_SAMPLES];
+    uint32_t m_OvershootNext;
+    uint32_t m_OvershootCount;
+    int64_t m_OvershootEstimateNs;
+
+#ifdef _WIN32
+    void* m_hTimer;     // High-resolution waitable timer, null if unsupported
+#endif
+};
\ No newline at end of file
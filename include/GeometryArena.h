@@ -0,0 +1,33 @@
+#pragma once
+#include "RenderBackend.h"
+#include "RingBufferAllocator.h"
+
+// Keeps a vertex ring mapped for the lifetime of one batch and hands out
+// consecutive spans from it, so Renderer writes vertices directly into their
+// final destination. Batches are capped at MAX_BATCH_VERTICES so
+// batch-relative indices always fit in 16 bits.
+class GeometryArena {
+public:
+    static constexpr uint32_t MAX_BATCH_VERTICES = 65536;
+
+    GeometryArena(RingBufferAllocator* pVertexRing);
+
+    bool Append(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex);
+
+    // Unmap the batch and report where it landed in the ring.
+    // Returns false if nothing was appended.
+    bool Close(uint32_t& firstVertex, uint32_t& vertexCount);
+
+    bool IsOpen() const { return m_bOpen; }
+
+private:
+    bool Open(uint32_t vertexCount);
+
+    RingBufferAllocator* m_pVertexRing;
+
+    uint8_t* m_pVertices;
+    uint32_t m_FirstVertex;
+    uint32_t m_VertexCapacity;
+    uint32_t m_VertexCount;
+    bool m_bOpen;
+};
\ No newline at end of file
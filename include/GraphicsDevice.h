@@ -17,10 +17,12 @@ public:
     IDXGISwapChain* GetSwapChain() const { return m_pSwapChain.Get(); }
     ID3D11RenderTargetView* GetRenderTargetView() const { return m_pRenderTargetView.Get(); }
     ID3D11DepthStencilView* GetDepthStencilView() const { return m_pDepthStencilView.Get(); }
+    UINT GetWidth() const { return m_width; }
+    UINT GetHeight() const { return m_height; }
 
     // Rendering methods
     void BeginFrame(float r = 0.0f, float g = 0.0f, float b = 0.0f, float a = 1.0f);
-    void EndFrame();
+    void EndFrame(bool bVSync = true);     // Present; without vsync it does not wait for the display
     void Resize(UINT width, UINT height);
 
 private:
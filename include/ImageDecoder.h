@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Decoded image: RGBA8, straight alpha, rows top-down with no padding
+struct Image {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;
+
+    Image() : width(0), height(0) {}
+    bool IsEmpty() const { return pixels.empty(); }
+};
+
+enum class ImageFormat {
+    UNKNOWN,
+    PNG,
+    TGA,
+    BMP
+};
+
+// Portable decoders; no platform codecs involved.
+// PNG: all colour types and bit depths, including Adam7 interlacing.
+// TGA: true-colour and greyscale, raw or RLE, 8/16/24/32-bit.
+// BMP: 8-bit palettised, 16/24/32-bit, BI_RGB and BI_BITFIELDS.
+ImageFormat DetectImageFormat(const uint8_t* pData, size_t size);
+bool DecodeImage(const uint8_t* pData, size_t size, Image& image);
+bool DecodePNG(const uint8_t* pData, size_t size, Image& image);
+bool DecodeTGA(const uint8_t* pData, size_t size, Image& image);
+bool DecodeBMP(const uint8_t* pData, size_t size, Image& image);
+
+bool LoadImageFile(const std::wstring& filename, Image& image);
+
+// Box-filtered mip levels 1..n down to 1x1 (level 0 is the image itself).
+// Premultiply first so transparent texels do not darken their neighbours.
+void GenerateMipChain(const Image& image, std::vector<Image>& mips);
\ No newline at end of file
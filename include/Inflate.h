@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// DEFLATE (RFC 1951) decoder with zlib (RFC 1950) framing, enough for PNG
+// image data. Output is appended to out; expectedSize is a capacity hint.
+bool InflateZlib(const uint8_t* pData, size_t size, std::vector<uint8_t>& out, size_t expectedSize = 0);
+bool InflateRaw(const uint8_t* pData, size_t size, std::vector<uint8_t>& out, size_t expectedSize = 0);
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+enum class InputEventType : uint8_t {
+    MOUSE_MOVE,
+    MOUSE_DOWN,
+    MOUSE_UP,
+    MOUSE_WHEEL,
+    PEN_DOWN,
+    PEN_MOVE,
+    PEN_UP,
+    KEY_DOWN,
+    KEY_UP
+};
+
+// One input sample, stamped when the device produced it rather than when
+// it was handled
+struct InputEvent {
+    // Pen event buttons
+    static constexpr uint32_t PEN_CONTACT = 1;
+    static constexpr uint32_t PEN_BARREL = 2;
+
+    double timeMs;          // Same clock as std::chrono::steady_clock
+    float x, y;
+    float pressure;         // 0.0 to 1.0; mouse events use 0
+    float tiltX, tiltY;     // Degrees
+    uint32_t buttons;       // MK_* flags for mouse, PEN_* for pen, or the key code for key events
+    int32_t wheelDelta;
+    InputEventType type;
+    bool isEraser;
+};
+
+// Single-producer/single-consumer queue of input events. The message thread
+// pushes, one other thread drains in batches; neither ever blocks. When the
+// consumer falls behind by a full ring the newest events are dropped and
+// counted, so the events that do arrive are always in order.
+class InputEventRing {
+public:
+    static const uint32_t DEFAULT_CAPACITY = 4096;
+
+    // Capacity is rounded up to a power of two
+    explicit InputEventRing(uint32_t capacity = DEFAULT_CAPACITY);
+
+    // Producer thread only
+    bool Push(const InputEvent& event);
+
+    // Consumer thread only; returns how many events were copied to pEvents
+    size_t PopBatch(InputEvent* pEvents, size_t maxCount);
+
+    uint32_t GetCapacity() const { return m_Mask + 1; }
+    uint64_t GetDroppedCount() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+    // Events waiting; only a snapshot while the other side is running
+    size_t GetSize() const;
+
+private:
+    static const size_t CACHE_LINE = 64;
+
+    std::vector<InputEvent> m_Events;
+    uint32_t m_Mask;
+
+    // Each side owns one index and keeps a stale copy of the other's, so it
+    // only touches the shared line when the copy says the ring is full/empty
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_Head;   // Next slot to write
+    uint64_t m_CachedTail;
+    std::atomic<uint64_t> m_Dropped;
+
+    alignas(CACHE_LINE) std::atomic<uint64_t> m_Tail;   // Next slot to read
+    uint64_t m_CachedHead;
+};
\ No newline at end of file
@@ -3,6 +3,8 @@
 #include <vector>
 #include <functional>
 #include <objbase.h>
+#include "InputEventRing.h"
+#include "StrokeLog.h"
 
 // Structure to hold pressure-sensitive tablet input data
 struct TabletData {
@@ -11,6 +13,7 @@ struct TabletData {
     float tiltX, tiltY;   // Tilt angles
     bool isPenDown;       // Whether pen is touching surface
     bool isEraser;        // Whether eraser is being used
+    double timeMs;        // When the pen reported it, steady_clock milliseconds
 };
 
 class InputManager {
@@ -18,7 +21,20 @@ public:
     InputManager();
     ~InputManager();
 
+    // Message thread: updates the current state and queues a timestamped
+    // event. Callbacks are not called from here.
     void ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam);
+
+    // Consumer thread: drain queued events in order, either raw or by
+    // calling the registered callbacks for each one
+    size_t DrainEvents(InputEvent* pEvents, size_t maxCount) { return m_EventRing.PopBatch(pEvents, maxCount); }
+    void DispatchEvents();
+
+    // Every dispatched event is also appended to the recorder; null stops
+    void SetRecorder(StrokeLogWriter* pRecorder) { m_pRecorder = pRecorder; }
+
+    // Events lost because the consumer fell a whole ring behind
+    uint64_t GetDroppedEventCount() const { return m_EventRing.GetDroppedCount(); }
     
     // Getters for current input state
     float GetMouseX() const { return m_MouseX; }
@@ -39,6 +55,12 @@ public:
     bool ProcessTabletMessage(UINT msg, WPARAM wParam, LPARAM lParam);
 
 private:
+    static const size_t DISPATCH_BATCH = 256;
+    static const UINT32 PEN_HISTORY_SIZE = 64;
+
+    void QueueEvent(InputEventType type, float x, float y, uint32_t buttons, int32_t wheelDelta);
+    double GetTimeMs(int64_t performanceCount) const;
+
     float m_MouseX, m_MouseY;
     bool m_MouseButtons[5];  // Left, Right, Middle, X1, X2
     bool m_KeyboardState[256];
@@ -49,6 +71,11 @@ private:
     std::vector<std::function<void(int, bool)>> m_KeyboardCallbacks;
     std::vector<std::function<void(const TabletData&)>> m_TabletCallbacks;
     
+    InputEventRing m_EventRing;
+    std::vector<InputEvent> m_DispatchBatch;
+    int64_t m_PerformanceFrequency;
+    StrokeLogWriter* m_pRecorder;
+
     // Windows tablet API structures
     HCTX m_hTabletContext;
 };
\ No newline at end of file
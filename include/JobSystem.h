@@ -0,0 +1,167 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// A unit of work: function(pData) runs once on whichever thread picks it up.
+// The data must outlive the job.
+typedef void (*JobFunction)(void* pData);
+
+struct Job {
+    JobFunction function;
+    void* pData;
+};
+
+class JobCounter;
+
+// A queued job and the counter it lowers when it finishes
+struct CountedJob {
+    Job job;
+    JobCounter* pCounter;
+    bool bMainThread;
+};
+
+// Counts unfinished jobs. Jobs given a counter raise it when they are queued
+// and lower it when they finish; waiting on it, or making other jobs depend
+// on it, waits for all of them. A counter must stay alive, and must not be
+// given more jobs, until it has been waited on.
+class JobCounter {
+public:
+    JobCounter() : m_State(0) {}
+
+    bool IsDone() const { return m_State.load(std::memory_order_acquire) == 0; }
+    uint32_t GetCount() const { return (uint32_t)m_State.load(std::memory_order_relaxed); }
+
+private:
+    friend class JobSystem;
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    // Low bits count jobs. HELD_JOBS is set while jobs wait on the counter and
+    // stays set until the thread that lowered it to zero has queued them, so
+    // a waiter never sees zero while the counter is still in use.
+    static constexpr uint64_t HELD_JOBS = 1ull << 63;
+    std::atomic<uint64_t> m_State;
+
+    std::mutex m_Mutex;
+    std::vector<CountedJob> m_HeldJobs;
+};
+
+// Engine-wide job scheduler. The thread that creates it is the main thread
+// and runs jobs while it waits; the other threads are workers. Each thread
+// has its own deque: it pushes and pops jobs at the bottom, newest first,
+// while idle threads steal the oldest from the top, so threads only contend
+// when they run out of work. Jobs queued from threads outside the system, or
+// beyond a full deque, go to a shared queue. Idle workers spin briefly and
+// then sleep until more jobs are queued.
+//
+// Main-thread jobs never run on a worker: they wait for RunMainThreadJobs,
+// which EngineCore calls once a frame, or for the main thread to wait on a
+// counter. Use them for anything that must touch the window or other state
+// the main thread owns.
+class JobSystem {
+public:
+    static const uint32_t DEQUE_CAPACITY = 4096;
+
+    // threadCount includes the main thread; 0 uses every hardware thread, but
+    // always at least one worker so jobs run without waiting. With 1 thread
+    // jobs only run when waited on.
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();   // Jobs still queued are discarded
+
+    uint32_t GetThreadCount() const { return m_ThreadCount; }
+    bool IsMainThread() const;
+
+    // Queue jobs; pCounter may be null. With a dependency they are held until
+    // it reaches zero, so chains and fan-in need no waiting on the caller's
+    // side. Jobs are started in no particular order.
+    void Run(const Job* pJobs, uint32_t count, JobCounter* pCounter, JobCounter* pDependency = nullptr);
+    void Run(const Job& job, JobCounter* pCounter, JobCounter* pDependency = nullptr) {
+        Run(&job, 1, pCounter, pDependency);
+    }
+
+    // Queue a job that only the main thread may run
+    void RunOnMainThread(const Job& job, JobCounter* pCounter, JobCounter* pDependency = nullptr);
+
+    // Main thread only: run every main-thread job queued so far
+    void RunMainThreadJobs();
+
+    // Run other jobs until the counter reaches zero. Any thread may wait,
+    // including a job; only the main thread runs main-thread jobs meanwhile.
+    void Wait(JobCounter& counter);
+
+    // Call body(begin, end) over [0, count) in runs of at most grain
+    // indices, spread across the threads, and return when all are done
+    void ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& body);
+
+    // Jobs run and jobs taken from another thread's deque since construction
+    uint64_t GetJobCount() const;
+    uint64_t GetStealCount() const;
+
+private:
+    static const uint32_t NOT_A_THREAD = 0xFFFFFFFFu;
+    static const uint32_t SPIN_COUNT = 256;
+
+    // Chase-Lev work-stealing deque of fixed capacity. Only the owner pushes
+    // and pops; any thread may steal. Slots are atomics so a thief reading a
+    // slot the owner is refilling is not a data race; the failed steal simply
+    // discards what it read.
+    struct Slot {
+        std::atomic<JobFunction> function;
+        std::atomic<void*> pData;
+        std::atomic<JobCounter*> pCounter;
+    };
+
+    struct alignas(64) ThreadState {
+        std::atomic<int64_t> top;
+        alignas(64) std::atomic<int64_t> bottom;
+        std::unique_ptr<Slot[]> slots;
+
+        std::atomic<uint64_t> jobs;
+        std::atomic<uint64_t> steals;
+    };
+
+    void WorkerMain(uint32_t threadIndex);
+    uint32_t GetThreadIndex() const;
+
+    bool Push(uint32_t threadIndex, const CountedJob& job);
+    bool Pop(uint32_t threadIndex, CountedJob& job);
+    bool Steal(uint32_t victimIndex, CountedJob& job);
+
+    // Park jobs on a dependency that has not finished; false if it has
+    bool Hold(JobCounter& dependency, const CountedJob* pJobs, uint32_t count);
+    // Queue jobs whose dependencies are met
+    void Submit(const CountedJob* pJobs, uint32_t count);
+    bool FindJob(uint32_t threadIndex, CountedJob& job);
+    bool PopMainThreadJob(CountedJob& job);
+    void Execute(const CountedJob& job);
+    void Finish(JobCounter* pCounter);
+
+    uint32_t m_ThreadCount;
+    std::unique_ptr<ThreadState[]> m_Threads;
+    std::vector<std::thread> m_Workers;
+
+    // Jobs queued from outside the system, or that did not fit a deque
+    std::mutex m_SharedMutex;
+    std::deque<CountedJob> m_SharedJobs;
+    std::atomic<uint32_t> m_SharedCount;
+
+    std::mutex m_MainMutex;
+    std::deque<CountedJob> m_MainJobs;
+    std::atomic<uint32_t> m_MainCount;
+
+    // Jobs queued and not yet taken, and workers asleep waiting for more
+    std::atomic<int64_t> m_Queued;
+    std::atomic<uint32_t> m_Sleepers;
+    std::mutex m_SleepMutex;
+    std::condition_variable m_WakeCondition;
+    bool m_bShutdown;
+};
\ No newline at end of file
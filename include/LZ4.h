@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// LZ4 block format (no frame header), compatible with the reference
+// LZ4_compress_default / LZ4_decompress_safe. Greedy single-probe matcher:
+// fast to pack, and decoding is a tight copy loop.
+size_t LZ4CompressBound(size_t size);
+
+// Replaces the contents of out; returns the compressed size
+size_t LZ4Compress(const uint8_t* pSrc, size_t size, std::vector<uint8_t>& out);
+
+// Decode exactly dstSize bytes; fails on malformed or truncated input
+bool LZ4Decompress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize);
\ No newline at end of file
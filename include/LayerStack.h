@@ -0,0 +1,92 @@
+#pragma once
+#include "Canvas.h"
+#include "BlendModes.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One paintable layer: a full-size tiled canvas plus how it composites
+class Layer {
+public:
+    Layer(const std::string& name, uint32_t width, uint32_t height);
+
+    const std::string& GetName() const { return m_Name; }
+    void SetName(const std::string& name) { m_Name = name; }
+
+    Canvas& GetCanvas() { return m_Canvas; }
+    const Canvas& GetCanvas() const { return m_Canvas; }
+
+    float GetOpacity() const { return m_Opacity; }
+    bool IsVisible() const { return m_bVisible; }
+    LayerBlendMode GetBlendMode() const { return m_BlendMode; }
+
+private:
+    friend class LayerStack;
+
+    std::string m_Name;
+    Canvas m_Canvas;
+    float m_Opacity;
+    bool m_bVisible;
+    LayerBlendMode m_BlendMode;
+};
+
+// Ordered layers (index 0 at the bottom) flattened into a composite canvas.
+// Only tiles that changed are recomposited: painting is picked up from each
+// layer canvas's dirty rect, and property or order changes invalidate the
+// tiles the affected layers have content in. Recompositing a tile blends
+// just the layers that have that tile allocated.
+class LayerStack {
+public:
+    LayerStack(uint32_t width, uint32_t height);
+    ~LayerStack();
+
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+
+    // Layer management; index 0 is the bottom
+    Layer* AddLayer(const std::string& name);
+    Layer* InsertLayer(uint32_t index, const std::string& name);
+    bool RemoveLayer(uint32_t index);
+    bool MoveLayer(uint32_t from, uint32_t to);
+    Layer* GetLayer(uint32_t index);
+    uint32_t GetLayerCount() const { return (uint32_t)m_Layers.size(); }
+
+    // Layer properties go through the stack so the right tiles recomposite
+    void SetOpacity(uint32_t index, float opacity);
+    void SetVisible(uint32_t index, bool bVisible);
+    void SetBlendMode(uint32_t index, LayerBlendMode mode);
+
+    // A transient canvas painted on top of one layer and blended with that
+    // layer's mode and opacity, such as the predicted stroke tail. It never
+    // modifies the layer; Composite picks up its dirty rect like a layer's.
+    // Null removes it, as does removing the layer.
+    void SetOverlay(Canvas* pOverlay, const Layer* pLayer);
+    Canvas* GetOverlay() { return m_pOverlay; }
+
+    // Force an area, or everything, to recomposite
+    void Invalidate(int x0, int y0, int x1, int y1);
+    void InvalidateAll();
+
+    // Bring the composite up to date; returns the number of tiles redone.
+    // The composite's own dirty rect covers them, for upload.
+    uint32_t Composite();
+    Canvas& GetComposite() { return m_Composite; }
+    const Canvas& GetComposite() const { return m_Composite; }
+
+private:
+    void InvalidateTile(uint32_t index);
+    void InvalidateCanvasTiles(const Canvas& canvas);
+    void InvalidateLayerTiles(const Layer& layer);
+    void CompositeTile(uint32_t index);
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    std::vector<std::unique_ptr<Layer>> m_Layers;
+    Canvas m_Composite;
+    Canvas* m_pOverlay;
+    const Layer* m_pOverlayLayer;
+
+    std::vector<uint8_t> m_TileDirty;
+    std::vector<uint32_t> m_DirtyTiles;
+};
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// touch, so opening is cheap regardless of size and unused data is never read.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::wstring& filename);
+    void Close();
+
+    bool IsOpen() const { return m_pData != nullptr; }
+    const uint8_t* GetData() const { return m_pData; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    const uint8_t* m_pData;
+    size_t m_Size;
+#ifdef _WIN32
+    void* m_hFile;
+    void* m_hMapping;
+#else
+    int m_FileDescriptor;
+#endif
+};
\ No newline at end of file
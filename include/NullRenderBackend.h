@@ -0,0 +1,57 @@
+#pragma once
+#include "RenderBackend.h"
+#include "SpriteInstance.h"
+#include <vector>
+
+// Backend that accepts every batch and draws nothing. Geometry is still
+// written into scratch memory and submitted as usual, so the CPU side of
+// rendering costs what it would on a real device while the GPU side costs
+// nothing; use it to time the threads that feed a backend in isolation.
+class NullRenderBackend : public RenderBackend {
+public:
+    explicit NullRenderBackend(VertexFormat vertexFormat = VertexFormat::STANDARD);
+    ~NullRenderBackend() override;
+
+    bool Initialize() override;
+    void Cleanup() override;
+    VertexFormat GetVertexFormat() const override { return m_VertexFormat; }
+    void BeginFrame() override;
+
+    uint32_t CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) override;
+    void DestroyTexture(uint32_t textureId) override;
+    bool UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                       const uint8_t* pPixels, uint32_t rowPitch) override;
+
+    bool AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) override;
+    void Submit(const uint16_t* pIndices, uint32_t indexCount,
+                const DrawRun* pRuns, uint32_t runCount) override;
+
+    bool AppendInstances(uint32_t count, SpriteInstance*& pInstances) override;
+    void SubmitInstances(BlendMode blendMode, uint32_t textureId) override;
+
+    void DrawIndexed(const Vertex* pVertices, uint32_t vertexCount,
+                     const uint32_t* pIndices, uint32_t indexCount,
+                     BlendMode blendMode) override;
+
+    // Counts since the last BeginFrame
+    uint32_t GetDrawCount() const { return m_Draws; }
+    uint32_t GetVertexCount() const { return m_Vertices; }
+    uint32_t GetInstanceCount() const { return m_Instances; }
+    uint32_t GetTextureCount() const { return m_LiveTextures; }
+
+private:
+    VertexFormat m_VertexFormat;
+    uint32_t m_Stride;
+
+    // Scratch batch memory, reused by every batch
+    std::vector<uint8_t> m_VertexData;
+    uint32_t m_BatchVertices;
+    std::vector<SpriteInstance> m_InstanceData;
+    uint32_t m_BatchInstances;
+
+    uint32_t m_NextTextureId;
+    uint32_t m_LiveTextures;
+    uint32_t m_Draws;
+    uint32_t m_Vertices;
+    uint32_t m_Instances;
+};
\ No newline at end of file
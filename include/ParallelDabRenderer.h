@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include "DabRasterizer.h"
+#include "WorkStealingPool.h"
+#include "JobSystem.h"
+
+class Canvas;
+
+// Stamps a batch of dabs with the canvas tiles split across threads. Dabs
+// are binned by the tiles they touch and each tile is one task that stamps
+// its dabs in batch order, so the canvas is bit-identical to stamping the
+// batch serially whatever the thread count. Binning runs on the calling
+// thread and also allocates (or copies out of history) every tile the batch
+// writes, since Canvas itself is not thread safe; workers only touch tile
+// pixels. Tiles run on a pool of its own, or as jobs on the engine's job
+// system when given one.
+class ParallelDabRenderer {
+public:
+    // Batches covering fewer pixels than this are stamped serially: waking
+    // the workers would cost more than it saves
+    static const uint64_t MIN_PARALLEL_PIXELS = 64 * 1024;
+
+    // threadCount of 0 uses every hardware thread
+    explicit ParallelDabRenderer(uint32_t threadCount = 0);
+    // Stamp on the job system's threads; it must outlive the renderer
+    explicit ParallelDabRenderer(JobSystem* pJobSystem);
+    ~ParallelDabRenderer();
+
+    uint32_t GetThreadCount() const { return m_pJobSystem ? m_pJobSystem->GetThreadCount() : m_pPool->GetThreadCount(); }
+    JobSystem* GetJobSystem() { return m_pJobSystem; }
+
+    // Stamp the batch in order. Stamps are prepared in place; masks must
+    // stay valid until this returns.
+    void Stamp(Canvas& canvas, DabStamp* pStamps, size_t count);
+
+    uint64_t GetParallelBatchCount() const { return m_ParallelBatches; }
+    uint64_t GetSerialBatchCount() const { return m_SerialBatches; }
+    // Steals by the renderer's own pool, or by the whole job system
+    uint64_t GetStealCount() const { return m_pJobSystem ? m_pJobSystem->GetStealCount() : m_pPool->GetStealCount(); }
+
+private:
+    // One tile and the batch indices of the stamps that touch it, in order
+    struct TileTask {
+        int tileX, tileY;
+        uint8_t* pTile;
+        std::vector<uint32_t> stamps;
+    };
+
+    std::unique_ptr<WorkStealingPool> m_pPool;     // Null when on a job system
+    JobSystem* m_pJobSystem;
+
+    // Task for each canvas tile in the current batch, NO_TASK if none
+    static constexpr uint32_t NO_TASK = 0xFFFFFFFFu;
+    std::vector<uint32_t> m_TileTasks;
+    std::vector<TileTask> m_Tasks;      // Reused across batches; m_TaskCount are live
+    uint32_t m_TaskCount;
+
+    uint64_t m_ParallelBatches;
+    uint64_t m_SerialBatches;
+};
\ No newline at end of file
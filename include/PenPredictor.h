@@ -0,0 +1,40 @@
+#pragma once
+#include "StrokeSmoother.h"
+#include <vector>
+
+// Extrapolates where the pen will be a few milliseconds from now, so a
+// provisional stroke tail can cover the input-to-display latency. Fits a
+// least-squares quadratic in time to each axis over the recent samples; the
+// acceleration term is damped and the extrapolated speed capped, which trades
+// a little lag on sharp turns for no overshoot on stops.
+class PenPredictor {
+public:
+    PenPredictor();
+
+    // Only samples this recent take part in the fit
+    void SetHistory(double historyMs) { m_HistoryMs = historyMs; }
+    double GetHistory() const { return m_HistoryMs; }
+
+    void Reset();
+    void AddSample(const StrokeSample& sample);
+
+    // Position predicted horizonMs after the newest sample. False until
+    // there are two samples to extrapolate from.
+    bool Predict(double horizonMs, StrokeSample& predicted) const;
+
+    // Points along the predicted path every stepMs up to horizonMs, not
+    // including the newest sample itself
+    bool PredictPath(double horizonMs, double stepMs, std::vector<StrokeSample>& out) const;
+
+private:
+    bool Fit() const;
+
+    double m_HistoryMs;
+    std::vector<StrokeSample> m_Samples;
+
+    // Polynomial in time since the newest sample, refit lazily
+    mutable bool m_bFitValid;
+    mutable bool m_bFitOk;
+    mutable double m_X[3], m_Y[3];
+    mutable double m_MaxSpeed;
+};
\ No newline at end of file
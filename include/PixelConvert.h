@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// Bulk RGBA8 pixel kernels. SSE2 paths are used on x86/x64 builds, with
+// scalar fallbacks elsewhere; both produce identical results.
+
+// 3-byte RGB (or BGR) to 4-byte RGBA with opaque alpha; swapRB reads BGR
+void ExpandRGBToRGBA(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool swapRB = false);
+
+// Swap the R and B channels of 4-byte pixels; pSrc may equal pDst
+void SwizzleBGRAToRGBA(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount);
+
+// Multiply colour by alpha in place: c = round(c * a / 255)
+void PremultiplyAlpha(uint8_t* pPixels, size_t pixelCount);
+
+// 2x2 box filter of an RGBA8 image into (width / 2) x (height / 2), each
+// dimension at least 1; odd edges clamp
+void DownsampleBox(const uint8_t* pSrc, uint32_t width, uint32_t height, uint8_t* pDst);
\ No newline at end of file
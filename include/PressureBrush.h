@@ -1,13 +1,33 @@
 #pragma once
 #include <string>
+#include <vector>
+#include "DabRasterizer.h"
+#include "BrushTip.h"
+#include "DabMaskCache.h"
+#ifdef _WIN32
 #include <d3d11_4.h>
 #include <wrl/client.h>
+#endif
+
+class Canvas;
+class ParallelDabRenderer;
+struct Image;
 
 enum class BrushType {
-    STANDARD,
-    TEXTURED,
-    SMUDGE,
-    ERASER
+    STANDARD,   // Round tip with a hardness falloff
+    TEXTURED,   // Tip texture, rotated with the pen tilt; round until one is set
+    SMUDGE,     // Drags the colour under the brush along the stroke
+    ERASER      // Round tip that removes alpha
+};
+
+// Where the brush is along the current stroke, so a provisional segment can
+// be emitted and then rolled back
+struct BrushStrokeState {
+    float lastX, lastY;
+    float lastPressure;
+    float distanceToNextDab;
+    float currentSize;
+    bool hasLastPoint;
 };
 
 class PressureBrush {
@@ -20,20 +40,66 @@ public:
     float GetMinSize() const { return m_MinSize; }
     float GetMaxSize() const { return m_MaxSize; }
     float GetCurrentSize() const { return m_CurrentSize; }
+    float GetHardness() const { return m_Hardness; }
+    float GetSpacing() const { return m_Spacing; }
+    float GetFlow() const { return m_Flow; }
     BrushType GetType() const { return m_Type; }
     
     // Setters
     void SetName(const std::string& name) { m_Name = name; }
     void SetType(BrushType type) { m_Type = type; }
     void SetHardness(float hardness);  // 0.0 (soft) to 1.0 (hard)
-    void SetSpacing(float spacing);    // Distance between brush marks
+    void SetSpacing(float spacing);    // Distance between dabs as a fraction of the brush size
     void SetFlow(float flow);          // Opacity multiplier based on pressure
+    void SetSmudgeRate(float rate);    // How much colour a smudge picks up per dab, 0..1
+    float GetSmudgeRate() const { return m_SmudgeRate; }
+
+    // Tip texture for TEXTURED brushes; see BrushTip for how it is read.
+    // Returns false if the image is empty.
+    bool SetTipTexture(const Image& image);
+    bool SetTipTexture(const uint8_t* pPixels, uint32_t width, uint32_t height);
+    BrushTip& GetTip() { return m_Tip; }
+
+    // Round tips are stamped from masks cached by size, hardness and
+    // sub-pixel offset (on by default); off rasterises every dab exactly
+    void SetMaskCacheEnabled(bool bEnabled) { m_bMaskCache = bEnabled; }
+    bool IsMaskCacheEnabled() const { return m_bMaskCache; }
+    DabMaskCache& GetMaskCache() { return m_MaskCache; }
+
+    // Stamp through a shared ParallelDabRenderer; null stamps on the calling
+    // thread. Smudge is always serial.
+    void SetRenderer(ParallelDabRenderer* pRenderer) { m_pRenderer = pRenderer; }
+    ParallelDabRenderer* GetRenderer() const { return m_pRenderer; }
+
+    // Pen tilt in degrees; the textured tip turns to face the direction the
+    // pen leans. No tilt keeps the last direction.
+    void SetTilt(float tiltX, float tiltY);
     
     // Update brush based on pressure
     void UpdateWithPressure(float pressure);
-    
-    // Apply brush stroke
-    void ApplyStroke(float x, float y, float pressure, ID3D11DeviceContext* pContext);
+    float GetSizeForPressure(float pressure) const;
+
+    // Walk the segment from the previous point to (x, y), appending a dab
+    // every spacing * size pixels with pressure interpolated linearly. The
+    // distance left over carries into the next segment, so dab spacing is
+    // independent of how input points are sampled. The first point of a
+    // stroke always gets a dab. Colour is straight alpha.
+    void EmitDabs(float x, float y, float pressure, float r, float g, float b, float a,
+                  std::vector<Dab>& dabs);
+
+    // Stamp dabs from EmitDabs with this brush's kernel: round, textured,
+    // smudge or eraser
+    void StampDabs(Canvas& canvas, const Dab* pDabs, size_t count);
+
+    // Emit the dabs for the segment ending at (x, y) and stamp them into the canvas
+    void ApplyStroke(float x, float y, float pressure, Canvas* pCanvas,
+                     float r, float g, float b, float a);
+
+    // Forget the previous point so the next stroke starts fresh
+    void ResetStroke();
+
+    BrushStrokeState GetStrokeState() const;
+    void SetStrokeState(const BrushStrokeState& state);
 
 private:
     std::string m_Name;
@@ -43,12 +109,30 @@ private:
     float m_Hardness;
     float m_Spacing;
     float m_Flow;
+    float m_SmudgeRate;
+    float m_TiltAngle;
     BrushType m_Type;
     
+#ifdef _WIN32
     // Brush texture (for textured brushes)
     Microsoft::WRL::ComPtr<ID3D11Texture2D> m_pBrushTexture;
     Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> m_pBrushTextureSRV;
+#endif
+
+    // Tips are stamped on the CPU from cached masks
+    BrushTip m_Tip;
+    DabMaskCache m_MaskCache;
+    bool m_bMaskCache;
+    ParallelDabRenderer* m_pRenderer;
+    SmudgeBuffer m_Smudge;
     
-    // Last position for spacing calculation
+    // End of the previous segment and distance still to travel before the next dab
     float m_LastX, m_LastY;
+    float m_LastPressure;
+    float m_DistanceToNextDab;
+    bool m_bHasLastPoint;
+
+    // Dab batch reused by ApplyStroke, and the stamps for StampDabs
+    std::vector<Dab> m_Dabs;
+    std::vector<DabStamp> m_Stamps;
 };
\ No newline at end of file
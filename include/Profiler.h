@@ -0,0 +1,207 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROFILER_RDTSC
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Scoped CPU zones: PROFILE_ZONE("Renderer::Flush") at the top of a block
+// times the rest of the block on whichever thread runs it. Names must be
+// string literals, or otherwise live as long as the profiler.
+//
+// Building with ENGINE_DISABLE_PROFILER defined compiles every zone out.
+// Otherwise a zone costs one load of the enabled flag while capture is off;
+// see ProfilerBench for what it costs while capturing.
+#ifdef ENGINE_DISABLE_PROFILER
+#define PROFILE_ZONE(name) ((void)0)
+#else
+#define PROFILE_ZONE_JOIN2(a, b) a##b
+#define PROFILE_ZONE_JOIN(a, b) PROFILE_ZONE_JOIN2(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_ZONE_JOIN(profileZone, __LINE__)(name)
+#endif
+
+// One finished zone. Times are in profiler ticks; see Profiler::TicksToNs.
+struct ProfileEvent {
+    const char* pName;
+    uint64_t startTicks;
+    uint64_t endTicks;
+    uint32_t depth;         // Zones open around it on its thread
+    uint32_t threadId;      // Filled in when collected
+};
+
+// Zones finished on one thread. The thread appends and Profiler::EndFrame
+// drains, each touching only its own end, so neither ever takes a lock.
+// When the buffer is full, zones are dropped and counted rather than
+// overwriting ones not yet collected.
+class ProfileThreadBuffer {
+public:
+    static const uint32_t CAPACITY = 16384;    // Power of two
+
+    ProfileThreadBuffer(uint32_t threadId);
+
+    bool Push(const char* pName, uint64_t startTicks, uint64_t endTicks, uint32_t depth) {
+        uint64_t head = m_Head.load(std::memory_order_relaxed);
+        if (head - m_TailCache >= CAPACITY) {
+            m_TailCache = m_Tail.load(std::memory_order_acquire);
+            if (head - m_TailCache >= CAPACITY) {
+                m_Dropped.store(m_Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        ProfileEvent& event = m_Events[head & (CAPACITY - 1)];
+        event.pName = pName;
+        event.startTicks = startTicks;
+        event.endTicks = endTicks;
+        event.depth = depth;
+        event.threadId = m_ThreadId;
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t GetThreadId() const { return m_ThreadId; }
+    uint64_t GetDroppedCount() const { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+    friend class Profiler;
+    friend class ProfileZone;
+    friend struct ProfileThreadExit;
+
+    // Collector side: append what has been pushed so far
+    void Drain(std::vector<ProfileEvent>& events);
+
+    std::vector<ProfileEvent> m_Events;
+    uint32_t m_ThreadId;
+
+    // Owning thread only
+    uint32_t m_Depth;
+    uint64_t m_TailCache;
+
+    alignas(64) std::atomic<uint64_t> m_Head;       // Written by the thread
+    std::atomic<uint64_t> m_Dropped;
+    alignas(64) std::atomic<uint64_t> m_Tail;       // Written by the collector
+    std::atomic<bool> m_bRetired;                   // Thread has exited
+};
+
+// What one frame captured: every zone that finished between the EndFrame
+// calls around it, on any thread. Zones are filed under the frame they
+// finished in, so the render thread's replay of a frame lands in the next.
+struct ProfileFrame {
+    uint64_t index;
+    uint64_t startTicks;
+    uint64_t endTicks;
+    std::vector<ProfileEvent> events;   // Grouped by thread, in finishing order
+};
+
+// One zone name summed over the frames kept
+struct ProfileZoneSummary {
+    const char* pName;
+    uint64_t calls;
+    double totalMs;
+    double maxMs;
+    double perFrameMs;      // Total over the frames kept
+};
+
+// Process-wide profiler. Capture is off until SetEnabled(true); EngineCore
+// turns it on. The thread calling EndFrame once a frame is the collector:
+// it moves each thread's finished zones into a ring holding the last N
+// frames, which can be summarised in place or written out as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev). Frames, summaries and export all
+// belong to the collector thread.
+//
+// Timestamps come from the time-stamp counter where there is one, which is
+// constant-rate on any CPU recent enough to run the engine, and steady_clock
+// elsewhere; ticks are converted to time against steady_clock.
+class Profiler {
+public:
+    static const uint32_t DEFAULT_FRAME_HISTORY = 240;
+
+    static void SetEnabled(bool bEnabled);
+    static bool IsEnabled() { return s_bEnabled.load(std::memory_order_relaxed); }
+
+    // Shown as the thread's name in traces; call from the thread itself
+    static void SetThreadName(const char* pName);
+
+    // Collector: close the frame and start the next. Frames older than the
+    // history are reused. Changing the history clears it.
+    static void EndFrame();
+    static void SetFrameHistory(uint32_t frames);
+    static size_t GetFrameCount();
+    static const ProfileFrame& GetFrame(size_t index);     // Oldest first
+    static void Clear();
+
+    // Zones across the frames kept, longest total first
+    static void Summarize(std::vector<ProfileZoneSummary>& summary);
+
+    // Write the frames kept as Chrome trace event JSON. Returns false if the
+    // file could not be written.
+    static bool WriteChromeTrace(const std::string& path);
+
+    // Zones lost because a thread filled its buffer between two EndFrames
+    static uint64_t GetDroppedCount();
+
+    static uint64_t GetTicks() {
+#ifdef PROFILER_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    static double TicksToNs(uint64_t ticks);
+    static double TicksToMs(uint64_t ticks) { return TicksToNs(ticks) * 1e-6; }
+
+    // The calling thread's buffer, registering the thread on first use, or
+    // null while capture is off
+    static ProfileThreadBuffer* GetThreadBuffer() {
+        if (!s_bEnabled.load(std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        ProfileThreadBuffer* pBuffer = t_pBuffer;
+        return pBuffer ? pBuffer : RegisterThread();
+    }
+
+private:
+    static ProfileThreadBuffer* RegisterThread();
+    static void Calibrate();
+
+    static std::atomic<bool> s_bEnabled;
+    static thread_local ProfileThreadBuffer* t_pBuffer;
+};
+
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* pName) :
+        m_pName(pName), m_pBuffer(Profiler::GetThreadBuffer()), m_StartTicks(0), m_Depth(0) {
+        if (m_pBuffer) {
+            m_Depth = m_pBuffer->m_Depth++;
+            m_StartTicks = Profiler::GetTicks();
+        }
+    }
+
+    ~ProfileZone() {
+        if (m_pBuffer) {
+            uint64_t endTicks = Profiler::GetTicks();
+            m_pBuffer->m_Depth--;
+            m_pBuffer->Push(m_pName, m_StartTicks, endTicks, m_Depth);
+        }
+    }
+
+private:
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    const char* m_pName;
+    ProfileThreadBuffer* m_pBuffer;
+    uint64_t m_StartTicks;
+    uint32_t m_Depth;
+};
\ No newline at end of file
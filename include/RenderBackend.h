@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include "VertexFormats.h"
+#include "SortKey.h"
+
+struct SpriteInstance;
+
+// Writable slice of the current batch. Vertices are in the backend's vertex
+// format; indices are 16-bit and batch-relative: add baseVertex to each one written.
+struct GeometrySpan {
+    void* pVertices;
+    uint16_t* pIndices;
+    uint32_t baseVertex;
+
+    template <typename TVertex>
+    TVertex* Vertices() const { return (TVertex*)pVertices; }
+};
+
+// Output-merger blend equations shared by every backend
+enum class BlendMode {
+    ALPHA,          // SrcAlpha / InvSrcAlpha on colour, source alpha replaces destination alpha
+    PREMULTIPLIED   // One / InvSrcAlpha on colour and alpha
+};
+
+// Range of sorted batch indices drawn with the state encoded in its sort key
+struct DrawRun {
+    uint64_t sortKey;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+// Destination for the batches built by Renderer. Vertex positions are in
+// pixels with the origin at the top-left of the render target.
+class RenderBackend {
+public:
+    // Built-in 1x1 white texture, used by untextured primitives
+    static const uint32_t WHITE_TEXTURE = 0;
+
+    virtual ~RenderBackend() {}
+
+    virtual bool Initialize() = 0;
+    virtual void Cleanup() = 0;
+
+    // Layout of the vertices handed out by AppendVertices
+    virtual VertexFormat GetVertexFormat() const = 0;
+
+    // Called once per frame before any batches are submitted
+    virtual void BeginFrame() {}
+
+    // RGBA8 textures, referenced by id from the texture field of sort keys.
+    // pPixels may be null for a transparent texture. Returns WHITE_TEXTURE on failure.
+    virtual uint32_t CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) = 0;
+    virtual void DestroyTexture(uint32_t textureId) = 0;
+
+    // Overwrite a region of a texture; rowPitch is in bytes
+    virtual bool UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                               const uint8_t* pPixels, uint32_t rowPitch) = 0;
+
+    // Reserve vertices in the current batch so they are written exactly once,
+    // straight into mapped (or arena) memory. Returns false when the batch is
+    // full; submit it and append again.
+    virtual bool AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) = 0;
+
+    // Draw the pending batch. Indices are batch-relative and already in draw
+    // order; each run is one draw call with the state from its sort key.
+    virtual void Submit(const uint16_t* pIndices, uint32_t indexCount,
+                        const DrawRun* pRuns, uint32_t runCount) = 0;
+
+    // Instanced sprite batches: one SpriteInstance per quad, written in place.
+    // Returns false when the batch is full; submit it and append again.
+    virtual bool AppendInstances(uint32_t count, SpriteInstance*& pInstances) = 0;
+    virtual void SubmitInstances(BlendMode blendMode, uint32_t textureId) = 0;
+
+    // Draw an untextured indexed triangle list from caller-owned memory. Not
+    // to be interleaved with AppendVertices; submit the pending batch first.
+    virtual void DrawIndexed(const Vertex* pVertices, uint32_t vertexCount,
+                             const uint32_t* pIndices, uint32_t indexCount,
+                             BlendMode blendMode) = 0;
+};
\ No newline at end of file
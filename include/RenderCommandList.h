@@ -0,0 +1,99 @@
+#pragma once
+#include "RenderBackend.h"
+#include "SpriteInstance.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class Sprite;
+
+enum class RenderCommandType : uint8_t {
+    CLEAR,          // Start drawing the frame into a cleared target
+    SET_LAYER,
+    SET_BLEND_MODE,
+    SET_DEPTH,
+    DRAW_QUAD,
+    DRAW_SPRITE,
+    DRAW_LINE,
+    DRAW_CIRCLE,
+    UPDATE_TEXTURE, // Copy recorded pixels into part of a texture
+    FLUSH,          // Submit what the renderer has batched so far
+    PRESENT         // Flush and show the frame
+};
+
+// One recorded command; the member that matches the type is valid
+struct RenderCommand {
+    RenderCommandType type;
+    union {
+        struct {
+            float r, g, b, a;
+        } clear;
+        uint32_t layer;
+        BlendMode blendMode;
+        float depth;
+        struct {
+            SpriteInstance instance;
+            uint32_t textureId;
+        } quad;
+        struct {
+            Sprite* pSprite;
+            float x, y, scaleX, scaleY, rotation;
+            uint32_t color;
+        } sprite;
+        struct {
+            float x1, y1, x2, y2, thickness;
+            float r, g, b, a;
+        } line;
+        struct {
+            float centerX, centerY, radius;
+            float r, g, b, a;
+        } circle;
+        struct {
+            uint32_t textureId;
+            uint32_t x, y, width, height;
+            size_t dataOffset;
+        } texture;
+    };
+};
+
+// A frame of drawing recorded on one thread to be replayed against a
+// Renderer on another. Commands are plain values, copied in as they are
+// recorded, so the list shares nothing with the recording thread except
+// sprites, which must stay alive until the frame has been rendered.
+// Texture pixels are copied into the list as well. Memory is kept across
+// Reset, so a steady scene records without allocating.
+class RenderCommandList {
+public:
+    void Reset() { m_Commands.clear(); m_Data.clear(); }
+    size_t GetCount() const { return m_Commands.size(); }
+    const RenderCommand* GetCommands() const { return m_Commands.data(); }
+    const uint8_t* GetData(size_t offset) const { return m_Data.data() + offset; }
+
+    void Clear(float r, float g, float b, float a = 1.0f);
+    void SetLayer(uint32_t layer);
+    void SetBlendMode(BlendMode blendMode);
+    void SetDepth(float depth);
+
+    // Quad centred on (x, y), drawn as one sprite instance. The colour is
+    // RGBA8 with red in the low byte.
+    void DrawQuad(float x, float y, float width, float height, uint32_t textureId,
+                  uint32_t color = 0xFFFFFFFF, float rotation = 0.0f,
+                  float u0 = 0.0f, float v0 = 0.0f, float u1 = 1.0f, float v1 = 1.0f);
+    void DrawSprite(Sprite* pSprite, float x, float y, float scaleX = 1.0f, float scaleY = 1.0f,
+                    float rotation = 0.0f, uint32_t color = 0xFFFFFFFF);
+    void DrawLine(float x1, float y1, float x2, float y2, float thickness, float r, float g, float b, float a = 1.0f);
+    void DrawCircle(float centerX, float centerY, float radius, float r, float g, float b, float a = 1.0f);
+
+    // Replace an area of a texture with tightly packed RGBA8 rows. Fill the
+    // returned memory before recording another texture update.
+    uint8_t* UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+    void Flush();
+    void Present();
+
+private:
+    RenderCommand& Add(RenderCommandType type);
+
+    std::vector<RenderCommand> m_Commands;
+    std::vector<uint8_t> m_Data;
+};
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include "RenderBackend.h"
+#include <vector>
+
+// Per-batch list of primitives tagged with 64-bit sort keys. Build() radix
+// sorts them, gathers their indices into sorted order and merges neighbours
+// that share pipeline state into single draw runs. The sort is stable, so
+// primitives with equal keys keep their submission order.
+class RenderQueue {
+public:
+    RenderQueue();
+
+    void Add(uint64_t sortKey, uint32_t firstIndex, uint32_t indexCount);
+    void Clear() { m_Commands.clear(); }
+    bool IsEmpty() const { return m_Commands.empty(); }
+    uint32_t GetCommandCount() const { return (uint32_t)m_Commands.size(); }
+
+    // pIndices holds the batch indices in submission order
+    void Build(const uint16_t* pIndices, std::vector<uint16_t>& sortedIndices, std::vector<DrawRun>& runs);
+
+    // Number of blend, shader and texture switches between two draws
+    static uint32_t CountStateChanges(uint64_t fromKey, uint64_t toKey);
+
+private:
+    struct Command {
+        uint64_t sortKey;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    void SortCommands();
+
+    std::vector<Command> m_Commands;
+    std::vector<Command> m_Scratch;
+};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+#include "RenderCommandList.h"
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class Renderer;
+
+// Replays command lists against a Renderer on a thread of its own, so the
+// main thread records frame N+1 while frame N is submitted. There are two
+// lists: the main thread records into one while the render thread executes
+// the other, and SubmitFrame swaps them. The swap is the only point where
+// the threads meet; nothing else is shared, and the renderer and its
+// backend belong to the render thread while it runs.
+class RenderThread {
+public:
+    static const uint32_t WAIT_FOREVER = 0xFFFFFFFFu;
+
+    explicit RenderThread(Renderer* pRenderer);
+    ~RenderThread();    // Stops
+
+    // Render thread hooks, set before Start. frameStart runs before each
+    // frame's commands, after the renderer's BeginFrame; clear handles CLEAR
+    // and present handles PRESENT once the renderer has been flushed. Any
+    // may be empty: the null and software backends need none.
+    void SetFrameStartCallback(std::function<void()> callback) { m_FrameStartCallback = callback; }
+    void SetClearCallback(std::function<void(float, float, float, float)> callback) { m_ClearCallback = callback; }
+    void SetPresentCallback(std::function<void()> callback) { m_PresentCallback = callback; }
+
+    // bThreaded false replays each frame on the calling thread inside
+    // SubmitFrame instead; same output, for comparison and debugging
+    bool Start(bool bThreaded = true);
+    void Stop();    // Finishes the frame in flight first
+    bool IsThreaded() const { return m_bThreaded; }
+
+    // Main thread: the list being recorded for the next frame
+    RenderCommandList& GetCommandList() { return *m_pRecording; }
+
+    // Main thread: hand the recorded frame over and start recording an empty
+    // one. Waits up to timeoutMs for the render thread to finish the frame
+    // before; on timeout nothing is swapped and it returns false. A thread
+    // that owns a window should keep handling messages between tries, since
+    // presenting can wait on the window.
+    bool SubmitFrame(uint32_t timeoutMs = WAIT_FOREVER);
+
+    // As of the last SubmitFrame: frames replayed, how long replaying the
+    // last of them took and how long the main thread waited at the swap.
+    // Unthreaded, the wait is the whole replay.
+    uint64_t GetFrameCount() const { return m_FrameCount; }
+    double GetLastRenderMs() const { return m_LastRenderMs; }
+    double GetLastWaitMs() const { return m_LastWaitMs; }
+
+private:
+    void ThreadMain();
+    void Execute(const RenderCommandList& commands);
+    static double GetTimeMs();
+
+    Renderer* m_pRenderer;
+    std::function<void()> m_FrameStartCallback;
+    std::function<void(float, float, float, float)> m_ClearCallback;
+    std::function<void()> m_PresentCallback;
+
+    RenderCommandList m_Lists[2];
+    RenderCommandList* m_pRecording;    // Main thread's
+    RenderCommandList* m_pExecuting;    // Render thread's while m_bFramePending
+
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_FrameCondition;
+    std::condition_variable m_DoneCondition;
+    bool m_bFramePending;
+    bool m_bRunning;
+    bool m_bThreaded;
+
+    // Written by the render thread under the lock
+    uint64_t m_FramesDone;
+    double m_FrameRenderMs;
+
+    // Main thread's copies, taken at the swap
+    uint64_t m_FrameCount;
+    double m_LastRenderMs;
+    double m_LastWaitMs;
+    double m_WaitStartMs;   // Negative unless a SubmitFrame timed out
+};
\ No newline at end of file
@@ -1,19 +1,31 @@
 #pragma once
-#include <d3d11_4.h>
-#include <wrl/client.h>
+#include "RenderBackend.h"
+#include "RenderQueue.h"
+#include "SpriteInstance.h"
 #include "Sprite.h"
-#include <vector>
 #include <memory>
+#include <vector>
 
-struct Vertex {
-    float x, y, z;
-    float u, v;
-    float r, g, b, a;
+class GraphicsDevice;
+
+// Upload volume and draw counts of the current frame, reset by BeginFrame
+struct RenderStats {
+    uint64_t vertexBytes;
+    uint64_t indexBytes;
+    uint64_t instanceBytes;
+    uint32_t vertices;
+    uint32_t indices;
+    uint32_t instances;
+    uint32_t drawCalls;
+    uint32_t stateChanges;  // Blend, shader and texture switches between draws
 };
 
 class Renderer {
 public:
-    Renderer(GraphicsDevice* pGraphicsDevice);
+#ifdef _WIN32
+    Renderer(GraphicsDevice* pGraphicsDevice, VertexFormat vertexFormat = VertexFormat::STANDARD);
+#endif
+    Renderer(std::unique_ptr<RenderBackend> pBackend);
     ~Renderer();
 
     bool Initialize();
@@ -23,36 +35,85 @@ public:
     void DrawSprite(Sprite* pSprite);
     void DrawLine(float x1, float y1, float x2, float y2, float thickness, float r, float g, float b, float a = 1.0f);
     void DrawCircle(float centerX, float centerY, float radius, float r, float g, float b, float a = 1.0f);
-    
+
+    // Reserve vertices and indices in the current batch and write them in
+    // place. The primitive is tagged with the current draw state and sorted
+    // at flush. Flushes and retries if the batch is full.
+    bool Append(uint32_t vertexCount, uint32_t indexCount, GeometrySpan& span);
+    bool Append(uint32_t vertexCount, uint32_t indexCount, uint32_t textureId, GeometrySpan& span);
+
+    // Instanced sprites: one compact record per quad, written in place.
+    // Flushes and retries if the batch is full. Sprites that carry their own
+    // texture use it; others use the current texture.
+    bool AppendInstances(uint32_t count, SpriteInstance*& pInstances);
+    bool AppendInstances(uint32_t count, uint32_t textureId, SpriteInstance*& pInstances);
+    void DrawSpriteInstanced(Sprite* pSprite, float x, float y, float scaleX = 1.0f, float scaleY = 1.0f,
+                             float rotation = 0.0f, uint32_t color = 0xFFFFFFFF);
+
     // Batch rendering
+    void BeginFrame();
     void Flush();
 
+    // Draw state for subsequent primitives. Within a batch primitives are
+    // ordered by layer, then grouped by blend mode and texture, then ordered
+    // by depth (0..1); ties keep submission order.
+    void SetLayer(uint32_t layer);
+    void SetBlendMode(BlendMode blendMode);
+    void SetTexture(uint32_t textureId);
+    void SetDepth(float depth);
+    uint32_t GetLayer() const { return m_Layer; }
+    BlendMode GetBlendMode() const { return m_BlendMode; }
+    uint32_t GetTexture() const { return m_TextureId; }
+
+    // Drawn in place of sprites that are still loading
+    void SetPlaceholderTexture(uint32_t textureId) { m_PlaceholderTextureId = textureId; }
+    uint32_t GetPlaceholderTexture() const { return m_PlaceholderTextureId; }
+
+    // Textures are owned by the backend; ids go in sort keys
+    uint32_t CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels);
+    void DestroyTexture(uint32_t textureId);
+    bool UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                       const uint8_t* pPixels, uint32_t rowPitch);
+
+    RenderBackend* GetBackend() { return m_pBackend.get(); }
+    VertexFormat GetVertexFormat() const { return m_pBackend->GetVertexFormat(); }
+    const RenderStats& GetStats() const { return m_Stats; }
+
 private:
-    bool CreateShaders();
-    bool CreateInputLayout();
-    bool CreateVertexBuffer();
-    bool CreateIndexBuffer();
-    bool CreateConstantBuffers();
-    bool CreateBlendStates();
-
-    GraphicsDevice* m_pGraphicsDevice;
-    
-    // Shaders
-    Microsoft::WRL::ComPtr<ID3D11VertexShader> m_pVertexShader;
-    Microsoft::WRL::ComPtr<ID3D11PixelShader> m_pPixelShader;
-    Microsoft::WRL::ComPtr<ID3D11InputLayout> m_pInputLayout;
-    
-    // Buffers
-    Microsoft::WRL::ComPtr<ID3D11Buffer> m_pVertexBuffer;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> m_pIndexBuffer;
-    Microsoft::WRL::ComPtr<ID3D11Buffer> m_pConstantBuffer;
-    
-    // Blend states for transparency
-    Microsoft::WRL::ComPtr<ID3D11BlendState> m_pBlendState;
-    
-    // Rendering data
-    std::vector<Vertex> m_Vertices;
-    std::vector<UINT> m_Indices;
-    UINT m_VertexCount;
-    UINT m_IndexCount;
+    // Geometry generation shared by every vertex format
+    template <typename TVertex>
+    void BuildSprite(Sprite* pSprite);
+    template <typename TVertex>
+    void BuildLine(float x1, float y1, float x2, float y2, float thickness, float r, float g, float b, float a);
+    template <typename TVertex>
+    void BuildCircle(float centerX, float centerY, float radius, float r, float g, float b, float a);
+
+    uint32_t GetSpriteTexture(const Sprite* pSprite) const;
+    uint64_t MakeSortKey(uint32_t shader, uint32_t textureId) const;
+    void RecordDraw(uint64_t sortKey);
+
+    std::unique_ptr<RenderBackend> m_pBackend;
+
+    // Current draw state
+    uint32_t m_Layer;
+    BlendMode m_BlendMode;
+    uint32_t m_TextureId;
+    uint32_t m_Depth;
+    uint32_t m_PlaceholderTextureId;
+
+    // Size of the batch pending in the backend
+    uint32_t m_VertexCount;
+    uint32_t m_IndexCount;
+    uint32_t m_InstanceCount;
+    uint32_t m_InstanceTextureId;
+
+    // Indices are staged in submission order and gathered by sort key at flush
+    RenderQueue m_Queue;
+    std::vector<uint16_t> m_Indices;
+    std::vector<uint16_t> m_SortedIndices;
+    std::vector<DrawRun> m_Runs;
+
+    RenderStats m_Stats;
+    uint64_t m_LastDrawKey;
+    bool m_bHasDrawn;
 };
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Backing store for a RingBufferAllocator. A GPU implementation maps a dynamic
+// buffer; discard == true means the previous contents may be thrown away
+// (WRITE_DISCARD), otherwise the mapping must not disturb in-flight data
+// (WRITE_NO_OVERWRITE).
+class RingBufferStorage {
+public:
+    virtual ~RingBufferStorage() {}
+
+    virtual bool Create(size_t sizeInBytes) = 0;
+    virtual void* Map(bool discard) = 0;
+    virtual void Unmap() = 0;
+};
+
+// CPU-side storage used by the headless path and for exercising the allocator
+// without a device. Counts maps so capacity/overflow behaviour can be checked.
+class CpuRingBufferStorage : public RingBufferStorage {
+public:
+    CpuRingBufferStorage() : m_MapCount(0), m_DiscardCount(0), m_CreateCount(0), m_bMapped(false) {}
+
+    bool Create(size_t sizeInBytes) override;
+    void* Map(bool discard) override;
+    void Unmap() override;
+
+    const uint8_t* GetData() const { return m_Data.data(); }
+    size_t GetSize() const { return m_Data.size(); }
+    uint32_t GetMapCount() const { return m_MapCount; }
+    uint32_t GetDiscardCount() const { return m_DiscardCount; }
+    uint32_t GetCreateCount() const { return m_CreateCount; }
+    bool IsMapped() const { return m_bMapped; }
+
+private:
+    std::vector<uint8_t> m_Data;
+    uint32_t m_MapCount;
+    uint32_t m_DiscardCount;
+    uint32_t m_CreateCount;
+    bool m_bMapped;
+};
+
+// Sub-allocates fixed-stride elements from a dynamic buffer. Allocations are
+// appended with no-overwrite maps and the buffer is only discarded when the
+// write head wraps. Capacity grows at frame boundaries to the observed
+// per-frame high-water mark so steady-state frames never wrap.
+class RingBufferAllocator {
+public:
+    RingBufferAllocator(RingBufferStorage* pStorage, uint32_t stride, uint32_t initialCapacity);
+
+    bool Initialize();
+
+    // Map space for count elements. Returns nullptr if count exceeds capacity;
+    // callers split the batch or Reserve() first.
+    void* Map(uint32_t count, uint32_t& firstElement);
+    void Unmap();
+
+    // Map everything from the head to the end of the ring, wrapping first if
+    // fewer than minCount elements remain. The head advances on UnmapSpan by
+    // however many elements were actually written.
+    void* MapSpan(uint32_t minCount, uint32_t& firstElement, uint32_t& availableCount);
+    void UnmapSpan(uint32_t usedCount);
+
+    // Grow immediately so a single allocation of count elements fits
+    bool Reserve(uint32_t count);
+
+    // Fold the finished frame into the high-water mark and grow if needed
+    void BeginFrame();
+
+    uint32_t GetStride() const { return m_Stride; }
+    uint32_t GetCapacity() const { return m_Capacity; }
+    uint32_t GetHighWaterMark() const { return m_HighWaterMark; }
+    uint32_t GetFrameUsage() const { return m_FrameUsage; }
+    uint32_t GetWrapCount() const { return m_WrapCount; }
+
+private:
+    bool Recreate(uint32_t capacity);
+    uint8_t* MapAtHead(uint32_t minCount);
+
+    RingBufferStorage* m_pStorage;
+    uint32_t m_Stride;
+    uint32_t m_Capacity;
+    uint32_t m_Head;
+    uint32_t m_FrameUsage;
+    uint32_t m_HighWaterMark;
+    uint32_t m_WrapCount;
+    bool m_bNeedsDiscard;
+};
+
+// A run of whole triangles whose referenced vertex range and index count fit
+// the given limits. Draw it with base vertex = (upload offset - minVertex).
+struct BatchRange {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t minVertex;
+    uint32_t maxVertex;
+};
+
+// Split an indexed triangle list into ranges that fit the ring capacities.
+// Returns false once startIndex reaches indexCount.
+bool NextBatchRange(const uint32_t* pIndices, uint32_t indexCount, uint32_t startIndex,
+                    uint32_t maxVertices, uint32_t maxIndices, BatchRange& range);
\ No newline at end of file
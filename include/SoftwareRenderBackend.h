@@ -0,0 +1,125 @@
+#pragma once
+#include "RenderBackend.h"
+#include "RingBufferAllocator.h"
+#include "GeometryArena.h"
+#include "SpriteInstance.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <string>
+
+// GPU-free backend that rasterises batches into an in-memory RGBA8 framebuffer.
+// Triangles are binned into screen tiles and tiles are shaded in parallel; every
+// pixel belongs to exactly one tile, so output is identical for any thread count.
+// Textures are sampled bilinearly with clamped addressing, like the D3D11 sampler.
+class SoftwareRenderBackend : public RenderBackend {
+public:
+    static const uint32_t TILE_SIZE = 64;
+
+    // threadCount of 0 uses every hardware thread
+    SoftwareRenderBackend(uint32_t width, uint32_t height, uint32_t threadCount = 0,
+                          VertexFormat vertexFormat = VertexFormat::STANDARD);
+    ~SoftwareRenderBackend() override;
+
+    bool Initialize() override;
+    void Cleanup() override;
+    VertexFormat GetVertexFormat() const override { return m_VertexFormat; }
+    void BeginFrame() override;
+
+    uint32_t CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) override;
+    void DestroyTexture(uint32_t textureId) override;
+    bool UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                       const uint8_t* pPixels, uint32_t rowPitch) override;
+
+    bool AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) override;
+    void Submit(const uint16_t* pIndices, uint32_t indexCount,
+                const DrawRun* pRuns, uint32_t runCount) override;
+
+    bool AppendInstances(uint32_t count, SpriteInstance*& pInstances) override;
+    void SubmitInstances(BlendMode blendMode, uint32_t textureId) override;
+
+    void DrawIndexed(const Vertex* pVertices, uint32_t vertexCount,
+                     const uint32_t* pIndices, uint32_t indexCount,
+                     BlendMode blendMode) override;
+
+    // Framebuffer access
+    void Clear(float r, float g, float b, float a);
+    void Resize(uint32_t width, uint32_t height);
+    const uint8_t* GetPixels() const { return m_Pixels.data(); }
+    uint32_t GetWidth() const { return m_Width; }
+    uint32_t GetHeight() const { return m_Height; }
+    uint32_t GetThreadCount() const { return m_ThreadCount; }
+
+    // Write the framebuffer as an uncompressed 32-bit TGA for image diffs
+    bool SaveToTGA(const std::string& filename) const;
+
+private:
+    struct Triangle {
+        float x[3], y[3];
+        float u[3], v[3];
+        float color[3][4];
+        int minX, minY, maxX, maxY;
+    };
+
+    struct Texture {
+        uint32_t width;
+        uint32_t height;
+        std::vector<uint8_t> pixels;
+    };
+
+    template <typename TVertex, typename TIndex>
+    void Rasterize(const TVertex* pVertices, uint32_t vertexCount,
+                   const TIndex* pIndices, uint32_t indexCount,
+                   BlendMode blendMode, uint32_t textureId);
+    template <typename TVertex, typename TIndex>
+    void BinTriangles(const TVertex* pVertices, uint32_t vertexCount,
+                      const TIndex* pIndices, uint32_t indexCount);
+    template <typename TVertex>
+    void ExpandInstances(BlendMode blendMode, uint32_t textureId);
+    void SampleTexture(float u, float v, float* pColor) const;
+    void RasterizeTile(uint32_t tileIndex);
+    void ProcessTiles();
+    void WorkerMain();
+    void StartWorkers();
+    void StopWorkers();
+
+    uint32_t m_Width;
+    uint32_t m_Height;
+    uint32_t m_TilesX;
+    uint32_t m_TilesY;
+    std::vector<uint8_t> m_Pixels;
+
+    // CPU arena that Renderer builds batches in
+    VertexFormat m_VertexFormat;
+    CpuRingBufferStorage m_VertexStorage;
+    RingBufferAllocator m_VertexRing;
+    GeometryArena m_Arena;
+
+    // Instances are expanded into the arena on submit
+    std::vector<SpriteInstance> m_Instances;
+    std::vector<uint16_t> m_InstanceIndices;
+    uint32_t m_InstanceCount;
+
+    // Slot 0 is WHITE_TEXTURE; destroyed slots are reused
+    std::vector<Texture> m_Textures;
+    std::vector<uint32_t> m_FreeTextures;
+
+    // Per-draw state read by the workers
+    std::vector<Triangle> m_Triangles;
+    std::vector<std::vector<uint32_t>> m_TileBins;
+    BlendMode m_BlendMode;
+    const Texture* m_pTexture;
+
+    // Worker pool; the calling thread also shades tiles
+    uint32_t m_ThreadCount;
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCondition;
+    std::condition_variable m_DoneCondition;
+    std::atomic<uint32_t> m_NextTile;
+    uint64_t m_Generation;
+    uint32_t m_ActiveWorkers;
+    bool m_bShutdown;
+};
\ No newline at end of file
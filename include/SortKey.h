@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+// 64-bit draw sort key, most significant field first:
+//   [63..56] layer   [55..54] blend mode   [53..48] shader
+//   [47..24] texture [23..0]  depth
+// Sorting by key groups primitives by pipeline state within each layer.
+namespace SortKey {
+    const int LAYER_SHIFT = 56;
+    const int BLEND_SHIFT = 54;
+    const int SHADER_SHIFT = 48;
+    const int TEXTURE_SHIFT = 24;
+
+    const uint64_t LAYER_MASK = 0xFFull;
+    const uint64_t BLEND_MASK = 0x3ull;
+    const uint64_t SHADER_MASK = 0x3Full;
+    const uint64_t TEXTURE_MASK = 0xFFFFFFull;
+    const uint64_t DEPTH_MASK = 0xFFFFFFull;
+
+    // Shader field values
+    const uint32_t SHADER_BATCHED = 0;
+    const uint32_t SHADER_INSTANCED = 1;
+
+    // Bits that require a pipeline state change on the backend
+    const uint64_t STATE_MASK = (BLEND_MASK << BLEND_SHIFT) | (SHADER_MASK << SHADER_SHIFT) | (TEXTURE_MASK << TEXTURE_SHIFT);
+
+    inline uint64_t Make(uint32_t layer, uint32_t blendMode, uint32_t shader, uint32_t texture, uint32_t depth) {
+        return ((layer & LAYER_MASK) << LAYER_SHIFT) |
+               ((blendMode & BLEND_MASK) << BLEND_SHIFT) |
+               ((shader & SHADER_MASK) << SHADER_SHIFT) |
+               ((texture & TEXTURE_MASK) << TEXTURE_SHIFT) |
+               (depth & DEPTH_MASK);
+    }
+
+    inline uint32_t GetLayer(uint64_t key) { return (uint32_t)((key >> LAYER_SHIFT) & LAYER_MASK); }
+    inline uint32_t GetBlendMode(uint64_t key) { return (uint32_t)((key >> BLEND_SHIFT) & BLEND_MASK); }
+    inline uint32_t GetShader(uint64_t key) { return (uint32_t)((key >> SHADER_SHIFT) & SHADER_MASK); }
+    inline uint32_t GetTexture(uint64_t key) { return (uint32_t)((key >> TEXTURE_SHIFT) & TEXTURE_MASK); }
+    inline uint32_t GetDepth(uint64_t key) { return (uint32_t)(key & DEPTH_MASK); }
+}
\ No newline at end of file
@@ -1,20 +1,45 @@
 #pragma once
+#ifdef _WIN32
 #include <d3d11_4.h>
 #include <wrl/client.h>
+#endif
 #include <string>
+#include <cstdint>
+#include "ImageDecoder.h"
+
+class AssetArchive;
 
 class Sprite {
 public:
     Sprite();
     ~Sprite();
 
+    // Decode a PNG, TGA or BMP image into GetImage()
     bool LoadFromFile(const std::wstring& filename);
-    bool CreateFromMemory(unsigned char* pData, size_t size);
+    bool CreateFromMemory(const unsigned char* pData, size_t size);
+
+    // Decode an archive entry in place from the mapping, with no file open
+    bool LoadFromArchive(const AssetArchive& archive, const std::string& name);
     void Render(float x, float y, float scaleX = 1.0f, float scaleY = 1.0f, float rotation = 0.0f);
     
+    // Backend texture and UV rectangle, usually an atlas page region
+    void SetTextureRegion(uint32_t textureId, float u0, float v0, float u1, float v1);
+    void SetSize(float width, float height);
+
+    // Set while an AssetLoader is still streaming the image in; the renderer
+    // draws the placeholder texture instead
+    void SetPending(bool bPending) { m_bPending = bPending; }
+    bool IsPending() const { return m_bPending; }
+
     // Getters
     float GetWidth() const { return m_Width; }
     float GetHeight() const { return m_Height; }
+    uint32_t GetTextureId() const { return m_TextureId; }
+    float GetU0() const { return m_U0; }
+    float GetV0() const { return m_V0; }
+    float GetU1() const { return m_U1; }
+    float GetV1() const { return m_V1; }
+    const Image& GetImage() const { return m_Image; }
 
 private:
     bool CreateTextureView();
@@ -22,4 +47,10 @@ private:
     float m_Width;
     float m_Height;
     std::wstring m_Filename;
+    Image m_Image;
+
+    // 0 is the backend's white texture
+    uint32_t m_TextureId;
+    float m_U0, m_V0, m_U1, m_V1;
+    bool m_bPending;
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+#include "RenderBackend.h"
+#include <cstdint>
+#include <cmath>
+
+// Compact per-quad record for instanced sprite batches (32 bytes vs. 4 Vertex +
+// 6 indices). The D3D11 backend expands it in the vertex shader; the software
+// backend expands it on the CPU with ExpandSpriteInstances.
+struct SpriteInstance {
+    float x, y;                 // Centre in pixels
+    float width, height;        // Size in pixels
+    float rotation;             // Radians, about the centre
+    uint16_t u0, v0, u1, v1;    // UV rect, UNORM16
+    uint32_t color;             // RGBA8, red in the low byte
+};
+
+static_assert(sizeof(SpriteInstance) == 32, "SpriteInstance must match the instanced input layout");
+
+inline uint16_t PackUNorm16(float value) {
+    value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+    return (uint16_t)(value * 65535.0f + 0.5f);
+}
+
+// Expand instances into 4 vertices and 6 indices each, matching the corner
+// order and triangle winding of the instanced vertex shader
+template <typename TVertex>
+void ExpandSpriteInstances(const SpriteInstance* pInstances, uint32_t count,
+                           TVertex* pVertices, uint16_t* pIndices, uint32_t baseVertex) {
+    const float unorm16 = 1.0f / 65535.0f;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const SpriteInstance& instance = pInstances[i];
+
+        float s = sin(instance.rotation);
+        float c = cos(instance.rotation);
+        float u[2] = { instance.u0 * unorm16, instance.u1 * unorm16 };
+        float v[2] = { instance.v0 * unorm16, instance.v1 * unorm16 };
+
+        // Corner k is (k & 1, k >> 1) in the unit square, as SV_VertexID in the shader
+        for (uint32_t k = 0; k < 4; k++) {
+            uint32_t cornerX = k & 1;
+            uint32_t cornerY = k >> 1;
+            float localX = (cornerX - 0.5f) * instance.width;
+            float localY = (cornerY - 0.5f) * instance.height;
+
+            VertexTraits<TVertex>::WritePacked(pVertices[k],
+                instance.x + localX * c - localY * s,
+                instance.y + localX * s + localY * c,
+                u[cornerX], v[cornerY], instance.color);
+        }
+
+        pIndices[0] = (uint16_t)(baseVertex + 0);
+        pIndices[1] = (uint16_t)(baseVertex + 1);
+        pIndices[2] = (uint16_t)(baseVertex + 2);
+        pIndices[3] = (uint16_t)(baseVertex + 1);
+        pIndices[4] = (uint16_t)(baseVertex + 3);
+        pIndices[5] = (uint16_t)(baseVertex + 2);
+
+        pVertices += 4;
+        pIndices += 6;
+        baseVertex += 4;
+    }
+}
\ No newline at end of file
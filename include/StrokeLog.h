@@ -0,0 +1,70 @@
+#pragma once
+#include "InputEventRing.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Compact binary log of input events, for reproducing what was drawn.
+// Layout: 8-byte header ("SLOG", version, 3 reserved bytes), then one record
+// per event. Each record is a tag byte (event type and flags) followed by
+// zigzag varint deltas from the previous event: time in microseconds,
+// position in 1/16 px, pressure in 1/1024ths and tilt in whole degrees.
+// A typical pen move costs 7 bytes against 40 in memory. Quantised values
+// are what replay sees, so a log replays identically every time.
+class StrokeLogWriter {
+public:
+    StrokeLogWriter();
+
+    void Add(const InputEvent& event);
+    void Clear();
+
+    bool Save(const std::string& filename) const;
+
+    const std::vector<uint8_t>& GetData() const { return m_Data; }
+    size_t GetEventCount() const { return m_EventCount; }
+
+private:
+    void WriteVarint(uint64_t value);
+    void WriteSigned(int64_t value);
+
+    std::vector<uint8_t> m_Data;
+    size_t m_EventCount;
+
+    // Previous event, quantised
+    int64_t m_TimeUs;
+    int32_t m_X, m_Y;
+    int32_t m_Pressure;
+    int32_t m_TiltX, m_TiltY;
+    uint32_t m_Buttons;
+};
+
+class StrokeLogReader {
+public:
+    StrokeLogReader();
+
+    bool Load(const std::string& filename);
+    bool Load(const uint8_t* pData, size_t size);
+
+    // False at the end of the log or on a corrupt record; check HasError
+    bool Next(InputEvent& event);
+    void Rewind();
+    bool HasError() const { return m_bError; }
+
+    // Decode everything from the start
+    bool ReadAll(std::vector<InputEvent>& events);
+
+private:
+    bool ReadVarint(uint64_t& value);
+    bool ReadSigned(int64_t& value);
+
+    std::vector<uint8_t> m_Data;
+    size_t m_Position;
+    bool m_bError;
+
+    int64_t m_TimeUs;
+    int32_t m_X, m_Y;
+    int32_t m_Pressure;
+    int32_t m_TiltX, m_TiltY;
+    uint32_t m_Buttons;
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Raw input sample, or a point on the smoothed curve
+struct StrokeSample {
+    float x, y;
+    float pressure;
+    double timeMs;      // When the sample arrived
+};
+
+// Delay the smoother added between a sample arriving and the curve reaching it
+struct StrokeLatency {
+    double averageMs;
+    double maxMs;
+    uint32_t sampleCount;
+};
+
+// Optional stage between input and the brush that turns the polyline of
+// raw samples into a centripetal Catmull-Rom curve. The lookahead, 0 to 3
+// samples, is the explicit latency/quality trade-off:
+//   0  pass-through, no added latency
+//   1  Catmull-Rom through the raw samples
+//   2  samples pre-filtered with a [1 2 1] kernel, then Catmull-Rom
+//   3  samples pre-filtered with a [1 4 6 4 1] kernel, then Catmull-Rom
+// The curve trails the newest sample by exactly lookahead samples until the
+// stroke ends, when the rest is flushed.
+class StrokeSmoother {
+public:
+    static constexpr uint32_t MAX_LOOKAHEAD = 3;
+
+    StrokeSmoother();
+
+    void SetLookahead(uint32_t lookahead);
+    uint32_t GetLookahead() const { return m_Lookahead; }
+
+    // Points appended to out are the curve, ready for PressureBrush::EmitDabs
+    void Begin();
+    void AddSample(const StrokeSample& sample, std::vector<StrokeSample>& out);
+    void End(std::vector<StrokeSample>& out);
+
+    // Raw samples the curve has not reached yet, held back for lookahead
+    void GetPending(std::vector<StrokeSample>& out) const;
+
+    // Measured over the current (or last) stroke while drawing; the flush at
+    // pen-up is not counted
+    const StrokeLatency& GetLatency() const { return m_Latency; }
+
+private:
+    StrokeSample GetFiltered(int index) const;
+    StrokeSample GetControlPoint(int index, int lastIndex) const;
+    void EmitUpTo(int lastIndex, int available, double nowMs, bool bMeasure, std::vector<StrokeSample>& out);
+
+    uint32_t m_Lookahead;
+    std::vector<StrokeSample> m_Samples;
+    int m_Emitted;      // Index of the last filtered sample the curve has reached
+    StrokeLatency m_Latency;
+};
\ No newline at end of file
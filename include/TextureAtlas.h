@@ -0,0 +1,90 @@
+#pragma once
+#include "AtlasPacker.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+
+class RenderBackend;
+class Sprite;
+struct Image;
+
+// Placement of one image inside an atlas page
+struct AtlasRegion {
+    uint32_t page;
+    AtlasRect rect;     // Image pixels, excluding padding
+    float u0, v0, u1, v1;
+};
+
+// Runtime cache that packs sprite images into shared RGBA8 pages, so many
+// sprites draw with one texture bound. Pages live in CPU memory and, when a
+// backend is given, as backend textures updated by Upload(). Without a
+// backend the atlas can still be built and saved offline.
+class TextureAtlas {
+public:
+    static const uint32_t DEFAULT_PAGE_SIZE = 2048;
+
+    // Border around every image, filled by edge extrusion so bilinear
+    // filtering never reads a neighbouring image
+    static const uint32_t PADDING = 1;
+
+    TextureAtlas(RenderBackend* pBackend = nullptr, uint32_t pageSize = DEFAULT_PAGE_SIZE, uint32_t maxPages = 8);
+    ~TextureAtlas();
+
+    // Copy an RGBA8 image in under name, replacing any previous image with
+    // that name. rowPitch of 0 means tightly packed. Returns false when no
+    // page has room; evict something and retry.
+    bool Insert(const std::string& name, uint32_t width, uint32_t height, const uint8_t* pPixels, uint32_t rowPitch = 0);
+    bool Insert(const std::string& name, const Image& image);
+
+    // Release an image's space for reuse. Sprites still pointing at it will
+    // show whatever is packed there next.
+    bool Evict(const std::string& name);
+    void Clear();
+
+    const AtlasRegion* Find(const std::string& name) const;
+
+    // Point a sprite at an image: texture, UV rectangle and pixel size
+    bool ApplyToSprite(const std::string& name, Sprite& sprite) const;
+
+    // Push modified page areas to the backend; call before drawing
+    void Upload();
+
+    uint32_t GetPageSize() const { return m_PageSize; }
+    uint32_t GetPageCount() const { return (uint32_t)m_Pages.size(); }
+    uint32_t GetRegionCount() const { return (uint32_t)m_Regions.size(); }
+    uint32_t GetTextureId(uint32_t page) const;
+    const uint8_t* GetPagePixels(uint32_t page) const;
+    float GetOccupancy() const;
+
+    // Baked atlas file: header, region table, then raw page pixels
+    bool Save(const std::string& filename) const;
+    bool Load(const std::string& filename);
+
+private:
+    struct Page {
+        AtlasPacker packer;
+        std::vector<uint8_t> pixels;
+        uint32_t textureId;
+
+        // Area modified since the last upload
+        bool bDirty;
+        uint32_t dirtyMinX, dirtyMinY, dirtyMaxX, dirtyMaxY;
+
+        Page(uint32_t size) : packer(size, size), textureId(0), bDirty(false),
+            dirtyMinX(0), dirtyMinY(0), dirtyMaxX(0), dirtyMaxY(0) {}
+    };
+
+    bool AddPage();
+    void CopyImage(Page& page, const AtlasRect& rect, const uint8_t* pPixels, uint32_t rowPitch);
+    void MarkDirty(Page& page, const AtlasRect& rect);
+    AtlasRegion MakeRegion(uint32_t page, const AtlasRect& paddedRect) const;
+    void ReleasePages();
+    bool LoadContents(std::ifstream& file, uint32_t pageCount, uint32_t regionCount);
+
+    RenderBackend* m_pBackend;
+    uint32_t m_PageSize;
+    uint32_t m_MaxPages;
+    std::vector<Page> m_Pages;
+    std::unordered_map<std::string, AtlasRegion> m_Regions;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include "Canvas.h"
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// Undo/redo for a Canvas, one state per edit (usually a stroke). A state
+// holds only the tiles its edit wrote, as the other version of each tile,
+// and undo or redo swaps them back in, so both cost O(tiles in the edit).
+// Tiles nobody wrote stay shared with the canvas and are never copied.
+// Undo and redo states share the memory budget, which is checked after every
+// push, undo and redo. Over it, the states furthest from the current one are
+// LZ4-compressed, and once all but the next undo and redo are compressed the
+// oldest undo states, then the furthest redo states, are dropped.
+class UndoHistory {
+public:
+    static const size_t DEFAULT_MEMORY_BUDGET = 256 * 1024 * 1024;
+    static const size_t DEFAULT_MAX_STATES = 200;
+
+    UndoHistory();
+
+    void SetMemoryBudget(size_t bytes);
+    size_t GetMemoryBudget() const { return m_MemoryBudget; }
+    void SetMaxStates(size_t count);
+    size_t GetMaxStates() const { return m_MaxStates; }
+
+    // Record a finished edit from Canvas::EndChange; clears the redo states.
+    // Edits that touched nothing are ignored.
+    void Push(std::vector<Canvas::TileChange>& changes);
+
+    bool Undo(Canvas& canvas);
+    bool Redo(Canvas& canvas);
+    bool CanUndo() const { return !m_UndoStates.empty(); }
+    bool CanRedo() const { return !m_RedoStates.empty(); }
+    size_t GetUndoCount() const { return m_UndoStates.size(); }
+    size_t GetRedoCount() const { return m_RedoStates.size(); }
+
+    // Bytes of tile data held for undo and redo
+    size_t GetMemoryUsage() const { return m_MemoryUsage; }
+    size_t GetCompressedStateCount() const;
+
+    void Clear();
+
+private:
+    // Tiles of one state, each either live or LZ4-compressed
+    struct HistoryState {
+        std::vector<Canvas::TileChange> tiles;
+        std::vector<std::vector<uint8_t>> compressed;   // Empty for live tiles
+        size_t bytes;
+        bool bCompressed;
+    };
+
+    static size_t MeasureState(const HistoryState& state);
+    void CompressState(HistoryState& state);
+    void Compress(HistoryState& state);
+    void Decompress(HistoryState& state);
+    void Apply(Canvas& canvas, HistoryState& state);
+    void EnforceBudget();
+
+    std::deque<HistoryState> m_UndoStates;      // Oldest first
+    std::vector<HistoryState> m_RedoStates;     // Next redo last
+    size_t m_MemoryBudget;
+    size_t m_MaxStates;
+    size_t m_MemoryUsage;
+};
\ No newline at end of file
@@ -0,0 +1,162 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+struct Vertex {
+    float x, y, z;
+    float u, v;
+    float r, g, b, a;
+};
+
+// 16-byte vertex: 2D position, half-float UVs, RGBA8 colour (red in the low byte)
+struct CompactVertex {
+    float x, y;
+    uint16_t u, v;
+    uint32_t color;
+};
+
+static_assert(sizeof(CompactVertex) == 16, "CompactVertex must match the compact input layout");
+
+enum class VertexFormat {
+    STANDARD,   // Vertex, 36 bytes
+    COMPACT     // CompactVertex, 16 bytes
+};
+
+inline uint32_t GetVertexStride(VertexFormat format) {
+    return format == VertexFormat::COMPACT ? (uint32_t)sizeof(CompactVertex) : (uint32_t)sizeof(Vertex);
+}
+
+// IEEE 754 binary16 conversion, round to nearest even
+inline uint16_t FloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponentBits = (bits >> 23) & 0xFF;
+    int32_t exponent = (int32_t)exponentBits - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (exponentBits == 0xFF) {
+        return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+    }
+    if (exponent >= 31) {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    if (exponent <= 0) {
+        // Subnormal half
+        if (exponent < -10) {
+            return (uint16_t)sign;
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = (uint32_t)(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (remainder > halfway || (remainder == halfway && (half & 1))) {
+            half++;
+        }
+        return (uint16_t)(sign | half);
+    }
+
+    // A carry out of the mantissa correctly bumps the exponent
+    uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) {
+        half++;
+    }
+    return (uint16_t)half;
+}
+
+inline float HalfToFloat(uint16_t half) {
+    uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Renormalise the subnormal
+            exponent = 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            mantissa &= 0x3FF;
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint32_t PackColorRGBA8(float r, float g, float b, float a) {
+    auto pack = [](float value) -> uint32_t {
+        value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+        return (uint32_t)(value * 255.0f + 0.5f);
+    };
+    return pack(r) | (pack(g) << 8) | (pack(b) << 16) | (pack(a) << 24);
+}
+
+inline void UnpackColorRGBA8(uint32_t color, float& r, float& g, float& b, float& a) {
+    const float unorm8 = 1.0f / 255.0f;
+    r = (color & 0xFF) * unorm8;
+    g = ((color >> 8) & 0xFF) * unorm8;
+    b = ((color >> 16) & 0xFF) * unorm8;
+    a = (color >> 24) * unorm8;
+}
+
+// Per-format encode/decode so batch building and rasterisation share code
+template <typename TVertex>
+struct VertexTraits;
+
+template <>
+struct VertexTraits<Vertex> {
+    static const VertexFormat Format = VertexFormat::STANDARD;
+
+    static void Write(Vertex& out, float x, float y, float u, float v, float r, float g, float b, float a) {
+        out = { x, y, 0.0f, u, v, r, g, b, a };
+    }
+
+    static void WritePacked(Vertex& out, float x, float y, float u, float v, uint32_t color) {
+        float r, g, b, a;
+        UnpackColorRGBA8(color, r, g, b, a);
+        out = { x, y, 0.0f, u, v, r, g, b, a };
+    }
+
+    static Vertex Decode(const Vertex& in) {
+        return in;
+    }
+};
+
+template <>
+struct VertexTraits<CompactVertex> {
+    static const VertexFormat Format = VertexFormat::COMPACT;
+
+    static void Write(CompactVertex& out, float x, float y, float u, float v, float r, float g, float b, float a) {
+        out = { x, y, FloatToHalf(u), FloatToHalf(v), PackColorRGBA8(r, g, b, a) };
+    }
+
+    static void WritePacked(CompactVertex& out, float x, float y, float u, float v, uint32_t color) {
+        out = { x, y, FloatToHalf(u), FloatToHalf(v), color };
+    }
+
+    static Vertex Decode(const CompactVertex& in) {
+        Vertex out;
+        out.x = in.x;
+        out.y = in.y;
+        out.z = 0.0f;
+        out.u = HalfToFloat(in.u);
+        out.v = HalfToFloat(in.v);
+        UnpackColorRGBA8(in.color, out.r, out.g, out.b, out.a);
+        return out;
+    }
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// Runs a batch of independent tasks, numbered 0..count-1, on a fixed set of
+// threads; the calling thread works too. Each thread starts with a
+// contiguous run of tasks and takes them from the front; a thread that runs
+// out steals the back half of another's run, so uneven tasks still balance
+// without a shared queue. Runs are packed into one atomic word per thread,
+// so taking and stealing are single compare-exchanges.
+class WorkStealingPool {
+public:
+    // threadCount of 0 uses every hardware thread
+    explicit WorkStealingPool(uint32_t threadCount = 0);
+    ~WorkStealingPool();
+
+    uint32_t GetThreadCount() const { return m_ThreadCount; }
+
+    // Call task(index) for every index below count and return when all are
+    // done. Not reentrant: one Run at a time, and not from inside a task.
+    void Run(uint32_t count, const std::function<void(uint32_t)>& task);
+
+    // Tasks taken from another thread's run since construction
+    uint64_t GetStealCount() const { return m_Steals.load(std::memory_order_relaxed); }
+
+private:
+    // [begin, end) packed as begin << 32 | end
+    struct alignas(64) TaskRange {
+        std::atomic<uint64_t> range;
+    };
+
+    void WorkerMain(uint32_t threadIndex);
+    void Work(uint32_t threadIndex, const std::function<void(uint32_t)>& task);
+    bool TakeTask(uint32_t threadIndex, uint32_t& task);
+    bool Steal(uint32_t threadIndex);
+
+    uint32_t m_ThreadCount;
+    std::unique_ptr<TaskRange[]> m_Ranges;
+    const std::function<void(uint32_t)>* m_pTask;     // Set only while Run is in progress
+    std::atomic<uint64_t> m_Steals;
+
+    std::vector<std::thread> m_Workers;
+    std::mutex m_Mutex;
+    std::condition_variable m_WorkCondition;
+    std::condition_variable m_DoneCondition;
+    uint64_t m_Generation;
+    uint32_t m_ActiveWorkers;
+    bool m_bShutdown;
+};
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "../include/AssetArchive.h"
+#include "../include/LZ4.h"
+#include <fstream>
+#include <filesystem>
+#include <cstring>
+#include <exception>
+
+static const char ARCHIVE_MAGIC[4] = { 'A', 'P', 'A', 'K' };
+static const uint32_t ARCHIVE_VERSION = 1;
+
+// magic, version, entryCount, alignment, tocOffset, tocSize
+static const size_t HEADER_SIZE = 32;
+
+// offset, storedSize, size, flags, nameLength
+static const size_t TOC_ENTRY_SIZE = 32;
+
+// No asset decompresses to more than this; a larger size is a corrupt entry
+static const uint64_t MAX_DECOMPRESSED_SIZE = (uint64_t)1 << 30;
+
+// Most an LZ4 block can expand to: every byte of a match length run adds 255
+static uint64_t LZ4MaxExpansion(uint64_t storedSize) {
+    return storedSize * 255 + 16;
+}
+
+template <typename T>
+static void Put(std::vector<uint8_t>& out, T value) {
+    size_t position = out.size();
+    out.resize(position + sizeof(T));
+    memcpy(&out[position], &value, sizeof(T));
+}
+
+template <typename T>
+static T Get(const uint8_t* p) {
+    T value;
+    memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+AssetArchive::AssetArchive() {
+}
+
+AssetArchive::~AssetArchive() {
+    Close();
+}
+
+bool AssetArchive::Open(const std::wstring& filename) {
+    Close();
+
+    if (!m_File.Open(filename)) {
+        return false;
+    }
+
+    if (!ReadTableOfContents()) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void AssetArchive::Close() {
+    m_File.Close();
+    m_Entries.clear();
+    m_Lookup.clear();
+}
+
+bool AssetArchive::ReadTableOfContents() {
+    const uint8_t* pData = m_File.GetData();
+    size_t fileSize = m_File.GetSize();
+
+    if (fileSize < HEADER_SIZE || memcmp(pData, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0 ||
+        Get<uint32_t>(pData + 4) != ARCHIVE_VERSION) {
+        return false;
+    }
+
+    uint32_t entryCount = Get<uint32_t>(pData + 8);
+    uint64_t tocOffset = Get<uint64_t>(pData + 16);
+    uint64_t tocSize = Get<uint64_t>(pData + 24);
+    if (tocOffset > fileSize || tocSize > fileSize - tocOffset ||
+        (uint64_t)entryCount * TOC_ENTRY_SIZE > tocSize) {
+        return false;
+    }
+
+    const uint8_t* p = pData + tocOffset;
+    const uint8_t* pEnd = p + tocSize;
+
+    m_Entries.resize(entryCount);
+    m_Lookup.reserve(entryCount);
+    for (uint32_t i = 0; i < entryCount; i++) {
+        if ((size_t)(pEnd - p) < TOC_ENTRY_SIZE) {
+            return false;
+        }
+
+        ArchiveEntry& entry = m_Entries[i];
+        entry.offset = Get<uint64_t>(p);
+        entry.storedSize = Get<uint64_t>(p + 8);
+        entry.size = Get<uint64_t>(p + 16);
+        entry.flags = Get<uint32_t>(p + 24);
+        uint32_t nameLength = Get<uint32_t>(p + 28);
+        p += TOC_ENTRY_SIZE;
+
+        if (nameLength > (size_t)(pEnd - p) || entry.offset > tocOffset ||
+            entry.storedSize > tocOffset - entry.offset ||
+            (!(entry.flags & FLAG_LZ4) && entry.storedSize != entry.size)) {
+            return false;
+        }
+
+        // The size decides the decode buffer, so it must be one the stored
+        // bytes could really produce
+        if ((entry.flags & FLAG_LZ4) &&
+            (entry.size > MAX_DECOMPRESSED_SIZE || entry.size > LZ4MaxExpansion(entry.storedSize))) {
+            return false;
+        }
+
+        entry.name.assign((const char*)p, nameLength);
+        p += nameLength;
+        m_Lookup[entry.name] = i;
+    }
+
+    return true;
+}
+
+const ArchiveEntry* AssetArchive::Find(const std::string& name) const {
+    auto it = m_Lookup.find(name);
+    return it != m_Lookup.end() ? &m_Entries[it->second] : nullptr;
+}
+
+bool AssetArchive::GetData(const ArchiveEntry& entry, std::vector<uint8_t>& scratch, const uint8_t*& pData, size_t& size) const {
+    const uint8_t* pStored = m_File.GetData() + entry.offset;
+
+    if (!(entry.flags & FLAG_LZ4)) {
+        pData = pStored;
+        size = (size_t)entry.size;
+        return true;
+    }
+
+    // Called on loader workers, where an escaping exception would terminate
+    try {
+        scratch.resize((size_t)entry.size);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (!LZ4Decompress(pStored, (size_t)entry.storedSize, scratch.data(), scratch.size())) {
+        return false;
+    }
+    pData = scratch.data();
+    size = scratch.size();
+    return true;
+}
+
+bool AssetArchive::Read(const std::string& name, std::vector<uint8_t>& scratch, const uint8_t*& pData, size_t& size) const {
+    const ArchiveEntry* pEntry = Find(name);
+    return pEntry && GetData(*pEntry, scratch, pData, size);
+}
+
+AssetArchiveWriter::AssetArchiveWriter() {
+}
+
+bool AssetArchiveWriter::AddFile(const std::string& name, const std::wstring& filename, bool bCompress) {
+    std::ifstream file(std::filesystem::path(filename), std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    file.seekg(0);
+
+    std::vector<uint8_t> data((size_t)size);
+    if (size > 0 && !file.read((char*)data.data(), size)) {
+        return false;
+    }
+
+    AddData(name, data.data(), data.size(), bCompress);
+    return true;
+}
+
+void AssetArchiveWriter::AddData(const std::string& name, const uint8_t* pData, size_t size, bool bCompress) {
+    PendingEntry entry;
+    entry.name = name;
+    entry.size = size;
+    entry.flags = 0;
+
+    if (bCompress && size > 0) {
+        LZ4Compress(pData, size, entry.data);
+        if (entry.data.size() <= size - size / 8) {
+            entry.flags = AssetArchive::FLAG_LZ4;
+        }
+    }
+    if (!(entry.flags & AssetArchive::FLAG_LZ4)) {
+        entry.data.assign(pData, pData + size);
+    }
+
+    // Replace an earlier entry with the same name
+    for (PendingEntry& existing : m_Entries) {
+        if (existing.name == name) {
+            existing = std::move(entry);
+            return;
+        }
+    }
+    m_Entries.push_back(std::move(entry));
+}
+
+bool AssetArchiveWriter::Save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    // Blobs start on an aligned boundary after the header
+    std::vector<uint64_t> offsets;
+    offsets.reserve(m_Entries.size());
+    uint64_t position = AssetArchive::ALIGNMENT;
+    for (const PendingEntry& entry : m_Entries) {
+        offsets.push_back(position);
+        position += entry.data.size();
+        position = (position + AssetArchive::ALIGNMENT - 1) & ~(uint64_t)(AssetArchive::ALIGNMENT - 1);
+    }
+    uint64_t tocOffset = position;
+
+    std::vector<uint8_t> toc;
+    for (size_t i = 0; i < m_Entries.size(); i++) {
+        const PendingEntry& entry = m_Entries[i];
+        Put<uint64_t>(toc, offsets[i]);
+        Put<uint64_t>(toc, entry.data.size());
+        Put<uint64_t>(toc, entry.size);
+        Put<uint32_t>(toc, entry.flags);
+        Put<uint32_t>(toc, (uint32_t)entry.name.size());
+        toc.insert(toc.end(), entry.name.begin(), entry.name.end());
+    }
+
+    std::vector<uint8_t> header;
+    header.insert(header.end(), ARCHIVE_MAGIC, ARCHIVE_MAGIC + sizeof(ARCHIVE_MAGIC));
+    Put<uint32_t>(header, ARCHIVE_VERSION);
+    Put<uint32_t>(header, (uint32_t)m_Entries.size());
+    Put<uint32_t>(header, AssetArchive::ALIGNMENT);
+    Put<uint64_t>(header, tocOffset);
+    Put<uint64_t>(header, toc.size());
+    header.resize(AssetArchive::ALIGNMENT, 0);
+    file.write((const char*)header.data(), header.size());
+
+    static const char padding[AssetArchive::ALIGNMENT] = {};
+    for (size_t i = 0; i < m_Entries.size(); i++) {
+        const PendingEntry& entry = m_Entries[i];
+        file.write((const char*)entry.data.data(), entry.data.size());
+
+        uint64_t end = offsets[i] + entry.data.size();
+        uint64_t next = i + 1 < m_Entries.size() ? offsets[i + 1] : tocOffset;
+        file.write(padding, (std::streamsize)(next - end));
+    }
+
+    file.write((const char*)toc.data(), toc.size());
+    return file.good();
+}
+
+uint64_t AssetArchiveWriter::GetStoredSize() const {
+    uint64_t total = 0;
+    for (const PendingEntry& entry : m_Entries) {
+        total += entry.data.size();
+    }
+    return total;
+}
+
+uint64_t AssetArchiveWriter::GetRawSize() const {
+    uint64_t total = 0;
+    for (const PendingEntry& entry : m_Entries) {
+        total += entry.size;
+    }
+    return total;
+}
\ No newline at end of file
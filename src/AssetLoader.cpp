@@ -0,0 +1,321 @@
+#include "../include/AssetLoader.h"
+#include "../include/Profiler.h"
+#include "../include/Renderer.h"
+#include "../include/TextureAtlas.h"
+#include "../include/AssetArchive.h"
+#include <filesystem>
+#include <algorithm>
+using std::min;
+using std::max;
+
+// Checkerboard shown in place of sprites that are not resident yet
+static const uint32_t PLACEHOLDER_SIZE = 8;
+
+Asset::Asset(const std::wstring& filename, bool bUpload) :
+    m_Filename(filename),
+    m_bUpload(bUpload),
+    m_State(AssetState::QUEUED),
+    m_TextureId(RenderBackend::WHITE_TEXTURE),
+    m_bUnloaded(false) {
+}
+
+AssetLoader::AssetLoader(Renderer* pRenderer, TextureAtlas* pAtlas, uint32_t workerCount) :
+    m_pRenderer(pRenderer),
+    m_pAtlas(pAtlas),
+    m_pArchive(nullptr),
+    m_PlaceholderTextureId(RenderBackend::WHITE_TEXTURE),
+    m_PendingCount(0),
+    m_WorkerCount(workerCount),
+    m_ActiveWorkers(0),
+    m_bShutdown(false) {
+    if (m_WorkerCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        m_WorkerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    Cleanup();
+}
+
+bool AssetLoader::Initialize() {
+    if (!m_pRenderer) {
+        return false;
+    }
+
+    uint8_t pixels[PLACEHOLDER_SIZE * PLACEHOLDER_SIZE * 4];
+    for (uint32_t y = 0; y < PLACEHOLDER_SIZE; y++) {
+        for (uint32_t x = 0; x < PLACEHOLDER_SIZE; x++) {
+            uint8_t* pPixel = &pixels[(y * PLACEHOLDER_SIZE + x) * 4];
+            uint8_t shade = ((x / 2 + y / 2) & 1) ? 0x60 : 0x90;
+            pPixel[0] = pPixel[1] = pPixel[2] = shade;
+            pPixel[3] = 0xFF;
+        }
+    }
+    m_PlaceholderTextureId = m_pRenderer->CreateTexture(PLACEHOLDER_SIZE, PLACEHOLDER_SIZE, pixels);
+    m_pRenderer->SetPlaceholderTexture(m_PlaceholderTextureId);
+
+    m_bShutdown = false;
+    for (uint32_t i = 0; i < m_WorkerCount; i++) {
+        m_Workers.emplace_back(&AssetLoader::WorkerMain, this);
+    }
+    return true;
+}
+
+void AssetLoader::Cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bShutdown = true;
+    }
+    m_WorkCondition.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+    m_Workers.clear();
+
+    m_Queue.clear();
+    m_Decoded.clear();
+
+    for (auto& asset : m_Unloaded) {
+        Release(*asset);
+    }
+    m_Unloaded.clear();
+    for (auto& entry : m_Sprites) {
+        Release(*entry.second);
+    }
+    m_Sprites.clear();
+    m_BrushTips.clear();
+    m_PendingCount = 0;
+
+    if (m_pRenderer && m_PlaceholderTextureId != RenderBackend::WHITE_TEXTURE) {
+        m_pRenderer->SetPlaceholderTexture(RenderBackend::WHITE_TEXTURE);
+        m_pRenderer->DestroyTexture(m_PlaceholderTextureId);
+        m_PlaceholderTextureId = RenderBackend::WHITE_TEXTURE;
+    }
+}
+
+AssetHandle AssetLoader::LoadSprite(const std::wstring& filename, float placeholderWidth, float placeholderHeight) {
+    return Load(filename, true, placeholderWidth, placeholderHeight);
+}
+
+AssetHandle AssetLoader::LoadBrushTip(const std::wstring& filename) {
+    return Load(filename, false, 0.0f, 0.0f);
+}
+
+AssetHandle AssetLoader::Load(const std::wstring& filename, bool bUpload, float placeholderWidth, float placeholderHeight) {
+    auto& assets = GetAssetMap(bUpload);
+    auto it = assets.find(filename);
+    if (it != assets.end()) {
+        return it->second;
+    }
+
+    AssetHandle asset(new Asset(filename, bUpload));
+    // Once queued the sprite belongs to Update
+    asset->m_Sprite.SetPending(bUpload);
+    if (bUpload) {
+        asset->m_Sprite.SetSize(placeholderWidth, placeholderHeight);
+    }
+    assets[filename] = asset;
+    m_PendingCount++;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.push_back(asset);
+    }
+    m_WorkCondition.notify_one();
+    return asset;
+}
+
+void AssetLoader::Unload(const AssetHandle& asset) {
+    if (!asset) return;
+
+    auto& assets = GetAssetMap(asset->m_bUpload);
+    auto it = assets.find(asset->m_Filename);
+    if (it == assets.end() || it->second != asset) {
+        return;
+    }
+    assets.erase(it);
+
+    {
+        // Still waiting in a queue, it is simply dropped. A worker decoding
+        // it, or Update finalizing it, sees the flag and finishes it instead.
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        asset->m_bUnloaded = true;
+        size_t waiting = m_Queue.size() + m_Decoded.size();
+        m_Queue.erase(std::remove(m_Queue.begin(), m_Queue.end(), asset), m_Queue.end());
+        m_Decoded.erase(std::remove(m_Decoded.begin(), m_Decoded.end(), asset), m_Decoded.end());
+        if (m_Queue.size() + m_Decoded.size() != waiting) {
+            m_PendingCount--;
+        }
+
+        // The texture and atlas belong to the render thread
+        m_Unloaded.push_back(asset);
+    }
+    m_DoneCondition.notify_all();
+}
+
+uint32_t AssetLoader::Update(size_t uploadBudget) {
+    PROFILE_ZONE("AssetLoader::Update");
+    uint32_t finished = 0;
+    size_t uploaded = 0;
+    bool bAtlasDirty = false;
+
+    for (;;) {
+        AssetHandle asset;
+        bool bUnloaded = false;
+        std::deque<AssetHandle> unloaded;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            unloaded.swap(m_Unloaded);
+            if (!m_Decoded.empty() && (finished == 0 || uploaded < uploadBudget)) {
+                asset = std::move(m_Decoded.front());
+                m_Decoded.pop_front();
+                bUnloaded = asset->m_bUnloaded;
+            }
+        }
+
+        // Released before anything later is finalized, so a file unloaded
+        // and loaded again does not lose its new atlas region to the old one
+        for (auto& pUnloaded : unloaded) {
+            Release(*pUnloaded);
+        }
+        if (!asset) break;
+
+        uploaded += asset->m_Image.pixels.size();
+        if (bUnloaded) {
+            // Already on its way out; nothing to upload
+        } else if (Finalize(*asset)) {
+            bAtlasDirty |= !asset->m_AtlasName.empty();
+            asset->m_Sprite.SetPending(false);
+            asset->m_State.store(AssetState::RESIDENT, std::memory_order_release);
+        } else {
+            // Keeps drawing the placeholder
+            asset->m_State.store(AssetState::FAILED, std::memory_order_release);
+        }
+
+        // The GPU (or atlas) holds the pixels now
+        asset->m_Image = Image();
+        m_PendingCount--;
+        finished++;
+    }
+
+    if (bAtlasDirty) {
+        m_pAtlas->Upload();
+    }
+    return finished;
+}
+
+void AssetLoader::Wait(const AssetHandle& asset) {
+    if (!asset) return;
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [&] {
+        return asset->GetState() != AssetState::QUEUED || asset->m_bUnloaded || m_bShutdown;
+    });
+}
+
+void AssetLoader::WaitAll() {
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [this] {
+        return (m_Queue.empty() && m_ActiveWorkers == 0) || m_bShutdown;
+    });
+}
+
+bool AssetLoader::Finalize(Asset& asset) {
+    const Image& image = asset.m_Image;
+    Sprite& sprite = asset.m_Sprite;
+
+    // Small images share atlas pages; anything that does not fit gets its own texture
+    if (m_pAtlas) {
+        std::string name = std::filesystem::path(asset.m_Filename).u8string();
+        if (m_pAtlas->Insert(name, image) && m_pAtlas->ApplyToSprite(name, sprite)) {
+            asset.m_AtlasName = name;
+            return true;
+        }
+    }
+
+    uint32_t textureId = m_pRenderer->CreateTexture(image.width, image.height, image.pixels.data());
+    if (textureId == RenderBackend::WHITE_TEXTURE) {
+        return false;
+    }
+
+    asset.m_TextureId = textureId;
+    sprite.SetTextureRegion(textureId, 0.0f, 0.0f, 1.0f, 1.0f);
+    sprite.SetSize((float)image.width, (float)image.height);
+    return true;
+}
+
+void AssetLoader::Release(Asset& asset) {
+    if (!asset.m_AtlasName.empty()) {
+        if (m_pAtlas) {
+            m_pAtlas->Evict(asset.m_AtlasName);
+        }
+        asset.m_AtlasName.clear();
+    }
+
+    if (asset.m_TextureId != RenderBackend::WHITE_TEXTURE) {
+        if (m_pRenderer) {
+            m_pRenderer->DestroyTexture(asset.m_TextureId);
+        }
+        asset.m_TextureId = RenderBackend::WHITE_TEXTURE;
+    }
+
+    asset.m_Sprite.SetTextureRegion(RenderBackend::WHITE_TEXTURE, 0.0f, 0.0f, 1.0f, 1.0f);
+    asset.m_Sprite.SetPending(asset.m_bUpload);
+}
+
+bool AssetLoader::Decode(Asset& asset, std::vector<uint8_t>& scratch) const {
+    PROFILE_ZONE("AssetLoader::Decode");
+    if (m_pArchive) {
+        const ArchiveEntry* pEntry = m_pArchive->Find(std::filesystem::path(asset.m_Filename).generic_u8string());
+        const uint8_t* pData;
+        size_t size;
+        if (pEntry && m_pArchive->GetData(*pEntry, scratch, pData, size)) {
+            return DecodeImage(pData, size, asset.m_Image);
+        }
+    }
+
+    return LoadImageFile(asset.m_Filename, asset.m_Image);
+}
+
+void AssetLoader::WorkerMain() {
+    Profiler::SetThreadName("Asset loader");
+    // Decompression buffer for archive entries, reused across files
+    std::vector<uint8_t> scratch;
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    for (;;) {
+        m_WorkCondition.wait(lock, [this] { return m_bShutdown || !m_Queue.empty(); });
+        if (m_bShutdown) {
+            return;
+        }
+
+        AssetHandle asset = std::move(m_Queue.front());
+        m_Queue.pop_front();
+        m_ActiveWorkers++;
+
+        // File reads and decoding run without the lock held
+        lock.unlock();
+        bool bDecoded = Decode(*asset, scratch);
+        lock.lock();
+
+        m_ActiveWorkers--;
+        if (asset->m_bUnloaded) {
+            // Unload could not take it off the queue, so it is finished here
+            m_PendingCount--;
+        } else {
+            if (!bDecoded) {
+                asset->m_State.store(AssetState::FAILED, std::memory_order_release);
+                m_PendingCount--;
+            } else if (asset->m_bUpload) {
+                asset->m_State.store(AssetState::DECODED, std::memory_order_release);
+                m_Decoded.push_back(asset);
+            } else {
+                asset->m_State.store(AssetState::RESIDENT, std::memory_order_release);
+                m_PendingCount--;
+            }
+        }
+        m_DoneCondition.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#include "../include/AtlasPacker.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+static inline bool Intersects(const AtlasRect& a, const AtlasRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static inline bool Contains(const AtlasRect& outer, const AtlasRect& inner) {
+    return inner.x >= outer.x && inner.y >= outer.y &&
+           inner.x + inner.width <= outer.x + outer.width &&
+           inner.y + inner.height <= outer.y + outer.height;
+}
+
+// Rebuild once the free list has grown this much past its clean size
+static const uint32_t REBUILD_SLACK = 64;
+
+// A failed insertion rebuilds only once this share of the used rectangles
+// has been freed, so the rebuild's cost is spread over as many frees
+static const uint32_t REBUILD_FREE_FRACTION = 8;
+
+AtlasPacker::AtlasPacker(uint32_t width, uint32_t height) :
+    m_Width(max(1u, width)),
+    m_Height(max(1u, height)),
+    m_UsedArea(0),
+    m_FreedCount(0),
+    m_FreedArea(0),
+    m_CleanFreeRectCount(1) {
+    Reset();
+}
+
+void AtlasPacker::Reset() {
+    m_UsedRects.clear();
+    m_FreeRects.clear();
+    m_FreeRects.push_back({ 0, 0, m_Width, m_Height });
+    m_UsedArea = 0;
+    m_FreedCount = 0;
+    m_FreedArea = 0;
+}
+
+bool AtlasPacker::FindPosition(uint32_t width, uint32_t height, AtlasRect& rect) const {
+    // Best short side fit, ties broken on the long side
+    uint32_t bestShortSide = UINT32_MAX;
+    uint32_t bestLongSide = UINT32_MAX;
+    bool found = false;
+
+    for (const AtlasRect& freeRect : m_FreeRects) {
+        if (freeRect.width < width || freeRect.height < height) {
+            continue;
+        }
+
+        uint32_t leftoverX = freeRect.width - width;
+        uint32_t leftoverY = freeRect.height - height;
+        uint32_t shortSide = min(leftoverX, leftoverY);
+        uint32_t longSide = max(leftoverX, leftoverY);
+
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide)) {
+            rect = { freeRect.x, freeRect.y, width, height };
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool AtlasPacker::Insert(uint32_t width, uint32_t height, AtlasRect& rect) {
+    if (width == 0 || height == 0) {
+        return false;
+    }
+
+    if (!FindPosition(width, height, rect)) {
+        // Space freed since the last rebuild may have room once merged with
+        // its neighbours. A rebuild costs a placement per used rectangle.
+        uint32_t minFreedCount = max(1u, (uint32_t)m_UsedRects.size() / REBUILD_FREE_FRACTION);
+        if (m_FreedCount < minFreedCount || m_FreedArea < (uint64_t)width * height) {
+            return false;
+        }
+        Rebuild();
+        if (!FindPosition(width, height, rect)) {
+            return false;
+        }
+    }
+
+    Place(rect);
+    m_UsedRects.push_back(rect);
+    return true;
+}
+
+bool AtlasPacker::Reserve(const AtlasRect& rect) {
+    if (rect.width == 0 || rect.height == 0) {
+        return false;
+    }
+
+    for (const AtlasRect& freeRect : m_FreeRects) {
+        if (Contains(freeRect, rect)) {
+            Place(rect);
+            m_UsedRects.push_back(rect);
+            return true;
+        }
+    }
+    return false;
+}
+
+void AtlasPacker::Free(const AtlasRect& rect) {
+    auto it = std::find_if(m_UsedRects.begin(), m_UsedRects.end(), [&rect](const AtlasRect& used) {
+        return used.x == rect.x && used.y == rect.y && used.width == rect.width && used.height == rect.height;
+    });
+    if (it == m_UsedRects.end()) {
+        return;
+    }
+    *it = m_UsedRects.back();
+    m_UsedRects.pop_back();
+
+    m_UsedArea -= (uint64_t)rect.width * rect.height;
+    if (m_UsedRects.empty()) {
+        Reset();
+        return;
+    }
+
+    // Freed space is disjoint from every free rectangle but not merged
+    // with them, so placements split it into ever more pieces; rebuild
+    // before the list gets out of hand
+    if (m_FreedCount == 0) {
+        m_CleanFreeRectCount = (uint32_t)m_FreeRects.size();
+    }
+    m_FreedCount++;
+    m_FreedArea += (uint64_t)rect.width * rect.height;
+    m_FreeRects.push_back(rect);
+
+    if (m_FreeRects.size() > m_CleanFreeRectCount * 2 + REBUILD_SLACK) {
+        Rebuild();
+    }
+}
+
+void AtlasPacker::Rebuild() {
+    // Placing in reading order keeps the free list short along the way
+    std::sort(m_UsedRects.begin(), m_UsedRects.end(), [](const AtlasRect& a, const AtlasRect& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+
+    m_FreeRects.clear();
+    m_FreeRects.push_back({ 0, 0, m_Width, m_Height });
+    m_UsedArea = 0;
+    for (const AtlasRect& used : m_UsedRects) {
+        Place(used);
+    }
+    m_FreedCount = 0;
+    m_FreedArea = 0;
+}
+
+void AtlasPacker::Place(const AtlasRect& rect) {
+    m_NewFreeRects.clear();
+
+    for (size_t i = 0; i < m_FreeRects.size();) {
+        if (SplitFreeRect(m_FreeRects[i], rect)) {
+            m_FreeRects[i] = m_FreeRects.back();
+            m_FreeRects.pop_back();
+        } else {
+            i++;
+        }
+    }
+
+    PruneFreeRects();
+    m_FreeRects.insert(m_FreeRects.end(), m_NewFreeRects.begin(), m_NewFreeRects.end());
+
+    m_UsedArea += (uint64_t)rect.width * rect.height;
+}
+
+bool AtlasPacker::SplitFreeRect(const AtlasRect& freeRect, const AtlasRect& usedRect) {
+    if (!Intersects(freeRect, usedRect)) {
+        return false;
+    }
+
+    uint32_t freeRight = freeRect.x + freeRect.width;
+    uint32_t freeBottom = freeRect.y + freeRect.height;
+    uint32_t usedRight = usedRect.x + usedRect.width;
+    uint32_t usedBottom = usedRect.y + usedRect.height;
+
+    // Up to four maximal rectangles around the used one
+    if (usedRect.x > freeRect.x) {
+        m_NewFreeRects.push_back({ freeRect.x, freeRect.y, usedRect.x - freeRect.x, freeRect.height });
+    }
+    if (usedRight < freeRight) {
+        m_NewFreeRects.push_back({ usedRight, freeRect.y, freeRight - usedRight, freeRect.height });
+    }
+    if (usedRect.y > freeRect.y) {
+        m_NewFreeRects.push_back({ freeRect.x, freeRect.y, freeRect.width, usedRect.y - freeRect.y });
+    }
+    if (usedBottom < freeBottom) {
+        m_NewFreeRects.push_back({ freeRect.x, usedBottom, freeRect.width, freeBottom - usedBottom });
+    }
+
+    return true;
+}
+
+void AtlasPacker::PruneFreeRects() {
+    // Surviving free rectangles never contain one another, and a piece split
+    // from one cannot contain another, so only the new pieces are checked.
+    // Of two equal pieces the earlier one is kept.
+    for (size_t i = 0; i < m_NewFreeRects.size();) {
+        const AtlasRect& rect = m_NewFreeRects[i];
+        bool bContained = false;
+        for (size_t j = 0; j < m_NewFreeRects.size() && !bContained; j++) {
+            bContained = j != i && Contains(m_NewFreeRects[j], rect) &&
+                         (j < i || !Contains(rect, m_NewFreeRects[j]));
+        }
+        for (size_t j = 0; j < m_FreeRects.size() && !bContained; j++) {
+            bContained = Contains(m_FreeRects[j], rect);
+        }
+
+        if (bContained) {
+            m_NewFreeRects[i] = m_NewFreeRects.back();
+            m_NewFreeRects.pop_back();
+        } else {
+            i++;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "../include/BlendModes.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BLEND_MODES_SSE2 1
+#endif
+using std::min;
+using std::max;
+
+namespace {
+
+// Each mode as a function of normalised premultiplied source s, destination
+// d and their alphas. The alpha channel goes through the same formula,
+// which for the separable modes works out to sa + da - sa * da.
+inline float BlendChannel(LayerBlendMode mode, float s, float d, float sa, float da) {
+    switch (mode) {
+        case LayerBlendMode::NORMAL:
+            return s + d * (1.0f - sa);
+        case LayerBlendMode::MULTIPLY:
+            return s * d + s * (1.0f - da) + d * (1.0f - sa);
+        case LayerBlendMode::SCREEN:
+            return s + d - s * d;
+        case LayerBlendMode::OVERLAY:
+            if (2.0f * d <= da) {
+                return 2.0f * s * d + s * (1.0f - da) + d * (1.0f - sa);
+            }
+            return sa * da - 2.0f * (da - d) * (sa - s) + s * (1.0f - da) + d * (1.0f - sa);
+        case LayerBlendMode::ADD:
+            return s + d;
+        case LayerBlendMode::ERASE:
+            return d * (1.0f - sa);
+    }
+    return d;
+}
+
+void BlendPixelsScalar(LayerBlendMode mode, float opacity, const uint8_t* pSrc, uint8_t* pDst, size_t count) {
+    const float scale = opacity / 255.0f;
+    for (size_t i = 0; i < count; i++, pSrc += 4, pDst += 4) {
+        if ((pSrc[0] | pSrc[1] | pSrc[2] | pSrc[3]) == 0) continue;
+
+        float sa = (float)pSrc[3] * scale;
+        float da = (float)pDst[3] * (1.0f / 255.0f);
+        for (int c = 0; c < 4; c++) {
+            float value = BlendChannel(mode, (float)pSrc[c] * scale, (float)pDst[c] * (1.0f / 255.0f), sa, da);
+            pDst[c] = (uint8_t)(int)std::lrint(max(0.0f, min(1.0f, value)) * 255.0f);
+        }
+    }
+}
+
+#ifdef BLEND_MODES_SSE2
+// One pixel per register, RGBA in the lanes, with the alphas broadcast
+template <LayerBlendMode Mode>
+inline __m128 BlendPixelSSE2(__m128 s, __m128 d, __m128 sa, __m128 da) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    switch (Mode) {
+        case LayerBlendMode::NORMAL:
+            return _mm_add_ps(s, _mm_mul_ps(d, _mm_sub_ps(one, sa)));
+        case LayerBlendMode::MULTIPLY:
+            return _mm_add_ps(_mm_mul_ps(s, d),
+                   _mm_add_ps(_mm_mul_ps(s, _mm_sub_ps(one, da)), _mm_mul_ps(d, _mm_sub_ps(one, sa))));
+        case LayerBlendMode::SCREEN:
+            return _mm_sub_ps(_mm_add_ps(s, d), _mm_mul_ps(s, d));
+        case LayerBlendMode::OVERLAY: {
+            const __m128 two = _mm_set1_ps(2.0f);
+            __m128 rest = _mm_add_ps(_mm_mul_ps(s, _mm_sub_ps(one, da)), _mm_mul_ps(d, _mm_sub_ps(one, sa)));
+            __m128 dark = _mm_mul_ps(two, _mm_mul_ps(s, d));
+            __m128 light = _mm_sub_ps(_mm_mul_ps(sa, da), _mm_mul_ps(two, _mm_mul_ps(_mm_sub_ps(da, d), _mm_sub_ps(sa, s))));
+            __m128 bDark = _mm_cmple_ps(_mm_mul_ps(two, d), da);
+            return _mm_add_ps(_mm_or_ps(_mm_and_ps(bDark, dark), _mm_andnot_ps(bDark, light)), rest);
+        }
+        case LayerBlendMode::ADD:
+            return _mm_add_ps(s, d);
+        case LayerBlendMode::ERASE:
+            return _mm_mul_ps(d, _mm_sub_ps(one, sa));
+    }
+    return d;
+}
+
+template <LayerBlendMode Mode>
+void BlendPixelsSSE2(float opacity, const uint8_t* pSrc, uint8_t* pDst, size_t count) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 srcScale = _mm_set1_ps(opacity / 255.0f);
+    const __m128 dstScale = _mm_set1_ps(1.0f / 255.0f);
+    const __m128 maxByte = _mm_set1_ps(255.0f);
+    const __m128i zeroi = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i srcPacked = _mm_loadu_si128((const __m128i*)(pSrc + i * 4));
+
+        // Transparent source leaves the destination alone in every mode
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(srcPacked, zeroi)) == 0xFFFF) {
+            continue;
+        }
+
+        __m128i dstPacked = _mm_loadu_si128((const __m128i*)(pDst + i * 4));
+        __m128i srcLo = _mm_unpacklo_epi8(srcPacked, zeroi);
+        __m128i srcHi = _mm_unpackhi_epi8(srcPacked, zeroi);
+        __m128i dstLo = _mm_unpacklo_epi8(dstPacked, zeroi);
+        __m128i dstHi = _mm_unpackhi_epi8(dstPacked, zeroi);
+        __m128i srcWide[4] = {
+            _mm_unpacklo_epi16(srcLo, zeroi), _mm_unpackhi_epi16(srcLo, zeroi),
+            _mm_unpacklo_epi16(srcHi, zeroi), _mm_unpackhi_epi16(srcHi, zeroi)
+        };
+        __m128i dstWide[4] = {
+            _mm_unpacklo_epi16(dstLo, zeroi), _mm_unpackhi_epi16(dstLo, zeroi),
+            _mm_unpacklo_epi16(dstHi, zeroi), _mm_unpackhi_epi16(dstHi, zeroi)
+        };
+
+        __m128i result[4];
+        for (int p = 0; p < 4; p++) {
+            __m128 s = _mm_mul_ps(_mm_cvtepi32_ps(srcWide[p]), srcScale);
+            __m128 d = _mm_mul_ps(_mm_cvtepi32_ps(dstWide[p]), dstScale);
+            __m128 sa = _mm_shuffle_ps(s, s, _MM_SHUFFLE(3, 3, 3, 3));
+            __m128 da = _mm_shuffle_ps(d, d, _MM_SHUFFLE(3, 3, 3, 3));
+
+            __m128 value = BlendPixelSSE2<Mode>(s, d, sa, da);
+            value = _mm_mul_ps(_mm_min_ps(_mm_max_ps(value, zero), one), maxByte);
+            result[p] = _mm_cvtps_epi32(value);
+        }
+
+        __m128i words = _mm_packs_epi32(result[0], result[1]);
+        __m128i words2 = _mm_packs_epi32(result[2], result[3]);
+        _mm_storeu_si128((__m128i*)(pDst + i * 4), _mm_packus_epi16(words, words2));
+    }
+
+    BlendPixelsScalar(Mode, opacity, pSrc + i * 4, pDst + i * 4, count - i);
+}
+#endif
+
+}
+
+const char* GetBlendModeName(LayerBlendMode mode) {
+    switch (mode) {
+        case LayerBlendMode::NORMAL: return "normal";
+        case LayerBlendMode::MULTIPLY: return "multiply";
+        case LayerBlendMode::SCREEN: return "screen";
+        case LayerBlendMode::OVERLAY: return "overlay";
+        case LayerBlendMode::ADD: return "add";
+        case LayerBlendMode::ERASE: return "erase";
+    }
+    return "unknown";
+}
+
+void BlendPixels(LayerBlendMode mode, float opacity, const uint8_t* pSrc, uint8_t* pDst, size_t count) {
+    opacity = max(0.0f, min(1.0f, opacity));
+    if (opacity <= 0.0f) return;
+
+#ifdef BLEND_MODES_SSE2
+    // Modes are template arguments so each loop compiles without a switch
+    switch (mode) {
+        case LayerBlendMode::NORMAL: BlendPixelsSSE2<LayerBlendMode::NORMAL>(opacity, pSrc, pDst, count); return;
+        case LayerBlendMode::MULTIPLY: BlendPixelsSSE2<LayerBlendMode::MULTIPLY>(opacity, pSrc, pDst, count); return;
+        case LayerBlendMode::SCREEN: BlendPixelsSSE2<LayerBlendMode::SCREEN>(opacity, pSrc, pDst, count); return;
+        case LayerBlendMode::OVERLAY: BlendPixelsSSE2<LayerBlendMode::OVERLAY>(opacity, pSrc, pDst, count); return;
+        case LayerBlendMode::ADD: BlendPixelsSSE2<LayerBlendMode::ADD>(opacity, pSrc, pDst, count); return;
+        case LayerBlendMode::ERASE: BlendPixelsSSE2<LayerBlendMode::ERASE>(opacity, pSrc, pDst, count); return;
+    }
+#endif
+    BlendPixelsScalar(mode, opacity, pSrc, pDst, count);
+}
\ No newline at end of file
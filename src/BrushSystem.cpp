@@ -1,13 +1,24 @@
 #include "../include/BrushSystem.h"
+#include "../include/Profiler.h"
 #include <algorithm>
+#include <chrono>
+#include <thread>
 using std::min;
 using std::max;
 
+// Spacing of predicted points along the tail
+static const double PREDICTION_STEP_MS = 4.0;
+
 BrushSystem::BrushSystem() :
     m_pCurrentBrush(nullptr),
+    m_pCanvas(nullptr),
     m_LastX(-1),
     m_LastY(-1),
     m_bDrawing(false),
+    m_DabCount(0),
+    m_pPreviewCanvas(nullptr),
+    m_PredictionMs(0.0),
+    m_bPreviewDrawn(false),
     m_ColorR(0.0f),
     m_ColorG(0.0f),
     m_ColorB(0.0f),
@@ -20,14 +31,26 @@ BrushSystem::~BrushSystem() {
 }
 
 bool BrushSystem::Initialize() {
+    SetDabThreads(0);
+
     // Create default brushes
     PressureBrush* defaultBrush = CreateBrush("Default", 2.0f, 20.0f);
     if (!defaultBrush) return false;
     
     defaultBrush->SetHardness(0.8f);
-    defaultBrush->SetSpacing(2.0f);
+    defaultBrush->SetSpacing(0.1f);
     defaultBrush->SetFlow(1.0f);
     
+    PressureBrush* eraser = CreateBrush("Eraser", 4.0f, 40.0f);
+    eraser->SetType(BrushType::ERASER);
+    eraser->SetHardness(0.6f);
+
+    PressureBrush* smudge = CreateBrush("Smudge", 8.0f, 48.0f);
+    smudge->SetType(BrushType::SMUDGE);
+    smudge->SetHardness(0.3f);
+    smudge->SetSpacing(0.05f);
+    smudge->SetFlow(0.6f);
+
     m_pCurrentBrush = defaultBrush;
     
     return true;
@@ -37,10 +60,12 @@ void BrushSystem::Cleanup() {
     m_Brushes.clear();
     m_BrushMap.clear();
     m_pCurrentBrush = nullptr;
+    m_pDabRenderer.reset();
 }
 
 PressureBrush* BrushSystem::CreateBrush(const std::string& name, float minSize, float maxSize) {
     auto brush = std::make_unique<PressureBrush>(name, minSize, maxSize);
+    brush->SetRenderer(m_pDabRenderer.get());
     PressureBrush* rawPtr = brush.get();
     
     m_Brushes.push_back(std::move(brush));
@@ -64,35 +89,203 @@ void BrushSystem::SetCurrentBrush(const std::string& name) {
     }
 }
 
+void BrushSystem::SetDabThreads(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = max(1u, std::thread::hardware_concurrency());
+    }
+    if (threadCount == GetDabThreads()) return;
+
+    SetDabRenderer(threadCount > 1 ? new ParallelDabRenderer(threadCount) : nullptr);
+}
+
+void BrushSystem::SetJobSystem(JobSystem* pJobSystem) {
+    if (!pJobSystem) {
+        SetDabRenderer(nullptr);
+        SetDabThreads(0);
+        return;
+    }
+    SetDabRenderer(pJobSystem->GetThreadCount() > 1 ? new ParallelDabRenderer(pJobSystem) : nullptr);
+}
+
+void BrushSystem::SetDabRenderer(ParallelDabRenderer* pRenderer) {
+    m_pDabRenderer.reset(pRenderer);
+    for (auto& brush : m_Brushes) {
+        brush->SetRenderer(pRenderer);
+    }
+}
+
+void BrushSystem::SetCanvas(Canvas* pCanvas) {
+    if (pCanvas == m_pCanvas) return;
+
+    EndStroke();
+    m_History.Clear();
+    m_pCanvas = pCanvas;
+}
+
 void BrushSystem::StartStroke(float x, float y, float pressure) {
+    StartStroke(x, y, pressure, GetTimeMs());
+}
+
+void BrushSystem::StartStroke(float x, float y, float pressure, double timeMs) {
+    PROFILE_ZONE("BrushSystem::StartStroke");
     if (!m_pCurrentBrush) return;
+    if (m_bDrawing) {
+        EndStroke();
+    }
     
     m_LastX = x;
     m_LastY = y;
     m_bDrawing = true;
     
+    // Everything the stroke paints becomes one undo state
+    if (m_pCanvas) {
+        m_pCanvas->BeginChange();
+    }
+    
     // Apply initial brush stroke
-    m_pCurrentBrush->ApplyStroke(x, y, pressure, nullptr);
+    m_pCurrentBrush->ResetStroke();
+    StrokeSample sample = { x, y, pressure, timeMs };
+    m_Smoother.Begin();
+    m_Smoother.AddSample(sample, m_Curve);
+    m_Predictor.Reset();
+    m_Predictor.AddSample(sample);
+    PaintCurve();
 }
 
 void BrushSystem::ContinueStroke(float x, float y, float pressure) {
+    ContinueStroke(x, y, pressure, GetTimeMs());
+}
+
+void BrushSystem::ContinueStroke(float x, float y, float pressure, double timeMs) {
+    PROFILE_ZONE("BrushSystem::ContinueStroke");
     if (!m_pCurrentBrush || !m_bDrawing) return;
     
-    // Draw a line from the last point to the current point
-    // In a real implementation, we would render this line segment with pressure-sensitive properties
-    // For now, just apply the stroke at the current position
-    m_pCurrentBrush->ApplyStroke(x, y, pressure, nullptr);
+    // The brush fills the segment from its previous point with evenly spaced dabs
+    StrokeSample sample = { x, y, pressure, timeMs };
+    m_Smoother.AddSample(sample, m_Curve);
+    m_Predictor.AddSample(sample);
+    PaintCurve();
     
     m_LastX = x;
     m_LastY = y;
 }
 
 void BrushSystem::EndStroke() {
+    PROFILE_ZONE("BrushSystem::EndStroke");
+    if (m_pCurrentBrush && m_bDrawing) {
+        // Draw the part of the curve still held back for lookahead
+        m_Smoother.End(m_Curve);
+        PaintCurve();
+        m_pCurrentBrush->ResetStroke();
+    }
+    if (m_pCanvas && m_pCanvas->IsChanging()) {
+        m_pCanvas->EndChange(m_TileChanges);
+        m_History.Push(m_TileChanges);
+    }
     m_bDrawing = false;
+    m_Predictor.Reset();
     m_LastX = -1;
     m_LastY = -1;
 }
 
+bool BrushSystem::Undo() {
+    PROFILE_ZONE("BrushSystem::Undo");
+    EndStroke();
+    return m_pCanvas && m_History.Undo(*m_pCanvas);
+}
+
+bool BrushSystem::Redo() {
+    PROFILE_ZONE("BrushSystem::Redo");
+    EndStroke();
+    return m_pCanvas && m_History.Redo(*m_pCanvas);
+}
+
+void BrushSystem::ProcessInput(const InputEvent& event) {
+    if (event.type != InputEventType::PEN_DOWN &&
+        event.type != InputEventType::PEN_MOVE &&
+        event.type != InputEventType::PEN_UP) {
+        return;
+    }
+
+    SetTilt(event.tiltX, event.tiltY);
+    if (event.buttons & InputEvent::PEN_CONTACT) {
+        float pressure = event.pressure > 0 ? event.pressure : 0.5f;
+        if (m_bDrawing) {
+            ContinueStroke(event.x, event.y, pressure, event.timeMs);
+        } else {
+            StartStroke(event.x, event.y, pressure, event.timeMs);
+        }
+    } else if (m_bDrawing) {
+        EndStroke();
+    }
+}
+
+void BrushSystem::PaintCurve() {
+    PROFILE_ZONE("BrushSystem::PaintCurve");
+    m_Dabs.clear();
+    for (const StrokeSample& point : m_Curve) {
+        m_pCurrentBrush->EmitDabs(point.x, point.y, point.pressure,
+                                  m_ColorR, m_ColorG, m_ColorB, m_ColorA * m_Opacity, m_Dabs);
+    }
+    m_Curve.clear();
+
+    if (m_pCanvas && !m_Dabs.empty()) {
+        m_pCurrentBrush->StampDabs(*m_pCanvas, m_Dabs.data(), m_Dabs.size());
+        m_DabCount += m_Dabs.size();
+    }
+}
+
+void BrushSystem::UpdatePreview() {
+    PROFILE_ZONE("BrushSystem::UpdatePreview");
+    if (!m_pPreviewCanvas) return;
+
+    // Last frame's tail is stale whether or not a new one is drawn
+    if (m_bPreviewDrawn) {
+        m_pPreviewCanvas->Clear();
+        m_bPreviewDrawn = false;
+    }
+    if (!m_pCurrentBrush || !m_bDrawing) return;
+
+    // A smudge tail would need the colour under the committed stroke, and an
+    // eraser tail cannot be shown by painting over the layer
+    BrushType type = m_pCurrentBrush->GetType();
+    if (type == BrushType::SMUDGE || type == BrushType::ERASER) return;
+
+    m_Curve.clear();
+    m_Smoother.GetPending(m_Curve);
+    if (m_PredictionMs > 0.0) {
+        m_Predictor.PredictPath(m_PredictionMs, PREDICTION_STEP_MS, m_Curve);
+    }
+    if (m_Curve.empty()) return;
+
+    // Continue from where the committed stroke ends, then roll the brush
+    // back so the real samples pick up from the same point
+    BrushStrokeState state = m_pCurrentBrush->GetStrokeState();
+    m_Dabs.clear();
+    for (const StrokeSample& point : m_Curve) {
+        m_pCurrentBrush->EmitDabs(point.x, point.y, point.pressure,
+                                  m_ColorR, m_ColorG, m_ColorB, m_ColorA * m_Opacity, m_Dabs);
+    }
+    m_pCurrentBrush->SetStrokeState(state);
+    m_Curve.clear();
+
+    if (!m_Dabs.empty()) {
+        m_pCurrentBrush->StampDabs(*m_pPreviewCanvas, m_Dabs.data(), m_Dabs.size());
+        m_bPreviewDrawn = true;
+    }
+}
+
+double BrushSystem::GetTimeMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void BrushSystem::SetTilt(float tiltX, float tiltY) {
+    if (m_pCurrentBrush) {
+        m_pCurrentBrush->SetTilt(tiltX, tiltY);
+    }
+}
+
 void BrushSystem::SetColor(float r, float g, float b, float a) {
     m_ColorR = max(0.0f, min(1.0f, r));
     m_ColorG = max(0.0f, min(1.0f, g));
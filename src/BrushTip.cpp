@@ -0,0 +1,267 @@
+#include "../include/BrushTip.h"
+#include "../include/ImageDecoder.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define BRUSH_TIP_SSE2 1
+#endif
+using std::min;
+using std::max;
+
+static const float TWO_PI = 6.28318530718f;
+
+BrushTip::BrushTip() :
+    m_CacheBudget(DEFAULT_CACHE_BUDGET),
+    m_CacheBytes(0),
+    m_Hits(0),
+    m_Misses(0),
+    m_bHold(false) {
+}
+
+BrushTip::~BrushTip() {
+}
+
+bool BrushTip::SetTexture(const Image& image) {
+    return SetTexture(image.pixels.data(), image.width, image.height);
+}
+
+bool BrushTip::SetTexture(const uint8_t* pPixels, uint32_t width, uint32_t height) {
+    Clear();
+    if (!pPixels || width == 0 || height == 0) {
+        return false;
+    }
+
+    size_t count = (size_t)width * height;
+    bool hasAlpha = false;
+    for (size_t i = 0; i < count && !hasAlpha; i++) {
+        hasAlpha = pPixels[i * 4 + 3] != 255;
+    }
+
+    Level base;
+    base.width = width;
+    base.height = height;
+    base.pixels.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t* pPixel = pPixels + i * 4;
+        if (hasAlpha) {
+            base.pixels[i] = pPixel[3];
+        } else {
+            uint32_t luminance = (77u * pPixel[0] + 150u * pPixel[1] + 29u * pPixel[2]) >> 8;
+            base.pixels[i] = (uint8_t)(255u - luminance);
+        }
+    }
+    m_Levels.push_back(std::move(base));
+
+    // Box-filtered levels down to 1x1; odd edges repeat their last texel
+    while (m_Levels.back().width > 1 || m_Levels.back().height > 1) {
+        const Level& src = m_Levels.back();
+        Level next;
+        next.width = max(1u, src.width / 2);
+        next.height = max(1u, src.height / 2);
+        next.pixels.resize((size_t)next.width * next.height);
+        for (uint32_t y = 0; y < next.height; y++) {
+            const uint8_t* pRow0 = src.pixels.data() + (size_t)min(y * 2, src.height - 1) * src.width;
+            const uint8_t* pRow1 = src.pixels.data() + (size_t)min(y * 2 + 1, src.height - 1) * src.width;
+            for (uint32_t x = 0; x < next.width; x++) {
+                uint32_t x0 = min(x * 2, src.width - 1);
+                uint32_t x1 = min(x * 2 + 1, src.width - 1);
+                next.pixels[(size_t)y * next.width + x] =
+                    (uint8_t)((pRow0[x0] + pRow0[x1] + pRow1[x0] + pRow1[x1] + 2) >> 2);
+            }
+        }
+        m_Levels.push_back(std::move(next));
+    }
+    return true;
+}
+
+void BrushTip::Clear() {
+    m_Levels.clear();
+    m_Cache.clear();
+    m_CacheIndex.clear();
+    m_CacheBytes = 0;
+}
+
+const TipMask* BrushTip::GetMask(float diameter, float angle) {
+    if (m_Levels.empty()) {
+        return nullptr;
+    }
+
+    uint32_t size = (uint32_t)max(1L, min((long)MAX_SIZE, std::lrint(diameter)));
+    long step = std::lrint(angle * ((float)ANGLE_STEPS / TWO_PI)) % (long)ANGLE_STEPS;
+    uint32_t angleStep = (uint32_t)(step < 0 ? step + ANGLE_STEPS : step);
+    uint32_t key = size << 8 | angleStep;
+
+    auto found = m_CacheIndex.find(key);
+    if (found != m_CacheIndex.end()) {
+        m_Hits++;
+        m_Cache.splice(m_Cache.begin(), m_Cache, found->second);
+        return &m_Cache.front();
+    }
+
+    m_Misses++;
+    m_Cache.emplace_front();
+    TipMask& mask = m_Cache.front();
+    mask.size = size;
+    mask.angleStep = angleStep;
+    BuildMask(mask);
+    m_CacheIndex[key] = m_Cache.begin();
+    m_CacheBytes += mask.pixels.size();
+
+    Evict();
+    return &mask;
+}
+
+void BrushTip::MakeStamp(const Dab& dab, DabStamp& stamp) {
+    stamp = DabStamp();
+    stamp.dab = dab;
+    const TipMask* pMask = GetMask(dab.radius * 2.0f, dab.angle);
+    if (pMask) {
+        stamp.pMask = pMask->pixels.data();
+        stamp.maskSize = pMask->size;
+        stamp.originX = (int)std::lrint(dab.x - (float)pMask->size * 0.5f);
+        stamp.originY = (int)std::lrint(dab.y - (float)pMask->size * 0.5f);
+    }
+}
+
+void BrushTip::EndBatch() {
+    m_bHold = false;
+    Evict();
+}
+
+void BrushTip::SetCacheBudget(size_t bytes) {
+    m_CacheBudget = bytes;
+    Evict();
+}
+
+void BrushTip::Evict() {
+    // The front mask was just handed out, so it always stays
+    if (m_bHold) return;
+    while (m_CacheBytes > m_CacheBudget && m_Cache.size() > 1) {
+        const TipMask& oldest = m_Cache.back();
+        m_CacheBytes -= oldest.pixels.size();
+        m_CacheIndex.erase(oldest.size << 8 | oldest.angleStep);
+        m_Cache.pop_back();
+    }
+}
+
+namespace {
+
+inline float SampleBilinear(const uint8_t* pPixels, uint32_t width, uint32_t height, float tx, float ty) {
+    tx = max(0.0f, min((float)(width - 1), tx));
+    ty = max(0.0f, min((float)(height - 1), ty));
+    uint32_t x0 = (uint32_t)tx;
+    uint32_t y0 = (uint32_t)ty;
+    uint32_t x1 = min(x0 + 1, width - 1);
+    uint32_t y1 = min(y0 + 1, height - 1);
+    float fx = tx - (float)x0;
+    float fy = ty - (float)y0;
+
+    const uint8_t* pRow0 = pPixels + (size_t)y0 * width;
+    const uint8_t* pRow1 = pPixels + (size_t)y1 * width;
+    float top = (float)pRow0[x0] + ((float)pRow0[x1] - (float)pRow0[x0]) * fx;
+    float bottom = (float)pRow1[x0] + ((float)pRow1[x1] - (float)pRow1[x0]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+}
+
+void BrushTip::BuildMask(TipMask& mask) const {
+    uint32_t size = mask.size;
+    mask.pixels.assign((size_t)size * size, 0);
+
+    // Smallest level that still has a texel per mask pixel
+    size_t levelIndex = 0;
+    while (levelIndex + 1 < m_Levels.size() &&
+           max(m_Levels[levelIndex + 1].width, m_Levels[levelIndex + 1].height) >= size) {
+        levelIndex++;
+    }
+    const Level& level = m_Levels[levelIndex];
+    const float width = (float)level.width;
+    const float height = (float)level.height;
+
+    // Mask pixels map back into the texture by the inverse rotation; along
+    // a row the texel coordinates advance by a constant step
+    float angle = (float)mask.angleStep * (TWO_PI / (float)ANGLE_STEPS);
+    float cosAngle = std::cos(angle);
+    float sinAngle = std::sin(angle);
+    float scaleX = width / (float)size;
+    float scaleY = height / (float)size;
+    float stepX = cosAngle * scaleX;
+    float stepY = -sinAngle * scaleY;
+    float half = (float)size * 0.5f;
+
+    for (uint32_t y = 0; y < size; y++) {
+        float oy = (float)y + 0.5f - half;
+        float ox = 0.5f - half;
+        float rowX = (ox * cosAngle + oy * sinAngle) * scaleX + width * 0.5f - 0.5f;
+        float rowY = (oy * cosAngle - ox * sinAngle) * scaleY + height * 0.5f - 0.5f;
+        uint8_t* pOut = mask.pixels.data() + (size_t)y * size;
+
+        uint32_t x = 0;
+#ifdef BRUSH_TIP_SSE2
+        // Coordinates, bounds and weights four pixels at a time; the texel
+        // fetches themselves are scalar since SSE2 has no gather
+        const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 minCoord = _mm_set1_ps(-0.5f);
+        const __m128 maxX = _mm_set1_ps(width - 0.5f);
+        const __m128 maxY = _mm_set1_ps(height - 0.5f);
+        const __m128 clampX = _mm_set1_ps(width - 1.0f);
+        const __m128 clampY = _mm_set1_ps(height - 1.0f);
+        for (; x + 4 <= size; x += 4) {
+            __m128 index = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+            __m128 tx = _mm_add_ps(_mm_set1_ps(rowX), _mm_mul_ps(index, _mm_set1_ps(stepX)));
+            __m128 ty = _mm_add_ps(_mm_set1_ps(rowY), _mm_mul_ps(index, _mm_set1_ps(stepY)));
+            __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(tx, minCoord), _mm_cmplt_ps(tx, maxX)),
+                                       _mm_and_ps(_mm_cmpge_ps(ty, minCoord), _mm_cmplt_ps(ty, maxY)));
+            if (_mm_movemask_ps(inside) == 0) continue;
+
+            tx = _mm_min_ps(_mm_max_ps(tx, zero), clampX);
+            ty = _mm_min_ps(_mm_max_ps(ty, zero), clampY);
+            __m128i ix = _mm_cvttps_epi32(tx);
+            __m128i iy = _mm_cvttps_epi32(ty);
+            __m128 fx = _mm_sub_ps(tx, _mm_cvtepi32_ps(ix));
+            __m128 fy = _mm_sub_ps(ty, _mm_cvtepi32_ps(iy));
+
+            alignas(16) int32_t xs[4];
+            alignas(16) int32_t ys[4];
+            _mm_store_si128((__m128i*)xs, ix);
+            _mm_store_si128((__m128i*)ys, iy);
+            alignas(16) float corners[4][4];
+            for (int lane = 0; lane < 4; lane++) {
+                uint32_t x0 = (uint32_t)xs[lane];
+                uint32_t y0 = (uint32_t)ys[lane];
+                uint32_t x1 = min(x0 + 1, level.width - 1);
+                uint32_t y1 = min(y0 + 1, level.height - 1);
+                const uint8_t* pRow0 = level.pixels.data() + (size_t)y0 * level.width;
+                const uint8_t* pRow1 = level.pixels.data() + (size_t)y1 * level.width;
+                corners[0][lane] = (float)pRow0[x0];
+                corners[1][lane] = (float)pRow0[x1];
+                corners[2][lane] = (float)pRow1[x0];
+                corners[3][lane] = (float)pRow1[x1];
+            }
+
+            __m128 a = _mm_load_ps(corners[0]);
+            __m128 b = _mm_load_ps(corners[1]);
+            __m128 c = _mm_load_ps(corners[2]);
+            __m128 d = _mm_load_ps(corners[3]);
+            __m128 top = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), fx));
+            __m128 bottom = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(d, c), fx));
+            __m128 value = _mm_and_ps(_mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), fy)), inside);
+
+            __m128i words = _mm_packs_epi32(_mm_cvtps_epi32(value), _mm_setzero_si128());
+            int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+            memcpy(pOut + x, &bytes, 4);
+        }
+#endif
+        for (; x < size; x++) {
+            float tx = rowX + (float)x * stepX;
+            float ty = rowY + (float)x * stepY;
+            if (tx < -0.5f || tx >= width - 0.5f || ty < -0.5f || ty >= height - 0.5f) continue;
+            float value = SampleBilinear(level.pixels.data(), level.width, level.height, tx, ty);
+            pOut[x] = (uint8_t)(int)std::lrint(value);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+#include "../include/Canvas.h"
+#include <algorithm>
+#include <cstring>
+using std::min;
+using std::max;
+
+Canvas::Canvas(uint32_t width, uint32_t height) :
+    m_Width(width),
+    m_Height(height),
+    m_TilesX((width + TILE_SIZE - 1) / TILE_SIZE),
+    m_TilesY((height + TILE_SIZE - 1) / TILE_SIZE),
+    m_AllocatedTiles(0),
+    m_bChanging(false),
+    m_bDirty(false),
+    m_DirtyX0(0), m_DirtyY0(0), m_DirtyX1(0), m_DirtyY1(0) {
+    m_Tiles.resize((size_t)m_TilesX * m_TilesY);
+}
+
+Canvas::~Canvas() {
+}
+
+const uint8_t* Canvas::GetTile(uint32_t tileX, uint32_t tileY) const {
+    if (tileX >= m_TilesX || tileY >= m_TilesY) return nullptr;
+    return m_Tiles[(size_t)tileY * m_TilesX + tileX].get();
+}
+
+uint8_t* Canvas::GetTile(uint32_t tileX, uint32_t tileY) {
+    if (tileX >= m_TilesX || tileY >= m_TilesY) return nullptr;
+    return GetWritableTile((size_t)tileY * m_TilesX + tileX, false);
+}
+
+uint8_t* Canvas::GetOrCreateTile(uint32_t tileX, uint32_t tileY) {
+    if (tileX >= m_TilesX || tileY >= m_TilesY) return nullptr;
+    return GetWritableTile((size_t)tileY * m_TilesX + tileX, true);
+}
+
+uint8_t* Canvas::GetWritableTile(size_t index, bool bCreate) {
+    TilePtr& tile = m_Tiles[index];
+    if (!tile && !bCreate) return nullptr;
+
+    if (m_bChanging) {
+        SaveTile(index);
+    }
+
+    if (!tile) {
+        tile.reset(new uint8_t[TILE_BYTES]());
+        m_AllocatedTiles++;
+    } else if (tile.use_count() > 1) {
+        TilePtr copy(new uint8_t[TILE_BYTES]);
+        memcpy(copy.get(), tile.get(), TILE_BYTES);
+        tile = copy;
+    }
+    return tile.get();
+}
+
+void Canvas::SaveTile(size_t index) {
+    if (m_TileSaved[index]) return;
+    m_TileSaved[index] = 1;
+    m_Changes.push_back({ (uint32_t)index, m_Tiles[index] });
+}
+
+void Canvas::BeginChange() {
+    if (m_TileSaved.size() != m_Tiles.size()) {
+        m_TileSaved.assign(m_Tiles.size(), 0);
+    }
+    for (const TileChange& change : m_Changes) {
+        m_TileSaved[change.index] = 0;
+    }
+    m_Changes.clear();
+    m_bChanging = true;
+}
+
+void Canvas::EndChange(std::vector<TileChange>& changes) {
+    for (const TileChange& change : m_Changes) {
+        m_TileSaved[change.index] = 0;
+    }
+    changes.swap(m_Changes);
+    m_Changes.clear();
+    m_bChanging = false;
+}
+
+void Canvas::SwapTiles(std::vector<TileChange>& changes) {
+    for (TileChange& change : changes) {
+        TilePtr& tile = m_Tiles[change.index];
+        if (tile && !change.tile) m_AllocatedTiles--;
+        if (!tile && change.tile) m_AllocatedTiles++;
+        tile.swap(change.tile);
+
+        uint32_t tileX = change.index % m_TilesX;
+        uint32_t tileY = change.index / m_TilesX;
+        MarkDirty((int)(tileX * TILE_SIZE), (int)(tileY * TILE_SIZE),
+                  (int)((tileX + 1) * TILE_SIZE), (int)((tileY + 1) * TILE_SIZE));
+    }
+}
+
+void Canvas::Clear() {
+    // Only the tiles that held paint change, which keeps clearing a
+    // mostly empty overlay cheap to re-upload
+    for (uint32_t tileY = 0; tileY < m_TilesY; tileY++) {
+        for (uint32_t tileX = 0; tileX < m_TilesX; tileX++) {
+            size_t index = (size_t)tileY * m_TilesX + tileX;
+            TilePtr& tile = m_Tiles[index];
+            if (tile) {
+                if (m_bChanging) {
+                    SaveTile(index);
+                }
+                tile.reset();
+                MarkDirty((int)(tileX * TILE_SIZE), (int)(tileY * TILE_SIZE),
+                          (int)((tileX + 1) * TILE_SIZE), (int)((tileY + 1) * TILE_SIZE));
+            }
+        }
+    }
+    m_AllocatedTiles = 0;
+}
+
+void Canvas::ReadPixels(uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t* pDst, uint32_t rowPitch) const {
+    uint32_t x1 = min(x + width, m_Width);
+    uint32_t y1 = min(y + height, m_Height);
+
+    for (uint32_t row = y; row < y1; row++) {
+        uint8_t* pOut = pDst + (size_t)(row - y) * rowPitch;
+        uint32_t tileY = row / TILE_SIZE;
+        uint32_t tileRow = row % TILE_SIZE;
+
+        // Copy one tile-wide span at a time
+        for (uint32_t column = x; column < x1;) {
+            uint32_t tileX = column / TILE_SIZE;
+            uint32_t tileColumn = column % TILE_SIZE;
+            uint32_t span = min(TILE_SIZE - tileColumn, x1 - column);
+
+            const uint8_t* pTile = GetTile(tileX, tileY);
+            if (pTile) {
+                memcpy(pOut, pTile + (tileRow * TILE_SIZE + tileColumn) * 4, span * 4);
+            } else {
+                memset(pOut, 0, span * 4);
+            }
+
+            pOut += span * 4;
+            column += span;
+        }
+    }
+}
+
+void Canvas::MarkDirty(int x0, int y0, int x1, int y1) {
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, (int)m_Width);
+    y1 = min(y1, (int)m_Height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    if (!m_bDirty) {
+        m_DirtyX0 = x0;
+        m_DirtyY0 = y0;
+        m_DirtyX1 = x1;
+        m_DirtyY1 = y1;
+        m_bDirty = true;
+    } else {
+        m_DirtyX0 = min(m_DirtyX0, x0);
+        m_DirtyY0 = min(m_DirtyY0, y0);
+        m_DirtyX1 = max(m_DirtyX1, x1);
+        m_DirtyY1 = max(m_DirtyY1, y1);
+    }
+}
+
+bool Canvas::GetDirtyRect(uint32_t& x, uint32_t& y, uint32_t& width, uint32_t& height) const {
+    if (!m_bDirty) return false;
+
+    x = (uint32_t)m_DirtyX0;
+    y = (uint32_t)m_DirtyY0;
+    width = (uint32_t)(m_DirtyX1 - m_DirtyX0);
+    height = (uint32_t)(m_DirtyY1 - m_DirtyY0);
+    return true;
+}
+
+void Canvas::ClearDirty() {
+    m_bDirty = false;
+}
\ No newline at end of file
@@ -0,0 +1,701 @@
+#include "../include/D3D11RenderBackend.h"
+#include <d3dcompiler.h>
+#include <DirectXMath.h>
+#include <cstring>
+#include <algorithm>
+using namespace DirectX;
+using std::min;
+
+// Simple vertex shader
+static const char* g_szVertexShader =
+"cbuffer MatrixBuffer : register(b0) \
+{ \
+    matrix worldViewProjection; \
+}; \
+\
+struct VS_INPUT \
+{ \
+    float3 pos : POSITION; \
+    float2 tex : TEXCOORD0; \
+    float4 col : COLOR0; \
+}; \
+\
+struct PS_INPUT \
+{ \
+    float4 pos : SV_POSITION; \
+    float2 tex : TEXCOORD0; \
+    float4 col : COLOR0; \
+}; \
+\
+PS_INPUT main(VS_INPUT input) \
+{ \
+    PS_INPUT output; \
+    output.pos = mul(worldViewProjection, float4(input.pos, 1.0f)); \
+    output.tex = input.tex; \
+    output.col = input.col; \
+    return output; \
+}";
+
+// Simple pixel shader
+static const char* g_szPixelShader =
+"struct PS_INPUT \
+{ \
+    float4 pos : SV_POSITION; \
+    float2 tex : TEXCOORD0; \
+    float4 col : COLOR0; \
+}; \
+\
+Texture2D tex : register(t0); \
+SamplerState sam : register(s0); \
+\
+float4 main(PS_INPUT input) : SV_TARGET \
+{ \
+    float4 textureColor = tex.Sample(sam, input.tex); \
+    return textureColor * input.col; \
+}";
+
+// Instanced sprite vertex shader: expands one SpriteInstance into a quad.
+// Drawn as a 4-vertex triangle strip; corner k is (k & 1, k >> 1).
+static const char* g_szInstancedVertexShader =
+"cbuffer MatrixBuffer : register(b0) \
+{ \
+    matrix worldViewProjection; \
+}; \
+\
+struct VS_INPUT \
+{ \
+    float2 pos : INSTANCE_POSITION; \
+    float2 size : INSTANCE_SIZE; \
+    float rotation : INSTANCE_ROTATION; \
+    float4 uvRect : INSTANCE_UV; \
+    float4 col : INSTANCE_COLOR; \
+    uint vertexId : SV_VertexID; \
+}; \
+\
+struct PS_INPUT \
+{ \
+    float4 pos : SV_POSITION; \
+    float2 tex : TEXCOORD0; \
+    float4 col : COLOR0; \
+}; \
+\
+PS_INPUT main(VS_INPUT input) \
+{ \
+    PS_INPUT output; \
+    float2 corner = float2(input.vertexId & 1, input.vertexId >> 1); \
+    float2 local = (corner - 0.5f) * input.size; \
+    float s, c; \
+    sincos(input.rotation, s, c); \
+    float2 world = input.pos + float2(local.x * c - local.y * s, local.x * s + local.y * c); \
+    output.pos = mul(worldViewProjection, float4(world, 0.0f, 1.0f)); \
+    output.tex = lerp(input.uvRect.xy, input.uvRect.zw, corner); \
+    output.col = input.col; \
+    return output; \
+}";
+
+// Initial ring capacities; grown from the per-frame high-water mark
+static const uint32_t INITIAL_VERTEX_CAPACITY = 10000;
+static const uint32_t INITIAL_INDEX_CAPACITY = 30000;
+static const uint32_t INITIAL_INSTANCE_CAPACITY = 16384;
+
+D3D11RingBufferStorage::D3D11RingBufferStorage(GraphicsDevice* pGraphicsDevice, UINT bindFlags) :
+    m_pGraphicsDevice(pGraphicsDevice),
+    m_BindFlags(bindFlags) {
+}
+
+bool D3D11RingBufferStorage::Create(size_t sizeInBytes) {
+    D3D11_BUFFER_DESC bd = {};
+    bd.Usage = D3D11_USAGE_DYNAMIC;
+    bd.ByteWidth = (UINT)sizeInBytes;
+    bd.BindFlags = m_BindFlags;
+    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBuffer(&bd, nullptr, m_pBuffer.ReleaseAndGetAddressOf());
+
+    return SUCCEEDED(hr);
+}
+
+void* D3D11RingBufferStorage::Map(bool discard) {
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
+    HRESULT hr = m_pGraphicsDevice->GetDeviceContext()->Map(m_pBuffer.Get(), 0,
+        discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedResource);
+
+    if (FAILED(hr)) {
+        return nullptr;
+    }
+
+    return mappedResource.pData;
+}
+
+void D3D11RingBufferStorage::Unmap() {
+    m_pGraphicsDevice->GetDeviceContext()->Unmap(m_pBuffer.Get(), 0);
+}
+
+D3D11RenderBackend::D3D11RenderBackend(GraphicsDevice* pGraphicsDevice, VertexFormat vertexFormat) :
+    m_pGraphicsDevice(pGraphicsDevice),
+    m_VertexFormat(vertexFormat),
+    m_VertexStorage(pGraphicsDevice, D3D11_BIND_VERTEX_BUFFER),
+    m_IndexStorage(pGraphicsDevice, D3D11_BIND_INDEX_BUFFER),
+    m_VertexRing(&m_VertexStorage, GetVertexStride(vertexFormat), INITIAL_VERTEX_CAPACITY),
+    m_IndexRing(&m_IndexStorage, sizeof(uint16_t), INITIAL_INDEX_CAPACITY),
+    m_Arena(&m_VertexRing),
+    m_InstanceStorage(pGraphicsDevice, D3D11_BIND_VERTEX_BUFFER),
+    m_InstanceRing(&m_InstanceStorage, sizeof(SpriteInstance), INITIAL_INSTANCE_CAPACITY),
+    m_pInstances(nullptr),
+    m_FirstInstance(0),
+    m_InstanceCapacity(0),
+    m_InstanceCount(0),
+    m_bInstancesMapped(false) {
+}
+
+D3D11RenderBackend::~D3D11RenderBackend() {
+    Cleanup();
+}
+
+bool D3D11RenderBackend::Initialize() {
+    if (!CreateShaders()) {
+        return false;
+    }
+
+    if (!CreateInputLayout()) {
+        return false;
+    }
+
+    if (!CreateInstancedShader()) {
+        return false;
+    }
+
+    if (!CreateVertexBuffer()) {
+        return false;
+    }
+
+    if (!CreateIndexBuffer()) {
+        return false;
+    }
+
+    if (!CreateConstantBuffers()) {
+        return false;
+    }
+
+    if (!CreateBlendStates()) {
+        return false;
+    }
+
+    if (!CreateSamplerState()) {
+        return false;
+    }
+
+    // Untextured primitives sample this, so the texture term is always defined
+    const uint8_t white[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+    m_Textures.clear();
+    m_FreeTextures.clear();
+    m_Textures.emplace_back();
+    if (CreateTexture(1, 1, white) != WHITE_TEXTURE || !m_Textures[WHITE_TEXTURE]) {
+        return false;
+    }
+
+    return true;
+}
+
+void D3D11RenderBackend::Cleanup() {
+    m_pVertexShader.Reset();
+    m_pPixelShader.Reset();
+    m_pInputLayout.Reset();
+    m_pInstancedVertexShader.Reset();
+    m_pInstancedInputLayout.Reset();
+    m_VertexStorage.Reset();
+    m_IndexStorage.Reset();
+    m_InstanceStorage.Reset();
+    m_pConstantBuffer.Reset();
+    m_pBlendState.Reset();
+    m_pPremultipliedBlendState.Reset();
+    m_Textures.clear();
+    m_FreeTextures.clear();
+    m_pSamplerState.Reset();
+}
+
+bool D3D11RenderBackend::CreateShaders() {
+    // Compile vertex shader
+    Microsoft::WRL::ComPtr<ID3DBlob> pVSBlob = nullptr;
+    HRESULT hr = D3DCompile(g_szVertexShader, strlen(g_szVertexShader), nullptr, nullptr, nullptr,
+        "main", "vs_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pVSBlob.GetAddressOf(), nullptr);
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    hr = m_pGraphicsDevice->GetDevice()->CreateVertexShader(
+        pVSBlob->GetBufferPointer(),
+        pVSBlob->GetBufferSize(),
+        nullptr,
+        m_pVertexShader.ReleaseAndGetAddressOf()
+    );
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    // Compile pixel shader
+    Microsoft::WRL::ComPtr<ID3DBlob> pPSBlob = nullptr;
+    hr = D3DCompile(g_szPixelShader, strlen(g_szPixelShader), nullptr, nullptr, nullptr,
+        "main", "ps_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pPSBlob.GetAddressOf(), nullptr);
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    hr = m_pGraphicsDevice->GetDevice()->CreatePixelShader(
+        pPSBlob->GetBufferPointer(),
+        pPSBlob->GetBufferSize(),
+        nullptr,
+        m_pPixelShader.ReleaseAndGetAddressOf()
+    );
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool D3D11RenderBackend::CreateInputLayout() {
+    D3D11_INPUT_ELEMENT_DESC standardLayout[] = {
+        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+        {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
+        {"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0}
+    };
+
+    // Same shader inputs; the missing z defaults to 0 and RGBA8 expands to float4
+    D3D11_INPUT_ELEMENT_DESC compactLayout[] = {
+        {"POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
+        {"TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0},
+        {"COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0}
+    };
+
+    D3D11_INPUT_ELEMENT_DESC* layout = m_VertexFormat == VertexFormat::COMPACT ? compactLayout : standardLayout;
+
+    Microsoft::WRL::ComPtr<ID3DBlob> pVSBlob = nullptr;
+    HRESULT hr = D3DCompile(g_szVertexShader, strlen(g_szVertexShader), nullptr, nullptr, nullptr,
+        "main", "vs_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pVSBlob.GetAddressOf(), nullptr);
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    hr = m_pGraphicsDevice->GetDevice()->CreateInputLayout(
+        layout, 3,
+        pVSBlob->GetBufferPointer(),
+        pVSBlob->GetBufferSize(),
+        m_pInputLayout.ReleaseAndGetAddressOf()
+    );
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    return true;
+}
+
+bool D3D11RenderBackend::CreateInstancedShader() {
+    Microsoft::WRL::ComPtr<ID3DBlob> pVSBlob = nullptr;
+    HRESULT hr = D3DCompile(g_szInstancedVertexShader, strlen(g_szInstancedVertexShader), nullptr, nullptr, nullptr,
+        "main", "vs_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pVSBlob.GetAddressOf(), nullptr);
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    hr = m_pGraphicsDevice->GetDevice()->CreateVertexShader(
+        pVSBlob->GetBufferPointer(),
+        pVSBlob->GetBufferSize(),
+        nullptr,
+        m_pInstancedVertexShader.ReleaseAndGetAddressOf()
+    );
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    // Per-instance elements mirror the SpriteInstance layout
+    D3D11_INPUT_ELEMENT_DESC layout[] = {
+        {"INSTANCE_POSITION", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+        {"INSTANCE_SIZE", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 8, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+        {"INSTANCE_ROTATION", 0, DXGI_FORMAT_R32_FLOAT, 0, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+        {"INSTANCE_UV", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 20, D3D11_INPUT_PER_INSTANCE_DATA, 1},
+        {"INSTANCE_COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 28, D3D11_INPUT_PER_INSTANCE_DATA, 1}
+    };
+
+    hr = m_pGraphicsDevice->GetDevice()->CreateInputLayout(
+        layout, 5,
+        pVSBlob->GetBufferPointer(),
+        pVSBlob->GetBufferSize(),
+        m_pInstancedInputLayout.ReleaseAndGetAddressOf()
+    );
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    return m_InstanceRing.Initialize();
+}
+
+bool D3D11RenderBackend::CreateVertexBuffer() {
+    return m_VertexRing.Initialize();
+}
+
+bool D3D11RenderBackend::CreateIndexBuffer() {
+    return m_IndexRing.Initialize();
+}
+
+bool D3D11RenderBackend::CreateConstantBuffers() {
+    D3D11_BUFFER_DESC bd = {};
+    bd.Usage = D3D11_USAGE_DEFAULT;
+    bd.ByteWidth = sizeof(XMMATRIX);
+    bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBuffer(&bd, nullptr, m_pConstantBuffer.ReleaseAndGetAddressOf());
+
+    return SUCCEEDED(hr);
+}
+
+bool D3D11RenderBackend::CreateBlendStates() {
+    D3D11_BLEND_DESC blendDesc = {};
+    blendDesc.AlphaToCoverageEnable = false;
+    blendDesc.RenderTarget[0].BlendEnable = true;
+    blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+    blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+    blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+    blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
+    blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+    blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBlendState(&blendDesc, m_pBlendState.ReleaseAndGetAddressOf());
+
+    if (FAILED(hr)) {
+        return false;
+    }
+
+    // Premultiplied alpha: colour is already scaled by alpha
+    blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_ONE;
+    blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+    blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+    blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_INV_SRC_ALPHA;
+
+    hr = m_pGraphicsDevice->GetDevice()->CreateBlendState(&blendDesc, m_pPremultipliedBlendState.ReleaseAndGetAddressOf());
+
+    return SUCCEEDED(hr);
+}
+
+bool D3D11RenderBackend::CreateSamplerState() {
+    // Bilinear, clamped; matched by SoftwareRenderBackend
+    D3D11_SAMPLER_DESC samplerDesc = {};
+    samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+    samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateSamplerState(&samplerDesc, m_pSamplerState.ReleaseAndGetAddressOf());
+
+    return SUCCEEDED(hr);
+}
+
+uint32_t D3D11RenderBackend::CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) {
+    if (width == 0 || height == 0 || m_Textures.empty()) {
+        return WHITE_TEXTURE;
+    }
+
+    // Default usage so atlas pages can be updated in place
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = width;
+    textureDesc.Height = height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    std::vector<uint8_t> blank;
+    if (!pPixels) {
+        blank.assign((size_t)width * height * 4, 0);
+        pPixels = blank.data();
+    }
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem = pPixels;
+    initData.SysMemPitch = width * 4;
+
+    Microsoft::WRL::ComPtr<ID3D11Texture2D> pTexture;
+    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateTexture2D(&textureDesc, &initData, pTexture.GetAddressOf());
+    if (FAILED(hr)) {
+        return WHITE_TEXTURE;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> pView;
+    hr = m_pGraphicsDevice->GetDevice()->CreateShaderResourceView(pTexture.Get(), nullptr, pView.GetAddressOf());
+    if (FAILED(hr)) {
+        return WHITE_TEXTURE;
+    }
+
+    // The white texture is created into the reserved slot 0
+    if (!m_Textures[WHITE_TEXTURE]) {
+        m_Textures[WHITE_TEXTURE] = pView;
+        return WHITE_TEXTURE;
+    }
+
+    uint32_t textureId;
+    if (!m_FreeTextures.empty()) {
+        textureId = m_FreeTextures.back();
+        m_FreeTextures.pop_back();
+    } else {
+        if (m_Textures.size() > SortKey::TEXTURE_MASK) {
+            return WHITE_TEXTURE;
+        }
+        textureId = (uint32_t)m_Textures.size();
+        m_Textures.emplace_back();
+    }
+
+    m_Textures[textureId] = pView;
+    return textureId;
+}
+
+void D3D11RenderBackend::DestroyTexture(uint32_t textureId) {
+    if (textureId == WHITE_TEXTURE || textureId >= m_Textures.size() || !m_Textures[textureId]) {
+        return;
+    }
+
+    m_Textures[textureId].Reset();
+    m_FreeTextures.push_back(textureId);
+}
+
+bool D3D11RenderBackend::UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                                       const uint8_t* pPixels, uint32_t rowPitch) {
+    if (textureId == WHITE_TEXTURE || textureId >= m_Textures.size() || !m_Textures[textureId] || !pPixels) {
+        return false;
+    }
+
+    Microsoft::WRL::ComPtr<ID3D11Resource> pResource;
+    m_Textures[textureId]->GetResource(pResource.GetAddressOf());
+
+    D3D11_BOX box = { x, y, 0, x + width, y + height, 1 };
+    m_pGraphicsDevice->GetDeviceContext()->UpdateSubresource(pResource.Get(), 0, &box, pPixels, rowPitch, 0);
+    return true;
+}
+
+void D3D11RenderBackend::BeginFrame() {
+    m_VertexRing.BeginFrame();
+    m_IndexRing.BeginFrame();
+    m_InstanceRing.BeginFrame();
+}
+
+void D3D11RenderBackend::BindPipeline(BlendMode blendMode, uint32_t textureId) {
+    ID3D11DeviceContext* pContext = m_pGraphicsDevice->GetDeviceContext();
+
+    // Pixel-space orthographic projection, origin at the top-left
+    XMMATRIX projection = XMMatrixOrthographicOffCenterLH(
+        0.0f, (float)m_pGraphicsDevice->GetWidth(),
+        (float)m_pGraphicsDevice->GetHeight(), 0.0f,
+        0.0f, 1.0f);
+    pContext->UpdateSubresource(m_pConstantBuffer.Get(), 0, nullptr, &projection, 0, 0);
+
+    // Set up rendering pipeline
+    pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    pContext->IASetInputLayout(m_pInputLayout.Get());
+
+    // Set shaders
+    pContext->VSSetShader(m_pVertexShader.Get(), nullptr, 0);
+    pContext->VSSetConstantBuffers(0, 1, m_pConstantBuffer.GetAddressOf());
+    pContext->PSSetShader(m_pPixelShader.Get(), nullptr, 0);
+    pContext->PSSetSamplers(0, 1, m_pSamplerState.GetAddressOf());
+
+    SetBlendState(blendMode);
+    BindTexture(textureId);
+}
+
+void D3D11RenderBackend::SetBlendState(BlendMode blendMode) {
+    // Set blend state for transparency
+    ID3D11BlendState* pBlendState = blendMode == BlendMode::PREMULTIPLIED ?
+        m_pPremultipliedBlendState.Get() : m_pBlendState.Get();
+    float blendFactor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    m_pGraphicsDevice->GetDeviceContext()->OMSetBlendState(pBlendState, blendFactor, 0xFFFFFFFF);
+}
+
+void D3D11RenderBackend::BindTexture(uint32_t textureId) {
+    // Unknown or destroyed textures fall back to white
+    if (textureId >= m_Textures.size() || !m_Textures[textureId]) {
+        textureId = WHITE_TEXTURE;
+    }
+    m_pGraphicsDevice->GetDeviceContext()->PSSetShaderResources(0, 1, m_Textures[textureId].GetAddressOf());
+}
+
+bool D3D11RenderBackend::AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) {
+    return m_Arena.Append(vertexCount, pVertices, baseVertex);
+}
+
+void D3D11RenderBackend::Submit(const uint16_t* pIndices, uint32_t indexCount,
+                                const DrawRun* pRuns, uint32_t runCount) {
+    uint32_t firstVertex, vertexCount;
+    if (!m_Arena.Close(firstVertex, vertexCount) || indexCount == 0 || runCount == 0) {
+        return;
+    }
+
+    // Indices arrive already sorted, so one copy uploads every run
+    if (!m_IndexRing.Reserve(indexCount)) {
+        return;
+    }
+
+    uint32_t firstIndex = 0;
+    uint16_t* pIndexData = (uint16_t*)m_IndexRing.Map(indexCount, firstIndex);
+    if (!pIndexData) {
+        return;
+    }
+    memcpy(pIndexData, pIndices, indexCount * sizeof(uint16_t));
+    m_IndexRing.Unmap();
+
+    ID3D11DeviceContext* pContext = m_pGraphicsDevice->GetDeviceContext();
+
+    UINT stride = m_VertexRing.GetStride();
+    UINT offset = 0;
+    pContext->IASetVertexBuffers(0, 1, m_VertexStorage.GetAddressOf(), &stride, &offset);
+    pContext->IASetIndexBuffer(m_IndexStorage.GetBuffer(), DXGI_FORMAT_R16_UINT, 0);
+
+    // Only touch the state that differs from the previous run
+    uint64_t boundKey = pRuns[0].sortKey;
+    BindPipeline((BlendMode)SortKey::GetBlendMode(boundKey), SortKey::GetTexture(boundKey));
+
+    for (uint32_t i = 0; i < runCount; i++) {
+        const DrawRun& run = pRuns[i];
+        if (run.firstIndex + run.indexCount > indexCount) {
+            continue;
+        }
+
+        if (SortKey::GetBlendMode(run.sortKey) != SortKey::GetBlendMode(boundKey)) {
+            SetBlendState((BlendMode)SortKey::GetBlendMode(run.sortKey));
+        }
+        if (SortKey::GetTexture(run.sortKey) != SortKey::GetTexture(boundKey)) {
+            BindTexture(SortKey::GetTexture(run.sortKey));
+        }
+        boundKey = run.sortKey;
+
+        pContext->DrawIndexed(run.indexCount, firstIndex + run.firstIndex, (INT)firstVertex);
+    }
+}
+
+bool D3D11RenderBackend::AppendInstances(uint32_t count, SpriteInstance*& pInstances) {
+    if (!m_bInstancesMapped) {
+        if (!m_InstanceRing.Reserve(count)) {
+            return false;
+        }
+
+        m_pInstances = (SpriteInstance*)m_InstanceRing.MapSpan(count, m_FirstInstance, m_InstanceCapacity);
+        if (!m_pInstances) {
+            return false;
+        }
+
+        m_InstanceCount = 0;
+        m_bInstancesMapped = true;
+    }
+
+    if (m_InstanceCount + count > m_InstanceCapacity) {
+        return false;
+    }
+
+    pInstances = m_pInstances + m_InstanceCount;
+    m_InstanceCount += count;
+    return true;
+}
+
+void D3D11RenderBackend::SubmitInstances(BlendMode blendMode, uint32_t textureId) {
+    if (!m_bInstancesMapped) {
+        return;
+    }
+
+    m_InstanceRing.UnmapSpan(m_InstanceCount);
+    m_bInstancesMapped = false;
+
+    if (m_InstanceCount == 0) {
+        return;
+    }
+
+    ID3D11DeviceContext* pContext = m_pGraphicsDevice->GetDeviceContext();
+    BindPipeline(blendMode, textureId);
+
+    // Corners come from SV_VertexID; only the instance stream is bound
+    UINT stride = sizeof(SpriteInstance);
+    UINT offset = 0;
+    pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    pContext->IASetInputLayout(m_pInstancedInputLayout.Get());
+    pContext->IASetVertexBuffers(0, 1, m_InstanceStorage.GetAddressOf(), &stride, &offset);
+    pContext->VSSetShader(m_pInstancedVertexShader.Get(), nullptr, 0);
+
+    pContext->DrawInstanced(4, m_InstanceCount, 0, m_FirstInstance);
+}
+
+void D3D11RenderBackend::DrawIndexed(const Vertex* pVertices, uint32_t vertexCount,
+                                     const uint32_t* pIndices, uint32_t indexCount,
+                                     BlendMode blendMode) {
+    if (vertexCount == 0 || indexCount == 0 || m_Arena.IsOpen()) {
+        return;
+    }
+
+    ID3D11DeviceContext* pContext = m_pGraphicsDevice->GetDeviceContext();
+    BindPipeline(blendMode, WHITE_TEXTURE);
+
+    // Split the batch into draws that fit the rings and 16-bit indices
+    uint32_t maxVertices = min(m_VertexRing.GetCapacity(), GeometryArena::MAX_BATCH_VERTICES);
+
+    BatchRange range;
+    uint32_t startIndex = 0;
+    while (NextBatchRange(pIndices, indexCount, startIndex,
+                          maxVertices, m_IndexRing.GetCapacity(), range)) {
+        startIndex = range.firstIndex + range.indexCount;
+
+        if (range.maxVertex >= vertexCount) {
+            continue;
+        }
+
+        // A single triangle wider than the ring grows it immediately
+        uint32_t rangeVertexCount = range.maxVertex - range.minVertex + 1;
+        if (!m_VertexRing.Reserve(rangeVertexCount) || !m_IndexRing.Reserve(range.indexCount)) {
+            return;
+        }
+
+        uint32_t firstVertex = 0;
+        void* pVertexData = m_VertexRing.Map(rangeVertexCount, firstVertex);
+        if (!pVertexData) {
+            return;
+        }
+        if (m_VertexFormat == VertexFormat::COMPACT) {
+            CompactVertex* pCompact = (CompactVertex*)pVertexData;
+            for (uint32_t i = 0; i < rangeVertexCount; i++) {
+                const Vertex& v = pVertices[range.minVertex + i];
+                VertexTraits<CompactVertex>::Write(pCompact[i], v.x, v.y, v.u, v.v, v.r, v.g, v.b, v.a);
+            }
+        } else {
+            memcpy(pVertexData, pVertices + range.minVertex, sizeof(Vertex) * rangeVertexCount);
+        }
+        m_VertexRing.Unmap();
+
+        // Rebase onto the range so indices fit in 16 bits
+        uint32_t firstIndex = 0;
+        uint16_t* pIndexData = (uint16_t*)m_IndexRing.Map(range.indexCount, firstIndex);
+        if (!pIndexData) {
+            return;
+        }
+        for (uint32_t i = 0; i < range.indexCount; i++) {
+            pIndexData[i] = (uint16_t)(pIndices[range.firstIndex + i] - range.minVertex);
+        }
+        m_IndexRing.Unmap();
+
+        // Buffers may have been recreated by growth, so bind per draw
+        UINT stride = m_VertexRing.GetStride();
+        UINT offset = 0;
+        pContext->IASetVertexBuffers(0, 1, m_VertexStorage.GetAddressOf(), &stride, &offset);
+        pContext->IASetIndexBuffer(m_IndexStorage.GetBuffer(), DXGI_FORMAT_R16_UINT, 0);
+
+        pContext->DrawIndexed(range.indexCount, firstIndex, (INT)firstVertex);
+    }
+}
\ No newline at end of file
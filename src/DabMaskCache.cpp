@@ -0,0 +1,108 @@
+#include "../include/DabMaskCache.h"
+#include "../include/Canvas.h"
+#include <algorithm>
+#include <cmath>
+using std::min;
+using std::max;
+
+DabMaskCache::DabMaskCache() :
+    m_CacheBudget(DEFAULT_CACHE_BUDGET),
+    m_CacheBytes(0),
+    m_Hits(0),
+    m_Misses(0),
+    m_bHold(false) {
+}
+
+DabMaskCache::~DabMaskCache() {
+}
+
+const DabMask* DabMaskCache::GetMask(const Dab& dab, int& originX, int& originY) {
+    if (dab.radius <= 0.0f || dab.radius > MAX_RADIUS) {
+        return nullptr;
+    }
+
+    // Diameter in 1/SIZE_STEPS pixels, never rounded down to nothing
+    uint32_t sizeStep = (uint32_t)max(1L, std::lrint(dab.radius * 2.0f * (float)SIZE_STEPS));
+    uint32_t hardnessStep = (uint32_t)std::lrint(max(0.0f, min(1.0f, dab.hardness)) * (float)HARDNESS_STEPS);
+
+    // Whole-pixel centre and the phase within the pixel
+    long centerX = std::lrint(dab.x * (float)SUBPIXEL_STEPS);
+    long centerY = std::lrint(dab.y * (float)SUBPIXEL_STEPS);
+    long pixelX = (centerX >= 0 ? centerX : centerX - (long)SUBPIXEL_STEPS + 1) / (long)SUBPIXEL_STEPS;
+    long pixelY = (centerY >= 0 ? centerY : centerY - (long)SUBPIXEL_STEPS + 1) / (long)SUBPIXEL_STEPS;
+    uint32_t phaseX = (uint32_t)(centerX - pixelX * (long)SUBPIXEL_STEPS);
+    uint32_t phaseY = (uint32_t)(centerY - pixelY * (long)SUBPIXEL_STEPS);
+
+    uint32_t key = sizeStep << 16 | hardnessStep << 8 | phaseY << 4 | phaseX;
+    auto found = m_CacheIndex.find(key);
+    if (found != m_CacheIndex.end()) {
+        m_Hits++;
+        m_Cache.splice(m_Cache.begin(), m_Cache, found->second);
+    } else {
+        m_Misses++;
+        float radius = (float)sizeStep / (float)(SIZE_STEPS * 2);
+        float hardness = (float)hardnessStep / (float)HARDNESS_STEPS;
+
+        // Coverage reaches the edge of the falloff ramp, at least a pixel
+        // past the solid core. The mask spans that either side of the
+        // centre pixel plus one for the phase.
+        float extent = max(radius, radius * hardness + 1.0f);
+        int reach = (int)std::ceil(extent);
+
+        m_Cache.emplace_front();
+        DabMask& mask = m_Cache.front();
+        mask.key = key;
+        mask.size = (uint32_t)reach * 2 + 2;
+        mask.offset = -reach;
+        mask.pixels.resize((size_t)mask.size * mask.size);
+        RasterizeDabMask(radius, hardness,
+                         (float)reach + (float)phaseX / (float)SUBPIXEL_STEPS,
+                         (float)reach + (float)phaseY / (float)SUBPIXEL_STEPS,
+                         mask.pixels.data(), mask.size);
+        m_CacheIndex[key] = m_Cache.begin();
+        m_CacheBytes += mask.pixels.size();
+        Evict();
+    }
+
+    const DabMask& mask = m_Cache.front();
+    originX = (int)pixelX + mask.offset;
+    originY = (int)pixelY + mask.offset;
+    return &mask;
+}
+
+void DabMaskCache::MakeStamp(const Dab& dab, DabStamp& stamp) {
+    stamp = DabStamp();
+    stamp.dab = dab;
+    const DabMask* pMask = dab.mode == DabMode::SMUDGE ? nullptr : GetMask(dab, stamp.originX, stamp.originY);
+    if (pMask) {
+        stamp.pMask = pMask->pixels.data();
+        stamp.maskSize = pMask->size;
+    }
+}
+
+void DabMaskCache::EndBatch() {
+    m_bHold = false;
+    Evict();
+}
+
+void DabMaskCache::Clear() {
+    m_Cache.clear();
+    m_CacheIndex.clear();
+    m_CacheBytes = 0;
+}
+
+void DabMaskCache::SetCacheBudget(size_t bytes) {
+    m_CacheBudget = bytes;
+    Evict();
+}
+
+void DabMaskCache::Evict() {
+    // The front mask was just handed out, so it always stays
+    if (m_bHold) return;
+    while (m_CacheBytes > m_CacheBudget && m_Cache.size() > 1) {
+        const DabMask& oldest = m_Cache.back();
+        m_CacheBytes -= oldest.pixels.size();
+        m_CacheIndex.erase(oldest.key);
+        m_Cache.pop_back();
+    }
+}
\ No newline at end of file
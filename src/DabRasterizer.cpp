@@ -0,0 +1,474 @@
+#include "../include/DabRasterizer.h"
+#include "../include/Canvas.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define DAB_RASTERIZER_SSE2 1
+#endif
+using std::min;
+using std::max;
+
+namespace {
+
+// Per-dab constants shared by the span loops
+struct DabSetup {
+    float centerX, centerY;
+    float inner;            // Full coverage inside this distance
+    float invRamp;          // 1 / width of the falloff ramp
+    float extent;           // No coverage beyond this distance
+    float opacity;
+    float color[4];         // Premultiplied, 0..255
+    float srcAlpha;         // Colour alpha, 0..1
+};
+
+inline float Smoothstep01(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+inline float Coverage(const DabSetup& setup, float distance) {
+    float t = (distance - setup.inner) * setup.invRamp;
+    t = max(0.0f, min(1.0f, t));
+    return (1.0f - Smoothstep01(t)) * setup.opacity;
+}
+
+inline uint8_t ToByte(float value) {
+    return (uint8_t)(int)std::lrint(max(0.0f, min(255.0f, value)));
+}
+
+// dst = src * coverage + dst * (1 - srcAlpha * coverage)
+inline void BlendPixel(const DabSetup& setup, float coverage, uint8_t* pPixel) {
+    float keep = 1.0f - setup.srcAlpha * coverage;
+    for (int c = 0; c < 4; c++) {
+        pPixel[c] = ToByte(setup.color[c] * coverage + (float)pPixel[c] * keep);
+    }
+}
+
+void BlendSpanScalar(const DabSetup& setup, uint8_t* pPixels, float px, float dy2, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        float dx = px + (float)i - setup.centerX;
+        float coverage = Coverage(setup, std::sqrt(dx * dx + dy2));
+        if (coverage > 0.0f) {
+            BlendPixel(setup, coverage, pPixels + i * 4);
+        }
+    }
+}
+
+#ifdef DAB_RASTERIZER_SSE2
+// Blend four pixels given their coverage: each pixel's RGBA is widened to
+// floats, blended and packed back
+inline void BlendGroupSSE2(const DabSetup& setup, uint8_t* pGroup, __m128 coverage) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 srcAlpha = _mm_set1_ps(setup.srcAlpha);
+    const __m128 color = _mm_loadu_ps(setup.color);
+    const __m128 maxByte = _mm_set1_ps(255.0f);
+    const __m128i zeroi = _mm_setzero_si128();
+
+    __m128 keep = _mm_sub_ps(one, _mm_mul_ps(srcAlpha, coverage));
+
+    __m128i packed = _mm_loadu_si128((const __m128i*)pGroup);
+    __m128i lo = _mm_unpacklo_epi8(packed, zeroi);
+    __m128i hi = _mm_unpackhi_epi8(packed, zeroi);
+    __m128 dst[4] = {
+        _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zeroi)),
+        _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zeroi)),
+        _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zeroi)),
+        _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zeroi))
+    };
+
+    __m128 coverages[4] = {
+        _mm_shuffle_ps(coverage, coverage, _MM_SHUFFLE(0, 0, 0, 0)),
+        _mm_shuffle_ps(coverage, coverage, _MM_SHUFFLE(1, 1, 1, 1)),
+        _mm_shuffle_ps(coverage, coverage, _MM_SHUFFLE(2, 2, 2, 2)),
+        _mm_shuffle_ps(coverage, coverage, _MM_SHUFFLE(3, 3, 3, 3))
+    };
+    __m128 keeps[4] = {
+        _mm_shuffle_ps(keep, keep, _MM_SHUFFLE(0, 0, 0, 0)),
+        _mm_shuffle_ps(keep, keep, _MM_SHUFFLE(1, 1, 1, 1)),
+        _mm_shuffle_ps(keep, keep, _MM_SHUFFLE(2, 2, 2, 2)),
+        _mm_shuffle_ps(keep, keep, _MM_SHUFFLE(3, 3, 3, 3))
+    };
+
+    __m128i result[4];
+    for (int p = 0; p < 4; p++) {
+        __m128 value = _mm_add_ps(_mm_mul_ps(color, coverages[p]), _mm_mul_ps(dst[p], keeps[p]));
+        value = _mm_min_ps(_mm_max_ps(value, zero), maxByte);
+        result[p] = _mm_cvtps_epi32(value);
+    }
+
+    __m128i words = _mm_packs_epi32(result[0], result[1]);
+    __m128i words2 = _mm_packs_epi32(result[2], result[3]);
+    _mm_storeu_si128((__m128i*)pGroup, _mm_packus_epi16(words, words2));
+}
+
+// Four pixels per iteration: falloff for all four lanes, then the blend
+void BlendSpanSSE2(const DabSetup& setup, uint8_t* pPixels, float px, float dy2, uint32_t count) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 three = _mm_set1_ps(3.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 inner = _mm_set1_ps(setup.inner);
+    const __m128 invRamp = _mm_set1_ps(setup.invRamp);
+    const __m128 opacity = _mm_set1_ps(setup.opacity);
+    const __m128 dyy = _mm_set1_ps(dy2);
+
+    __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps(px), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)), _mm_set1_ps(setup.centerX));
+    const __m128 step = _mm_set1_ps(4.0f);
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4, dx = _mm_add_ps(dx, step)) {
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dyy));
+        __m128 t = _mm_mul_ps(_mm_sub_ps(distance, inner), invRamp);
+        t = _mm_min_ps(_mm_max_ps(t, zero), one);
+        __m128 smooth = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+        __m128 coverage = _mm_mul_ps(_mm_sub_ps(one, smooth), opacity);
+
+        // Skip groups entirely outside the dab
+        if (_mm_movemask_ps(_mm_cmpgt_ps(coverage, zero)) == 0) {
+            continue;
+        }
+
+        BlendGroupSSE2(setup, pPixels + i * 4, coverage);
+    }
+
+    BlendSpanScalar(setup, pPixels + i * 4, px + (float)i, dy2, count - i);
+}
+#endif
+
+// Coverage from a row of tip mask bytes instead of the round falloff
+void BlendMaskedSpan(const DabSetup& setup, uint8_t* pPixels, const uint8_t* pMask, uint32_t count) {
+    const float scale = setup.opacity * (1.0f / 255.0f);
+    uint32_t i = 0;
+#ifdef DAB_RASTERIZER_SSE2
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128i zeroi = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        int32_t bytes;
+        memcpy(&bytes, pMask + i, 4);
+        if (bytes == 0) continue;
+
+        __m128i words = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zeroi);
+        __m128 coverage = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zeroi)), scales);
+        BlendGroupSSE2(setup, pPixels + i * 4, coverage);
+    }
+#endif
+    for (; i < count; i++) {
+        if (pMask[i]) {
+            BlendPixel(setup, (float)pMask[i] * scale, pPixels + i * 4);
+        }
+    }
+}
+
+// Per-dab constants; ERASE blends transparent black, which scales every
+// channel by 1 - alpha * coverage. Returns false if the dab paints nothing.
+bool SetupDab(const Dab& dab, DabSetup& setup) {
+    if (dab.radius <= 0.0f || dab.opacity <= 0.0f) return false;
+
+    float hardness = max(0.0f, min(1.0f, dab.hardness));
+    setup.centerX = dab.x;
+    setup.centerY = dab.y;
+    setup.inner = dab.radius * hardness;
+
+    // At least a one-pixel ramp so hard tips stay antialiased
+    float ramp = max(dab.radius - setup.inner, 1.0f);
+    setup.invRamp = 1.0f / ramp;
+    setup.extent = setup.inner + ramp;
+    setup.opacity = min(dab.opacity, 1.0f);
+    setup.srcAlpha = max(0.0f, min(1.0f, dab.a));
+    if (dab.mode == DabMode::ERASE) {
+        setup.color[0] = setup.color[1] = setup.color[2] = setup.color[3] = 0.0f;
+    } else {
+        setup.color[0] = max(0.0f, min(1.0f, dab.r)) * setup.srcAlpha * 255.0f;
+        setup.color[1] = max(0.0f, min(1.0f, dab.g)) * setup.srcAlpha * 255.0f;
+        setup.color[2] = max(0.0f, min(1.0f, dab.b)) * setup.srcAlpha * 255.0f;
+        setup.color[3] = setup.srcAlpha * 255.0f;
+    }
+    return true;
+}
+
+}
+
+float DabFalloff(float distance, float radius, float hardness) {
+    DabSetup setup;
+    hardness = max(0.0f, min(1.0f, hardness));
+    setup.inner = radius * hardness;
+    setup.invRamp = 1.0f / max(radius - setup.inner, 1.0f);
+    setup.opacity = 1.0f;
+    return Coverage(setup, distance);
+}
+
+bool PrepareStamp(const Canvas& canvas, DabStamp& stamp) {
+    // Smudge needs the colour carried along the stroke
+    if (stamp.dab.mode == DabMode::SMUDGE) return false;
+
+    DabSetup setup;
+    if (!SetupDab(stamp.dab, setup)) return false;
+
+    if (stamp.pMask) {
+        if (stamp.maskSize == 0) return false;
+        stamp.x0 = max(0, stamp.originX);
+        stamp.y0 = max(0, stamp.originY);
+        stamp.x1 = min((int)canvas.GetWidth(), stamp.originX + (int)stamp.maskSize);
+        stamp.y1 = min((int)canvas.GetHeight(), stamp.originY + (int)stamp.maskSize);
+    } else {
+        // Pixels whose centres can receive coverage
+        const Dab& dab = stamp.dab;
+        float extent = setup.extent;
+        stamp.x0 = max(0, (int)std::floor(dab.x - extent));
+        stamp.y0 = max(0, (int)std::floor(dab.y - extent));
+        stamp.x1 = min((int)canvas.GetWidth(), (int)std::ceil(dab.x + extent));
+        stamp.y1 = min((int)canvas.GetHeight(), (int)std::ceil(dab.y + extent));
+    }
+    return stamp.x0 < stamp.x1 && stamp.y0 < stamp.y1;
+}
+
+bool StampTouchesTile(const DabStamp& stamp, int tileX, int tileY) {
+    const int tileSize = (int)Canvas::TILE_SIZE;
+    int tileX0 = max(stamp.x0, tileX * tileSize);
+    int tileX1 = min(stamp.x1, (tileX + 1) * tileSize);
+    int rowY0 = max(stamp.y0, tileY * tileSize);
+    int rowY1 = min(stamp.y1, (tileY + 1) * tileSize);
+    if (tileX0 >= tileX1 || rowY0 >= rowY1) return false;
+
+    if (stamp.pMask) {
+        // Skip tiles under empty parts of the mask
+        const uint8_t* pMaskTile = stamp.pMask + (size_t)(rowY0 - stamp.originY) * stamp.maskSize + (tileX0 - stamp.originX);
+        for (int y = rowY0; y < rowY1; y++) {
+            const uint8_t* pMaskRow = pMaskTile + (size_t)(y - rowY0) * stamp.maskSize;
+            for (int x = 0; x < tileX1 - tileX0; x++) {
+                if (pMaskRow[x]) return true;
+            }
+        }
+        return false;
+    }
+
+    // Leave tiles in the corners of the bounding box unallocated
+    const Dab& dab = stamp.dab;
+    DabSetup setup;
+    SetupDab(dab, setup);
+    float extent = setup.extent;
+    float nearestX = max((float)tileX0 + 0.5f, min(dab.x, (float)tileX1 - 0.5f)) - dab.x;
+    float nearestY = max((float)rowY0 + 0.5f, min(dab.y, (float)rowY1 - 0.5f)) - dab.y;
+    return nearestX * nearestX + nearestY * nearestY < extent * extent;
+}
+
+void StampTile(const DabStamp& stamp, uint8_t* pTile, int tileX, int tileY) {
+    const int tileSize = (int)Canvas::TILE_SIZE;
+    int tileX0 = max(stamp.x0, tileX * tileSize);
+    int tileX1 = min(stamp.x1, (tileX + 1) * tileSize);
+    int rowY0 = max(stamp.y0, tileY * tileSize);
+    int rowY1 = min(stamp.y1, (tileY + 1) * tileSize);
+
+    const Dab& dab = stamp.dab;
+    DabSetup setup;
+    SetupDab(dab, setup);
+
+    if (stamp.pMask) {
+        const uint8_t* pMaskTile = stamp.pMask + (size_t)(rowY0 - stamp.originY) * stamp.maskSize + (tileX0 - stamp.originX);
+        for (int y = rowY0; y < rowY1; y++) {
+            uint8_t* pRow = pTile + ((size_t)(y - tileY * tileSize) * tileSize + (tileX0 - tileX * tileSize)) * 4;
+            BlendMaskedSpan(setup, pRow, pMaskTile + (size_t)(y - rowY0) * stamp.maskSize, (uint32_t)(tileX1 - tileX0));
+        }
+        return;
+    }
+
+    float extent = setup.extent;
+    for (int y = rowY0; y < rowY1; y++) {
+        // Clip the row to the chord of the circle
+        float dy = (float)y + 0.5f - dab.y;
+        float halfChord = std::sqrt(max(extent * extent - dy * dy, 0.0f));
+        int spanX0 = max(tileX0, (int)std::floor(dab.x - halfChord));
+        int spanX1 = min(tileX1, (int)std::ceil(dab.x + halfChord));
+        if (spanX0 >= spanX1) continue;
+
+        uint8_t* pRow = pTile + ((size_t)(y - tileY * tileSize) * tileSize + (spanX0 - tileX * tileSize)) * 4;
+#ifdef DAB_RASTERIZER_SSE2
+        BlendSpanSSE2(setup, pRow, (float)spanX0 + 0.5f, dy * dy, (uint32_t)(spanX1 - spanX0));
+#else
+        BlendSpanScalar(setup, pRow, (float)spanX0 + 0.5f, dy * dy, (uint32_t)(spanX1 - spanX0));
+#endif
+    }
+}
+
+void RasterizeStamp(Canvas& canvas, DabStamp& stamp) {
+    if (!PrepareStamp(canvas, stamp)) return;
+
+    const int tileSize = (int)Canvas::TILE_SIZE;
+    for (int tileY = stamp.y0 / tileSize; tileY <= (stamp.y1 - 1) / tileSize; tileY++) {
+        for (int tileX = stamp.x0 / tileSize; tileX <= (stamp.x1 - 1) / tileSize; tileX++) {
+            if (!StampTouchesTile(stamp, tileX, tileY)) continue;
+
+            // Erasing never needs to allocate: unpainted tiles stay transparent
+            uint8_t* pTile = stamp.dab.mode == DabMode::ERASE ?
+                canvas.GetTile((uint32_t)tileX, (uint32_t)tileY) :
+                canvas.GetOrCreateTile((uint32_t)tileX, (uint32_t)tileY);
+            if (pTile) {
+                StampTile(stamp, pTile, tileX, tileY);
+            }
+        }
+    }
+
+    canvas.MarkDirty(stamp.x0, stamp.y0, stamp.x1, stamp.y1);
+}
+
+void RasterizeDab(Canvas& canvas, const Dab& dab) {
+    DabStamp stamp = {};
+    stamp.dab = dab;
+    RasterizeStamp(canvas, stamp);
+}
+
+void RasterizeDabs(Canvas& canvas, const Dab* pDabs, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        RasterizeDab(canvas, pDabs[i]);
+    }
+}
+
+void RasterizeMaskedDab(Canvas& canvas, const Dab& dab, const uint8_t* pMask, uint32_t maskSize) {
+    // Snap the mask's top-left corner to the nearest pixel
+    int originX = (int)std::lrint(dab.x - (float)maskSize * 0.5f);
+    int originY = (int)std::lrint(dab.y - (float)maskSize * 0.5f);
+    RasterizeMask(canvas, dab, pMask, maskSize, originX, originY);
+}
+
+void RasterizeMask(Canvas& canvas, const Dab& dab, const uint8_t* pMask, uint32_t maskSize, int originX, int originY) {
+    if (!pMask) return;
+
+    DabStamp stamp = {};
+    stamp.dab = dab;
+    stamp.pMask = pMask;
+    stamp.maskSize = maskSize;
+    stamp.originX = originX;
+    stamp.originY = originY;
+    RasterizeStamp(canvas, stamp);
+}
+
+void RasterizeDabMask(float radius, float hardness, float centerX, float centerY, uint8_t* pMask, uint32_t maskSize) {
+    DabSetup setup;
+    hardness = max(0.0f, min(1.0f, hardness));
+    setup.centerX = centerX;
+    setup.centerY = centerY;
+    setup.inner = radius * hardness;
+    setup.invRamp = 1.0f / max(radius - setup.inner, 1.0f);
+    setup.opacity = 255.0f;
+
+    for (uint32_t y = 0; y < maskSize; y++) {
+        float dy = (float)y + 0.5f - centerY;
+        uint8_t* pRow = pMask + (size_t)y * maskSize;
+
+        uint32_t x = 0;
+#ifdef DAB_RASTERIZER_SSE2
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 three = _mm_set1_ps(3.0f);
+        const __m128 two = _mm_set1_ps(2.0f);
+        const __m128 inner = _mm_set1_ps(setup.inner);
+        const __m128 invRamp = _mm_set1_ps(setup.invRamp);
+        const __m128 scale = _mm_set1_ps(setup.opacity);
+        const __m128 dyy = _mm_set1_ps(dy * dy);
+        const __m128 lanes = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+        for (; x + 4 <= maskSize; x += 4) {
+            __m128 dx = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float)x), lanes), _mm_set1_ps(centerX));
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dyy));
+            __m128 t = _mm_mul_ps(_mm_sub_ps(distance, inner), invRamp);
+            t = _mm_min_ps(_mm_max_ps(t, zero), one);
+            __m128 smooth = _mm_mul_ps(_mm_mul_ps(t, t), _mm_sub_ps(three, _mm_mul_ps(two, t)));
+            __m128i value = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(one, smooth), scale));
+
+            __m128i words = _mm_packs_epi32(value, _mm_setzero_si128());
+            int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+            memcpy(pRow + x, &bytes, 4);
+        }
+#endif
+        for (; x < maskSize; x++) {
+            float dx = (float)x + 0.5f - centerX;
+            pRow[x] = ToByte(Coverage(setup, std::sqrt(dx * dx + dy * dy)));
+        }
+    }
+}
+
+void RasterizeSmudgeDab(Canvas& canvas, const Dab& dab, SmudgeBuffer& buffer, float pickup) {
+    DabSetup setup;
+    if (!SetupDab(dab, setup) || buffer.size == 0) return;
+    pickup = max(0.0f, min(1.0f, pickup));
+
+    // Buffer pixel (bx, by) lies over canvas pixel (originX + bx, originY + by)
+    int originX = (int)std::floor(dab.x) - (int)buffer.size / 2;
+    int originY = (int)std::floor(dab.y) - (int)buffer.size / 2;
+
+    if (!buffer.loaded) {
+        // The first dab only picks up the canvas under it
+        std::vector<uint8_t> pixels((size_t)buffer.size * buffer.size * 4, 0);
+        int bx0 = max(0, -originX);
+        int by0 = max(0, -originY);
+        if (originX + bx0 < (int)canvas.GetWidth() && originY + by0 < (int)canvas.GetHeight()) {
+            canvas.ReadPixels((uint32_t)(originX + bx0), (uint32_t)(originY + by0),
+                              buffer.size - (uint32_t)bx0, buffer.size - (uint32_t)by0,
+                              pixels.data() + ((size_t)by0 * buffer.size + bx0) * 4, buffer.size * 4);
+        }
+        for (size_t i = 0; i < pixels.size(); i++) {
+            buffer.pixels[i] = (float)pixels[i];
+        }
+        buffer.loaded = true;
+        return;
+    }
+
+    // Pixels the dab covers that the buffer also reaches
+    float extent = setup.extent;
+    int x0 = max(max(0, originX), (int)std::floor(dab.x - extent));
+    int y0 = max(max(0, originY), (int)std::floor(dab.y - extent));
+    int x1 = min(min((int)canvas.GetWidth(), originX + (int)buffer.size), (int)std::ceil(dab.x + extent));
+    int y1 = min(min((int)canvas.GetHeight(), originY + (int)buffer.size), (int)std::ceil(dab.y + extent));
+    if (x0 >= x1 || y0 >= y1) return;
+
+    static const uint8_t transparent[4] = { 0, 0, 0, 0 };
+    const Canvas& source = canvas;
+    const int tileSize = (int)Canvas::TILE_SIZE;
+    for (int tileY = y0 / tileSize; tileY <= (y1 - 1) / tileSize; tileY++) {
+        for (int tileX = x0 / tileSize; tileX <= (x1 - 1) / tileSize; tileX++) {
+            int tileX0 = max(x0, tileX * tileSize);
+            int tileX1 = min(x1, (tileX + 1) * tileSize);
+            int rowY0 = max(y0, tileY * tileSize);
+            int rowY1 = min(y1, (tileY + 1) * tileSize);
+
+            // Read through the const path; the tile is only made writable
+            // (allocated or copied from history) once a pixel changes
+            const uint8_t* pRead = source.GetTile((uint32_t)tileX, (uint32_t)tileY);
+            uint8_t* pTile = nullptr;
+
+            for (int y = rowY0; y < rowY1; y++) {
+                float dy = (float)y + 0.5f - dab.y;
+                size_t tileRow = (size_t)(y - tileY * tileSize) * tileSize;
+                float* pBufferRow = buffer.pixels.data() + (size_t)(y - originY) * buffer.size * 4;
+
+                for (int x = tileX0; x < tileX1; x++) {
+                    float dx = (float)x + 0.5f - dab.x;
+                    float coverage = Coverage(setup, std::sqrt(dx * dx + dy * dy));
+                    if (coverage <= 0.0f) continue;
+
+                    size_t offset = (tileRow + (x - tileX * tileSize)) * 4;
+                    const uint8_t* pSrc = pRead ? pRead + offset : transparent;
+                    float* pCarry = pBufferRow + (size_t)(x - originX) * 4;
+
+                    // Pick up some of the canvas, then lay the carried colour down
+                    float mix = pickup * coverage;
+                    uint8_t result[4];
+                    for (int c = 0; c < 4; c++) {
+                        pCarry[c] += ((float)pSrc[c] - pCarry[c]) * mix;
+                        result[c] = ToByte((float)pSrc[c] + (pCarry[c] - (float)pSrc[c]) * coverage);
+                    }
+                    if (memcmp(result, pSrc, 4) == 0) continue;
+
+                    if (!pTile) {
+                        pTile = canvas.GetOrCreateTile((uint32_t)tileX, (uint32_t)tileY);
+                        pRead = pTile;
+                    }
+                    memcpy(pTile + offset, result, 4);
+                }
+            }
+        }
+    }
+
+    canvas.MarkDirty(x0, y0, x1, y1);
+}
\ No newline at end of file
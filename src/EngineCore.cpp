@@ -1,7 +1,8 @@
 #include "../include/EngineCore.h"
+#include "../include/Profiler.h"
 #include <commctrl.h>
 
-EngineCore::EngineCore() : m_hInstance(nullptr), m_hwnd(nullptr), m_bRunning(false) {
+EngineCore::EngineCore() : m_bVSync(true), m_PendingSize(0), m_hInstance(nullptr), m_hwnd(nullptr), m_bRunning(false) {
     // Initialize COM for Windows tablet support
     CoInitialize(NULL);
 }
@@ -38,7 +39,15 @@ bool EngineCore::Initialize(HINSTANCE hInstance, int nCmdShow) {
         return false;
     }
 
-    // Initialize subsystems
+    // Capture profiling zones from every thread; the main loop collects
+    // them once a frame
+    Profiler::SetThreadName("Main");
+    Profiler::SetEnabled(true);
+
+    // Initialize subsystems. The job system comes first and makes this the
+    // main thread.
+    m_pJobSystem = std::make_unique<JobSystem>();
+
     m_pGraphicsDevice = std::make_unique<GraphicsDevice>();
     if (!m_pGraphicsDevice->Initialize(m_hwnd)) {
         return false;
@@ -49,8 +58,40 @@ bool EngineCore::Initialize(HINSTANCE hInstance, int nCmdShow) {
         return false;
     }
 
+    // Assets stream in on worker threads; the window shows before they are ready
+    m_pAssetLoader = std::make_unique<AssetLoader>(m_pRenderer.get());
+    if (!m_pAssetLoader->Initialize()) {
+        return false;
+    }
+
     m_pInputManager = std::make_unique<InputManager>();
 
+    if (m_RendererCallback) {
+        m_RendererCallback(*m_pRenderer);
+    }
+
+    // From here the renderer and device are driven from the render thread:
+    // it uploads finished assets, applies resizes, clears and presents
+    m_pRenderThread = std::make_unique<RenderThread>(m_pRenderer.get());
+    m_pRenderThread->SetFrameStartCallback([this]() {
+        uint32_t size = m_PendingSize.exchange(0, std::memory_order_acq_rel);
+        if (size != 0) {
+            m_pGraphicsDevice->Resize(size >> 16, size & 0xFFFF);
+        }
+        // Loads and unloads are asked for on the main thread; uploads and
+        // releases happen here, where the renderer lives
+        m_pAssetLoader->Update();
+    });
+    m_pRenderThread->SetClearCallback([this](float r, float g, float b, float a) {
+        m_pGraphicsDevice->BeginFrame(r, g, b, a);
+    });
+    m_pRenderThread->SetPresentCallback([this]() {
+        m_pGraphicsDevice->EndFrame(m_bVSync.load(std::memory_order_relaxed));
+    });
+    if (!m_pRenderThread->Start()) {
+        return false;
+    }
+
     ShowWindow(m_hwnd, nCmdShow);
     UpdateWindow(m_hwnd);
 
@@ -59,25 +100,87 @@ bool EngineCore::Initialize(HINSTANCE hInstance, int nCmdShow) {
 }
 
 void EngineCore::Run() {
-    MSG msg = {};
+    m_FrameTimer.Reset();
 
     while (m_bRunning) {
-        if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
-            TranslateMessage(&msg);
-            DispatchMessage(&msg);
-        } else {
-            // Main game loop
-            m_pGraphicsDevice->BeginFrame(0.1f, 0.1f, 0.1f, 1.0f);
-            
-            // Render here
-            m_pRenderer->Flush();
-            
-            m_pGraphicsDevice->EndFrame();
+        // Every waiting message, every frame, so message traffic no longer
+        // decides how often frames run
+        {
+            PROFILE_ZONE("EngineCore::PumpMessages");
+            PumpMessages();
+        }
+        if (!m_bRunning) {
+            break;
+        }
+
+        // Main game loop: build the frame's commands while the render
+        // thread replays the previous frame's
+        uint32_t updates = m_FrameTimer.BeginFrame();
+        RenderCommandList& commands = m_pRenderThread->GetCommandList();
+        commands.Clear(0.1f, 0.1f, 0.1f, 1.0f);
+        m_pInputManager->DispatchEvents();
+        m_pJobSystem->RunMainThreadJobs();
+
+        if (m_UpdateCallback) {
+            PROFILE_ZONE("EngineCore::Update");
+            for (uint32_t i = 0; i < updates; i++) {
+                m_UpdateCallback(m_FrameTimer.GetFixedStep());
+            }
         }
+        
+        // Render here
+        if (m_FrameCallback) {
+            PROFILE_ZONE("EngineCore::FrameCallback");
+            m_FrameCallback();
+        }
+        m_pJobSystem->Wait(m_FrameJobs);
+        commands.Present();
+
+        // Present can wait on this thread's window, so keep handling
+        // messages while the render thread finishes the last frame
+        {
+            PROFILE_ZONE("EngineCore::SubmitFrame");
+            while (m_bRunning && !m_pRenderThread->SubmitFrame(1)) {
+                PumpMessages();
+            }
+        }
+
+        // Sleep off what is left of the frame, if capped
+        {
+            PROFILE_ZONE("EngineCore::Pace");
+            m_FrameTimer.EndFrame();
+        }
+        Profiler::EndFrame();
+    }
+}
+
+void EngineCore::PumpMessages() {
+    MSG msg = {};
+    while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE)) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
     }
 }
 
 void EngineCore::Shutdown() {
+    // Finish what jobs are running before the subsystems they use go away
+    if (m_pJobSystem) {
+        m_pJobSystem->Wait(m_FrameJobs);
+        m_pJobSystem->RunMainThreadJobs();
+        m_pJobSystem.reset();
+    }
+
+    // Hands the renderer and device back to this thread
+    if (m_pRenderThread) {
+        m_pRenderThread->Stop();
+        m_pRenderThread.reset();
+    }
+
+    if (m_pAssetLoader) {
+        m_pAssetLoader->Cleanup();
+        m_pAssetLoader.reset();
+    }
+
     if (m_pRenderer) {
         m_pRenderer->Cleanup();
         m_pRenderer.reset();
@@ -116,10 +219,14 @@ LRESULT CALLBACK EngineCore::WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPA
             return 0;
 
         case WM_SIZE:
-            if (pEngine->GetGraphicsDevice()) {
+            {
+                // The device belongs to the render thread, which resizes
+                // before its next frame; minimising reports 0 x 0
                 UINT width = LOWORD(lParam);
                 UINT height = HIWORD(lParam);
-                pEngine->GetGraphicsDevice()->Resize(width, height);
+                if (width > 0 && height > 0) {
+                    pEngine->m_PendingSize.store(width << 16 | height, std::memory_order_release);
+                }
             }
             return 0;
         }
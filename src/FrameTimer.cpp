@@ -0,0 +1,226 @@
+#include "../include/FrameTimer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+using std::min;
+using std::max;
+
+// The estimate starts pessimistic and adapts within a few frames
+static const int64_t INITIAL_OVERSHOOT_ESTIMATE_NS = 500000;
+// Only the last stretch before a deadline is yielded through rather than
+// slept, so the loop never spins for longer than this
+static const int64_t SPIN_WINDOW_NS = 50000;
+
+FrameTimer::FrameTimer() :
+    m_StepNs(1000000000 / 120),
+    m_MaxSteps(8),
+    m_PeriodNs(0),
+    m_FrameStartNs(0),
+    m_DeadlineNs(0),
+    m_DeltaNs(0),
+    m_AccumulatorNs(0),
+    m_FrameCount(0),
+    m_StepCount(0),
+    m_Current(),
+    m_History(HISTORY_SIZE),
+    m_HistoryNext(0),
+    m_HistoryCount(0),
+    m_DroppedSteps(0),
+    m_OvershootNext(0),
+    m_OvershootCount(0),
+    m_OvershootEstimateNs(INITIAL_OVERSHOOT_ESTIMATE_NS) {
+#ifdef _WIN32
+    // Sleeps as short as the timer allows; without it Sleep(1) can take a
+    // whole 15.6 ms scheduler tick
+    m_hTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!m_hTimer) {
+        timeBeginPeriod(1);
+    }
+#endif
+}
+
+FrameTimer::~FrameTimer() {
+#ifdef _WIN32
+    if (m_hTimer) {
+        CloseHandle(m_hTimer);
+    } else {
+        timeEndPeriod(1);
+    }
+#endif
+}
+
+void FrameTimer::SetFixedStep(double stepSeconds) {
+    m_StepNs = max((int64_t)1, (int64_t)llround(stepSeconds * 1e9));
+    m_AccumulatorNs = min(m_AccumulatorNs, m_StepNs - 1);
+}
+
+void FrameTimer::SetTargetFps(double fps) {
+    m_PeriodNs = fps > 0.0 ? (int64_t)llround(1e9 / fps) : 0;
+    m_DeadlineNs = 0;
+}
+
+void FrameTimer::Reset() {
+    m_FrameStartNs = 0;
+    m_DeadlineNs = 0;
+    m_AccumulatorNs = 0;
+}
+
+uint32_t FrameTimer::BeginFrame() {
+    int64_t nowNs = GetTimeNs();
+
+    if (m_FrameStartNs != 0) {
+        m_DeltaNs = nowNs - m_FrameStartNs;
+
+        // Finish the previous frame's record
+        m_Current.frameMs = (double)m_DeltaNs * 1e-6;
+        m_Current.lateMs = m_DeadlineNs != 0 ? max(0.0, (double)(nowNs - m_DeadlineNs) * 1e-6) : 0.0;
+        m_History[m_HistoryNext] = m_Current;
+        m_HistoryNext = (m_HistoryNext + 1) % HISTORY_SIZE;
+        m_HistoryCount = min(m_HistoryCount + 1, (size_t)HISTORY_SIZE);
+    } else {
+        m_DeltaNs = 0;
+    }
+    m_FrameStartNs = nowNs;
+    m_FrameCount++;
+
+    m_AccumulatorNs += m_DeltaNs;
+    int64_t steps = m_AccumulatorNs / m_StepNs;
+    m_AccumulatorNs -= steps * m_StepNs;
+    if (steps > (int64_t)m_MaxSteps) {
+        m_DroppedSteps += (uint64_t)(steps - m_MaxSteps);
+        steps = m_MaxSteps;
+    }
+    m_StepCount += (uint64_t)steps;
+
+    m_Current = FrameTiming();
+    m_Current.updates = (uint32_t)steps;
+    m_Current.alpha = GetAlpha();
+    return (uint32_t)steps;
+}
+
+void FrameTimer::EndFrame() {
+    int64_t nowNs = GetTimeNs();
+    m_Current.workMs = (double)(nowNs - m_FrameStartNs) * 1e-6;
+
+    if (m_PeriodNs <= 0) {
+        m_DeadlineNs = 0;
+        return;
+    }
+
+    // One period after the last deadline; a frame that overran by more
+    // than a whole period starts the schedule again from now
+    m_DeadlineNs = m_DeadlineNs != 0 ? m_DeadlineNs + m_PeriodNs : m_FrameStartNs + m_PeriodNs;
+    if (nowNs - m_DeadlineNs > m_PeriodNs) {
+        m_DeadlineNs = nowNs;
+    }
+
+    SleepUntil(m_DeadlineNs);
+    m_Current.waitMs = (double)(GetTimeNs() - nowNs) * 1e-6;
+}
+
+void FrameTimer::SleepUntil(int64_t deadlineNs) {
+    // Aim each sleep at the start of the spin window, asking for less by
+    // however much sleeps have been running over; a sleep that wakes early
+    // just leaves another, shorter one. Closer in than the overshoot, take
+    // the shortest sleep there is: a frame a little late beats a core spun
+    for (;;) {
+        int64_t startNs = GetTimeNs();
+        int64_t sleepNs = deadlineNs - SPIN_WINDOW_NS - startNs;
+        if (sleepNs <= 0) {
+            break;
+        }
+        int64_t requestNs = max((int64_t)1, sleepNs - m_OvershootEstimateNs);
+        SleepFor(requestNs);
+
+        m_OvershootNs[m_OvershootNext] = max((int64_t)0, GetTimeNs() - startNs - requestNs);
+        m_OvershootNext = (m_OvershootNext + 1) % OVERSHOOT_SAMPLES;
+        m_OvershootCount = min(m_OvershootCount + 1, (uint32_t)OVERSHOOT_SAMPLES);
+
+        // Third quartile of the recent samples
+        int64_t sorted[OVERSHOOT_SAMPLES];
+        std::copy(m_OvershootNs, m_OvershootNs + m_OvershootCount, sorted);
+        int64_t* pQuartile = sorted + m_OvershootCount * 3 / 4;
+        std::nth_element(sorted, pQuartile, sorted + m_OvershootCount);
+        m_OvershootEstimateNs = *pQuartile;
+    }
+
+    // Too close to trust the OS with: give the core away a slice at a time
+    int64_t spinStartNs = GetTimeNs();
+    int64_t nowNs = spinStartNs;
+    while (nowNs < deadlineNs) {
+        std::this_thread::yield();
+        nowNs = GetTimeNs();
+    }
+    m_Current.spinMs = (double)(nowNs - spinStartNs) * 1e-6;
+}
+
+void FrameTimer::SleepFor(int64_t durationNs) {
+#ifdef _WIN32
+    if (m_hTimer) {
+        // Relative due time in 100 ns units
+        LARGE_INTEGER dueTime;
+        dueTime.QuadPart = -max((int64_t)1, durationNs / 100);
+        if (SetWaitableTimerEx(m_hTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+            WaitForSingleObject(m_hTimer, INFINITE);
+            return;
+        }
+    }
+    // Whole milliseconds only; the rounding shows up as overshoot
+    Sleep((DWORD)max((int64_t)1, durationNs / 1000000));
+#else
+    std::this_thread::sleep_for(std::chrono::nanoseconds(durationNs));
+#endif
+}
+
+size_t FrameTimer::GetHistoryCount() const {
+    return m_HistoryCount;
+}
+
+const FrameTiming& FrameTimer::GetHistory(size_t index) const {
+    size_t oldest = (m_HistoryNext + HISTORY_SIZE - m_HistoryCount) % HISTORY_SIZE;
+    return m_History[(oldest + index) % HISTORY_SIZE];
+}
+
+FrameStats FrameTimer::GetStats() const {
+    FrameStats stats = {};
+    stats.frames = (uint32_t)m_HistoryCount;
+    stats.droppedSteps = m_DroppedSteps;
+    if (m_HistoryCount == 0) {
+        return stats;
+    }
+
+    std::vector<double> frameTimes(m_HistoryCount);
+    double sum = 0.0;
+    double waitSum = 0.0;
+    double spinSum = 0.0;
+    for (size_t i = 0; i < m_HistoryCount; i++) {
+        const FrameTiming& timing = GetHistory(i);
+        frameTimes[i] = timing.frameMs;
+        sum += timing.frameMs;
+        waitSum += timing.waitMs;
+        spinSum += timing.spinMs;
+    }
+    stats.meanMs = sum / (double)m_HistoryCount;
+    stats.meanWaitMs = waitSum / (double)m_HistoryCount;
+    stats.meanSpinMs = spinSum / (double)m_HistoryCount;
+
+    double variance = 0.0;
+    for (double frameMs : frameTimes) {
+        variance += (frameMs - stats.meanMs) * (frameMs - stats.meanMs);
+    }
+    stats.jitterMs = sqrt(variance / (double)m_HistoryCount);
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    stats.p99Ms = frameTimes[min(frameTimes.size() - 1, frameTimes.size() * 99 / 100)];
+    stats.maxMs = frameTimes.back();
+    return stats;
+}
+
+int64_t FrameTimer::GetTimeNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "../include/GeometryArena.h"
+#include <algorithm>
+using std::min;
+
+GeometryArena::GeometryArena(RingBufferAllocator* pVertexRing) :
+    m_pVertexRing(pVertexRing),
+    m_pVertices(nullptr),
+    m_FirstVertex(0),
+    m_VertexCapacity(0),
+    m_VertexCount(0),
+    m_bOpen(false) {
+}
+
+bool GeometryArena::Open(uint32_t vertexCount) {
+    if (vertexCount > MAX_BATCH_VERTICES) {
+        return false;
+    }
+
+    // Grow up front if a single primitive is larger than the ring
+    if (!m_pVertexRing->Reserve(vertexCount)) {
+        return false;
+    }
+
+    m_pVertices = (uint8_t*)m_pVertexRing->MapSpan(vertexCount, m_FirstVertex, m_VertexCapacity);
+    if (!m_pVertices) {
+        return false;
+    }
+    m_VertexCapacity = min(m_VertexCapacity, MAX_BATCH_VERTICES);
+
+    m_VertexCount = 0;
+    m_bOpen = true;
+    return true;
+}
+
+bool GeometryArena::Append(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) {
+    if (!m_bOpen && !Open(vertexCount)) {
+        return false;
+    }
+
+    if (m_VertexCount + vertexCount > m_VertexCapacity) {
+        return false;
+    }
+
+    pVertices = m_pVertices + (size_t)m_VertexCount * m_pVertexRing->GetStride();
+    baseVertex = m_VertexCount;
+
+    m_VertexCount += vertexCount;
+    return true;
+}
+
+bool GeometryArena::Close(uint32_t& firstVertex, uint32_t& vertexCount) {
+    if (!m_bOpen) {
+        return false;
+    }
+
+    m_pVertexRing->UnmapSpan(m_VertexCount);
+    m_bOpen = false;
+
+    firstVertex = m_FirstVertex;
+    vertexCount = m_VertexCount;
+
+    return m_VertexCount > 0;
+}
\ No newline at end of file
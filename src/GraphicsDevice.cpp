@@ -1,4 +1,5 @@
 #include "../include/GraphicsDevice.h"
+#include "../include/Profiler.h"
 #include <dxgi1_4.h>
 #include <d3dcompiler.h>
 
@@ -155,17 +156,20 @@ bool GraphicsDevice::CreateRasterizerState() {
 }
 
 void GraphicsDevice::BeginFrame(float r, float g, float b, float a) {
+    PROFILE_ZONE("GraphicsDevice::BeginFrame");
     float color[4] = { r, g, b, a };
     m_pDeviceContext->ClearRenderTargetView(m_pRenderTargetView.Get(), color);
     m_pDeviceContext->ClearDepthStencilView(m_pDepthStencilView.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
     m_pDeviceContext->OMSetRenderTargets(1, m_pRenderTargetView.GetAddressOf(), m_pDepthStencilView.Get());
 }
 
-void GraphicsDevice::EndFrame() {
-    m_pSwapChain->Present(1, 0);
+void GraphicsDevice::EndFrame(bool bVSync) {
+    PROFILE_ZONE("GraphicsDevice::EndFrame");
+    m_pSwapChain->Present(bVSync ? 1 : 0, 0);
 }
 
 void GraphicsDevice::Resize(UINT width, UINT height) {
+    PROFILE_ZONE("GraphicsDevice::Resize");
     if (m_pDevice && m_pSwapChain) {
         m_pDeviceContext->OMSetRenderTargets(0, 0, 0);
         
@@ -0,0 +1,655 @@
+#include "../include/ImageDecoder.h"
+#include "../include/Inflate.h"
+#include "../include/PixelConvert.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+using std::min;
+using std::max;
+
+// Reject headers that would need absurd allocations
+static const uint32_t MAX_IMAGE_DIMENSION = 16384;
+
+static inline uint32_t ReadBE32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint16_t ReadLE16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t ReadLE32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool AllocateImage(Image& image, uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0 || width > MAX_IMAGE_DIMENSION || height > MAX_IMAGE_DIMENSION) {
+        return false;
+    }
+
+    image.width = width;
+    image.height = height;
+    image.pixels.assign((size_t)width * height * 4, 0);
+    return true;
+}
+
+ImageFormat DetectImageFormat(const uint8_t* pData, size_t size) {
+    static const uint8_t PNG_SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+    if (size >= 8 && memcmp(pData, PNG_SIGNATURE, 8) == 0) {
+        return ImageFormat::PNG;
+    }
+    if (size >= 2 && pData[0] == 'B' && pData[1] == 'M') {
+        return ImageFormat::BMP;
+    }
+
+    // TGA has no signature; accept headers with a supported image type
+    if (size >= 18 && pData[1] <= 1) {
+        uint8_t type = pData[2];
+        if (type == 2 || type == 3 || type == 10 || type == 11) {
+            return ImageFormat::TGA;
+        }
+    }
+    return ImageFormat::UNKNOWN;
+}
+
+bool DecodeImage(const uint8_t* pData, size_t size, Image& image) {
+    if (!pData) {
+        return false;
+    }
+
+    switch (DetectImageFormat(pData, size)) {
+    case ImageFormat::PNG: return DecodePNG(pData, size, image);
+    case ImageFormat::TGA: return DecodeTGA(pData, size, image);
+    case ImageFormat::BMP: return DecodeBMP(pData, size, image);
+    default: return false;
+    }
+}
+
+bool LoadImageFile(const std::wstring& filename, Image& image) {
+    std::ifstream file(std::filesystem::path(filename), std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size <= 0) {
+        return false;
+    }
+    file.seekg(0);
+
+    std::vector<uint8_t> data((size_t)size);
+    if (!file.read((char*)data.data(), size)) {
+        return false;
+    }
+
+    return DecodeImage(data.data(), data.size(), image);
+}
+
+void GenerateMipChain(const Image& image, std::vector<Image>& mips) {
+    mips.clear();
+    if (image.IsEmpty()) {
+        return;
+    }
+
+    const Image* pLevel = &image;
+    while (pLevel->width > 1 || pLevel->height > 1) {
+        Image next;
+        next.width = max(1u, pLevel->width / 2);
+        next.height = max(1u, pLevel->height / 2);
+        next.pixels.resize((size_t)next.width * next.height * 4);
+        DownsampleBox(pLevel->pixels.data(), pLevel->width, pLevel->height, next.pixels.data());
+
+        mips.push_back(std::move(next));
+        pLevel = &mips.back();
+    }
+}
+
+// ---------------------------------------------------------------------------
+// PNG
+
+namespace {
+
+struct PngHeader {
+    uint32_t width;
+    uint32_t height;
+    uint8_t bitDepth;
+    uint8_t colorType;
+    uint8_t interlace;
+};
+
+struct PngPalette {
+    uint8_t entries[256][4];
+    uint32_t count;
+
+    // tRNS for greyscale / true-colour: one transparent sample value
+    bool hasColorKey;
+    uint16_t colorKey[3];
+};
+
+int PngChannels(uint8_t colorType) {
+    switch (colorType) {
+    case 0: return 1;   // Greyscale
+    case 2: return 3;   // RGB
+    case 3: return 1;   // Palette index
+    case 4: return 2;   // Greyscale + alpha
+    case 6: return 4;   // RGBA
+    default: return 0;
+    }
+}
+
+bool PngValidDepth(uint8_t colorType, uint8_t bitDepth) {
+    switch (colorType) {
+    case 0: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16;
+    case 3: return bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8;
+    case 2:
+    case 4:
+    case 6: return bitDepth == 8 || bitDepth == 16;
+    default: return false;
+    }
+}
+
+inline uint8_t Paeth(uint8_t a, uint8_t b, uint8_t c) {
+    int p = (int)a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return pb <= pc ? b : c;
+}
+
+// Reverse one row's filter in place; pPrior is the unfiltered row above (or zeros)
+bool Unfilter(uint8_t filter, uint8_t* pRow, const uint8_t* pPrior, size_t rowBytes, size_t bytesPerPixel) {
+    switch (filter) {
+    case 0:
+        return true;
+    case 1:
+        for (size_t i = bytesPerPixel; i < rowBytes; i++) {
+            pRow[i] = (uint8_t)(pRow[i] + pRow[i - bytesPerPixel]);
+        }
+        return true;
+    case 2:
+        for (size_t i = 0; i < rowBytes; i++) {
+            pRow[i] = (uint8_t)(pRow[i] + pPrior[i]);
+        }
+        return true;
+    case 3:
+        for (size_t i = 0; i < rowBytes; i++) {
+            uint8_t left = i >= bytesPerPixel ? pRow[i - bytesPerPixel] : 0;
+            pRow[i] = (uint8_t)(pRow[i] + ((left + pPrior[i]) >> 1));
+        }
+        return true;
+    case 4:
+        for (size_t i = 0; i < rowBytes; i++) {
+            uint8_t left = i >= bytesPerPixel ? pRow[i - bytesPerPixel] : 0;
+            uint8_t upLeft = i >= bytesPerPixel ? pPrior[i - bytesPerPixel] : 0;
+            pRow[i] = (uint8_t)(pRow[i] + Paeth(left, pPrior[i], upLeft));
+        }
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Convert one unfiltered row to RGBA8; pixel x lands at pOut + x * outStride
+void ConvertPngRow(const PngHeader& header, const PngPalette& palette, const uint8_t* pRow,
+                   uint32_t width, uint8_t* pOut, size_t outStride) {
+    const uint8_t depth = header.bitDepth;
+
+    // Fast paths for the common 8-bit layouts written contiguously
+    if (depth == 8 && outStride == 4 && !palette.hasColorKey) {
+        if (header.colorType == 6) {
+            memcpy(pOut, pRow, (size_t)width * 4);
+            return;
+        }
+        if (header.colorType == 2) {
+            ExpandRGBToRGBA(pRow, pOut, width);
+            return;
+        }
+    }
+
+    // Sample i of the row, at the image's bit depth
+    auto sample = [&](size_t index) -> uint32_t {
+        if (depth == 8) return pRow[index];
+        if (depth == 16) return ((uint32_t)pRow[index * 2] << 8) | pRow[index * 2 + 1];
+        size_t bit = index * depth;
+        uint32_t shift = 8 - depth - (uint32_t)(bit & 7);
+        return (pRow[bit >> 3] >> shift) & ((1u << depth) - 1);
+    };
+
+    // Scale a sample to 8 bits; 16-bit keeps the high byte
+    auto toByte = [&](uint32_t value) -> uint8_t {
+        if (depth == 16) return (uint8_t)(value >> 8);
+        if (depth == 8) return (uint8_t)value;
+        return (uint8_t)(value * 255 / ((1u << depth) - 1));
+    };
+
+    for (uint32_t x = 0; x < width; x++) {
+        uint8_t* p = pOut + x * outStride;
+
+        switch (header.colorType) {
+        case 0: {
+            uint32_t grey = sample(x);
+            p[0] = p[1] = p[2] = toByte(grey);
+            p[3] = palette.hasColorKey && grey == palette.colorKey[0] ? 0 : 255;
+            break;
+        }
+        case 2: {
+            uint32_t r = sample(x * 3), g = sample(x * 3 + 1), b = sample(x * 3 + 2);
+            p[0] = toByte(r);
+            p[1] = toByte(g);
+            p[2] = toByte(b);
+            p[3] = palette.hasColorKey && r == palette.colorKey[0] && g == palette.colorKey[1] &&
+                   b == palette.colorKey[2] ? 0 : 255;
+            break;
+        }
+        case 3: {
+            uint32_t index = sample(x);
+            if (index < palette.count) {
+                memcpy(p, palette.entries[index], 4);
+            } else {
+                p[0] = p[1] = p[2] = 0;
+                p[3] = 255;
+            }
+            break;
+        }
+        case 4:
+            p[0] = p[1] = p[2] = toByte(sample(x * 2));
+            p[3] = toByte(sample(x * 2 + 1));
+            break;
+        case 6:
+            p[0] = toByte(sample(x * 4));
+            p[1] = toByte(sample(x * 4 + 1));
+            p[2] = toByte(sample(x * 4 + 2));
+            p[3] = toByte(sample(x * 4 + 3));
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool DecodePNG(const uint8_t* pData, size_t size, Image& image) {
+    if (DetectImageFormat(pData, size) != ImageFormat::PNG) {
+        return false;
+    }
+
+    PngHeader header = {};
+    PngPalette palette = {};
+    std::vector<uint8_t> compressed;
+    bool hasHeader = false;
+    bool hasEnd = false;
+
+    // Gather chunks
+    size_t offset = 8;
+    while (offset + 12 <= size && !hasEnd) {
+        uint32_t length = ReadBE32(pData + offset);
+        const uint8_t* pType = pData + offset + 4;
+        const uint8_t* pChunk = pData + offset + 8;
+        if (length > size - offset - 12) {
+            return false;
+        }
+
+        if (memcmp(pType, "IHDR", 4) == 0) {
+            if (length < 13) return false;
+            header.width = ReadBE32(pChunk);
+            header.height = ReadBE32(pChunk + 4);
+            header.bitDepth = pChunk[8];
+            header.colorType = pChunk[9];
+            header.interlace = pChunk[12];
+            if (pChunk[10] != 0 || pChunk[11] != 0 || header.interlace > 1 ||
+                !PngValidDepth(header.colorType, header.bitDepth)) {
+                return false;
+            }
+            hasHeader = true;
+        } else if (memcmp(pType, "PLTE", 4) == 0) {
+            palette.count = min(256u, length / 3);
+            for (uint32_t i = 0; i < palette.count; i++) {
+                palette.entries[i][0] = pChunk[i * 3];
+                palette.entries[i][1] = pChunk[i * 3 + 1];
+                palette.entries[i][2] = pChunk[i * 3 + 2];
+                palette.entries[i][3] = 255;
+            }
+        } else if (memcmp(pType, "tRNS", 4) == 0) {
+            if (header.colorType == 3) {
+                for (uint32_t i = 0; i < min(length, 256u); i++) {
+                    palette.entries[i][3] = pChunk[i];
+                }
+            } else if (header.colorType == 0 && length >= 2) {
+                palette.hasColorKey = true;
+                palette.colorKey[0] = (uint16_t)((pChunk[0] << 8) | pChunk[1]);
+            } else if (header.colorType == 2 && length >= 6) {
+                palette.hasColorKey = true;
+                for (int c = 0; c < 3; c++) {
+                    palette.colorKey[c] = (uint16_t)((pChunk[c * 2] << 8) | pChunk[c * 2 + 1]);
+                }
+            }
+        } else if (memcmp(pType, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), pChunk, pChunk + length);
+        } else if (memcmp(pType, "IEND", 4) == 0) {
+            hasEnd = true;
+        } else if (!(pType[0] & 0x20)) {
+            // Unknown critical chunk
+            return false;
+        }
+
+        offset += (size_t)length + 12;
+    }
+
+    if (!hasHeader || compressed.empty() || (header.colorType == 3 && palette.count == 0)) {
+        return false;
+    }
+    if (!AllocateImage(image, header.width, header.height)) {
+        return false;
+    }
+
+    const size_t bitsPerPixel = (size_t)PngChannels(header.colorType) * header.bitDepth;
+    const size_t bytesPerPixel = max((size_t)1, bitsPerPixel / 8);
+
+    // Adam7 passes: origin and step; a non-interlaced image is one 1x1-step pass
+    static const uint32_t ADAM7[7][4] = {
+        { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 },
+        { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 } };
+    static const uint32_t SINGLE_PASS[1][4] = { { 0, 0, 1, 1 } };
+    const uint32_t (*pPasses)[4] = header.interlace ? ADAM7 : SINGLE_PASS;
+    int passCount = header.interlace ? 7 : 1;
+
+    size_t expectedSize = 0;
+    for (int pass = 0; pass < passCount; pass++) {
+        uint32_t passWidth = (header.width - pPasses[pass][0] + pPasses[pass][2] - 1) / pPasses[pass][2];
+        uint32_t passHeight = (header.height - pPasses[pass][1] + pPasses[pass][3] - 1) / pPasses[pass][3];
+        if (header.width > pPasses[pass][0] && header.height > pPasses[pass][1]) {
+            expectedSize += ((passWidth * bitsPerPixel + 7) / 8 + 1) * passHeight;
+        }
+    }
+
+    std::vector<uint8_t> raw;
+    if (!InflateZlib(compressed.data(), compressed.size(), raw, expectedSize) || raw.size() < expectedSize) {
+        return false;
+    }
+
+    const uint8_t* pRaw = raw.data();
+    std::vector<uint8_t> prior;
+    for (int pass = 0; pass < passCount; pass++) {
+        uint32_t x0 = pPasses[pass][0], y0 = pPasses[pass][1];
+        uint32_t dx = pPasses[pass][2], dy = pPasses[pass][3];
+        if (header.width <= x0 || header.height <= y0) {
+            continue;
+        }
+
+        uint32_t passWidth = (header.width - x0 + dx - 1) / dx;
+        uint32_t passHeight = (header.height - y0 + dy - 1) / dy;
+        size_t rowBytes = (passWidth * bitsPerPixel + 7) / 8;
+        prior.assign(rowBytes, 0);
+
+        for (uint32_t y = 0; y < passHeight; y++) {
+            // Rows are unfiltered in place inside the inflated buffer
+            uint8_t filter = pRaw[0];
+            uint8_t* pRow = (uint8_t*)pRaw + 1;
+            if (!Unfilter(filter, pRow, prior.data(), rowBytes, bytesPerPixel)) {
+                return false;
+            }
+
+            uint8_t* pOut = &image.pixels[(((size_t)(y0 + y * dy)) * header.width + x0) * 4];
+            ConvertPngRow(header, palette, pRow, passWidth, pOut, (size_t)dx * 4);
+
+            memcpy(prior.data(), pRow, rowBytes);
+            pRaw += rowBytes + 1;
+        }
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// TGA
+
+bool DecodeTGA(const uint8_t* pData, size_t size, Image& image) {
+    if (size < 18) {
+        return false;
+    }
+
+    uint8_t idLength = pData[0];
+    uint8_t colorMapType = pData[1];
+    uint8_t imageType = pData[2];
+    uint16_t colorMapLength = ReadLE16(pData + 5);
+    uint8_t colorMapEntryBits = pData[7];
+    uint16_t width = ReadLE16(pData + 12);
+    uint16_t height = ReadLE16(pData + 14);
+    uint8_t pixelDepth = pData[16];
+    uint8_t descriptor = pData[17];
+
+    bool rle = imageType == 10 || imageType == 11;
+    bool grey = imageType == 3 || imageType == 11;
+    if (!(imageType == 2 || imageType == 3 || rle) || colorMapType > 1) {
+        return false;
+    }
+    if (grey ? pixelDepth != 8 : (pixelDepth != 16 && pixelDepth != 24 && pixelDepth != 32)) {
+        return false;
+    }
+
+    size_t offset = 18 + idLength;
+    if (colorMapType == 1) {
+        offset += ((size_t)colorMapLength * colorMapEntryBits + 7) / 8;
+    }
+    if (offset > size || !AllocateImage(image, width, height)) {
+        return false;
+    }
+
+    // Unpack to the file's own pixel layout first, then convert in bulk
+    const size_t bytesPerPixel = pixelDepth / 8;
+    const size_t pixelCount = (size_t)width * height;
+    std::vector<uint8_t> source;
+    const uint8_t* pSource = pData + offset;
+
+    if (rle) {
+        source.resize(pixelCount * bytesPerPixel);
+        size_t written = 0;
+        while (written < pixelCount) {
+            if (offset >= size) return false;
+            uint8_t packet = pData[offset++];
+            size_t count = min((size_t)(packet & 0x7F) + 1, pixelCount - written);
+
+            if (packet & 0x80) {
+                if (offset + bytesPerPixel > size) return false;
+                for (size_t i = 0; i < count; i++) {
+                    memcpy(&source[(written + i) * bytesPerPixel], pData + offset, bytesPerPixel);
+                }
+                offset += bytesPerPixel;
+            } else {
+                if (offset + count * bytesPerPixel > size) return false;
+                memcpy(&source[written * bytesPerPixel], pData + offset, count * bytesPerPixel);
+                offset += count * bytesPerPixel;
+            }
+            written += count;
+        }
+        pSource = source.data();
+    } else if (size - offset < pixelCount * bytesPerPixel) {
+        return false;
+    }
+
+    // Bit 5 set means rows are stored top-down, bit 4 right-to-left
+    bool topDown = (descriptor & 0x20) != 0;
+    bool rightToLeft = (descriptor & 0x10) != 0;
+    bool hasAlpha = (descriptor & 0x0F) != 0;
+
+    for (uint32_t y = 0; y < height; y++) {
+        const uint8_t* pRow = pSource + (size_t)y * width * bytesPerPixel;
+        uint32_t dstY = topDown ? y : height - 1 - y;
+        uint8_t* pOut = &image.pixels[(size_t)dstY * width * 4];
+
+        if (pixelDepth == 32) {
+            SwizzleBGRAToRGBA(pRow, pOut, width);
+            if (!hasAlpha) {
+                for (uint32_t x = 0; x < width; x++) pOut[x * 4 + 3] = 255;
+            }
+        } else if (pixelDepth == 24) {
+            ExpandRGBToRGBA(pRow, pOut, width, true);
+        } else if (pixelDepth == 16) {
+            // A1R5G5B5
+            for (uint32_t x = 0; x < width; x++) {
+                uint16_t pixel = ReadLE16(pRow + x * 2);
+                pOut[x * 4 + 0] = (uint8_t)(((pixel >> 10) & 0x1F) * 255 / 31);
+                pOut[x * 4 + 1] = (uint8_t)(((pixel >> 5) & 0x1F) * 255 / 31);
+                pOut[x * 4 + 2] = (uint8_t)((pixel & 0x1F) * 255 / 31);
+                pOut[x * 4 + 3] = hasAlpha && !(pixel & 0x8000) ? 0 : 255;
+            }
+        } else {
+            for (uint32_t x = 0; x < width; x++) {
+                pOut[x * 4 + 0] = pOut[x * 4 + 1] = pOut[x * 4 + 2] = pRow[x];
+                pOut[x * 4 + 3] = 255;
+            }
+        }
+
+        if (rightToLeft) {
+            uint32_t* pPixels = (uint32_t*)pOut;
+            std::reverse(pPixels, pPixels + width);
+        }
+    }
+
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// BMP
+
+namespace {
+
+// Extract a channel described by a BI_BITFIELDS mask and scale it to 8 bits
+struct BitfieldChannel {
+    uint32_t mask;
+    uint32_t shift;
+    uint32_t max;
+
+    void Set(uint32_t channelMask) {
+        mask = channelMask;
+        shift = 0;
+        max = 0;
+        if (!mask) return;
+        while (!((mask >> shift) & 1)) shift++;
+        max = mask >> shift;
+    }
+
+    uint8_t Extract(uint32_t pixel, uint8_t fallback) const {
+        if (!mask) return fallback;
+        return (uint8_t)((((pixel & mask) >> shift) * 255 + max / 2) / max);
+    }
+};
+
+} // namespace
+
+bool DecodeBMP(const uint8_t* pData, size_t size, Image& image) {
+    if (size < 26 || pData[0] != 'B' || pData[1] != 'M') {
+        return false;
+    }
+
+    uint32_t pixelOffset = ReadLE32(pData + 10);
+    uint32_t headerSize = ReadLE32(pData + 14);
+    if (headerSize < 40 || 14 + (size_t)headerSize > size) {
+        return false;
+    }
+
+    int32_t width = (int32_t)ReadLE32(pData + 18);
+    int32_t height = (int32_t)ReadLE32(pData + 22);
+    uint16_t bitCount = ReadLE16(pData + 28);
+    uint32_t compression = ReadLE32(pData + 30);
+    uint32_t colorsUsed = ReadLE32(pData + 46);
+
+    const uint32_t BI_RGB = 0;
+    const uint32_t BI_BITFIELDS = 3;
+    const uint32_t BI_ALPHABITFIELDS = 6;
+
+    bool topDown = height < 0;
+    uint32_t absHeight = topDown ? (uint32_t)(-(int64_t)height) : (uint32_t)height;
+    if (width <= 0 || !AllocateImage(image, (uint32_t)width, absHeight)) {
+        return false;
+    }
+
+    bool bitfields = compression == BI_BITFIELDS || compression == BI_ALPHABITFIELDS;
+    if (!(compression == BI_RGB || bitfields)) {
+        return false;
+    }
+    if (!(bitCount == 8 || bitCount == 16 || bitCount == 24 || bitCount == 32) ||
+        (bitfields && bitCount != 16 && bitCount != 32)) {
+        return false;
+    }
+
+    // Masks live in the V4/V5 header, or just after a 40-byte header
+    BitfieldChannel channels[4];
+    if (bitfields) {
+        size_t maskOffset = 14 + 40;
+        int maskCount = compression == BI_ALPHABITFIELDS || headerSize >= 56 ? 4 : 3;
+        if (maskOffset + maskCount * 4 > size) {
+            return false;
+        }
+        for (int c = 0; c < 4; c++) {
+            channels[c].Set(c < maskCount ? ReadLE32(pData + maskOffset + c * 4) : 0);
+        }
+    } else if (bitCount == 16) {
+        // X1R5G5B5
+        channels[0].Set(0x7C00);
+        channels[1].Set(0x03E0);
+        channels[2].Set(0x001F);
+        channels[3].Set(0);
+    }
+
+    uint8_t palette[256][4] = {};
+    if (bitCount == 8) {
+        uint32_t paletteCount = colorsUsed ? min(colorsUsed, 256u) : 256u;
+        size_t paletteOffset = 14 + (size_t)headerSize;
+        if (paletteOffset + paletteCount * 4 > size) {
+            return false;
+        }
+        for (uint32_t i = 0; i < paletteCount; i++) {
+            const uint8_t* pEntry = pData + paletteOffset + i * 4;
+            palette[i][0] = pEntry[2];
+            palette[i][1] = pEntry[1];
+            palette[i][2] = pEntry[0];
+            palette[i][3] = 255;
+        }
+    }
+
+    size_t rowBytes = (((size_t)width * bitCount + 31) / 32) * 4;
+    if (pixelOffset > size || (size - pixelOffset) / rowBytes < absHeight) {
+        return false;
+    }
+
+    bool anyAlpha = false;
+    for (uint32_t y = 0; y < absHeight; y++) {
+        const uint8_t* pRow = pData + pixelOffset + (size_t)y * rowBytes;
+        uint32_t dstY = topDown ? y : absHeight - 1 - y;
+        uint8_t* pOut = &image.pixels[(size_t)dstY * width * 4];
+
+        if (bitCount == 24) {
+            ExpandRGBToRGBA(pRow, pOut, width, true);
+        } else if (bitCount == 32 && !bitfields) {
+            SwizzleBGRAToRGBA(pRow, pOut, width);
+            for (int32_t x = 0; x < width && !anyAlpha; x++) {
+                anyAlpha = pOut[x * 4 + 3] != 0;
+            }
+        } else if (bitCount == 8) {
+            for (int32_t x = 0; x < width; x++) {
+                memcpy(pOut + x * 4, palette[pRow[x]], 4);
+            }
+        } else {
+            for (int32_t x = 0; x < width; x++) {
+                uint32_t pixel = bitCount == 32 ? ReadLE32(pRow + x * 4) : ReadLE16(pRow + x * 2);
+                pOut[x * 4 + 0] = channels[0].Extract(pixel, 0);
+                pOut[x * 4 + 1] = channels[1].Extract(pixel, 0);
+                pOut[x * 4 + 2] = channels[2].Extract(pixel, 0);
+                pOut[x * 4 + 3] = channels[3].Extract(pixel, 255);
+            }
+        }
+    }
+
+    // BI_RGB 32-bit files usually leave the fourth byte zero: treat as opaque
+    if (bitCount == 32 && !bitfields && !anyAlpha) {
+        for (size_t i = 3; i < image.pixels.size(); i += 4) {
+            image.pixels[i] = 255;
+        }
+    }
+
+    return true;
+}
\ No newline at end of file
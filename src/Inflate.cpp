@@ -0,0 +1,335 @@
+#include "../include/Inflate.h"
+#include <cstring>
+
+namespace {
+
+// Little-endian bit reader; refills up to 64 bits at a time. Reading past
+// the end yields zeros and only fails once those bits are consumed.
+class BitReader {
+public:
+    BitReader(const uint8_t* pData, size_t size) :
+        m_pData(pData), m_Size(size), m_Position(0), m_Bits(0), m_BitCount(0), m_bOverrun(false) {}
+
+    void Refill() {
+        while (m_BitCount <= 56) {
+            if (m_Position < m_Size) {
+                m_Bits |= (uint64_t)m_pData[m_Position] << m_BitCount;
+            }
+            m_Position++;
+            m_BitCount += 8;
+        }
+    }
+
+    uint32_t Peek(int count) {
+        if (m_BitCount < count) Refill();
+        return (uint32_t)(m_Bits & ((1ull << count) - 1));
+    }
+
+    void Consume(int count) {
+        m_Bits >>= count;
+        m_BitCount -= count;
+        if (m_Position - m_BitCount / 8 > m_Size) m_bOverrun = true;
+    }
+
+    uint32_t Read(int count) {
+        if (count == 0) return 0;
+        uint32_t value = Peek(count);
+        Consume(count);
+        return value;
+    }
+
+    // Drop to a byte boundary and return the unread byte offset,
+    // handing any buffered whole bytes back
+    size_t AlignToByte() {
+        Consume(m_BitCount & 7);
+        size_t position = m_Position - m_BitCount / 8;
+        m_Bits = 0;
+        m_BitCount = 0;
+        m_Position = position;
+        return position;
+    }
+
+    void Skip(size_t bytes) { m_Position += bytes; }
+    bool HasOverrun() const { return m_bOverrun; }
+
+private:
+    const uint8_t* m_pData;
+    size_t m_Size;
+    size_t m_Position;
+    uint64_t m_Bits;
+    int m_BitCount;
+    bool m_bOverrun;
+};
+
+// Canonical Huffman table: a FAST_BITS lookup for short codes, then a
+// per-length walk for the rest
+class Huffman {
+public:
+    static const int FAST_BITS = 10;
+    static const int MAX_BITS = 15;
+
+    bool Build(const uint8_t* pLengths, int count) {
+        int lengthCounts[MAX_BITS + 1] = {};
+        for (int i = 0; i < count; i++) {
+            lengthCounts[pLengths[i]]++;
+        }
+        lengthCounts[0] = 0;
+
+        // Reject over-subscribed code sets
+        int left = 1;
+        for (int length = 1; length <= MAX_BITS; length++) {
+            left = (left << 1) - lengthCounts[length];
+            if (left < 0) return false;
+        }
+
+        int offsets[MAX_BITS + 2];
+        offsets[1] = 0;
+        for (int length = 1; length <= MAX_BITS; length++) {
+            offsets[length + 1] = offsets[length] + lengthCounts[length];
+            m_Counts[length] = (uint16_t)lengthCounts[length];
+        }
+        for (int i = 0; i < count; i++) {
+            if (pLengths[i]) m_Symbols[offsets[pLengths[i]]++] = (uint16_t)i;
+        }
+
+        // Fast table entries are (symbol << 4) | length; 0 means slow path
+        memset(m_Fast, 0, sizeof(m_Fast));
+        int code = 0;
+        int index = 0;
+        for (int length = 1; length <= FAST_BITS; length++) {
+            for (int n = 0; n < lengthCounts[length]; n++, code++, index++) {
+                // DEFLATE codes are stored MSB first; the reader is LSB first
+                int reversed = 0;
+                for (int b = 0; b < length; b++) {
+                    reversed |= ((code >> b) & 1) << (length - 1 - b);
+                }
+                for (int fill = reversed; fill < (1 << FAST_BITS); fill += 1 << length) {
+                    m_Fast[fill] = (uint16_t)((m_Symbols[index] << 4) | length);
+                }
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    int Decode(BitReader& reader) const {
+        uint32_t bits = reader.Peek(MAX_BITS);
+        uint16_t entry = m_Fast[bits & ((1 << FAST_BITS) - 1)];
+        if (entry) {
+            reader.Consume(entry & 15);
+            return entry >> 4;
+        }
+
+        // Canonical decode, one bit at a time
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int length = 1; length <= MAX_BITS; length++) {
+            code |= (bits >> (length - 1)) & 1;
+            int count = m_Counts[length];
+            if (code - first < count) {
+                reader.Consume(length);
+                return m_Symbols[index + (code - first)];
+            }
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+private:
+    uint16_t m_Fast[1 << FAST_BITS];
+    uint16_t m_Counts[MAX_BITS + 1] = {};
+    uint16_t m_Symbols[288];
+};
+
+const uint16_t LENGTH_BASE[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8_t LENGTH_EXTRA[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16_t DISTANCE_BASE[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8_t DISTANCE_EXTRA[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+bool InflateBlock(BitReader& reader, const Huffman& literals, const Huffman& distances, std::vector<uint8_t>& out) {
+    for (;;) {
+        int symbol = literals.Decode(reader);
+        if (symbol < 0 || reader.HasOverrun()) {
+            return false;
+        }
+
+        if (symbol < 256) {
+            out.push_back((uint8_t)symbol);
+            continue;
+        }
+        if (symbol == 256) {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= 29) {
+            return false;
+        }
+        size_t length = LENGTH_BASE[symbol] + reader.Read(LENGTH_EXTRA[symbol]);
+
+        int distanceSymbol = distances.Decode(reader);
+        if (distanceSymbol < 0 || distanceSymbol >= 30) {
+            return false;
+        }
+        size_t distance = DISTANCE_BASE[distanceSymbol] + reader.Read(DISTANCE_EXTRA[distanceSymbol]);
+        if (distance > out.size()) {
+            return false;
+        }
+
+        // Copies may overlap their own output, so go byte by byte when close
+        size_t start = out.size() - distance;
+        out.resize(out.size() + length);
+        uint8_t* pDst = &out[out.size() - length];
+        const uint8_t* pSrc = &out[start];
+        if (distance >= length) {
+            memcpy(pDst, pSrc, length);
+        } else {
+            for (size_t i = 0; i < length; i++) {
+                pDst[i] = pSrc[i];
+            }
+        }
+    }
+}
+
+bool BuildFixedTables(Huffman& literals, Huffman& distances) {
+    uint8_t lengths[288];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    if (!literals.Build(lengths, 288)) return false;
+
+    memset(lengths, 5, 30);
+    return distances.Build(lengths, 30);
+}
+
+bool ReadDynamicTables(BitReader& reader, Huffman& literals, Huffman& distances) {
+    static const uint8_t CODE_LENGTH_ORDER[19] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    int literalCount = reader.Read(5) + 257;
+    int distanceCount = reader.Read(5) + 1;
+    int codeLengthCount = reader.Read(4) + 4;
+
+    uint8_t codeLengths[19] = {};
+    for (int i = 0; i < codeLengthCount; i++) {
+        codeLengths[CODE_LENGTH_ORDER[i]] = (uint8_t)reader.Read(3);
+    }
+
+    Huffman codeLengthTable;
+    if (!codeLengthTable.Build(codeLengths, 19)) {
+        return false;
+    }
+
+    uint8_t lengths[288 + 32] = {};
+    int total = literalCount + distanceCount;
+    int n = 0;
+    while (n < total) {
+        int symbol = codeLengthTable.Decode(reader);
+        if (symbol < 0 || reader.HasOverrun()) {
+            return false;
+        }
+
+        if (symbol < 16) {
+            lengths[n++] = (uint8_t)symbol;
+            continue;
+        }
+
+        int repeat;
+        uint8_t value = 0;
+        if (symbol == 16) {
+            if (n == 0) return false;
+            value = lengths[n - 1];
+            repeat = 3 + reader.Read(2);
+        } else if (symbol == 17) {
+            repeat = 3 + reader.Read(3);
+        } else {
+            repeat = 11 + reader.Read(7);
+        }
+
+        if (n + repeat > total) {
+            return false;
+        }
+        memset(lengths + n, value, repeat);
+        n += repeat;
+    }
+
+    return literals.Build(lengths, literalCount) && distances.Build(lengths + literalCount, distanceCount);
+}
+
+} // namespace
+
+bool InflateRaw(const uint8_t* pData, size_t size, std::vector<uint8_t>& out, size_t expectedSize) {
+    if (expectedSize) {
+        out.reserve(out.size() + expectedSize);
+    }
+
+    BitReader reader(pData, size);
+    Huffman literals;
+    Huffman distances;
+
+    bool finalBlock = false;
+    while (!finalBlock) {
+        finalBlock = reader.Read(1) != 0;
+        uint32_t type = reader.Read(2);
+
+        if (type == 0) {
+            // Stored block: LEN, NLEN, then raw bytes
+            size_t position = reader.AlignToByte();
+            if (reader.HasOverrun() || position + 4 > size) {
+                return false;
+            }
+            const uint8_t* p = pData + position;
+            uint32_t length = p[0] | (p[1] << 8);
+            uint32_t inverse = p[2] | (p[3] << 8);
+            if ((length ^ 0xFFFF) != inverse || position + 4 + length > size) {
+                return false;
+            }
+            out.insert(out.end(), p + 4, p + 4 + length);
+            reader.Skip(4 + length);
+        } else if (type == 1) {
+            if (!BuildFixedTables(literals, distances) || !InflateBlock(reader, literals, distances, out)) {
+                return false;
+            }
+        } else if (type == 2) {
+            if (!ReadDynamicTables(reader, literals, distances) || !InflateBlock(reader, literals, distances, out)) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+
+        if (reader.HasOverrun()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool InflateZlib(const uint8_t* pData, size_t size, std::vector<uint8_t>& out, size_t expectedSize) {
+    if (size < 2) {
+        return false;
+    }
+
+    // CM must be deflate, the header checksum must hold and no preset dictionary
+    uint8_t cmf = pData[0];
+    uint8_t flags = pData[1];
+    if ((cmf & 0x0F) != 8 || ((cmf << 8) | flags) % 31 != 0 || (flags & 0x20)) {
+        return false;
+    }
+
+    // The trailing Adler-32 is not verified; PNG chunks carry their own CRC
+    return InflateRaw(pData + 2, size - 2, out, expectedSize);
+}
\ No newline at end of file
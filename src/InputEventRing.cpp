@@ -0,0 +1,59 @@
+#include "../include/InputEventRing.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+InputEventRing::InputEventRing(uint32_t capacity) :
+    m_Mask(0),
+    m_Head(0),
+    m_CachedTail(0),
+    m_Dropped(0),
+    m_Tail(0),
+    m_CachedHead(0) {
+    uint32_t size = 1;
+    while (size < max(capacity, 2u)) {
+        size <<= 1;
+    }
+    m_Events.resize(size);
+    m_Mask = size - 1;
+}
+
+bool InputEventRing::Push(const InputEvent& event) {
+    uint64_t head = m_Head.load(std::memory_order_relaxed);
+    if (head - m_CachedTail > m_Mask) {
+        m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        if (head - m_CachedTail > m_Mask) {
+            m_Dropped.store(m_Dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    m_Events[head & m_Mask] = event;
+    m_Head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+size_t InputEventRing::PopBatch(InputEvent* pEvents, size_t maxCount) {
+    uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+    if (m_CachedHead - tail < maxCount) {
+        m_CachedHead = m_Head.load(std::memory_order_acquire);
+    }
+
+    size_t count = (size_t)min<uint64_t>(m_CachedHead - tail, maxCount);
+    if (count == 0) return 0;
+
+    // Copy in up to two runs around the wrap point
+    size_t start = (size_t)(tail & m_Mask);
+    size_t firstRun = min(count, (size_t)m_Mask + 1 - start);
+    std::copy(m_Events.begin() + start, m_Events.begin() + start + firstRun, pEvents);
+    std::copy(m_Events.begin(), m_Events.begin() + (count - firstRun), pEvents + firstRun);
+
+    m_Tail.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+size_t InputEventRing::GetSize() const {
+    uint64_t tail = m_Tail.load(std::memory_order_acquire);
+    uint64_t head = m_Head.load(std::memory_order_acquire);
+    return (size_t)(head - tail);
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "../include/InputManager.h"
+#include "../include/Profiler.h"
 #include <windowsx.h>
 #include <tabletapi.h>
 
@@ -6,8 +7,16 @@ InputManager::InputManager() :
     m_MouseX(0.0f), 
     m_MouseY(0.0f),
     m_bTabletActive(false),
+    m_DispatchBatch(DISPATCH_BATCH),
+    m_PerformanceFrequency(1),
+    m_pRecorder(nullptr),
     m_hTabletContext(nullptr) {
     
+    LARGE_INTEGER frequency;
+    if (QueryPerformanceFrequency(&frequency)) {
+        m_PerformanceFrequency = frequency.QuadPart;
+    }
+    
     // Initialize mouse buttons and keyboard state
     for (int i = 0; i < 5; i++) {
         m_MouseButtons[i] = false;
@@ -25,6 +34,7 @@ InputManager::InputManager() :
     m_TabletData.tiltY = 0.0f;
     m_TabletData.isPenDown = false;
     m_TabletData.isEraser = false;
+    m_TabletData.timeMs = 0.0;
 }
 
 InputManager::~InputManager() {
@@ -79,11 +89,19 @@ void InputManager::ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                     break;
             }
             
-            // Trigger mouse callbacks
-            for (auto& callback : m_MouseCallbacks) {
-                callback((float)GET_X_LPARAM(lParam), (float)GET_Y_LPARAM(lParam), 
-                         GET_KEYSTATE_WPARAM(wParam), 
-                         (msg == WM_LBUTTONDOWN || msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN));
+            // Queue for the mouse callbacks
+            {
+                InputEventType type = InputEventType::MOUSE_MOVE;
+                if (msg == WM_LBUTTONDOWN || msg == WM_RBUTTONDOWN || msg == WM_MBUTTONDOWN) {
+                    type = InputEventType::MOUSE_DOWN;
+                } else if (msg == WM_LBUTTONUP || msg == WM_RBUTTONUP || msg == WM_MBUTTONUP) {
+                    type = InputEventType::MOUSE_UP;
+                } else if (msg == WM_MOUSEWHEEL) {
+                    type = InputEventType::MOUSE_WHEEL;
+                }
+                int32_t wheelDelta = msg == WM_MOUSEWHEEL ? GET_WHEEL_DELTA_WPARAM(wParam) : 0;
+                QueueEvent(type, (float)GET_X_LPARAM(lParam), (float)GET_Y_LPARAM(lParam),
+                           GET_KEYSTATE_WPARAM(wParam), wheelDelta);
             }
             break;
             
@@ -94,10 +112,9 @@ void InputManager::ProcessMessage(UINT msg, WPARAM wParam, LPARAM lParam) {
                 bool isDown = (msg == WM_KEYDOWN);
                 m_KeyboardState[key] = isDown;
                 
-                // Trigger keyboard callbacks
-                for (auto& callback : m_KeyboardCallbacks) {
-                    callback(key, isDown);
-                }
+                // Queue for the keyboard callbacks
+                QueueEvent(isDown ? InputEventType::KEY_DOWN : InputEventType::KEY_UP,
+                           m_MouseX, m_MouseY, (uint32_t)key, 0);
             }
             break;
             
@@ -115,27 +132,140 @@ bool InputManager::ProcessTabletMessage(UINT msg, WPARAM wParam, LPARAM lParam)
         return TRUE;
     }
     
-    // Handle packet messages for pressure-sensitive input
-    // We'll look for standard pen/stylus messages
-    if (msg >= WM_POINTERDEVICECHANGE && msg <= WM_POINTERUPDATE) {
-        // This is a simplified approach - in reality, we'd need to use the RealTimeStylus API
-        // or Windows Ink APIs to get pressure data
-        
-        // For now, simulate pressure based on other input
-        m_bTabletActive = true;
-        m_TabletData.pressure = 0.5f; // Default pressure
-        m_TabletData.x = (float)GET_X_LPARAM(lParam);
-        m_TabletData.y = (float)GET_Y_LPARAM(lParam);
-        
-        // Trigger tablet callbacks
-        for (auto& callback : m_TabletCallbacks) {
-            callback(m_TabletData);
+    if (msg != WM_POINTERDOWN && msg != WM_POINTERUPDATE && msg != WM_POINTERUP) {
+        return false;
+    }
+
+    // Mouse and touch pointers arrive again as mouse messages
+    UINT32 pointerId = GET_POINTERID_WPARAM(wParam);
+    POINTER_INPUT_TYPE pointerType = PT_POINTER;
+    if (!GetPointerType(pointerId, &pointerType) || pointerType != PT_PEN) {
+        return false;
+    }
+
+    // A pen reports far faster than messages are delivered; the history
+    // holds every packet coalesced into this message, newest first
+    POINTER_PEN_INFO history[PEN_HISTORY_SIZE];
+    UINT32 count = PEN_HISTORY_SIZE;
+    if (!GetPointerPenInfoHistory(pointerId, &count, history)) {
+        count = 1;
+        if (!GetPointerPenInfo(pointerId, &history[0])) {
+            return false;
+        }
+    }
+    if (count > PEN_HISTORY_SIZE) {
+        count = PEN_HISTORY_SIZE;
+    }
+
+    m_bTabletActive = true;
+    for (UINT32 i = count; i-- > 0;) {
+        const POINTER_PEN_INFO& penInfo = history[i];
+        const POINTER_INFO& pointerInfo = penInfo.pointerInfo;
+
+        POINT position = pointerInfo.ptPixelLocation;
+        ScreenToClient(pointerInfo.hwndTarget, &position);
+
+        InputEvent event = {};
+        event.timeMs = GetTimeMs((int64_t)pointerInfo.PerformanceCount);
+        event.x = (float)position.x;
+        event.y = (float)position.y;
+        event.pressure = (penInfo.penMask & PEN_MASK_PRESSURE) ? (float)penInfo.pressure / 1024.0f : 0.5f;
+        event.tiltX = (penInfo.penMask & PEN_MASK_TILT_X) ? (float)penInfo.tiltX : 0.0f;
+        event.tiltY = (penInfo.penMask & PEN_MASK_TILT_Y) ? (float)penInfo.tiltY : 0.0f;
+        event.buttons = 0;
+        if (pointerInfo.pointerFlags & POINTER_FLAG_INCONTACT) event.buttons |= InputEvent::PEN_CONTACT;
+        if (penInfo.penFlags & PEN_FLAG_BARREL) event.buttons |= InputEvent::PEN_BARREL;
+        event.isEraser = (penInfo.penFlags & (PEN_FLAG_ERASER | PEN_FLAG_INVERTED)) != 0;
+
+        if (pointerInfo.pointerFlags & POINTER_FLAG_DOWN) {
+            event.type = InputEventType::PEN_DOWN;
+        } else if (pointerInfo.pointerFlags & POINTER_FLAG_UP) {
+            event.type = InputEventType::PEN_UP;
+        } else {
+            event.type = InputEventType::PEN_MOVE;
+        }
+        m_EventRing.Push(event);
+
+        m_TabletData.x = event.x;
+        m_TabletData.y = event.y;
+        m_TabletData.pressure = event.pressure;
+        m_TabletData.tiltX = event.tiltX;
+        m_TabletData.tiltY = event.tiltY;
+        m_TabletData.isPenDown = (event.buttons & InputEvent::PEN_CONTACT) != 0;
+        m_TabletData.isEraser = event.isEraser;
+        m_TabletData.timeMs = event.timeMs;
+    }
+
+    return true;
+}
+
+void InputManager::QueueEvent(InputEventType type, float x, float y, uint32_t buttons, int32_t wheelDelta) {
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    InputEvent event = {};
+    event.timeMs = GetTimeMs(now.QuadPart);
+    event.x = x;
+    event.y = y;
+    event.buttons = buttons;
+    event.wheelDelta = wheelDelta;
+    event.type = type;
+    m_EventRing.Push(event);
+}
+
+double InputManager::GetTimeMs(int64_t performanceCount) const {
+    // steady_clock counts from the same performance counter
+    return (double)performanceCount * 1000.0 / (double)m_PerformanceFrequency;
+}
+
+void InputManager::DispatchEvents() {
+    PROFILE_ZONE("InputManager::DispatchEvents");
+    size_t count;
+    while ((count = m_EventRing.PopBatch(m_DispatchBatch.data(), m_DispatchBatch.size())) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            const InputEvent& event = m_DispatchBatch[i];
+            if (m_pRecorder) {
+                m_pRecorder->Add(event);
+            }
+
+            switch (event.type) {
+                case InputEventType::MOUSE_MOVE:
+                case InputEventType::MOUSE_DOWN:
+                case InputEventType::MOUSE_UP:
+                case InputEventType::MOUSE_WHEEL:
+                    for (auto& callback : m_MouseCallbacks) {
+                        callback(event.x, event.y, (int)event.buttons, event.type == InputEventType::MOUSE_DOWN);
+                    }
+                    break;
+
+                case InputEventType::KEY_DOWN:
+                case InputEventType::KEY_UP:
+                    for (auto& callback : m_KeyboardCallbacks) {
+                        callback((int)event.buttons, event.type == InputEventType::KEY_DOWN);
+                    }
+                    break;
+
+                case InputEventType::PEN_DOWN:
+                case InputEventType::PEN_MOVE:
+                case InputEventType::PEN_UP:
+                    {
+                        TabletData tabletData;
+                        tabletData.x = event.x;
+                        tabletData.y = event.y;
+                        tabletData.pressure = event.pressure;
+                        tabletData.tiltX = event.tiltX;
+                        tabletData.tiltY = event.tiltY;
+                        tabletData.isPenDown = (event.buttons & InputEvent::PEN_CONTACT) != 0;
+                        tabletData.isEraser = event.isEraser;
+                        tabletData.timeMs = event.timeMs;
+                        for (auto& callback : m_TabletCallbacks) {
+                            callback(tabletData);
+                        }
+                    }
+                    break;
+            }
         }
-        
-        return true;
     }
-    
-    return false;
 }
 
 void InputManager::RegisterMouseCallback(std::function<void(float, float, int, bool)> callback) {
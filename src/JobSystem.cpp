@@ -0,0 +1,390 @@
+#include "../include/JobSystem.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+// Which system and thread slot the current thread belongs to, if any
+static thread_local const JobSystem* t_pJobSystem = nullptr;
+static thread_local uint32_t t_ThreadIndex = 0;
+
+JobSystem::JobSystem(uint32_t threadCount) :
+    m_ThreadCount(threadCount),
+    m_SharedCount(0),
+    m_MainCount(0),
+    m_Queued(0),
+    m_Sleepers(0),
+    m_bShutdown(false) {
+    if (m_ThreadCount == 0) {
+        m_ThreadCount = max(2u, std::thread::hardware_concurrency());
+    }
+
+    m_Threads.reset(new ThreadState[m_ThreadCount]);
+    for (uint32_t i = 0; i < m_ThreadCount; i++) {
+        ThreadState& thread = m_Threads[i];
+        thread.top.store(0, std::memory_order_relaxed);
+        thread.bottom.store(0, std::memory_order_relaxed);
+        thread.slots.reset(new Slot[DEQUE_CAPACITY]);
+        thread.jobs.store(0, std::memory_order_relaxed);
+        thread.steals.store(0, std::memory_order_relaxed);
+    }
+
+    t_pJobSystem = this;
+    t_ThreadIndex = 0;
+    for (uint32_t i = 1; i < m_ThreadCount; i++) {
+        m_Workers.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_bShutdown = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+    if (t_pJobSystem == this) {
+        t_pJobSystem = nullptr;
+    }
+}
+
+bool JobSystem::IsMainThread() const {
+    return t_pJobSystem == this && t_ThreadIndex == 0;
+}
+
+uint32_t JobSystem::GetThreadIndex() const {
+    return t_pJobSystem == this ? t_ThreadIndex : NOT_A_THREAD;
+}
+
+void JobSystem::Run(const Job* pJobs, uint32_t count, JobCounter* pCounter, JobCounter* pDependency) {
+    if (count == 0) {
+        return;
+    }
+    if (pCounter) {
+        pCounter->m_State.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    // Submitted in slices so queuing needs no allocation
+    static const uint32_t SLICE = 64;
+    CountedJob slice[SLICE];
+    for (uint32_t first = 0; first < count; first += SLICE) {
+        uint32_t sliceCount = min(SLICE, count - first);
+        for (uint32_t i = 0; i < sliceCount; i++) {
+            slice[i].job = pJobs[first + i];
+            slice[i].pCounter = pCounter;
+            slice[i].bMainThread = false;
+        }
+        if (!pDependency || !Hold(*pDependency, slice, sliceCount)) {
+            Submit(slice, sliceCount);
+        }
+    }
+}
+
+void JobSystem::RunOnMainThread(const Job& job, JobCounter* pCounter, JobCounter* pDependency) {
+    if (pCounter) {
+        pCounter->m_State.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CountedJob counted;
+    counted.job = job;
+    counted.pCounter = pCounter;
+    counted.bMainThread = true;
+    if (!pDependency || !Hold(*pDependency, &counted, 1)) {
+        Submit(&counted, 1);
+    }
+}
+
+bool JobSystem::Hold(JobCounter& dependency, const CountedJob* pJobs, uint32_t count) {
+    // Under the dependency's lock, so the thread that lowers it to zero
+    // either sees HELD_JOBS and queues these, or lowered it before we
+    // looked and the caller queues them now
+    std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+    uint64_t state = dependency.m_State.load(std::memory_order_acquire);
+    while ((uint32_t)state != 0) {
+        if (dependency.m_State.compare_exchange_weak(state, state | JobCounter::HELD_JOBS, std::memory_order_acq_rel)) {
+            dependency.m_HeldJobs.insert(dependency.m_HeldJobs.end(), pJobs, pJobs + count);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Submit(const CountedJob* pJobs, uint32_t count) {
+    uint32_t threadIndex = GetThreadIndex();
+    uint32_t queued = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        const CountedJob& job = pJobs[i];
+        if (job.bMainThread) {
+            std::lock_guard<std::mutex> lock(m_MainMutex);
+            m_MainJobs.push_back(job);
+            m_MainCount.fetch_add(1, std::memory_order_release);
+            continue;
+        }
+
+        // Counted before it is visible, so a thread that takes it never
+        // sees the count go negative for long
+        m_Queued.fetch_add(1, std::memory_order_seq_cst);
+        queued++;
+        if (threadIndex == NOT_A_THREAD || !Push(threadIndex, job)) {
+            std::lock_guard<std::mutex> lock(m_SharedMutex);
+            m_SharedJobs.push_back(job);
+            m_SharedCount.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    // Taking the lock orders this after a worker that checked m_Queued and
+    // is about to sleep, so the wake-up cannot fall between the two
+    if (queued > 0 && m_Sleepers.load(std::memory_order_seq_cst) > 0) {
+        {
+            std::lock_guard<std::mutex> lock(m_SleepMutex);
+        }
+        if (queued > 1) {
+            m_WakeCondition.notify_all();
+        } else {
+            m_WakeCondition.notify_one();
+        }
+    }
+}
+
+bool JobSystem::Push(uint32_t threadIndex, const CountedJob& job) {
+    ThreadState& thread = m_Threads[threadIndex];
+    int64_t bottom = thread.bottom.load(std::memory_order_relaxed);
+    int64_t top = thread.top.load(std::memory_order_acquire);
+    if (bottom - top >= (int64_t)DEQUE_CAPACITY) {
+        return false;
+    }
+
+    Slot& slot = thread.slots[bottom & (DEQUE_CAPACITY - 1)];
+    slot.function.store(job.job.function, std::memory_order_relaxed);
+    slot.pData.store(job.job.pData, std::memory_order_relaxed);
+    slot.pCounter.store(job.pCounter, std::memory_order_relaxed);
+    thread.bottom.store(bottom + 1, std::memory_order_release);
+    return true;
+}
+
+bool JobSystem::Pop(uint32_t threadIndex, CountedJob& job) {
+    ThreadState& thread = m_Threads[threadIndex];
+    int64_t bottom = thread.bottom.load(std::memory_order_relaxed) - 1;
+    thread.bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = thread.top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+        thread.bottom.store(bottom + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Slot& slot = thread.slots[bottom & (DEQUE_CAPACITY - 1)];
+    job.job.function = slot.function.load(std::memory_order_relaxed);
+    job.job.pData = slot.pData.load(std::memory_order_relaxed);
+    job.pCounter = slot.pCounter.load(std::memory_order_relaxed);
+    job.bMainThread = false;
+    if (top < bottom) {
+        return true;
+    }
+
+    // The last job: race any thief for it
+    bool bWon = thread.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    thread.bottom.store(bottom + 1, std::memory_order_relaxed);
+    return bWon;
+}
+
+bool JobSystem::Steal(uint32_t victimIndex, CountedJob& job) {
+    ThreadState& thread = m_Threads[victimIndex];
+    int64_t top = thread.top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = thread.bottom.load(std::memory_order_acquire);
+    if (top >= bottom) {
+        return false;
+    }
+
+    Slot& slot = thread.slots[top & (DEQUE_CAPACITY - 1)];
+    job.job.function = slot.function.load(std::memory_order_relaxed);
+    job.job.pData = slot.pData.load(std::memory_order_relaxed);
+    job.pCounter = slot.pCounter.load(std::memory_order_relaxed);
+    job.bMainThread = false;
+    return thread.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+bool JobSystem::FindJob(uint32_t threadIndex, CountedJob& job) {
+    bool bFound = threadIndex != NOT_A_THREAD && Pop(threadIndex, job);
+
+    if (!bFound && m_SharedCount.load(std::memory_order_acquire) > 0) {
+        std::lock_guard<std::mutex> lock(m_SharedMutex);
+        if (!m_SharedJobs.empty()) {
+            job = m_SharedJobs.front();
+            m_SharedJobs.pop_front();
+            m_SharedCount.fetch_sub(1, std::memory_order_relaxed);
+            bFound = true;
+        }
+    }
+
+    // Start with the next thread along so thieves spread out
+    uint32_t start = threadIndex == NOT_A_THREAD ? 0 : threadIndex + 1;
+    for (uint32_t offset = 0; !bFound && offset < m_ThreadCount; offset++) {
+        uint32_t victim = (start + offset) % m_ThreadCount;
+        if (victim != threadIndex && Steal(victim, job)) {
+            if (threadIndex != NOT_A_THREAD) {
+                m_Threads[threadIndex].steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            bFound = true;
+        }
+    }
+
+    if (bFound) {
+        m_Queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return bFound;
+}
+
+bool JobSystem::PopMainThreadJob(CountedJob& job) {
+    if (m_MainCount.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(m_MainMutex);
+    if (m_MainJobs.empty()) {
+        return false;
+    }
+    job = m_MainJobs.front();
+    m_MainJobs.pop_front();
+    m_MainCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+void JobSystem::Execute(const CountedJob& job) {
+    PROFILE_ZONE("JobSystem::Execute");
+    job.job.function(job.job.pData);
+
+    uint32_t threadIndex = GetThreadIndex();
+    if (threadIndex != NOT_A_THREAD) {
+        m_Threads[threadIndex].jobs.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (job.pCounter) {
+        Finish(job.pCounter);
+    }
+}
+
+void JobSystem::Finish(JobCounter* pCounter) {
+    uint64_t previous = pCounter->m_State.fetch_sub(1, std::memory_order_acq_rel);
+    if ((uint32_t)previous != 1 || !(previous & JobCounter::HELD_JOBS)) {
+        return;
+    }
+
+    // Last job out queues everything that was waiting on the counter, then
+    // clears HELD_JOBS as its final touch so waiters may destroy it
+    std::vector<CountedJob> held;
+    {
+        std::lock_guard<std::mutex> lock(pCounter->m_Mutex);
+        held.swap(pCounter->m_HeldJobs);
+    }
+    pCounter->m_State.fetch_and(~JobCounter::HELD_JOBS, std::memory_order_release);
+    Submit(held.data(), (uint32_t)held.size());
+}
+
+void JobSystem::RunMainThreadJobs() {
+    PROFILE_ZONE("JobSystem::RunMainThreadJobs");
+    CountedJob job;
+    while (PopMainThreadJob(job)) {
+        Execute(job);
+    }
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    PROFILE_ZONE("JobSystem::Wait");
+    uint32_t threadIndex = GetThreadIndex();
+    bool bMainThread = threadIndex == 0;
+
+    CountedJob job;
+    while (counter.m_State.load(std::memory_order_acquire) != 0) {
+        if ((bMainThread && PopMainThreadJob(job)) || FindJob(threadIndex, job)) {
+            Execute(job);
+        } else {
+            // What is left is running on other threads
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = max(grain, 1u);
+    uint32_t jobCount = (count + grain - 1) / grain;
+    if (jobCount == 1) {
+        body(0, count);
+        return;
+    }
+
+    struct Range {
+        const std::function<void(uint32_t, uint32_t)>* pBody;
+        uint32_t begin, end;
+    };
+    std::vector<Range> ranges(jobCount);
+    std::vector<Job> jobs(jobCount);
+    for (uint32_t i = 0; i < jobCount; i++) {
+        ranges[i].pBody = &body;
+        ranges[i].begin = i * grain;
+        ranges[i].end = min(count, (i + 1) * grain);
+        jobs[i].function = [](void* pData) {
+            const Range& range = *(const Range*)pData;
+            (*range.pBody)(range.begin, range.end);
+        };
+        jobs[i].pData = &ranges[i];
+    }
+
+    JobCounter counter;
+    Run(jobs.data(), jobCount, &counter);
+    Wait(counter);
+}
+
+uint64_t JobSystem::GetJobCount() const {
+    uint64_t jobs = 0;
+    for (uint32_t i = 0; i < m_ThreadCount; i++) {
+        jobs += m_Threads[i].jobs.load(std::memory_order_relaxed);
+    }
+    return jobs;
+}
+
+uint64_t JobSystem::GetStealCount() const {
+    uint64_t steals = 0;
+    for (uint32_t i = 0; i < m_ThreadCount; i++) {
+        steals += m_Threads[i].steals.load(std::memory_order_relaxed);
+    }
+    return steals;
+}
+
+void JobSystem::WorkerMain(uint32_t threadIndex) {
+    t_pJobSystem = this;
+    t_ThreadIndex = threadIndex;
+    Profiler::SetThreadName("Job worker");
+
+    CountedJob job;
+    for (;;) {
+        bool bFound = false;
+        for (uint32_t spin = 0; spin < SPIN_COUNT && !bFound; spin++) {
+            bFound = FindJob(threadIndex, job);
+            if (!bFound) {
+                std::this_thread::yield();
+            }
+        }
+        if (bFound) {
+            Execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_Sleepers.fetch_add(1, std::memory_order_seq_cst);
+        m_WakeCondition.wait(lock, [this] {
+            return m_bShutdown || m_Queued.load(std::memory_order_seq_cst) > 0;
+        });
+        m_Sleepers.fetch_sub(1, std::memory_order_relaxed);
+        if (m_bShutdown) {
+            return;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,174 @@
+#include "../include/LZ4.h"
+#include <cstring>
+
+// Format limits from the LZ4 block specification
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;      // The block always ends with this many literals
+static const size_t MATCH_FIND_LIMIT = 12;  // No match may start this close to the end
+static const size_t MAX_OFFSET = 65535;
+static const int HASH_BITS = 14;
+
+static inline uint32_t Read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+static inline uint32_t Hash(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static inline uint8_t* WriteLength(uint8_t* pOut, size_t length) {
+    while (length >= 255) {
+        *pOut++ = 255;
+        length -= 255;
+    }
+    *pOut++ = (uint8_t)length;
+    return pOut;
+}
+
+size_t LZ4CompressBound(size_t size) {
+    return size + size / 255 + 16;
+}
+
+size_t LZ4Compress(const uint8_t* pSrc, size_t size, std::vector<uint8_t>& out) {
+    out.resize(LZ4CompressBound(size));
+    uint8_t* pOut = out.data();
+
+    const uint8_t* pAnchor = pSrc;
+    const uint8_t* pEnd = pSrc + size;
+
+    if (size > MATCH_FIND_LIMIT) {
+        std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0);
+        const uint8_t* pMatchLimit = pEnd - MATCH_FIND_LIMIT;
+        const uint8_t* pLiteralLimit = pEnd - LAST_LITERALS;
+        const uint8_t* p = pSrc + 1;
+
+        while (p < pMatchLimit) {
+            uint32_t sequence = Read32(p);
+            uint32_t& slot = table[Hash(sequence)];
+            const uint8_t* pCandidate = pSrc + slot;
+            slot = (uint32_t)(p - pSrc);
+
+            if (pCandidate >= p || (size_t)(p - pCandidate) > MAX_OFFSET || Read32(pCandidate) != sequence) {
+                p++;
+                continue;
+            }
+
+            // Extend backwards over pending literals, then forwards
+            while (p > pAnchor && pCandidate > pSrc && p[-1] == pCandidate[-1]) {
+                p--;
+                pCandidate--;
+            }
+            const uint8_t* pMatchEnd = p + MIN_MATCH;
+            const uint8_t* pCandidateEnd = pCandidate + MIN_MATCH;
+            while (pMatchEnd < pLiteralLimit && *pMatchEnd == *pCandidateEnd) {
+                pMatchEnd++;
+                pCandidateEnd++;
+            }
+
+            size_t literalLength = (size_t)(p - pAnchor);
+            size_t matchLength = (size_t)(pMatchEnd - p) - MIN_MATCH;
+
+            uint8_t* pToken = pOut++;
+            *pToken = (uint8_t)((literalLength < 15 ? literalLength : 15) << 4);
+            if (literalLength >= 15) {
+                pOut = WriteLength(pOut, literalLength - 15);
+            }
+            memcpy(pOut, pAnchor, literalLength);
+            pOut += literalLength;
+
+            uint16_t offset = (uint16_t)(p - pCandidate);
+            *pOut++ = (uint8_t)(offset & 0xFF);
+            *pOut++ = (uint8_t)(offset >> 8);
+
+            *pToken |= (uint8_t)(matchLength < 15 ? matchLength : 15);
+            if (matchLength >= 15) {
+                pOut = WriteLength(pOut, matchLength - 15);
+            }
+
+            p = pMatchEnd;
+            pAnchor = p;
+        }
+    }
+
+    // Trailing literals
+    size_t literalLength = (size_t)(pEnd - pAnchor);
+    *pOut++ = (uint8_t)((literalLength < 15 ? literalLength : 15) << 4);
+    if (literalLength >= 15) {
+        pOut = WriteLength(pOut, literalLength - 15);
+    }
+    if (literalLength > 0) {
+        memcpy(pOut, pAnchor, literalLength);
+    }
+    pOut += literalLength;
+
+    out.resize((size_t)(pOut - out.data()));
+    return out.size();
+}
+
+bool LZ4Decompress(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize) {
+    const uint8_t* pIn = pSrc;
+    const uint8_t* pInEnd = pSrc + srcSize;
+    uint8_t* pOut = pDst;
+    uint8_t* pOutEnd = pDst + dstSize;
+
+    while (pIn < pInEnd) {
+        uint8_t token = *pIn++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15) {
+            uint8_t extra;
+            do {
+                if (pIn >= pInEnd) return false;
+                extra = *pIn++;
+                literalLength += extra;
+            } while (extra == 255);
+        }
+        if (literalLength > (size_t)(pInEnd - pIn) || literalLength > (size_t)(pOutEnd - pOut)) {
+            return false;
+        }
+        if (literalLength > 0) {
+            memcpy(pOut, pIn, literalLength);
+        }
+        pIn += literalLength;
+        pOut += literalLength;
+
+        // The last sequence has literals only
+        if (pIn == pInEnd) break;
+
+        if (pInEnd - pIn < 2) return false;
+        size_t offset = (size_t)pIn[0] | ((size_t)pIn[1] << 8);
+        pIn += 2;
+        if (offset == 0 || offset > (size_t)(pOut - pDst)) {
+            return false;
+        }
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15) {
+            uint8_t extra;
+            do {
+                if (pIn >= pInEnd) return false;
+                extra = *pIn++;
+                matchLength += extra;
+            } while (extra == 255);
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > (size_t)(pOutEnd - pOut)) {
+            return false;
+        }
+
+        // Overlapping copies repeat the pattern, so copy forwards
+        const uint8_t* pMatch = pOut - offset;
+        if (offset >= matchLength) {
+            memcpy(pOut, pMatch, matchLength);
+            pOut += matchLength;
+        } else {
+            for (size_t i = 0; i < matchLength; i++) {
+                *pOut++ = *pMatch++;
+            }
+        }
+    }
+
+    return pOut == pOutEnd;
+}
\ No newline at end of file
@@ -0,0 +1,227 @@
+#include "../include/LayerStack.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cstring>
+using std::min;
+using std::max;
+
+Layer::Layer(const std::string& name, uint32_t width, uint32_t height) :
+    m_Name(name),
+    m_Canvas(width, height),
+    m_Opacity(1.0f),
+    m_bVisible(true),
+    m_BlendMode(LayerBlendMode::NORMAL) {
+}
+
+LayerStack::LayerStack(uint32_t width, uint32_t height) :
+    m_Width(width),
+    m_Height(height),
+    m_Composite(width, height),
+    m_pOverlay(nullptr),
+    m_pOverlayLayer(nullptr) {
+    m_TileDirty.resize((size_t)m_Composite.GetTilesX() * m_Composite.GetTilesY());
+}
+
+LayerStack::~LayerStack() {
+}
+
+Layer* LayerStack::AddLayer(const std::string& name) {
+    return InsertLayer((uint32_t)m_Layers.size(), name);
+}
+
+Layer* LayerStack::InsertLayer(uint32_t index, const std::string& name) {
+    // A new layer is empty, so nothing needs recompositing yet
+    index = min(index, (uint32_t)m_Layers.size());
+    m_Layers.insert(m_Layers.begin() + index, std::make_unique<Layer>(name, m_Width, m_Height));
+    return m_Layers[index].get();
+}
+
+bool LayerStack::RemoveLayer(uint32_t index) {
+    if (index >= m_Layers.size()) return false;
+
+    InvalidateLayerTiles(*m_Layers[index]);
+    if (m_Layers[index].get() == m_pOverlayLayer) {
+        m_pOverlay = nullptr;
+        m_pOverlayLayer = nullptr;
+    }
+    m_Layers.erase(m_Layers.begin() + index);
+    return true;
+}
+
+bool LayerStack::MoveLayer(uint32_t from, uint32_t to) {
+    if (from >= m_Layers.size() || to >= m_Layers.size()) return false;
+    if (from == to) return true;
+
+    InvalidateLayerTiles(*m_Layers[from]);
+    std::unique_ptr<Layer> layer = std::move(m_Layers[from]);
+    m_Layers.erase(m_Layers.begin() + from);
+    m_Layers.insert(m_Layers.begin() + to, std::move(layer));
+    return true;
+}
+
+Layer* LayerStack::GetLayer(uint32_t index) {
+    return index < m_Layers.size() ? m_Layers[index].get() : nullptr;
+}
+
+void LayerStack::SetOpacity(uint32_t index, float opacity) {
+    if (index >= m_Layers.size()) return;
+
+    Layer& layer = *m_Layers[index];
+    opacity = max(0.0f, min(1.0f, opacity));
+    if (opacity == layer.m_Opacity) return;
+    layer.m_Opacity = opacity;
+    InvalidateLayerTiles(layer);
+}
+
+void LayerStack::SetVisible(uint32_t index, bool bVisible) {
+    if (index >= m_Layers.size()) return;
+
+    Layer& layer = *m_Layers[index];
+    if (bVisible == layer.m_bVisible) return;
+    layer.m_bVisible = bVisible;
+    InvalidateLayerTiles(layer);
+}
+
+void LayerStack::SetBlendMode(uint32_t index, LayerBlendMode mode) {
+    if (index >= m_Layers.size()) return;
+
+    Layer& layer = *m_Layers[index];
+    if (mode == layer.m_BlendMode) return;
+    layer.m_BlendMode = mode;
+    InvalidateLayerTiles(layer);
+}
+
+void LayerStack::SetOverlay(Canvas* pOverlay, const Layer* pLayer) {
+    if (!pOverlay || !pLayer) {
+        pOverlay = nullptr;
+        pLayer = nullptr;
+    }
+    if (pOverlay == m_pOverlay && pLayer == m_pOverlayLayer) return;
+
+    if (m_pOverlay) {
+        InvalidateCanvasTiles(*m_pOverlay);
+    }
+    m_pOverlay = pOverlay;
+    m_pOverlayLayer = pLayer;
+    if (m_pOverlay) {
+        InvalidateCanvasTiles(*m_pOverlay);
+    }
+}
+
+void LayerStack::Invalidate(int x0, int y0, int x1, int y1) {
+    x0 = max(x0, 0);
+    y0 = max(y0, 0);
+    x1 = min(x1, (int)m_Width);
+    y1 = min(y1, (int)m_Height);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    const int tileSize = (int)Canvas::TILE_SIZE;
+    uint32_t tilesX = m_Composite.GetTilesX();
+    for (int tileY = y0 / tileSize; tileY <= (y1 - 1) / tileSize; tileY++) {
+        for (int tileX = x0 / tileSize; tileX <= (x1 - 1) / tileSize; tileX++) {
+            InvalidateTile((uint32_t)tileY * tilesX + (uint32_t)tileX);
+        }
+    }
+}
+
+void LayerStack::InvalidateAll() {
+    Invalidate(0, 0, (int)m_Width, (int)m_Height);
+}
+
+void LayerStack::InvalidateTile(uint32_t index) {
+    if (m_TileDirty[index]) return;
+    m_TileDirty[index] = 1;
+    m_DirtyTiles.push_back(index);
+}
+
+void LayerStack::InvalidateCanvasTiles(const Canvas& canvas) {
+    uint32_t tilesX = canvas.GetTilesX();
+    uint32_t tilesY = canvas.GetTilesY();
+    for (uint32_t tileY = 0; tileY < tilesY; tileY++) {
+        for (uint32_t tileX = 0; tileX < tilesX; tileX++) {
+            if (canvas.GetTile(tileX, tileY)) {
+                InvalidateTile(tileY * tilesX + tileX);
+            }
+        }
+    }
+}
+
+void LayerStack::InvalidateLayerTiles(const Layer& layer) {
+    InvalidateCanvasTiles(layer.GetCanvas());
+    if (&layer == m_pOverlayLayer) {
+        InvalidateCanvasTiles(*m_pOverlay);
+    }
+}
+
+uint32_t LayerStack::Composite() {
+    PROFILE_ZONE("LayerStack::Composite");
+    // Pick up whatever was painted, undone or cleared since last time
+    for (auto& layer : m_Layers) {
+        uint32_t x, y, width, height;
+        if (layer->m_Canvas.GetDirtyRect(x, y, width, height)) {
+            Invalidate((int)x, (int)y, (int)(x + width), (int)(y + height));
+            layer->m_Canvas.ClearDirty();
+        }
+    }
+    if (m_pOverlay) {
+        uint32_t x, y, width, height;
+        if (m_pOverlay->GetDirtyRect(x, y, width, height)) {
+            Invalidate((int)x, (int)y, (int)(x + width), (int)(y + height));
+            m_pOverlay->ClearDirty();
+        }
+    }
+
+    uint32_t count = (uint32_t)m_DirtyTiles.size();
+    for (uint32_t index : m_DirtyTiles) {
+        CompositeTile(index);
+        m_TileDirty[index] = 0;
+    }
+    m_DirtyTiles.clear();
+    return count;
+}
+
+void LayerStack::CompositeTile(uint32_t index) {
+    uint32_t tileX = index % m_Composite.GetTilesX();
+    uint32_t tileY = index / m_Composite.GetTilesX();
+    const size_t pixelCount = Canvas::TILE_SIZE * Canvas::TILE_SIZE;
+
+    uint8_t* pDst = m_Composite.GetTile(tileX, tileY);
+    bool bEmpty = true;
+
+    for (const auto& layer : m_Layers) {
+        if (!layer->m_bVisible || layer->m_Opacity <= 0.0f) continue;
+
+        // Read through const so a tile shared with undo history is not copied
+        const Canvas& canvas = layer->m_Canvas;
+        const uint8_t* pSources[2] = { canvas.GetTile(tileX, tileY), nullptr };
+        if (layer.get() == m_pOverlayLayer) {
+            const Canvas& overlay = *m_pOverlay;
+            pSources[1] = overlay.GetTile(tileX, tileY);
+        }
+
+        for (const uint8_t* pSrc : pSources) {
+            if (!pSrc) continue;
+
+            if (!pDst) {
+                pDst = m_Composite.GetOrCreateTile(tileX, tileY);
+            }
+
+            // Over nothing, every mode but erase reduces to the source
+            if (bEmpty && layer->m_BlendMode != LayerBlendMode::ERASE && layer->m_Opacity >= 1.0f) {
+                memcpy(pDst, pSrc, Canvas::TILE_BYTES);
+            } else {
+                if (bEmpty) {
+                    memset(pDst, 0, Canvas::TILE_BYTES);
+                }
+                BlendPixels(layer->m_BlendMode, layer->m_Opacity, pSrc, pDst, pixelCount);
+            }
+            bEmpty = false;
+        }
+    }
+
+    if (bEmpty && pDst) {
+        memset(pDst, 0, Canvas::TILE_BYTES);
+    }
+    m_Composite.MarkDirty((int)(tileX * Canvas::TILE_SIZE), (int)(tileY * Canvas::TILE_SIZE),
+                          (int)((tileX + 1) * Canvas::TILE_SIZE), (int)((tileY + 1) * Canvas::TILE_SIZE));
+}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "../include/MappedFile.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : m_pData(nullptr), m_Size(0), m_hFile(INVALID_HANDLE_VALUE), m_hMapping(nullptr) {
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::wstring& filename) {
+    Close();
+
+    m_hFile = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_hFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(m_hFile, &fileSize) || fileSize.QuadPart <= 0) {
+        Close();
+        return false;
+    }
+
+    m_hMapping = CreateFileMappingW(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!m_hMapping) {
+        Close();
+        return false;
+    }
+
+    m_pData = (const uint8_t*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (!m_pData) {
+        Close();
+        return false;
+    }
+
+    m_Size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_pData) {
+        UnmapViewOfFile(m_pData);
+        m_pData = nullptr;
+    }
+    if (m_hMapping) {
+        CloseHandle(m_hMapping);
+        m_hMapping = nullptr;
+    }
+    if (m_hFile != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_hFile);
+        m_hFile = INVALID_HANDLE_VALUE;
+    }
+    m_Size = 0;
+}
+
+#else
+
+MappedFile::MappedFile() : m_pData(nullptr), m_Size(0), m_FileDescriptor(-1) {
+}
+
+MappedFile::~MappedFile() {
+    Close();
+}
+
+bool MappedFile::Open(const std::wstring& filename) {
+    Close();
+
+    m_FileDescriptor = open(std::filesystem::path(filename).c_str(), O_RDONLY);
+    if (m_FileDescriptor < 0) {
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(m_FileDescriptor, &fileStat) != 0 || fileStat.st_size <= 0) {
+        Close();
+        return false;
+    }
+
+    void* pMapping = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_SHARED, m_FileDescriptor, 0);
+    if (pMapping == MAP_FAILED) {
+        Close();
+        return false;
+    }
+
+    m_pData = (const uint8_t*)pMapping;
+    m_Size = (size_t)fileStat.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_pData) {
+        munmap((void*)m_pData, m_Size);
+        m_pData = nullptr;
+    }
+    if (m_FileDescriptor >= 0) {
+        close(m_FileDescriptor);
+        m_FileDescriptor = -1;
+    }
+    m_Size = 0;
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "../include/NullRenderBackend.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+// Batches are capped like the real backends so Renderer flushes as often
+static const uint32_t VERTEX_BATCH_CAPACITY = 65536;
+static const uint32_t INSTANCE_BATCH_CAPACITY = 16384;
+
+NullRenderBackend::NullRenderBackend(VertexFormat vertexFormat) :
+    m_VertexFormat(vertexFormat),
+    m_Stride(GetVertexStride(vertexFormat)),
+    m_BatchVertices(0),
+    m_BatchInstances(0),
+    m_NextTextureId(RenderBackend::WHITE_TEXTURE + 1),
+    m_LiveTextures(0),
+    m_Draws(0),
+    m_Vertices(0),
+    m_Instances(0) {
+}
+
+NullRenderBackend::~NullRenderBackend() {
+    Cleanup();
+}
+
+bool NullRenderBackend::Initialize() {
+    m_VertexData.resize((size_t)VERTEX_BATCH_CAPACITY * m_Stride);
+    m_InstanceData.resize(INSTANCE_BATCH_CAPACITY);
+    return true;
+}
+
+void NullRenderBackend::Cleanup() {
+    m_VertexData.clear();
+    m_VertexData.shrink_to_fit();
+    m_InstanceData.clear();
+    m_InstanceData.shrink_to_fit();
+    m_LiveTextures = 0;
+}
+
+void NullRenderBackend::BeginFrame() {
+    m_Draws = 0;
+    m_Vertices = 0;
+    m_Instances = 0;
+}
+
+uint32_t NullRenderBackend::CreateTexture(uint32_t width, uint32_t height, const uint8_t* /*pPixels*/) {
+    if (width == 0 || height == 0) {
+        return RenderBackend::WHITE_TEXTURE;
+    }
+    m_LiveTextures++;
+    return m_NextTextureId++;
+}
+
+void NullRenderBackend::DestroyTexture(uint32_t textureId) {
+    if (textureId != RenderBackend::WHITE_TEXTURE && m_LiveTextures > 0) {
+        m_LiveTextures--;
+    }
+}
+
+bool NullRenderBackend::UpdateTexture(uint32_t textureId, uint32_t /*x*/, uint32_t /*y*/, uint32_t width, uint32_t /*height*/,
+                                      const uint8_t* pPixels, uint32_t rowPitch) {
+    return textureId != RenderBackend::WHITE_TEXTURE && pPixels && rowPitch >= width * 4;
+}
+
+bool NullRenderBackend::AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) {
+    if ((size_t)(m_BatchVertices + vertexCount) * m_Stride > m_VertexData.size()) {
+        return false;
+    }
+    pVertices = &m_VertexData[(size_t)m_BatchVertices * m_Stride];
+    baseVertex = m_BatchVertices;
+    m_BatchVertices += vertexCount;
+    return true;
+}
+
+void NullRenderBackend::Submit(const uint16_t* /*pIndices*/, uint32_t /*indexCount*/,
+                               const DrawRun* /*pRuns*/, uint32_t runCount) {
+    m_Draws += runCount;
+    m_Vertices += m_BatchVertices;
+    m_BatchVertices = 0;
+}
+
+bool NullRenderBackend::AppendInstances(uint32_t count, SpriteInstance*& pInstances) {
+    if (m_BatchInstances + count > m_InstanceData.size()) {
+        return false;
+    }
+    pInstances = &m_InstanceData[m_BatchInstances];
+    m_BatchInstances += count;
+    return true;
+}
+
+void NullRenderBackend::SubmitInstances(BlendMode /*blendMode*/, uint32_t /*textureId*/) {
+    if (m_BatchInstances > 0) {
+        m_Draws++;
+    }
+    m_Instances += m_BatchInstances;
+    m_BatchInstances = 0;
+}
+
+void NullRenderBackend::DrawIndexed(const Vertex* /*pVertices*/, uint32_t vertexCount,
+                                    const uint32_t* /*pIndices*/, uint32_t /*indexCount*/,
+                                    BlendMode /*blendMode*/) {
+    m_Draws++;
+    m_Vertices += vertexCount;
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+#include "../include/ParallelDabRenderer.h"
+#include "../include/Profiler.h"
+#include "../include/Canvas.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+ParallelDabRenderer::ParallelDabRenderer(uint32_t threadCount) :
+    m_pPool(new WorkStealingPool(threadCount)),
+    m_pJobSystem(nullptr),
+    m_TaskCount(0),
+    m_ParallelBatches(0),
+    m_SerialBatches(0) {
+}
+
+ParallelDabRenderer::ParallelDabRenderer(JobSystem* pJobSystem) :
+    m_pJobSystem(pJobSystem),
+    m_TaskCount(0),
+    m_ParallelBatches(0),
+    m_SerialBatches(0) {
+}
+
+ParallelDabRenderer::~ParallelDabRenderer() {
+}
+
+void ParallelDabRenderer::Stamp(Canvas& canvas, DabStamp* pStamps, size_t count) {
+    PROFILE_ZONE("ParallelDabRenderer::Stamp");
+    uint64_t pixels = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (PrepareStamp(canvas, pStamps[i])) {
+            pixels += (uint64_t)(pStamps[i].x1 - pStamps[i].x0) * (uint64_t)(pStamps[i].y1 - pStamps[i].y0);
+        } else {
+            // Marks the stamp as skipped for the binning below
+            pStamps[i].x1 = pStamps[i].x0;
+        }
+    }
+
+    if (GetThreadCount() == 1 || pixels < MIN_PARALLEL_PIXELS) {
+        m_SerialBatches++;
+        for (size_t i = 0; i < count; i++) {
+            if (pStamps[i].x0 < pStamps[i].x1) {
+                RasterizeStamp(canvas, pStamps[i]);
+            }
+        }
+        return;
+    }
+    m_ParallelBatches++;
+
+    size_t tileCount = (size_t)canvas.GetTilesX() * canvas.GetTilesY();
+    if (m_TileTasks.size() != tileCount) {
+        m_TileTasks.assign(tileCount, NO_TASK);
+    }
+
+    // Bin in batch order, so each tile's list is in the order the dabs
+    // would have been stamped. Tiles are made writable here exactly as the
+    // serial path would: erasing never allocates, but an earlier dab in the
+    // batch may already have.
+    const int tileSize = (int)Canvas::TILE_SIZE;
+    m_TaskCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        const DabStamp& stamp = pStamps[i];
+        if (stamp.x0 >= stamp.x1) continue;
+
+        for (int tileY = stamp.y0 / tileSize; tileY <= (stamp.y1 - 1) / tileSize; tileY++) {
+            for (int tileX = stamp.x0 / tileSize; tileX <= (stamp.x1 - 1) / tileSize; tileX++) {
+                if (!StampTouchesTile(stamp, tileX, tileY)) continue;
+
+                uint32_t& taskIndex = m_TileTasks[(size_t)tileY * canvas.GetTilesX() + tileX];
+                if (taskIndex == NO_TASK) {
+                    uint8_t* pTile = stamp.dab.mode == DabMode::ERASE ?
+                        canvas.GetTile((uint32_t)tileX, (uint32_t)tileY) :
+                        canvas.GetOrCreateTile((uint32_t)tileX, (uint32_t)tileY);
+                    if (!pTile) continue;
+
+                    if (m_TaskCount == m_Tasks.size()) {
+                        m_Tasks.emplace_back();
+                    }
+                    TileTask& task = m_Tasks[m_TaskCount];
+                    task.tileX = tileX;
+                    task.tileY = tileY;
+                    task.pTile = pTile;
+                    task.stamps.clear();
+                    taskIndex = m_TaskCount++;
+                }
+                m_Tasks[taskIndex].stamps.push_back((uint32_t)i);
+            }
+        }
+
+        canvas.MarkDirty(stamp.x0, stamp.y0, stamp.x1, stamp.y1);
+    }
+
+    auto stampTile = [&](uint32_t taskIndex) {
+        const TileTask& task = m_Tasks[taskIndex];
+        for (uint32_t stampIndex : task.stamps) {
+            StampTile(pStamps[stampIndex], task.pTile, task.tileX, task.tileY);
+        }
+    };
+    if (m_pJobSystem) {
+        m_pJobSystem->ParallelFor(m_TaskCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                stampTile(i);
+            }
+        });
+    } else {
+        m_pPool->Run(m_TaskCount, stampTile);
+    }
+
+    for (uint32_t i = 0; i < m_TaskCount; i++) {
+        m_TileTasks[(size_t)m_Tasks[i].tileY * canvas.GetTilesX() + m_Tasks[i].tileX] = NO_TASK;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,155 @@
+#include "../include/PenPredictor.h"
+#include <algorithm>
+#include <cmath>
+using std::min;
+using std::max;
+
+static const double DEFAULT_HISTORY_MS = 25.0;
+
+// Fraction of the fitted acceleration applied when extrapolating
+static const double ACCELERATION_DAMPING = 0.5;
+
+// Predicted speed may not exceed the fastest observed speed by more than this
+static const double SPEED_LIMIT_FACTOR = 1.2;
+
+// Time unit for the fit, so the normal equations stay well conditioned
+static const double TIME_SCALE_MS = 16.0;
+
+PenPredictor::PenPredictor() :
+    m_HistoryMs(DEFAULT_HISTORY_MS),
+    m_bFitValid(false),
+    m_bFitOk(false),
+    m_X(),
+    m_Y(),
+    m_MaxSpeed(0.0) {
+}
+
+void PenPredictor::Reset() {
+    m_Samples.clear();
+    m_bFitValid = false;
+}
+
+void PenPredictor::AddSample(const StrokeSample& sample) {
+    // Samples with the timestamp of the previous one replace it
+    if (!m_Samples.empty() && sample.timeMs <= m_Samples.back().timeMs) {
+        m_Samples.back() = sample;
+    } else {
+        m_Samples.push_back(sample);
+    }
+
+    // Keep one sample older than the window so a sparse stream still fits
+    size_t first = 0;
+    while (first + 2 < m_Samples.size() && sample.timeMs - m_Samples[first + 1].timeMs > m_HistoryMs) {
+        first++;
+    }
+    if (first > 0) {
+        m_Samples.erase(m_Samples.begin(), m_Samples.begin() + first);
+    }
+    m_bFitValid = false;
+}
+
+bool PenPredictor::Fit() const {
+    if (m_bFitValid) return m_bFitOk;
+    m_bFitValid = true;
+    m_bFitOk = false;
+
+    size_t count = m_Samples.size();
+    if (count < 2) return false;
+
+    const StrokeSample& newest = m_Samples.back();
+
+    // Normal equations for x(t) = c0 + c1 t + c2 t^2, t <= 0 at the samples
+    double s[5] = {};
+    double sx[3] = {};
+    double sy[3] = {};
+    m_MaxSpeed = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        const StrokeSample& sample = m_Samples[i];
+        double t = (sample.timeMs - newest.timeMs) / TIME_SCALE_MS;
+        double power = 1.0;
+        for (int k = 0; k < 5; k++) {
+            if (k < 3) {
+                sx[k] += power * sample.x;
+                sy[k] += power * sample.y;
+            }
+            s[k] += power;
+            power *= t;
+        }
+
+        if (i > 0) {
+            const StrokeSample& previous = m_Samples[i - 1];
+            double dt = (sample.timeMs - previous.timeMs) / TIME_SCALE_MS;
+            double dx = sample.x - previous.x;
+            double dy = sample.y - previous.y;
+            m_MaxSpeed = max(m_MaxSpeed, std::sqrt(dx * dx + dy * dy) / dt);
+        }
+    }
+
+    if (count >= 3) {
+        // Solve the 3x3 system with Cramer's rule
+        double a = s[0], b = s[1], c = s[2], d = s[3], e = s[4];
+        double det = a * (c * e - d * d) - b * (b * e - c * d) + c * (b * d - c * c);
+        if (std::fabs(det) > 1e-9) {
+            const double* rhs[2] = { sx, sy };
+            double* coefficients[2] = { m_X, m_Y };
+            for (int axis = 0; axis < 2; axis++) {
+                const double* r = rhs[axis];
+                coefficients[axis][0] = (r[0] * (c * e - d * d) - b * (r[1] * e - d * r[2]) + c * (r[1] * d - c * r[2])) / det;
+                coefficients[axis][1] = (a * (r[1] * e - d * r[2]) - r[0] * (b * e - c * d) + c * (b * r[2] - r[1] * c)) / det;
+                coefficients[axis][2] = (a * (c * r[2] - r[1] * d) - b * (b * r[2] - r[1] * c) + r[0] * (b * d - c * c)) / det;
+            }
+            m_bFitOk = true;
+            return true;
+        }
+    }
+
+    // Straight line through the two newest samples
+    const StrokeSample& previous = m_Samples[count - 2];
+    double dt = (newest.timeMs - previous.timeMs) / TIME_SCALE_MS;
+    m_X[0] = newest.x;
+    m_Y[0] = newest.y;
+    m_X[1] = (newest.x - previous.x) / dt;
+    m_Y[1] = (newest.y - previous.y) / dt;
+    m_X[2] = 0.0;
+    m_Y[2] = 0.0;
+    m_bFitOk = true;
+    return true;
+}
+
+bool PenPredictor::Predict(double horizonMs, StrokeSample& predicted) const {
+    if (!Fit()) return false;
+
+    const StrokeSample& newest = m_Samples.back();
+    double t = max(horizonMs, 0.0) / TIME_SCALE_MS;
+
+    // Extrapolate from the newest sample itself rather than the fitted
+    // value, so the tail always starts where the real stroke ends
+    double dx = m_X[1] * t + m_X[2] * ACCELERATION_DAMPING * t * t;
+    double dy = m_Y[1] * t + m_Y[2] * ACCELERATION_DAMPING * t * t;
+
+    double distance = std::sqrt(dx * dx + dy * dy);
+    double maxDistance = m_MaxSpeed * SPEED_LIMIT_FACTOR * t;
+    if (distance > maxDistance && distance > 0.0) {
+        dx *= maxDistance / distance;
+        dy *= maxDistance / distance;
+    }
+
+    predicted = newest;
+    predicted.x = newest.x + (float)dx;
+    predicted.y = newest.y + (float)dy;
+    predicted.timeMs = newest.timeMs + horizonMs;
+    return true;
+}
+
+bool PenPredictor::PredictPath(double horizonMs, double stepMs, std::vector<StrokeSample>& out) const {
+    if (horizonMs <= 0.0 || stepMs <= 0.0 || !Fit()) return false;
+
+    StrokeSample point;
+    for (double t = stepMs; t < horizonMs; t += stepMs) {
+        Predict(t, point);
+        out.push_back(point);
+    }
+    Predict(horizonMs, point);
+    out.push_back(point);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "../include/PixelConvert.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PIXEL_CONVERT_SSE2 1
+#endif
+using std::min;
+using std::max;
+
+// x / 255 rounded to nearest, exact for 0 <= x <= 255 * 255
+static inline uint32_t DivideBy255(uint32_t x) {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+}
+
+void ExpandRGBToRGBA(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount, bool swapRB) {
+    size_t i = 0;
+
+    // Four-byte loads read one byte past each pixel, so stop one pixel early
+    // and finish with byte copies
+    for (; i + 1 < pixelCount; i++) {
+        uint32_t pixel;
+        memcpy(&pixel, pSrc + i * 3, 4);
+        if (swapRB) {
+            pixel = (pixel & 0x0000FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+        }
+        pixel |= 0xFF000000;
+        memcpy(pDst + i * 4, &pixel, 4);
+    }
+
+    for (; i < pixelCount; i++) {
+        const uint8_t* pIn = pSrc + i * 3;
+        uint8_t* pOut = pDst + i * 4;
+        pOut[0] = swapRB ? pIn[2] : pIn[0];
+        pOut[1] = pIn[1];
+        pOut[2] = swapRB ? pIn[0] : pIn[2];
+        pOut[3] = 0xFF;
+    }
+}
+
+void SwizzleBGRAToRGBA(const uint8_t* pSrc, uint8_t* pDst, size_t pixelCount) {
+    size_t i = 0;
+
+#ifdef PIXEL_CONVERT_SSE2
+    const __m128i maskGA = _mm_set1_epi32((int)0xFF00FF00);
+    const __m128i maskLow = _mm_set1_epi32(0x000000FF);
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(pSrc + i * 4));
+        __m128i ga = _mm_and_si128(pixels, maskGA);
+        __m128i b = _mm_and_si128(_mm_srli_epi32(pixels, 16), maskLow);
+        __m128i r = _mm_slli_epi32(_mm_and_si128(pixels, maskLow), 16);
+        _mm_storeu_si128((__m128i*)(pDst + i * 4), _mm_or_si128(ga, _mm_or_si128(b, r)));
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        uint32_t pixel;
+        memcpy(&pixel, pSrc + i * 4, 4);
+        pixel = (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+        memcpy(pDst + i * 4, &pixel, 4);
+    }
+}
+
+void PremultiplyAlpha(uint8_t* pPixels, size_t pixelCount) {
+    size_t i = 0;
+
+#ifdef PIXEL_CONVERT_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    // Keep the original alpha: multiply the alpha lane by 255 instead
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    const __m128i alpha255 = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+
+    for (; i + 4 <= pixelCount; i += 4) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(pPixels + i * 4));
+        __m128i halves[2] = { _mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero) };
+
+        for (__m128i& half : halves) {
+            // Broadcast each pixel's alpha across its four lanes
+            __m128i alpha = _mm_shufflelo_epi16(half, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+            alpha = _mm_or_si128(_mm_andnot_si128(alphaMask, alpha), alpha255);
+
+            __m128i x = _mm_add_epi16(_mm_mullo_epi16(half, alpha), bias);
+            half = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+        }
+
+        _mm_storeu_si128((__m128i*)(pPixels + i * 4), _mm_packus_epi16(halves[0], halves[1]));
+    }
+#endif
+
+    for (; i < pixelCount; i++) {
+        uint8_t* p = pPixels + i * 4;
+        uint32_t alpha = p[3];
+        p[0] = (uint8_t)DivideBy255(p[0] * alpha);
+        p[1] = (uint8_t)DivideBy255(p[1] * alpha);
+        p[2] = (uint8_t)DivideBy255(p[2] * alpha);
+    }
+}
+
+void DownsampleBox(const uint8_t* pSrc, uint32_t width, uint32_t height, uint8_t* pDst) {
+    uint32_t dstWidth = max(1u, width / 2);
+    uint32_t dstHeight = max(1u, height / 2);
+    size_t srcPitch = (size_t)width * 4;
+
+    for (uint32_t y = 0; y < dstHeight; y++) {
+        const uint8_t* pRow0 = pSrc + (size_t)min(y * 2, height - 1) * srcPitch;
+        const uint8_t* pRow1 = pSrc + (size_t)min(y * 2 + 1, height - 1) * srcPitch;
+        uint8_t* pOut = pDst + (size_t)y * dstWidth * 4;
+        uint32_t x = 0;
+
+#ifdef PIXEL_CONVERT_SSE2
+        // Two output pixels from a 4x2 block per iteration
+        if (width >= 2) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+            for (; x + 2 <= dstWidth && x * 2 + 4 <= width; x += 2) {
+                __m128i row0 = _mm_loadu_si128((const __m128i*)(pRow0 + x * 8));
+                __m128i row1 = _mm_loadu_si128((const __m128i*)(pRow1 + x * 8));
+
+                __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+                __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+                sumLo = _mm_add_epi16(sumLo, _mm_srli_si128(sumLo, 8));
+                sumHi = _mm_add_epi16(sumHi, _mm_srli_si128(sumHi, 8));
+
+                __m128i sum = _mm_unpacklo_epi64(sumLo, sumHi);
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+                _mm_storel_epi64((__m128i*)(pOut + x * 4), _mm_packus_epi16(sum, sum));
+            }
+        }
+#endif
+
+        for (; x < dstWidth; x++) {
+            uint32_t x0 = min(x * 2, width - 1);
+            uint32_t x1 = min(x * 2 + 1, width - 1);
+            for (int c = 0; c < 4; c++) {
+                uint32_t sum = pRow0[x0 * 4 + c] + pRow0[x1 * 4 + c] + pRow1[x0 * 4 + c] + pRow1[x1 * 4 + c];
+                pOut[x * 4 + c] = (uint8_t)((sum + 2) >> 2);
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -1,19 +1,33 @@
 #include "../include/PressureBrush.h"
+#include "../include/Canvas.h"
+#include "../include/DabRasterizer.h"
+#include "../include/ParallelDabRenderer.h"
 #include <algorithm>
+#include <cmath>
 using std::min;
 using std::max;
 
+// Shortest step between dabs in pixels, so tiny brushes cannot flood the batch
+static const float MIN_DAB_STEP = 0.25f;
+
 PressureBrush::PressureBrush(const std::string& name, float minSize, float maxSize) :
     m_Name(name),
     m_MinSize(minSize),
     m_MaxSize(maxSize),
     m_CurrentSize(minSize),
     m_Hardness(0.5f),
-    m_Spacing(1.0f),
+    m_Spacing(0.1f),
     m_Flow(1.0f),
+    m_SmudgeRate(0.25f),
+    m_TiltAngle(0.0f),
     m_Type(BrushType::STANDARD),
-    m_LastX(-1),
-    m_LastY(-1) {
+    m_bMaskCache(true),
+    m_pRenderer(nullptr),
+    m_LastX(0.0f),
+    m_LastY(0.0f),
+    m_LastPressure(0.0f),
+    m_DistanceToNextDab(0.0f),
+    m_bHasLastPoint(false) {
 }
 
 PressureBrush::~PressureBrush() {
@@ -24,35 +38,176 @@ void PressureBrush::SetHardness(float hardness) {
 }
 
 void PressureBrush::SetSpacing(float spacing) {
-    m_Spacing = max(0.1f, spacing);
+    m_Spacing = max(0.01f, min(10.0f, spacing));
 }
 
 void PressureBrush::SetFlow(float flow) {
     m_Flow = max(0.0f, min(1.0f, flow));
 }
 
+void PressureBrush::SetSmudgeRate(float rate) {
+    m_SmudgeRate = max(0.0f, min(1.0f, rate));
+}
+
+bool PressureBrush::SetTipTexture(const Image& image) {
+    return m_Tip.SetTexture(image);
+}
+
+bool PressureBrush::SetTipTexture(const uint8_t* pPixels, uint32_t width, uint32_t height) {
+    return m_Tip.SetTexture(pPixels, width, height);
+}
+
+void PressureBrush::SetTilt(float tiltX, float tiltY) {
+    if (tiltX != 0.0f || tiltY != 0.0f) {
+        m_TiltAngle = std::atan2(tiltY, tiltX);
+    }
+}
+
 void PressureBrush::UpdateWithPressure(float pressure) {
     // Adjust brush size based on pressure
+    m_CurrentSize = GetSizeForPressure(pressure);
+}
+
+float PressureBrush::GetSizeForPressure(float pressure) const {
     float pressureFactor = max(0.0f, min(1.0f, pressure));
-    m_CurrentSize = m_MinSize + (m_MaxSize - m_MinSize) * pressureFactor;
+    return m_MinSize + (m_MaxSize - m_MinSize) * pressureFactor;
 }
 
-void PressureBrush::ApplyStroke(float x, float y, float pressure, ID3D11DeviceContext* pContext) {
-    // Determine if we should draw at this position based on spacing
-    if (m_LastX != -1 && m_LastY != -1) {
-        float dist = sqrt((x - m_LastX) * (x - m_LastX) + (y - m_LastY) * (y - m_LastY));
-        if (dist < m_Spacing) {
-            return; // Skip drawing if too close to last point
-        }
+void PressureBrush::EmitDabs(float x, float y, float pressure, float r, float g, float b, float a,
+                             std::vector<Dab>& dabs) {
+    Dab dab;
+    dab.hardness = m_Hardness;
+    dab.opacity = m_Flow;
+    dab.r = r;
+    dab.g = g;
+    dab.b = b;
+    dab.a = a;
+    dab.angle = m_TiltAngle;
+    dab.mode = m_Type == BrushType::ERASER ? DabMode::ERASE :
+               m_Type == BrushType::SMUDGE ? DabMode::SMUDGE : DabMode::PAINT;
+
+    if (!m_bHasLastPoint) {
+        UpdateWithPressure(pressure);
+        dab.x = x;
+        dab.y = y;
+        dab.radius = m_CurrentSize * 0.5f;
+        dabs.push_back(dab);
+
+        m_LastX = x;
+        m_LastY = y;
+        m_LastPressure = pressure;
+        m_DistanceToNextDab = max(m_Spacing * m_CurrentSize, MIN_DAB_STEP);
+        m_bHasLastPoint = true;
+        return;
     }
-    
-    // Update brush properties based on pressure
-    UpdateWithPressure(pressure);
-    
-    // Store current position for next spacing check
+
+    float dx = x - m_LastX;
+    float dy = y - m_LastY;
+    float length = sqrt(dx * dx + dy * dy);
+
+    // Each step is sized from the pressure where the dab lands, so spacing
+    // follows the brush as it grows and shrinks along the segment
+    float travelled = 0.0f;
+    while (length - travelled >= m_DistanceToNextDab) {
+        travelled += m_DistanceToNextDab;
+        float t = travelled / length;
+        float dabPressure = m_LastPressure + (pressure - m_LastPressure) * t;
+
+        UpdateWithPressure(dabPressure);
+        dab.x = m_LastX + dx * t;
+        dab.y = m_LastY + dy * t;
+        dab.radius = m_CurrentSize * 0.5f;
+        dabs.push_back(dab);
+
+        m_DistanceToNextDab = max(m_Spacing * m_CurrentSize, MIN_DAB_STEP);
+    }
+    m_DistanceToNextDab -= length - travelled;
+
     m_LastX = x;
     m_LastY = y;
-    
-    // In a real implementation, we would render the brush mark to the current render target
-    // For now, we'll just log that the stroke was applied
+    m_LastPressure = pressure;
+}
+
+void PressureBrush::ApplyStroke(float x, float y, float pressure, Canvas* pCanvas,
+                                float r, float g, float b, float a) {
+    m_Dabs.clear();
+    EmitDabs(x, y, pressure, r, g, b, a, m_Dabs);
+
+    if (pCanvas && !m_Dabs.empty()) {
+        StampDabs(*pCanvas, m_Dabs.data(), m_Dabs.size());
+    }
+}
+
+void PressureBrush::StampDabs(Canvas& canvas, const Dab* pDabs, size_t count) {
+    if (m_Type == BrushType::SMUDGE) {
+        // Each dab carries colour to the next, so smudging stays serial.
+        // Sized for the largest dab; reset at the start of every stroke.
+        if (!m_Smudge.loaded) {
+            m_Smudge.Reset((uint32_t)std::ceil(m_MaxSize) + 2);
+        }
+        for (size_t i = 0; i < count; i++) {
+            RasterizeSmudgeDab(canvas, pDabs[i], m_Smudge, m_SmudgeRate);
+        }
+        return;
+    }
+
+    // Masks are looked up first and held until the whole batch is stamped
+    bool bTextured = m_Type == BrushType::TEXTURED && !m_Tip.IsEmpty();
+    m_Stamps.resize(count);
+    if (bTextured) {
+        m_Tip.BeginBatch();
+        for (size_t i = 0; i < count; i++) {
+            m_Tip.MakeStamp(pDabs[i], m_Stamps[i]);
+        }
+    } else if (m_bMaskCache) {
+        m_MaskCache.BeginBatch();
+        for (size_t i = 0; i < count; i++) {
+            m_MaskCache.MakeStamp(pDabs[i], m_Stamps[i]);
+        }
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            m_Stamps[i] = DabStamp();
+            m_Stamps[i].dab = pDabs[i];
+        }
+    }
+
+    if (m_pRenderer) {
+        m_pRenderer->Stamp(canvas, m_Stamps.data(), m_Stamps.size());
+    } else {
+        for (DabStamp& stamp : m_Stamps) {
+            RasterizeStamp(canvas, stamp);
+        }
+    }
+
+    if (bTextured) {
+        m_Tip.EndBatch();
+    } else if (m_bMaskCache) {
+        m_MaskCache.EndBatch();
+    }
+}
+
+void PressureBrush::ResetStroke() {
+    m_bHasLastPoint = false;
+    m_DistanceToNextDab = 0.0f;
+    m_Smudge.loaded = false;
+}
+
+BrushStrokeState PressureBrush::GetStrokeState() const {
+    BrushStrokeState state;
+    state.lastX = m_LastX;
+    state.lastY = m_LastY;
+    state.lastPressure = m_LastPressure;
+    state.distanceToNextDab = m_DistanceToNextDab;
+    state.currentSize = m_CurrentSize;
+    state.hasLastPoint = m_bHasLastPoint;
+    return state;
+}
+
+void PressureBrush::SetStrokeState(const BrushStrokeState& state) {
+    m_LastX = state.lastX;
+    m_LastY = state.lastY;
+    m_LastPressure = state.lastPressure;
+    m_DistanceToNextDab = state.distanceToNextDab;
+    m_CurrentSize = state.currentSize;
+    m_bHasLastPoint = state.hasLastPoint;
 }
\ No newline at end of file
@@ -0,0 +1,279 @@
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+using std::min;
+using std::max;
+
+std::atomic<bool> Profiler::s_bEnabled(false);
+thread_local ProfileThreadBuffer* Profiler::t_pBuffer = nullptr;
+
+// Every thread that has captured a zone; a buffer's index is its thread id.
+// A buffer outlives its thread and is handed to the next new thread once
+// everything in it has been collected.
+static std::mutex s_ThreadMutex;
+static std::vector<std::unique_ptr<ProfileThreadBuffer>> s_Buffers;
+static std::vector<std::string> s_ThreadNames;
+static thread_local std::string t_ThreadName;
+
+// Retires the thread's buffer when the thread exits
+struct ProfileThreadExit {
+    ProfileThreadBuffer* pBuffer = nullptr;
+    ~ProfileThreadExit() {
+        if (pBuffer) {
+            pBuffer->m_bRetired.store(true, std::memory_order_release);
+        }
+    }
+};
+static thread_local ProfileThreadExit t_ThreadExit;
+
+// Collector state
+static std::vector<ProfileFrame> s_Frames;
+static size_t s_FrameNext = 0;
+static size_t s_FrameCount = 0;
+static uint32_t s_FrameHistory = Profiler::DEFAULT_FRAME_HISTORY;
+static uint64_t s_FrameIndex = 0;
+static uint64_t s_FrameStartTicks = 0;
+
+// Ticks are converted against steady_clock since this point
+static uint64_t GetSteadyNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+static const uint64_t s_BaseTicks = Profiler::GetTicks();
+static const uint64_t s_BaseNs = GetSteadyNs();
+static double s_NsPerTick = 1.0;
+static bool s_bCalibrated = false;
+
+ProfileThreadBuffer::ProfileThreadBuffer(uint32_t threadId) :
+    m_Events(CAPACITY),
+    m_ThreadId(threadId),
+    m_Depth(0),
+    m_TailCache(0),
+    m_Head(0),
+    m_Dropped(0),
+    m_Tail(0),
+    m_bRetired(false) {
+}
+
+void ProfileThreadBuffer::Drain(std::vector<ProfileEvent>& events) {
+    uint64_t tail = m_Tail.load(std::memory_order_relaxed);
+    uint64_t head = m_Head.load(std::memory_order_acquire);
+    for (; tail != head; tail++) {
+        events.push_back(m_Events[tail & (CAPACITY - 1)]);
+    }
+    m_Tail.store(tail, std::memory_order_release);
+}
+
+void Profiler::SetEnabled(bool bEnabled) {
+    s_bEnabled.store(bEnabled, std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(const char* pName) {
+    t_ThreadName = pName;
+    if (t_pBuffer) {
+        std::lock_guard<std::mutex> lock(s_ThreadMutex);
+        s_ThreadNames[t_pBuffer->GetThreadId()] = t_ThreadName;
+    }
+}
+
+ProfileThreadBuffer* Profiler::RegisterThread() {
+    std::lock_guard<std::mutex> lock(s_ThreadMutex);
+
+    ProfileThreadBuffer* pBuffer = nullptr;
+    for (auto& buffer : s_Buffers) {
+        if (buffer->m_bRetired.load(std::memory_order_acquire) &&
+            buffer->m_Head.load(std::memory_order_relaxed) == buffer->m_Tail.load(std::memory_order_acquire)) {
+            pBuffer = buffer.get();
+            pBuffer->m_bRetired.store(false, std::memory_order_relaxed);
+            pBuffer->m_Depth = 0;
+            pBuffer->m_TailCache = pBuffer->m_Tail.load(std::memory_order_relaxed);
+            break;
+        }
+    }
+    if (!pBuffer) {
+        s_Buffers.push_back(std::make_unique<ProfileThreadBuffer>((uint32_t)s_Buffers.size()));
+        s_ThreadNames.emplace_back();
+        pBuffer = s_Buffers.back().get();
+    }
+
+    uint32_t threadId = pBuffer->GetThreadId();
+    s_ThreadNames[threadId] = t_ThreadName.empty() ? "Thread " + std::to_string(threadId) : t_ThreadName;
+    t_ThreadExit.pBuffer = pBuffer;
+    t_pBuffer = pBuffer;
+    return pBuffer;
+}
+
+void Profiler::Calibrate() {
+#ifdef PROFILER_RDTSC
+    // The longer since the base, the better the rate; the first time wait
+    // long enough for a usable one
+    uint64_t elapsedNs = GetSteadyNs() - s_BaseNs;
+    if (!s_bCalibrated && elapsedNs < 10000000) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(10000000 - elapsedNs));
+    }
+    uint64_t ticks = GetTicks();
+    uint64_t ns = GetSteadyNs();
+    if (ticks > s_BaseTicks) {
+        s_NsPerTick = (double)(ns - s_BaseNs) / (double)(ticks - s_BaseTicks);
+    }
+#endif
+    s_bCalibrated = true;
+}
+
+double Profiler::TicksToNs(uint64_t ticks) {
+    if (!s_bCalibrated) {
+        Calibrate();
+    }
+    return (double)ticks * s_NsPerTick;
+}
+
+void Profiler::EndFrame() {
+    uint64_t now = GetTicks();
+    if (s_Frames.size() != s_FrameHistory) {
+        s_Frames.resize(s_FrameHistory);
+        s_FrameNext = 0;
+        s_FrameCount = 0;
+    }
+
+    ProfileFrame& frame = s_Frames[s_FrameNext];
+    frame.index = s_FrameIndex++;
+    frame.startTicks = s_FrameStartTicks ? s_FrameStartTicks : now;
+    frame.endTicks = now;
+    frame.events.clear();
+    {
+        std::lock_guard<std::mutex> lock(s_ThreadMutex);
+        for (auto& buffer : s_Buffers) {
+            buffer->Drain(frame.events);
+        }
+    }
+
+    s_FrameNext = (s_FrameNext + 1) % s_Frames.size();
+    s_FrameCount = min(s_FrameCount + 1, s_Frames.size());
+    s_FrameStartTicks = now;
+    Calibrate();
+}
+
+void Profiler::SetFrameHistory(uint32_t frames) {
+    s_FrameHistory = max(1u, frames);
+    Clear();
+}
+
+size_t Profiler::GetFrameCount() {
+    return s_FrameCount;
+}
+
+const ProfileFrame& Profiler::GetFrame(size_t index) {
+    size_t oldest = (s_FrameNext + s_Frames.size() - s_FrameCount) % s_Frames.size();
+    return s_Frames[(oldest + index) % s_Frames.size()];
+}
+
+void Profiler::Clear() {
+    s_Frames.clear();
+    s_FrameNext = 0;
+    s_FrameCount = 0;
+    s_FrameStartTicks = 0;
+
+    // Zones still buffered belong to the frames just dropped
+    std::vector<ProfileEvent> discard;
+    std::lock_guard<std::mutex> lock(s_ThreadMutex);
+    for (auto& buffer : s_Buffers) {
+        buffer->Drain(discard);
+        discard.clear();
+    }
+}
+
+void Profiler::Summarize(std::vector<ProfileZoneSummary>& summary) {
+    summary.clear();
+
+    // The same name can be a different literal in each translation unit
+    std::map<std::string, size_t> zones;
+    for (size_t i = 0; i < s_FrameCount; i++) {
+        for (const ProfileEvent& event : GetFrame(i).events) {
+            auto inserted = zones.emplace(event.pName, summary.size());
+            if (inserted.second) {
+                summary.push_back({ event.pName, 0, 0.0, 0.0, 0.0 });
+            }
+            ProfileZoneSummary& zone = summary[inserted.first->second];
+            double ms = TicksToMs(event.endTicks - event.startTicks);
+            zone.calls++;
+            zone.totalMs += ms;
+            zone.maxMs = max(zone.maxMs, ms);
+        }
+    }
+
+    for (auto& zone : summary) {
+        zone.perFrameMs = s_FrameCount > 0 ? zone.totalMs / (double)s_FrameCount : 0.0;
+    }
+    std::sort(summary.begin(), summary.end(), [](const ProfileZoneSummary& a, const ProfileZoneSummary& b) {
+        return a.totalMs > b.totalMs;
+    });
+}
+
+static void WriteJsonString(FILE* pFile, const char* pText) {
+    fputc('"', pFile);
+    for (const char* p = pText; *p; p++) {
+        unsigned char c = (unsigned char)*p;
+        if (c == '"' || c == '\\') {
+            fputc('\\', pFile);
+            fputc(c, pFile);
+        } else if (c < 0x20) {
+            fprintf(pFile, "\\u%04x", c);
+        } else {
+            fputc(c, pFile);
+        }
+    }
+    fputc('"', pFile);
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path) {
+    FILE* pFile = fopen(path.c_str(), "wb");
+    if (!pFile) {
+        return false;
+    }
+
+    // Timestamps are microseconds since the profiler started
+    auto toUs = [](uint64_t ticks) {
+        return ticks > s_BaseTicks ? TicksToNs(ticks - s_BaseTicks) * 1e-3 : 0.0;
+    };
+
+    fprintf(pFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Engine\"}}");
+    {
+        std::lock_guard<std::mutex> lock(s_ThreadMutex);
+        for (size_t i = 0; i < s_ThreadNames.size(); i++) {
+            fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", (uint32_t)i);
+            WriteJsonString(pFile, s_ThreadNames[i].c_str());
+            fprintf(pFile, "}}");
+        }
+    }
+
+    for (size_t i = 0; i < s_FrameCount; i++) {
+        const ProfileFrame& frame = GetFrame(i);
+        fprintf(pFile, ",\n{\"name\":\"Frame %llu\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+                (unsigned long long)frame.index, toUs(frame.startTicks));
+        for (const ProfileEvent& event : frame.events) {
+            double startUs = toUs(event.startTicks);
+            fprintf(pFile, ",\n{\"name\":");
+            WriteJsonString(pFile, event.pName);
+            fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    event.threadId, startUs, toUs(event.endTicks) - startUs);
+        }
+    }
+    fprintf(pFile, "\n]}\n");
+
+    bool bOk = ferror(pFile) == 0;
+    return fclose(pFile) == 0 && bOk;
+}
+
+uint64_t Profiler::GetDroppedCount() {
+    std::lock_guard<std::mutex> lock(s_ThreadMutex);
+    uint64_t dropped = 0;
+    for (auto& buffer : s_Buffers) {
+        dropped += buffer->GetDroppedCount();
+    }
+    return dropped;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "../include/RenderCommandList.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+RenderCommand& RenderCommandList::Add(RenderCommandType type) {
+    m_Commands.emplace_back();
+    RenderCommand& command = m_Commands.back();
+    command.type = type;
+    return command;
+}
+
+void RenderCommandList::Clear(float r, float g, float b, float a) {
+    RenderCommand& command = Add(RenderCommandType::CLEAR);
+    command.clear.r = r;
+    command.clear.g = g;
+    command.clear.b = b;
+    command.clear.a = a;
+}
+
+void RenderCommandList::SetLayer(uint32_t layer) {
+    Add(RenderCommandType::SET_LAYER).layer = layer;
+}
+
+void RenderCommandList::SetBlendMode(BlendMode blendMode) {
+    Add(RenderCommandType::SET_BLEND_MODE).blendMode = blendMode;
+}
+
+void RenderCommandList::SetDepth(float depth) {
+    Add(RenderCommandType::SET_DEPTH).depth = depth;
+}
+
+void RenderCommandList::DrawQuad(float x, float y, float width, float height, uint32_t textureId,
+                                 uint32_t color, float rotation, float u0, float v0, float u1, float v1) {
+    RenderCommand& command = Add(RenderCommandType::DRAW_QUAD);
+    SpriteInstance& instance = command.quad.instance;
+    instance.x = x;
+    instance.y = y;
+    instance.width = width;
+    instance.height = height;
+    instance.rotation = rotation;
+    instance.u0 = PackUNorm16(u0);
+    instance.v0 = PackUNorm16(v0);
+    instance.u1 = PackUNorm16(u1);
+    instance.v1 = PackUNorm16(v1);
+    instance.color = color;
+    command.quad.textureId = textureId;
+}
+
+void RenderCommandList::DrawSprite(Sprite* pSprite, float x, float y, float scaleX, float scaleY,
+                                   float rotation, uint32_t color) {
+    if (!pSprite) return;
+
+    RenderCommand& command = Add(RenderCommandType::DRAW_SPRITE);
+    command.sprite.pSprite = pSprite;
+    command.sprite.x = x;
+    command.sprite.y = y;
+    command.sprite.scaleX = scaleX;
+    command.sprite.scaleY = scaleY;
+    command.sprite.rotation = rotation;
+    command.sprite.color = color;
+}
+
+void RenderCommandList::DrawLine(float x1, float y1, float x2, float y2, float thickness,
+                                 float r, float g, float b, float a) {
+    RenderCommand& command = Add(RenderCommandType::DRAW_LINE);
+    command.line.x1 = x1;
+    command.line.y1 = y1;
+    command.line.x2 = x2;
+    command.line.y2 = y2;
+    command.line.thickness = thickness;
+    command.line.r = r;
+    command.line.g = g;
+    command.line.b = b;
+    command.line.a = a;
+}
+
+void RenderCommandList::DrawCircle(float centerX, float centerY, float radius, float r, float g, float b, float a) {
+    RenderCommand& command = Add(RenderCommandType::DRAW_CIRCLE);
+    command.circle.centerX = centerX;
+    command.circle.centerY = centerY;
+    command.circle.radius = radius;
+    command.circle.r = r;
+    command.circle.g = g;
+    command.circle.b = b;
+    command.circle.a = a;
+}
+
+uint8_t* RenderCommandList::UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    RenderCommand& command = Add(RenderCommandType::UPDATE_TEXTURE);
+    command.texture.textureId = textureId;
+    command.texture.x = x;
+    command.texture.y = y;
+    command.texture.width = width;
+    command.texture.height = height;
+    command.texture.dataOffset = m_Data.size();
+    m_Data.resize(m_Data.size() + (size_t)width * height * 4);
+    return m_Data.data() + command.texture.dataOffset;
+}
+
+void RenderCommandList::Flush() {
+    Add(RenderCommandType::FLUSH);
+}
+
+void RenderCommandList::Present() {
+    Add(RenderCommandType::PRESENT);
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "../include/RenderQueue.h"
+#include <cstring>
+
+RenderQueue::RenderQueue() {
+}
+
+void RenderQueue::Add(uint64_t sortKey, uint32_t firstIndex, uint32_t indexCount) {
+    // Consecutive primitives with the same key are one command
+    if (!m_Commands.empty()) {
+        Command& last = m_Commands.back();
+        if (last.sortKey == sortKey && last.firstIndex + last.indexCount == firstIndex) {
+            last.indexCount += indexCount;
+            return;
+        }
+    }
+
+    m_Commands.push_back({ sortKey, firstIndex, indexCount });
+}
+
+void RenderQueue::SortCommands() {
+    const uint32_t count = (uint32_t)m_Commands.size();
+    if (count < 2) {
+        return;
+    }
+
+    // LSD radix sort on 8-bit digits; all histograms are built in one pass
+    uint32_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+    for (const Command& command : m_Commands) {
+        for (int digit = 0; digit < 8; digit++) {
+            histograms[digit][(command.sortKey >> (digit * 8)) & 0xFF]++;
+        }
+    }
+
+    m_Scratch.resize(count);
+    Command* pSrc = m_Commands.data();
+    Command* pDst = m_Scratch.data();
+
+    for (int digit = 0; digit < 8; digit++) {
+        uint32_t* pHistogram = histograms[digit];
+
+        // Every key has the same digit: this pass would not move anything
+        if (pHistogram[(pSrc[0].sortKey >> (digit * 8)) & 0xFF] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            uint32_t bucketCount = pHistogram[bucket];
+            pHistogram[bucket] = offset;
+            offset += bucketCount;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            pDst[pHistogram[(pSrc[i].sortKey >> (digit * 8)) & 0xFF]++] = pSrc[i];
+        }
+        std::swap(pSrc, pDst);
+    }
+
+    if (pSrc != m_Commands.data()) {
+        m_Commands.swap(m_Scratch);
+    }
+}
+
+void RenderQueue::Build(const uint16_t* pIndices, std::vector<uint16_t>& sortedIndices, std::vector<DrawRun>& runs) {
+    runs.clear();
+    sortedIndices.clear();
+    if (m_Commands.empty()) {
+        return;
+    }
+
+    SortCommands();
+
+    uint32_t totalIndices = 0;
+    for (const Command& command : m_Commands) {
+        totalIndices += command.indexCount;
+    }
+    sortedIndices.resize(totalIndices);
+
+    uint32_t writeIndex = 0;
+    for (const Command& command : m_Commands) {
+        memcpy(&sortedIndices[writeIndex], pIndices + command.firstIndex, command.indexCount * sizeof(uint16_t));
+
+        // Depth and layer only order primitives; runs split on state alone
+        if (!runs.empty() && ((runs.back().sortKey ^ command.sortKey) & SortKey::STATE_MASK) == 0) {
+            runs.back().indexCount += command.indexCount;
+        } else {
+            runs.push_back({ command.sortKey, writeIndex, command.indexCount });
+        }
+        writeIndex += command.indexCount;
+    }
+}
+
+uint32_t RenderQueue::CountStateChanges(uint64_t fromKey, uint64_t toKey) {
+    uint64_t diff = fromKey ^ toKey;
+
+    uint32_t changes = 0;
+    if (diff & (SortKey::BLEND_MASK << SortKey::BLEND_SHIFT)) changes++;
+    if (diff & (SortKey::SHADER_MASK << SortKey::SHADER_SHIFT)) changes++;
+    if (diff & (SortKey::TEXTURE_MASK << SortKey::TEXTURE_SHIFT)) changes++;
+    return changes;
+}
\ No newline at end of file
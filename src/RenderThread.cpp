@@ -0,0 +1,201 @@
+#include "../include/RenderThread.h"
+#include "../include/Profiler.h"
+#include "../include/Renderer.h"
+#include <algorithm>
+#include <chrono>
+using std::min;
+using std::max;
+
+RenderThread::RenderThread(Renderer* pRenderer) :
+    m_pRenderer(pRenderer),
+    m_pRecording(&m_Lists[0]),
+    m_pExecuting(&m_Lists[1]),
+    m_bFramePending(false),
+    m_bRunning(false),
+    m_bThreaded(false),
+    m_FramesDone(0),
+    m_FrameRenderMs(0.0),
+    m_FrameCount(0),
+    m_LastRenderMs(0.0),
+    m_LastWaitMs(0.0),
+    m_WaitStartMs(-1.0) {
+}
+
+RenderThread::~RenderThread() {
+    Stop();
+}
+
+bool RenderThread::Start(bool bThreaded) {
+    if (m_bRunning || !m_pRenderer) {
+        return false;
+    }
+
+    m_bThreaded = bThreaded;
+    m_bRunning = true;
+    if (m_bThreaded) {
+        m_Thread = std::thread(&RenderThread::ThreadMain, this);
+    }
+    return true;
+}
+
+void RenderThread::Stop() {
+    if (!m_bRunning) {
+        return;
+    }
+
+    if (m_bThreaded) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_bRunning = false;
+        }
+        m_FrameCondition.notify_one();
+        m_Thread.join();
+    } else {
+        m_bRunning = false;
+    }
+}
+
+bool RenderThread::SubmitFrame(uint32_t timeoutMs) {
+    if (!m_bRunning) {
+        return false;
+    }
+
+    // A wait that timed out carries on from where it started
+    if (m_WaitStartMs < 0.0) {
+        m_WaitStartMs = GetTimeMs();
+    }
+
+    if (!m_bThreaded) {
+        Execute(*m_pRecording);
+        m_pRecording->Reset();
+        m_FrameCount = ++m_FramesDone;
+        m_LastRenderMs = m_LastWaitMs = GetTimeMs() - m_WaitStartMs;
+        m_WaitStartMs = -1.0;
+        return true;
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        auto bFrameDone = [this] { return !m_bFramePending; };
+        if (timeoutMs == WAIT_FOREVER) {
+            m_DoneCondition.wait(lock, bFrameDone);
+        } else if (!m_DoneCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), bFrameDone)) {
+            return false;
+        }
+
+        std::swap(m_pRecording, m_pExecuting);
+        m_bFramePending = true;
+        m_FrameCount = m_FramesDone;
+        m_LastRenderMs = m_FrameRenderMs;
+    }
+    m_FrameCondition.notify_one();
+
+    // The render thread is done with this one
+    m_pRecording->Reset();
+    m_LastWaitMs = GetTimeMs() - m_WaitStartMs;
+    m_WaitStartMs = -1.0;
+    return true;
+}
+
+void RenderThread::ThreadMain() {
+    Profiler::SetThreadName("Render");
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    for (;;) {
+        m_FrameCondition.wait(lock, [this] { return m_bFramePending || !m_bRunning; });
+        if (!m_bFramePending) {
+            return;
+        }
+
+        const RenderCommandList* pCommands = m_pExecuting;
+        lock.unlock();
+
+        double startMs = GetTimeMs();
+        Execute(*pCommands);
+        double renderMs = GetTimeMs() - startMs;
+
+        lock.lock();
+        m_FrameRenderMs = renderMs;
+        m_FramesDone++;
+        m_bFramePending = false;
+        m_DoneCondition.notify_one();
+    }
+}
+
+void RenderThread::Execute(const RenderCommandList& commands) {
+    PROFILE_ZONE("RenderThread::Execute");
+    m_pRenderer->BeginFrame();
+    if (m_FrameStartCallback) {
+        m_FrameStartCallback();
+    }
+
+    const RenderCommand* pCommands = commands.GetCommands();
+    for (size_t i = 0; i < commands.GetCount(); i++) {
+        const RenderCommand& command = pCommands[i];
+        switch (command.type) {
+            case RenderCommandType::CLEAR:
+                if (m_ClearCallback) {
+                    m_ClearCallback(command.clear.r, command.clear.g, command.clear.b, command.clear.a);
+                }
+                break;
+
+            case RenderCommandType::SET_LAYER:
+                m_pRenderer->SetLayer(command.layer);
+                break;
+
+            case RenderCommandType::SET_BLEND_MODE:
+                m_pRenderer->SetBlendMode(command.blendMode);
+                break;
+
+            case RenderCommandType::SET_DEPTH:
+                m_pRenderer->SetDepth(command.depth);
+                break;
+
+            case RenderCommandType::DRAW_QUAD:
+                {
+                    SpriteInstance* pInstance;
+                    if (m_pRenderer->AppendInstances(1, command.quad.textureId, pInstance)) {
+                        *pInstance = command.quad.instance;
+                    }
+                }
+                break;
+
+            case RenderCommandType::DRAW_SPRITE:
+                m_pRenderer->DrawSpriteInstanced(command.sprite.pSprite, command.sprite.x, command.sprite.y,
+                                                 command.sprite.scaleX, command.sprite.scaleY,
+                                                 command.sprite.rotation, command.sprite.color);
+                break;
+
+            case RenderCommandType::DRAW_LINE:
+                m_pRenderer->DrawLine(command.line.x1, command.line.y1, command.line.x2, command.line.y2,
+                                      command.line.thickness, command.line.r, command.line.g,
+                                      command.line.b, command.line.a);
+                break;
+
+            case RenderCommandType::DRAW_CIRCLE:
+                m_pRenderer->DrawCircle(command.circle.centerX, command.circle.centerY, command.circle.radius,
+                                        command.circle.r, command.circle.g, command.circle.b, command.circle.a);
+                break;
+
+            case RenderCommandType::UPDATE_TEXTURE:
+                m_pRenderer->UpdateTexture(command.texture.textureId, command.texture.x, command.texture.y,
+                                           command.texture.width, command.texture.height,
+                                           commands.GetData(command.texture.dataOffset), command.texture.width * 4);
+                break;
+
+            case RenderCommandType::FLUSH:
+                m_pRenderer->Flush();
+                break;
+
+            case RenderCommandType::PRESENT:
+                m_pRenderer->Flush();
+                if (m_PresentCallback) {
+                    m_PresentCallback();
+                }
+                break;
+        }
+    }
+}
+
+double RenderThread::GetTimeMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
\ No newline at end of file
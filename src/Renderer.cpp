@@ -1,60 +1,59 @@
 #include "../include/Renderer.h"
-#include <d3dcompiler.h>
-#include <DirectXMath.h>
-using namespace DirectX;
-
-// Simple vertex shader
-static const char* g_szVertexShader =
-"cbuffer MatrixBuffer : register(b0) \
-{ \
-    matrix worldViewProjection; \
-}; \
-\
-struct VS_INPUT \
-{ \
-    float3 pos : POSITION; \
-    float2 tex : TEXCOORD0; \
-    float4 col : COLOR0; \
-}; \
-\
-struct PS_INPUT \
-{ \
-    float4 pos : SV_POSITION; \
-    float2 tex : TEXCOORD0; \
-    float4 col : COLOR0; \
-}; \
-\
-PS_INPUT main(VS_INPUT input) \
-{ \
-    PS_INPUT output; \
-    output.pos = mul(worldViewProjection, float4(input.pos, 1.0f)); \
-    output.tex = input.tex; \
-    output.col = input.col; \
-    return output; \
-}";
-
-// Simple pixel shader
-static const char* g_szPixelShader =
-"struct PS_INPUT \
-{ \
-    float4 pos : SV_POSITION; \
-    float2 tex : TEXCOORD0; \
-    float4 col : COLOR0; \
-}; \
-\
-Texture2D tex : register(t0); \
-SamplerState sam : register(s0); \
-\
-float4 main(PS_INPUT input) : SV_TARGET \
-{ \
-    float4 textureColor = tex.Sample(sam, input.tex); \
-    return textureColor * input.col; \
-}";
-
-Renderer::Renderer(GraphicsDevice* pGraphicsDevice) :
-    m_pGraphicsDevice(pGraphicsDevice),
+#include "../include/Profiler.h"
+#include <cmath>
+#include <algorithm>
+#ifdef _WIN32
+#include "../include/D3D11RenderBackend.h"
+#endif
+using std::min;
+using std::max;
+
+// Initial size of the index staging buffer; grows on demand
+static const uint32_t INITIAL_INDEX_CAPACITY = 98304;
+
+static inline void WriteQuadIndices(uint16_t* pIndices, uint32_t baseVertex) {
+    pIndices[0] = (uint16_t)(baseVertex + 0);
+    pIndices[1] = (uint16_t)(baseVertex + 1);
+    pIndices[2] = (uint16_t)(baseVertex + 2);
+    pIndices[3] = (uint16_t)(baseVertex + 1);
+    pIndices[4] = (uint16_t)(baseVertex + 3);
+    pIndices[5] = (uint16_t)(baseVertex + 2);
+}
+
+#ifdef _WIN32
+Renderer::Renderer(GraphicsDevice* pGraphicsDevice, VertexFormat vertexFormat) :
+    m_pBackend(std::make_unique<D3D11RenderBackend>(pGraphicsDevice, vertexFormat)),
+    m_Layer(0),
+    m_BlendMode(BlendMode::ALPHA),
+    m_TextureId(RenderBackend::WHITE_TEXTURE),
+    m_Depth(0),
+    m_PlaceholderTextureId(RenderBackend::WHITE_TEXTURE),
+    m_VertexCount(0),
+    m_IndexCount(0),
+    m_InstanceCount(0),
+    m_InstanceTextureId(RenderBackend::WHITE_TEXTURE),
+    m_Indices(INITIAL_INDEX_CAPACITY),
+    m_Stats(),
+    m_LastDrawKey(0),
+    m_bHasDrawn(false) {
+}
+#endif
+
+Renderer::Renderer(std::unique_ptr<RenderBackend> pBackend) :
+    m_pBackend(std::move(pBackend)),
+    m_Layer(0),
+    m_BlendMode(BlendMode::ALPHA),
+    m_TextureId(RenderBackend::WHITE_TEXTURE),
+    m_Depth(0),
+    m_PlaceholderTextureId(RenderBackend::WHITE_TEXTURE),
     m_VertexCount(0),
-    m_IndexCount(0) {
+    m_IndexCount(0),
+    m_InstanceCount(0),
+    m_InstanceTextureId(RenderBackend::WHITE_TEXTURE),
+    m_Indices(INITIAL_INDEX_CAPACITY),
+    m_Stats(),
+    m_LastDrawKey(0),
+    m_bHasDrawn(false) {
 }
 
 Renderer::~Renderer() {
@@ -62,198 +61,211 @@ Renderer::~Renderer() {
 }
 
 bool Renderer::Initialize() {
-    if (!CreateShaders()) {
+    if (!m_pBackend) {
         return false;
     }
 
-    if (!CreateInputLayout()) {
-        return false;
-    }
+    return m_pBackend->Initialize();
+}
 
-    if (!CreateVertexBuffer()) {
-        return false;
+void Renderer::Cleanup() {
+    if (m_pBackend) {
+        m_pBackend->Cleanup();
     }
+}
 
-    if (!CreateIndexBuffer()) {
-        return false;
+bool Renderer::Append(uint32_t vertexCount, uint32_t indexCount, GeometrySpan& span) {
+    return Append(vertexCount, indexCount, m_TextureId, span);
+}
+
+bool Renderer::Append(uint32_t vertexCount, uint32_t indexCount, uint32_t textureId, GeometrySpan& span) {
+    // Keep submission order when switching from instanced sprites
+    if (m_InstanceCount > 0) {
+        Flush();
     }
 
-    if (!CreateConstantBuffers()) {
-        return false;
+    if (!m_pBackend->AppendVertices(vertexCount, span.pVertices, span.baseVertex)) {
+        Flush();
+        if (!m_pBackend->AppendVertices(vertexCount, span.pVertices, span.baseVertex)) {
+            return false;
+        }
     }
 
-    if (!CreateBlendStates()) {
-        return false;
+    if (m_IndexCount + indexCount > m_Indices.size()) {
+        m_Indices.resize(max(m_Indices.size() * 2, (size_t)(m_IndexCount + indexCount)));
     }
+    span.pIndices = &m_Indices[m_IndexCount];
+
+    m_Queue.Add(MakeSortKey(SortKey::SHADER_BATCHED, textureId), m_IndexCount, indexCount);
 
+    m_VertexCount += vertexCount;
+    m_IndexCount += indexCount;
+    m_Stats.vertices += vertexCount;
+    m_Stats.indices += indexCount;
     return true;
 }
 
-void Renderer::Cleanup() {
-    m_pVertexShader.Reset();
-    m_pPixelShader.Reset();
-    m_pInputLayout.Reset();
-    m_pVertexBuffer.Reset();
-    m_pIndexBuffer.Reset();
-    m_pConstantBuffer.Reset();
-    m_pBlendState.Reset();
+bool Renderer::AppendInstances(uint32_t count, SpriteInstance*& pInstances) {
+    return AppendInstances(count, m_TextureId, pInstances);
 }
 
-bool Renderer::CreateShaders() {
-    // Compile vertex shader
-    Microsoft::WRL::ComPtr<ID3DBlob> pVSBlob = nullptr;
-    HRESULT hr = D3DCompile(g_szVertexShader, strlen(g_szVertexShader), nullptr, nullptr, nullptr,
-        "main", "vs_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pVSBlob.GetAddressOf(), nullptr);
-
-    if (FAILED(hr)) {
-        return false;
-    }
-
-    hr = m_pGraphicsDevice->GetDevice()->CreateVertexShader(
-        pVSBlob->GetBufferPointer(),
-        pVSBlob->GetBufferSize(),
-        nullptr,
-        m_pVertexShader.ReleaseAndGetAddressOf()
-    );
-
-    if (FAILED(hr)) {
-        return false;
+bool Renderer::AppendInstances(uint32_t count, uint32_t textureId, SpriteInstance*& pInstances) {
+    // Keep submission order when switching from indexed geometry; an
+    // instanced batch draws with a single texture
+    if (m_VertexCount > 0 || (m_InstanceCount > 0 && textureId != m_InstanceTextureId)) {
+        Flush();
     }
+    m_InstanceTextureId = textureId;
 
-    // Compile pixel shader
-    Microsoft::WRL::ComPtr<ID3DBlob> pPSBlob = nullptr;
-    hr = D3DCompile(g_szPixelShader, strlen(g_szPixelShader), nullptr, nullptr, nullptr,
-        "main", "ps_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pPSBlob.GetAddressOf(), nullptr);
-
-    if (FAILED(hr)) {
-        return false;
-    }
-
-    hr = m_pGraphicsDevice->GetDevice()->CreatePixelShader(
-        pPSBlob->GetBufferPointer(),
-        pPSBlob->GetBufferSize(),
-        nullptr,
-        m_pPixelShader.ReleaseAndGetAddressOf()
-    );
-
-    if (FAILED(hr)) {
-        return false;
+    if (!m_pBackend->AppendInstances(count, pInstances)) {
+        Flush();
+        if (!m_pBackend->AppendInstances(count, pInstances)) {
+            return false;
+        }
     }
 
+    m_InstanceCount += count;
+    m_Stats.instances += count;
     return true;
 }
 
-bool Renderer::CreateInputLayout() {
-    D3D11_INPUT_ELEMENT_DESC layout[] = {
-        {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
-        {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
-        {"COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0}
-    };
-
-    Microsoft::WRL::ComPtr<ID3DBlob> pVSBlob = nullptr;
-    HRESULT hr = D3DCompile(g_szVertexShader, strlen(g_szVertexShader), nullptr, nullptr, nullptr,
-        "main", "vs_5_0", D3DCOMPILE_ENABLE_STRICTNESS, 0, pVSBlob.GetAddressOf(), nullptr);
+void Renderer::DrawSpriteInstanced(Sprite* pSprite, float x, float y, float scaleX, float scaleY,
+                                   float rotation, uint32_t color) {
+    if (!pSprite) return;
 
-    if (FAILED(hr)) {
-        return false;
-    }
+    uint32_t textureId = GetSpriteTexture(pSprite);
+
+    SpriteInstance* pInstance;
+    if (!AppendInstances(1, textureId, pInstance)) return;
+
+    pInstance->x = x;
+    pInstance->y = y;
+    pInstance->width = pSprite->GetWidth() * scaleX;
+    pInstance->height = pSprite->GetHeight() * scaleY;
+    pInstance->rotation = rotation;
+    pInstance->u0 = PackUNorm16(pSprite->GetU0());
+    pInstance->v0 = PackUNorm16(pSprite->GetV0());
+    pInstance->u1 = PackUNorm16(pSprite->GetU1());
+    pInstance->v1 = PackUNorm16(pSprite->GetV1());
+    pInstance->color = color;
+}
 
-    hr = m_pGraphicsDevice->GetDevice()->CreateInputLayout(
-        layout, 3,
-        pVSBlob->GetBufferPointer(),
-        pVSBlob->GetBufferSize(),
-        m_pInputLayout.ReleaseAndGetAddressOf()
-    );
+void Renderer::SetLayer(uint32_t layer) {
+    m_Layer = min(layer, (uint32_t)SortKey::LAYER_MASK);
+}
 
-    if (FAILED(hr)) {
-        return false;
+void Renderer::SetBlendMode(BlendMode blendMode) {
+    // Pending instances are drawn with a single state
+    if (m_InstanceCount > 0 && blendMode != m_BlendMode) {
+        Flush();
     }
+    m_BlendMode = blendMode;
+}
 
-    return true;
+void Renderer::SetTexture(uint32_t textureId) {
+    m_TextureId = textureId;
 }
 
-bool Renderer::CreateVertexBuffer() {
-    D3D11_BUFFER_DESC bd = {};
-    bd.Usage = D3D11_USAGE_DYNAMIC;
-    bd.ByteWidth = sizeof(Vertex) * 10000; // Max vertices
-    bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+void Renderer::SetDepth(float depth) {
+    depth = max(0.0f, min(1.0f, depth));
+    m_Depth = (uint32_t)(depth * (float)SortKey::DEPTH_MASK);
+}
 
-    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBuffer(&bd, nullptr, m_pVertexBuffer.ReleaseAndGetAddressOf());
+uint32_t Renderer::CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) {
+    return m_pBackend->CreateTexture(width, height, pPixels);
+}
 
-    return SUCCEEDED(hr);
+void Renderer::DestroyTexture(uint32_t textureId) {
+    // The pending batch may still reference it
+    Flush();
+    m_pBackend->DestroyTexture(textureId);
+    if (m_TextureId == textureId) {
+        m_TextureId = RenderBackend::WHITE_TEXTURE;
+    }
 }
 
-bool Renderer::CreateIndexBuffer() {
-    D3D11_BUFFER_DESC bd = {};
-    bd.Usage = D3D11_USAGE_DYNAMIC;
-    bd.ByteWidth = sizeof(UINT) * 30000; // Max indices
-    bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+bool Renderer::UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                             const uint8_t* pPixels, uint32_t rowPitch) {
+    // Batched draws recorded before the update must see the old contents
+    Flush();
+    return m_pBackend->UpdateTexture(textureId, x, y, width, height, pPixels, rowPitch);
+}
 
-    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBuffer(&bd, nullptr, m_pIndexBuffer.ReleaseAndGetAddressOf());
+uint32_t Renderer::GetSpriteTexture(const Sprite* pSprite) const {
+    if (pSprite->IsPending()) {
+        return m_PlaceholderTextureId;
+    }
+    return pSprite->GetTextureId() != RenderBackend::WHITE_TEXTURE ? pSprite->GetTextureId() : m_TextureId;
+}
 
-    return SUCCEEDED(hr);
+uint64_t Renderer::MakeSortKey(uint32_t shader, uint32_t textureId) const {
+    return SortKey::Make(m_Layer, (uint32_t)m_BlendMode, shader, textureId, m_Depth);
 }
 
-bool Renderer::CreateConstantBuffers() {
-    D3D11_BUFFER_DESC bd = {};
-    bd.Usage = D3D11_USAGE_DEFAULT;
-    bd.ByteWidth = sizeof(XMMATRIX);
-    bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+void Renderer::RecordDraw(uint64_t sortKey) {
+    if (m_bHasDrawn) {
+        m_Stats.stateChanges += RenderQueue::CountStateChanges(m_LastDrawKey, sortKey);
+    }
+    m_LastDrawKey = sortKey;
+    m_bHasDrawn = true;
+    m_Stats.drawCalls++;
+}
 
-    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBuffer(&bd, nullptr, m_pConstantBuffer.ReleaseAndGetAddressOf());
+void Renderer::DrawSprite(Sprite* pSprite) {
+    if (GetVertexFormat() == VertexFormat::COMPACT) {
+        BuildSprite<CompactVertex>(pSprite);
+    } else {
+        BuildSprite<Vertex>(pSprite);
+    }
+}
 
-    return SUCCEEDED(hr);
+void Renderer::DrawLine(float x1, float y1, float x2, float y2, float thickness, float r, float g, float b, float a) {
+    if (GetVertexFormat() == VertexFormat::COMPACT) {
+        BuildLine<CompactVertex>(x1, y1, x2, y2, thickness, r, g, b, a);
+    } else {
+        BuildLine<Vertex>(x1, y1, x2, y2, thickness, r, g, b, a);
+    }
 }
 
-bool Renderer::CreateBlendStates() {
-    D3D11_BLEND_DESC blendDesc = {};
-    blendDesc.AlphaToCoverageEnable = false;
-    blendDesc.RenderTarget[0].BlendEnable = true;
-    blendDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
-    blendDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
-    blendDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
-    blendDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
-    blendDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
-    blendDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
-    blendDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
-
-    HRESULT hr = m_pGraphicsDevice->GetDevice()->CreateBlendState(&blendDesc, m_pBlendState.ReleaseAndGetAddressOf());
-
-    return SUCCEEDED(hr);
+void Renderer::DrawCircle(float centerX, float centerY, float radius, float r, float g, float b, float a) {
+    if (GetVertexFormat() == VertexFormat::COMPACT) {
+        BuildCircle<CompactVertex>(centerX, centerY, radius, r, g, b, a);
+    } else {
+        BuildCircle<Vertex>(centerX, centerY, radius, r, g, b, a);
+    }
 }
 
-void Renderer::DrawSprite(Sprite* pSprite) {
+template <typename TVertex>
+void Renderer::BuildSprite(Sprite* pSprite) {
     if (!pSprite) return;
 
     // Calculate sprite vertices for a quad
     float halfWidth = pSprite->GetWidth() * 0.5f;
     float halfHeight = pSprite->GetHeight() * 0.5f;
 
-    // Create vertices for the sprite quad
-    Vertex vertices[4] = {
-        {-halfWidth, -halfHeight, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f}, // Bottom-left
-        { halfWidth, -halfHeight, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f}, // Bottom-right
-        {-halfWidth,  halfHeight, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f}, // Top-left
-        { halfWidth,  halfHeight, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f}  // Top-right
-    };
+    uint32_t textureId = GetSpriteTexture(pSprite);
 
-    // Create indices for two triangles
-    UINT indices[6] = { 0, 1, 2, 1, 3, 2 };
+    GeometrySpan span;
+    if (!Append(4, 6, textureId, span)) return;
 
-    // Add to batch
-    for (int i = 0; i < 4; i++) {
-        m_Vertices.push_back(vertices[i]);
-    }
-    for (int i = 0; i < 6; i++) {
-        m_Indices.push_back(m_VertexCount + indices[i]);
-    }
-    m_VertexCount += 4;
-    m_IndexCount += 6;
+    // Write the quad straight into the batch, mapped onto the sprite's UV rectangle
+    float u0 = pSprite->GetU0();
+    float v0 = pSprite->GetV0();
+    float u1 = pSprite->GetU1();
+    float v1 = pSprite->GetV1();
+
+    TVertex* pVertices = span.Vertices<TVertex>();
+    VertexTraits<TVertex>::Write(pVertices[0], -halfWidth, -halfHeight, u0, v1, 1.0f, 1.0f, 1.0f, 1.0f); // Bottom-left
+    VertexTraits<TVertex>::Write(pVertices[1],  halfWidth, -halfHeight, u1, v1, 1.0f, 1.0f, 1.0f, 1.0f); // Bottom-right
+    VertexTraits<TVertex>::Write(pVertices[2], -halfWidth,  halfHeight, u0, v0, 1.0f, 1.0f, 1.0f, 1.0f); // Top-left
+    VertexTraits<TVertex>::Write(pVertices[3],  halfWidth,  halfHeight, u1, v0, 1.0f, 1.0f, 1.0f, 1.0f); // Top-right
+
+    // Indices for two triangles
+    WriteQuadIndices(span.pIndices, span.baseVertex);
 }
 
-void Renderer::DrawLine(float x1, float y1, float x2, float y2, float thickness, float r, float g, float b, float a) {
+template <typename TVertex>
+void Renderer::BuildLine(float x1, float y1, float x2, float y2, float thickness, float r, float g, float b, float a) {
     // Calculate direction vector
     float dx = x2 - x1;
     float dy = y2 - y1;
@@ -268,36 +280,32 @@ void Renderer::DrawLine(float x1, float y1, float x2, float y2, float thickness,
     // Calculate perpendicular vector for line thickness
     float perpX = -dy * thickness * 0.5f;
     float perpY = dx * thickness * 0.5f;
-    
-    // Create vertices for a quad representing the line
-    Vertex vertices[4] = {
-        {x1 + perpX, y1 + perpY, 0.0f, 0.0f, 0.0f, r, g, b, a}, // Top-left
-        {x1 - perpX, y1 - perpY, 0.0f, 0.0f, 1.0f, r, g, b, a}, // Bottom-left
-        {x2 + perpX, y2 + perpY, 0.0f, 1.0f, 0.0f, r, g, b, a}, // Top-right
-        {x2 - perpX, y2 - perpY, 0.0f, 1.0f, 1.0f, r, g, b, a}  // Bottom-right
-    };
-    
+
+    GeometrySpan span;
+    if (!Append(4, 6, RenderBackend::WHITE_TEXTURE, span)) return;
+
+    // Write a quad representing the line
+    TVertex* pVertices = span.Vertices<TVertex>();
+    VertexTraits<TVertex>::Write(pVertices[0], x1 + perpX, y1 + perpY, 0.0f, 0.0f, r, g, b, a); // Top-left
+    VertexTraits<TVertex>::Write(pVertices[1], x1 - perpX, y1 - perpY, 0.0f, 1.0f, r, g, b, a); // Bottom-left
+    VertexTraits<TVertex>::Write(pVertices[2], x2 + perpX, y2 + perpY, 1.0f, 0.0f, r, g, b, a); // Top-right
+    VertexTraits<TVertex>::Write(pVertices[3], x2 - perpX, y2 - perpY, 1.0f, 1.0f, r, g, b, a); // Bottom-right
+
     // Indices for two triangles
-    UINT indices[6] = {0, 1, 2, 1, 3, 2};
-    
-    // Add to batch
-    for (int i = 0; i < 4; i++) {
-        m_Vertices.push_back(vertices[i]);
-    }
-    for (int i = 0; i < 6; i++) {
-        m_Indices.push_back(m_VertexCount + indices[i]);
-    }
-    m_VertexCount += 4;
-    m_IndexCount += 6;
+    WriteQuadIndices(span.pIndices, span.baseVertex);
 }
 
-void Renderer::DrawCircle(float centerX, float centerY, float radius, float r, float g, float b, float a) {
+template <typename TVertex>
+void Renderer::BuildCircle(float centerX, float centerY, float radius, float r, float g, float b, float a) {
     const int segments = 32;
     const float angleStep = 2.0f * 3.14159f / segments;
-    
+
+    GeometrySpan span;
+    if (!Append(segments + 2, segments * 3, RenderBackend::WHITE_TEXTURE, span)) return;
+
     // Create vertices for the circle (fan-style)
-    Vertex centerVertex = {centerX, centerY, 0.0f, 0.5f, 0.5f, r, g, b, a};
-    m_Vertices.push_back(centerVertex);
+    TVertex* pVertices = span.Vertices<TVertex>();
+    VertexTraits<TVertex>::Write(pVertices[0], centerX, centerY, 0.5f, 0.5f, r, g, b, a);
     
     // Add vertices around the circle
     for (int i = 0; i <= segments; i++) {
@@ -305,66 +313,47 @@ void Renderer::DrawCircle(float centerX, float centerY, float radius, float r, f
         float x = centerX + cos(angle) * radius;
         float y = centerY + sin(angle) * radius;
         
-        Vertex v = {x, y, 0.0f, 0.0f, 0.0f, r, g, b, a};
-        m_Vertices.push_back(v);
+        VertexTraits<TVertex>::Write(pVertices[i + 1], x, y, 0.0f, 0.0f, r, g, b, a);
     }
     
     // Create indices for triangle fan
+    uint16_t* pIndices = span.pIndices;
     for (int i = 0; i < segments; i++) {
-        m_Indices.push_back(m_VertexCount); // Center vertex
-        m_Indices.push_back(m_VertexCount + i + 1);
-        m_Indices.push_back(m_VertexCount + i + 2);
+        *pIndices++ = (uint16_t)span.baseVertex; // Center vertex
+        *pIndices++ = (uint16_t)(span.baseVertex + i + 1);
+        *pIndices++ = (uint16_t)(span.baseVertex + i + 2);
     }
-    
-    m_VertexCount += segments + 2;
-    m_IndexCount += segments * 3;
 }
 
-void Renderer::Flush() {
-    if (m_Vertices.empty() || m_Indices.empty()) {
-        return;
-    }
+void Renderer::BeginFrame() {
+    m_pBackend->BeginFrame();
+    m_Stats = RenderStats();
+    m_bHasDrawn = false;
+}
 
-    // Map vertex buffer and copy data
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    HRESULT hr = m_pGraphicsDevice->GetDeviceContext()->Map(m_pVertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    
-    if (SUCCEEDED(hr)) {
-        memcpy(mappedResource.pData, m_Vertices.data(), sizeof(Vertex) * m_Vertices.size());
-        m_pGraphicsDevice->GetDeviceContext()->Unmap(m_pVertexBuffer.Get(), 0);
+void Renderer::Flush() {
+    PROFILE_ZONE("Renderer::Flush");
+    if (m_VertexCount > 0) {
+        m_Queue.Build(m_Indices.data(), m_SortedIndices, m_Runs);
+        m_pBackend->Submit(m_SortedIndices.data(), (uint32_t)m_SortedIndices.size(),
+                           m_Runs.data(), (uint32_t)m_Runs.size());
+        m_Queue.Clear();
+
+        for (const DrawRun& run : m_Runs) {
+            RecordDraw(run.sortKey);
+        }
+        m_Stats.vertexBytes += (uint64_t)m_VertexCount * GetVertexStride(GetVertexFormat());
+        m_Stats.indexBytes += (uint64_t)m_IndexCount * sizeof(uint16_t);
     }
 
-    // Map index buffer and copy data
-    hr = m_pGraphicsDevice->GetDeviceContext()->Map(m_pIndexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    
-    if (SUCCEEDED(hr)) {
-        memcpy(mappedResource.pData, m_Indices.data(), sizeof(UINT) * m_Indices.size());
-        m_pGraphicsDevice->GetDeviceContext()->Unmap(m_pIndexBuffer.Get(), 0);
+    if (m_InstanceCount > 0) {
+        m_pBackend->SubmitInstances(m_BlendMode, m_InstanceTextureId);
+        RecordDraw(MakeSortKey(SortKey::SHADER_INSTANCED, m_InstanceTextureId));
+        m_Stats.instanceBytes += (uint64_t)m_InstanceCount * sizeof(SpriteInstance);
     }
 
-    // Set up rendering pipeline
-    UINT stride = sizeof(Vertex);
-    UINT offset = 0;
-    
-    m_pGraphicsDevice->GetDeviceContext()->IASetVertexBuffers(0, 1, m_pVertexBuffer.GetAddressOf(), &stride, &offset);
-    m_pGraphicsDevice->GetDeviceContext()->IASetIndexBuffer(m_pIndexBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
-    m_pGraphicsDevice->GetDeviceContext()->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    m_pGraphicsDevice->GetDeviceContext()->IASetInputLayout(m_pInputLayout.Get());
-    
-    // Set shaders
-    m_pGraphicsDevice->GetDeviceContext()->VSSetShader(m_pVertexShader.Get(), nullptr, 0);
-    m_pGraphicsDevice->GetDeviceContext()->PSSetShader(m_pPixelShader.Get(), nullptr, 0);
-    
-    // Set blend state for transparency
-    float blendFactor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
-    m_pGraphicsDevice->GetDeviceContext()->OMSetBlendState(m_pBlendState.Get(), blendFactor, 0xFFFFFFFF);
-    
-    // Draw indexed
-    m_pGraphicsDevice->GetDeviceContext()->DrawIndexed(m_IndexCount, 0, 0);
-    
     // Clear batch data
-    m_Vertices.clear();
-    m_Indices.clear();
     m_VertexCount = 0;
     m_IndexCount = 0;
+    m_InstanceCount = 0;
 }
\ No newline at end of file
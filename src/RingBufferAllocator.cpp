@@ -0,0 +1,165 @@
+#include "../include/RingBufferAllocator.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+bool CpuRingBufferStorage::Create(size_t sizeInBytes) {
+    m_Data.assign(sizeInBytes, 0);
+    m_CreateCount++;
+    m_bMapped = false;
+    return true;
+}
+
+void* CpuRingBufferStorage::Map(bool discard) {
+    if (m_bMapped || m_Data.empty()) {
+        return nullptr;
+    }
+
+    m_MapCount++;
+    if (discard) {
+        m_DiscardCount++;
+    }
+    m_bMapped = true;
+    return m_Data.data();
+}
+
+void CpuRingBufferStorage::Unmap() {
+    m_bMapped = false;
+}
+
+RingBufferAllocator::RingBufferAllocator(RingBufferStorage* pStorage, uint32_t stride, uint32_t initialCapacity) :
+    m_pStorage(pStorage),
+    m_Stride(stride),
+    m_Capacity(max(1u, initialCapacity)),
+    m_Head(0),
+    m_FrameUsage(0),
+    m_HighWaterMark(0),
+    m_WrapCount(0),
+    m_bNeedsDiscard(true) {
+}
+
+bool RingBufferAllocator::Initialize() {
+    return Recreate(m_Capacity);
+}
+
+bool RingBufferAllocator::Recreate(uint32_t capacity) {
+    if (!m_pStorage->Create((size_t)capacity * m_Stride)) {
+        return false;
+    }
+
+    m_Capacity = capacity;
+    m_Head = 0;
+    m_bNeedsDiscard = true;
+    return true;
+}
+
+uint8_t* RingBufferAllocator::MapAtHead(uint32_t minCount) {
+    if (minCount == 0 || minCount > m_Capacity) {
+        return nullptr;
+    }
+
+    // Wrap: everything behind the head may still be in flight, so discard
+    if (m_Head + minCount > m_Capacity) {
+        m_Head = 0;
+        m_bNeedsDiscard = true;
+        m_WrapCount++;
+    }
+
+    uint8_t* pData = (uint8_t*)m_pStorage->Map(m_bNeedsDiscard);
+    if (!pData) {
+        return nullptr;
+    }
+
+    m_bNeedsDiscard = false;
+    return pData;
+}
+
+void* RingBufferAllocator::Map(uint32_t count, uint32_t& firstElement) {
+    uint8_t* pData = MapAtHead(count);
+    if (!pData) {
+        return nullptr;
+    }
+
+    firstElement = m_Head;
+    m_Head += count;
+    m_FrameUsage += count;
+
+    return pData + (size_t)firstElement * m_Stride;
+}
+
+void RingBufferAllocator::Unmap() {
+    m_pStorage->Unmap();
+}
+
+void* RingBufferAllocator::MapSpan(uint32_t minCount, uint32_t& firstElement, uint32_t& availableCount) {
+    uint8_t* pData = MapAtHead(minCount);
+    if (!pData) {
+        return nullptr;
+    }
+
+    firstElement = m_Head;
+    availableCount = m_Capacity - m_Head;
+
+    return pData + (size_t)firstElement * m_Stride;
+}
+
+void RingBufferAllocator::UnmapSpan(uint32_t usedCount) {
+    m_pStorage->Unmap();
+    m_Head = min(m_Capacity, m_Head + usedCount);
+    m_FrameUsage += usedCount;
+}
+
+bool RingBufferAllocator::Reserve(uint32_t count) {
+    if (count <= m_Capacity) {
+        return true;
+    }
+
+    uint32_t capacity = m_Capacity;
+    while (capacity < count) {
+        capacity *= 2;
+    }
+    return Recreate(capacity);
+}
+
+void RingBufferAllocator::BeginFrame() {
+    m_HighWaterMark = max(m_HighWaterMark, m_FrameUsage);
+    m_FrameUsage = 0;
+
+    // A frame that used more than the whole ring wrapped onto its own data
+    if (m_HighWaterMark > m_Capacity) {
+        Reserve(m_HighWaterMark);
+    }
+}
+
+bool NextBatchRange(const uint32_t* pIndices, uint32_t indexCount, uint32_t startIndex,
+                    uint32_t maxVertices, uint32_t maxIndices, BatchRange& range) {
+    if (startIndex + 3 > indexCount) {
+        return false;
+    }
+
+    range.firstIndex = startIndex;
+    range.indexCount = 0;
+    range.minVertex = UINT32_MAX;
+    range.maxVertex = 0;
+
+    for (uint32_t i = startIndex; i + 3 <= indexCount; i += 3) {
+        uint32_t minVertex = range.minVertex;
+        uint32_t maxVertex = range.maxVertex;
+        for (uint32_t k = 0; k < 3; k++) {
+            minVertex = min(minVertex, pIndices[i + k]);
+            maxVertex = max(maxVertex, pIndices[i + k]);
+        }
+
+        // Always take at least one triangle so callers make progress
+        bool fits = range.indexCount + 3 <= maxIndices && maxVertex - minVertex + 1 <= maxVertices;
+        if (!fits && range.indexCount > 0) {
+            break;
+        }
+
+        range.minVertex = minVertex;
+        range.maxVertex = maxVertex;
+        range.indexCount += 3;
+    }
+
+    return true;
+}
\ No newline at end of file
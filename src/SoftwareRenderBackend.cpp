@@ -0,0 +1,557 @@
+#include "../include/SoftwareRenderBackend.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+using std::min;
+using std::max;
+
+static inline uint8_t ToUNorm8(float value) {
+    value = max(0.0f, min(1.0f, value));
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static inline float EdgeFunction(float ax, float ay, float bx, float by, float px, float py) {
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+// Top-left fill rule for a counter-clockwise (positive area) triangle
+static inline bool IsTopLeftEdge(float ax, float ay, float bx, float by) {
+    float dx = bx - ax;
+    float dy = by - ay;
+    return dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+}
+
+// Initial arena capacity; grown from the per-frame high-water mark
+static const uint32_t INITIAL_VERTEX_CAPACITY = 65536;
+static const uint32_t INSTANCE_BATCH_CAPACITY = 16384;
+
+SoftwareRenderBackend::SoftwareRenderBackend(uint32_t width, uint32_t height, uint32_t threadCount,
+                                             VertexFormat vertexFormat) :
+    m_Width(0),
+    m_Height(0),
+    m_TilesX(0),
+    m_TilesY(0),
+    m_VertexFormat(vertexFormat),
+    m_VertexRing(&m_VertexStorage, GetVertexStride(vertexFormat), INITIAL_VERTEX_CAPACITY),
+    m_Arena(&m_VertexRing),
+    m_Instances(INSTANCE_BATCH_CAPACITY),
+    m_InstanceCount(0),
+    m_BlendMode(BlendMode::ALPHA),
+    m_pTexture(nullptr),
+    m_ThreadCount(threadCount),
+    m_NextTile(0),
+    m_Generation(0),
+    m_ActiveWorkers(0),
+    m_bShutdown(false) {
+    if (m_ThreadCount == 0) {
+        m_ThreadCount = max(1u, std::thread::hardware_concurrency());
+    }
+    Resize(width, height);
+}
+
+SoftwareRenderBackend::~SoftwareRenderBackend() {
+    Cleanup();
+}
+
+bool SoftwareRenderBackend::Initialize() {
+    if (m_Width == 0 || m_Height == 0) {
+        return false;
+    }
+
+    if (!m_VertexRing.Initialize()) {
+        return false;
+    }
+
+    // White texture in slot 0; never sampled
+    if (m_Textures.empty()) {
+        m_Textures.push_back({ 1, 1, std::vector<uint8_t>(4, 0xFF) });
+    }
+
+    StartWorkers();
+    return true;
+}
+
+void SoftwareRenderBackend::Cleanup() {
+    StopWorkers();
+    m_Triangles.clear();
+}
+
+void SoftwareRenderBackend::BeginFrame() {
+    m_VertexRing.BeginFrame();
+}
+
+uint32_t SoftwareRenderBackend::CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) {
+    if (width == 0 || height == 0 || m_Textures.empty()) {
+        return WHITE_TEXTURE;
+    }
+
+    uint32_t textureId;
+    if (!m_FreeTextures.empty()) {
+        textureId = m_FreeTextures.back();
+        m_FreeTextures.pop_back();
+    } else {
+        if (m_Textures.size() > SortKey::TEXTURE_MASK) {
+            return WHITE_TEXTURE;
+        }
+        textureId = (uint32_t)m_Textures.size();
+        m_Textures.emplace_back();
+    }
+
+    Texture& texture = m_Textures[textureId];
+    texture.width = width;
+    texture.height = height;
+    if (pPixels) {
+        texture.pixels.assign(pPixels, pPixels + (size_t)width * height * 4);
+    } else {
+        texture.pixels.assign((size_t)width * height * 4, 0);
+    }
+    return textureId;
+}
+
+void SoftwareRenderBackend::DestroyTexture(uint32_t textureId) {
+    if (textureId == WHITE_TEXTURE || textureId >= m_Textures.size() || m_Textures[textureId].pixels.empty()) {
+        return;
+    }
+
+    m_Textures[textureId] = Texture();
+    m_FreeTextures.push_back(textureId);
+}
+
+bool SoftwareRenderBackend::UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                                          const uint8_t* pPixels, uint32_t rowPitch) {
+    if (textureId == WHITE_TEXTURE || textureId >= m_Textures.size() || !pPixels) {
+        return false;
+    }
+
+    Texture& texture = m_Textures[textureId];
+    if (texture.pixels.empty() || x + width > texture.width || y + height > texture.height) {
+        return false;
+    }
+
+    for (uint32_t row = 0; row < height; row++) {
+        memcpy(&texture.pixels[(((size_t)y + row) * texture.width + x) * 4],
+               pPixels + (size_t)row * rowPitch, (size_t)width * 4);
+    }
+    return true;
+}
+
+bool SoftwareRenderBackend::AppendVertices(uint32_t vertexCount, void*& pVertices, uint32_t& baseVertex) {
+    return m_Arena.Append(vertexCount, pVertices, baseVertex);
+}
+
+void SoftwareRenderBackend::Submit(const uint16_t* pIndices, uint32_t indexCount,
+                                   const DrawRun* pRuns, uint32_t runCount) {
+    uint32_t firstVertex, vertexCount;
+    if (!m_Arena.Close(firstVertex, vertexCount)) {
+        return;
+    }
+
+    // Arena memory stays valid after unmapping, so rasterise from it in place
+    const uint8_t* pVertexData = m_VertexStorage.GetData() + (size_t)firstVertex * m_VertexRing.GetStride();
+
+    for (uint32_t i = 0; i < runCount; i++) {
+        const DrawRun& run = pRuns[i];
+        if (run.firstIndex + run.indexCount > indexCount) {
+            continue;
+        }
+
+        BlendMode blendMode = (BlendMode)SortKey::GetBlendMode(run.sortKey);
+        uint32_t textureId = SortKey::GetTexture(run.sortKey);
+        const uint16_t* pRunIndices = pIndices + run.firstIndex;
+
+        if (m_VertexFormat == VertexFormat::COMPACT) {
+            Rasterize((const CompactVertex*)pVertexData, vertexCount, pRunIndices, run.indexCount, blendMode, textureId);
+        } else {
+            Rasterize((const Vertex*)pVertexData, vertexCount, pRunIndices, run.indexCount, blendMode, textureId);
+        }
+    }
+}
+
+bool SoftwareRenderBackend::AppendInstances(uint32_t count, SpriteInstance*& pInstances) {
+    if (m_InstanceCount + count > m_Instances.size()) {
+        // Only grow between batches so handed-out pointers stay valid
+        if (m_InstanceCount > 0) {
+            return false;
+        }
+        m_Instances.resize(count);
+    }
+
+    pInstances = &m_Instances[m_InstanceCount];
+    m_InstanceCount += count;
+    return true;
+}
+
+void SoftwareRenderBackend::SubmitInstances(BlendMode blendMode, uint32_t textureId) {
+    if (m_VertexFormat == VertexFormat::COMPACT) {
+        ExpandInstances<CompactVertex>(blendMode, textureId);
+    } else {
+        ExpandInstances<Vertex>(blendMode, textureId);
+    }
+    m_InstanceCount = 0;
+}
+
+template <typename TVertex>
+void SoftwareRenderBackend::ExpandInstances(BlendMode blendMode, uint32_t textureId) {
+    const uint32_t expandChunk = 4096;
+
+    DrawRun run = { SortKey::Make(0, (uint32_t)blendMode, SortKey::SHADER_INSTANCED, textureId, 0), 0, 0 };
+    m_InstanceIndices.clear();
+
+    uint32_t expanded = 0;
+    while (expanded < m_InstanceCount) {
+        uint32_t count = min(expandChunk, m_InstanceCount - expanded);
+
+        void* pVertices;
+        uint32_t baseVertex;
+        if (!m_Arena.Append(count * 4, pVertices, baseVertex)) {
+            run.indexCount = (uint32_t)m_InstanceIndices.size();
+            Submit(m_InstanceIndices.data(), run.indexCount, &run, 1);
+            m_InstanceIndices.clear();
+            if (!m_Arena.Append(count * 4, pVertices, baseVertex)) {
+                break;
+            }
+        }
+
+        size_t firstIndex = m_InstanceIndices.size();
+        m_InstanceIndices.resize(firstIndex + (size_t)count * 6);
+        ExpandSpriteInstances(&m_Instances[expanded], count, (TVertex*)pVertices, &m_InstanceIndices[firstIndex], baseVertex);
+        expanded += count;
+    }
+
+    run.indexCount = (uint32_t)m_InstanceIndices.size();
+    Submit(m_InstanceIndices.data(), run.indexCount, &run, 1);
+}
+
+void SoftwareRenderBackend::StartWorkers() {
+    if (!m_Workers.empty()) {
+        return;
+    }
+
+    m_bShutdown = false;
+    for (uint32_t i = 1; i < m_ThreadCount; i++) {
+        m_Workers.emplace_back(&SoftwareRenderBackend::WorkerMain, this);
+    }
+}
+
+void SoftwareRenderBackend::StopWorkers() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bShutdown = true;
+    }
+    m_WorkCondition.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+    m_Workers.clear();
+}
+
+void SoftwareRenderBackend::Clear(float r, float g, float b, float a) {
+    uint8_t color[4] = { ToUNorm8(r), ToUNorm8(g), ToUNorm8(b), ToUNorm8(a) };
+    for (size_t i = 0; i < m_Pixels.size(); i += 4) {
+        m_Pixels[i + 0] = color[0];
+        m_Pixels[i + 1] = color[1];
+        m_Pixels[i + 2] = color[2];
+        m_Pixels[i + 3] = color[3];
+    }
+}
+
+void SoftwareRenderBackend::Resize(uint32_t width, uint32_t height) {
+    m_Width = width;
+    m_Height = height;
+    m_TilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_TilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    m_Pixels.assign((size_t)width * height * 4, 0);
+    m_TileBins.assign((size_t)m_TilesX * m_TilesY, std::vector<uint32_t>());
+}
+
+void SoftwareRenderBackend::DrawIndexed(const Vertex* pVertices, uint32_t vertexCount,
+                                        const uint32_t* pIndices, uint32_t indexCount,
+                                        BlendMode blendMode) {
+    if (m_Arena.IsOpen()) {
+        return;
+    }
+
+    Rasterize(pVertices, vertexCount, pIndices, indexCount, blendMode, WHITE_TEXTURE);
+}
+
+template <typename TVertex, typename TIndex>
+void SoftwareRenderBackend::Rasterize(const TVertex* pVertices, uint32_t vertexCount,
+                                      const TIndex* pIndices, uint32_t indexCount,
+                                      BlendMode blendMode, uint32_t textureId) {
+    if (vertexCount == 0 || indexCount < 3 || m_TileBins.empty()) {
+        return;
+    }
+
+    // Unknown or destroyed textures fall back to white
+    m_BlendMode = blendMode;
+    m_pTexture = nullptr;
+    if (textureId != WHITE_TEXTURE && textureId < m_Textures.size() && !m_Textures[textureId].pixels.empty()) {
+        m_pTexture = &m_Textures[textureId];
+    }
+    BinTriangles(pVertices, vertexCount, pIndices, indexCount);
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_NextTile = 0;
+        m_Generation++;
+    }
+    m_WorkCondition.notify_all();
+
+    ProcessTiles();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [this] { return m_ActiveWorkers == 0; });
+}
+
+template <typename TVertex, typename TIndex>
+void SoftwareRenderBackend::BinTriangles(const TVertex* pVertices, uint32_t vertexCount,
+                                         const TIndex* pIndices, uint32_t indexCount) {
+    m_Triangles.clear();
+    for (auto& bin : m_TileBins) {
+        bin.clear();
+    }
+
+    for (uint32_t i = 0; i + 2 < indexCount; i += 3) {
+        uint32_t i0 = pIndices[i];
+        uint32_t i1 = pIndices[i + 1];
+        uint32_t i2 = pIndices[i + 2];
+        if (i0 >= vertexCount || i1 >= vertexCount || i2 >= vertexCount) {
+            continue;
+        }
+
+        Vertex v[3] = {
+            VertexTraits<TVertex>::Decode(pVertices[i0]),
+            VertexTraits<TVertex>::Decode(pVertices[i1]),
+            VertexTraits<TVertex>::Decode(pVertices[i2])
+        };
+
+        // Culling is disabled in GraphicsDevice, so wind every triangle counter-clockwise
+        float area = EdgeFunction(v[0].x, v[0].y, v[1].x, v[1].y, v[2].x, v[2].y);
+        if (area == 0.0f) {
+            continue;
+        }
+        if (area < 0.0f) {
+            std::swap(v[1], v[2]);
+        }
+
+        Triangle tri;
+        for (int k = 0; k < 3; k++) {
+            tri.x[k] = v[k].x;
+            tri.y[k] = v[k].y;
+            tri.u[k] = v[k].u;
+            tri.v[k] = v[k].v;
+            tri.color[k][0] = v[k].r;
+            tri.color[k][1] = v[k].g;
+            tri.color[k][2] = v[k].b;
+            tri.color[k][3] = v[k].a;
+        }
+
+        float minX = min(tri.x[0], min(tri.x[1], tri.x[2]));
+        float maxX = max(tri.x[0], max(tri.x[1], tri.x[2]));
+        float minY = min(tri.y[0], min(tri.y[1], tri.y[2]));
+        float maxY = max(tri.y[0], max(tri.y[1], tri.y[2]));
+
+        // Pixel centres are at +0.5; clamp to the framebuffer
+        tri.minX = max(0, (int)std::floor(minX));
+        tri.minY = max(0, (int)std::floor(minY));
+        tri.maxX = min((int)m_Width - 1, (int)std::ceil(maxX));
+        tri.maxY = min((int)m_Height - 1, (int)std::ceil(maxY));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+            continue;
+        }
+
+        uint32_t triIndex = (uint32_t)m_Triangles.size();
+        m_Triangles.push_back(tri);
+
+        uint32_t tileMinX = tri.minX / TILE_SIZE;
+        uint32_t tileMaxX = tri.maxX / TILE_SIZE;
+        uint32_t tileMinY = tri.minY / TILE_SIZE;
+        uint32_t tileMaxY = tri.maxY / TILE_SIZE;
+        for (uint32_t ty = tileMinY; ty <= tileMaxY; ty++) {
+            for (uint32_t tx = tileMinX; tx <= tileMaxX; tx++) {
+                m_TileBins[ty * m_TilesX + tx].push_back(triIndex);
+            }
+        }
+    }
+}
+
+void SoftwareRenderBackend::ProcessTiles() {
+    uint32_t tileCount = (uint32_t)m_TileBins.size();
+    for (;;) {
+        uint32_t tile = m_NextTile.fetch_add(1);
+        if (tile >= tileCount) {
+            break;
+        }
+        RasterizeTile(tile);
+    }
+}
+
+void SoftwareRenderBackend::WorkerMain() {
+    uint64_t seenGeneration = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkCondition.wait(lock, [&] { return m_bShutdown || m_Generation != seenGeneration; });
+            if (m_bShutdown) {
+                return;
+            }
+            seenGeneration = m_Generation;
+            m_ActiveWorkers++;
+        }
+
+        ProcessTiles();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ActiveWorkers--;
+        }
+        m_DoneCondition.notify_one();
+    }
+}
+
+void SoftwareRenderBackend::RasterizeTile(uint32_t tileIndex) {
+    const std::vector<uint32_t>& bin = m_TileBins[tileIndex];
+    if (bin.empty()) {
+        return;
+    }
+
+    int tileX0 = (int)((tileIndex % m_TilesX) * TILE_SIZE);
+    int tileY0 = (int)((tileIndex / m_TilesX) * TILE_SIZE);
+    int tileX1 = min((int)m_Width - 1, tileX0 + (int)TILE_SIZE - 1);
+    int tileY1 = min((int)m_Height - 1, tileY0 + (int)TILE_SIZE - 1);
+
+    bool premultiplied = m_BlendMode == BlendMode::PREMULTIPLIED;
+
+    for (uint32_t triIndex : bin) {
+        const Triangle& tri = m_Triangles[triIndex];
+
+        int x0 = max(tileX0, tri.minX);
+        int x1 = min(tileX1, tri.maxX);
+        int y0 = max(tileY0, tri.minY);
+        int y1 = min(tileY1, tri.maxY);
+
+        float area = EdgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+        float invArea = 1.0f / area;
+
+        // Edge k is opposite vertex k
+        bool topLeft0 = IsTopLeftEdge(tri.x[1], tri.y[1], tri.x[2], tri.y[2]);
+        bool topLeft1 = IsTopLeftEdge(tri.x[2], tri.y[2], tri.x[0], tri.y[0]);
+        bool topLeft2 = IsTopLeftEdge(tri.x[0], tri.y[0], tri.x[1], tri.y[1]);
+
+        for (int y = y0; y <= y1; y++) {
+            float py = y + 0.5f;
+            uint8_t* pRow = &m_Pixels[((size_t)y * m_Width) * 4];
+
+            for (int x = x0; x <= x1; x++) {
+                float px = x + 0.5f;
+                float w0 = EdgeFunction(tri.x[1], tri.y[1], tri.x[2], tri.y[2], px, py);
+                float w1 = EdgeFunction(tri.x[2], tri.y[2], tri.x[0], tri.y[0], px, py);
+                float w2 = EdgeFunction(tri.x[0], tri.y[0], tri.x[1], tri.y[1], px, py);
+
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+                if ((w0 == 0.0f && !topLeft0) || (w1 == 0.0f && !topLeft1) || (w2 == 0.0f && !topLeft2)) continue;
+
+                float l0 = w0 * invArea;
+                float l1 = w1 * invArea;
+                float l2 = w2 * invArea;
+
+                float src[4];
+                for (int c = 0; c < 4; c++) {
+                    src[c] = tri.color[0][c] * l0 + tri.color[1][c] * l1 + tri.color[2][c] * l2;
+                }
+
+                if (m_pTexture) {
+                    float texel[4];
+                    SampleTexture(tri.u[0] * l0 + tri.u[1] * l1 + tri.u[2] * l2,
+                                  tri.v[0] * l0 + tri.v[1] * l1 + tri.v[2] * l2, texel);
+                    for (int c = 0; c < 4; c++) {
+                        src[c] *= texel[c];
+                    }
+                }
+
+                uint8_t* pDst = pRow + x * 4;
+                float dst[4] = { pDst[0] / 255.0f, pDst[1] / 255.0f, pDst[2] / 255.0f, pDst[3] / 255.0f };
+                float srcAlpha = max(0.0f, min(1.0f, src[3]));
+                float invSrcAlpha = 1.0f - srcAlpha;
+
+                if (premultiplied) {
+                    pDst[0] = ToUNorm8(src[0] + dst[0] * invSrcAlpha);
+                    pDst[1] = ToUNorm8(src[1] + dst[1] * invSrcAlpha);
+                    pDst[2] = ToUNorm8(src[2] + dst[2] * invSrcAlpha);
+                    pDst[3] = ToUNorm8(srcAlpha + dst[3] * invSrcAlpha);
+                } else {
+                    pDst[0] = ToUNorm8(src[0] * srcAlpha + dst[0] * invSrcAlpha);
+                    pDst[1] = ToUNorm8(src[1] * srcAlpha + dst[1] * invSrcAlpha);
+                    pDst[2] = ToUNorm8(src[2] * srcAlpha + dst[2] * invSrcAlpha);
+                    pDst[3] = ToUNorm8(srcAlpha);
+                }
+            }
+        }
+    }
+}
+
+void SoftwareRenderBackend::SampleTexture(float u, float v, float* pColor) const {
+    const Texture& texture = *m_pTexture;
+    const float unorm8 = 1.0f / 255.0f;
+
+    // Bilinear filter between texel centres, clamped at the edges
+    float tx = u * texture.width - 0.5f;
+    float ty = v * texture.height - 0.5f;
+    float fx = std::floor(tx);
+    float fy = std::floor(ty);
+    float wx = tx - fx;
+    float wy = ty - fy;
+
+    int maxX = (int)texture.width - 1;
+    int maxY = (int)texture.height - 1;
+    int x0 = max(0, min(maxX, (int)fx));
+    int y0 = max(0, min(maxY, (int)fy));
+    int x1 = max(0, min(maxX, (int)fx + 1));
+    int y1 = max(0, min(maxY, (int)fy + 1));
+
+    const uint8_t* p00 = &texture.pixels[((size_t)y0 * texture.width + x0) * 4];
+    const uint8_t* p10 = &texture.pixels[((size_t)y0 * texture.width + x1) * 4];
+    const uint8_t* p01 = &texture.pixels[((size_t)y1 * texture.width + x0) * 4];
+    const uint8_t* p11 = &texture.pixels[((size_t)y1 * texture.width + x1) * 4];
+
+    for (int c = 0; c < 4; c++) {
+        float top = p00[c] + (p10[c] - p00[c]) * wx;
+        float bottom = p01[c] + (p11[c] - p01[c]) * wx;
+        pColor[c] = (top + (bottom - top) * wy) * unorm8;
+    }
+}
+
+bool SoftwareRenderBackend::SaveToTGA(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    uint8_t header[18] = {};
+    header[2] = 2; // Uncompressed true-colour
+    header[12] = (uint8_t)(m_Width & 0xFF);
+    header[13] = (uint8_t)(m_Width >> 8);
+    header[14] = (uint8_t)(m_Height & 0xFF);
+    header[15] = (uint8_t)(m_Height >> 8);
+    header[16] = 32;
+    header[17] = 0x28; // 8 alpha bits, top-left origin
+    file.write((const char*)header, sizeof(header));
+
+    // TGA stores BGRA
+    std::vector<uint8_t> row(m_Width * 4);
+    for (uint32_t y = 0; y < m_Height; y++) {
+        const uint8_t* pSrc = &m_Pixels[((size_t)y * m_Width) * 4];
+        for (uint32_t x = 0; x < m_Width; x++) {
+            row[x * 4 + 0] = pSrc[x * 4 + 2];
+            row[x * 4 + 1] = pSrc[x * 4 + 1];
+            row[x * 4 + 2] = pSrc[x * 4 + 0];
+            row[x * 4 + 3] = pSrc[x * 4 + 3];
+        }
+        file.write((const char*)row.data(), row.size());
+    }
+
+    return file.good();
+}
\ No newline at end of file
@@ -1,8 +1,13 @@
 #include "../include/Sprite.h"
+#include "../include/AssetArchive.h"
+#include <filesystem>
+#ifdef _WIN32
 #include <wincodec.h>
 #include <wrl/client.h>
+#endif
 
-Sprite::Sprite() : m_Width(0.0f), m_Height(0.0f) {
+Sprite::Sprite() : m_Width(0.0f), m_Height(0.0f),
+    m_TextureId(0), m_U0(0.0f), m_V0(0.0f), m_U1(1.0f), m_V1(1.0f), m_bPending(false) {
 }
 
 Sprite::~Sprite() {
@@ -11,40 +16,60 @@ Sprite::~Sprite() {
 
 bool Sprite::LoadFromFile(const std::wstring& filename) {
     m_Filename = filename;
-    
-    // For now, we'll just set basic dimensions
-    // In a real implementation, we would load the image and create the texture
-    m_Width = 64.0f;
-    m_Height = 64.0f;
-    
-    // This is a simplified version - in a real implementation, 
-    // we would use WIC (Windows Imaging Component) to load the image
-    // and create a texture from it
-    
+
+    if (!LoadImageFile(filename, m_Image)) {
+        return false;
+    }
+
     return CreateTextureView();
 }
 
-bool Sprite::CreateFromMemory(unsigned char* pData, size_t size) {
-    // Similar to loading from file, but from memory
-    m_Width = 64.0f;
-    m_Height = 64.0f;
-    
+bool Sprite::CreateFromMemory(const unsigned char* pData, size_t size) {
+    if (!DecodeImage(pData, size, m_Image)) {
+        return false;
+    }
+
     return CreateTextureView();
 }
 
-void Sprite::Render(float x, float y, float scaleX, float scaleY, float rotation) {
+bool Sprite::LoadFromArchive(const AssetArchive& archive, const std::string& name) {
+    std::vector<uint8_t> scratch;
+    const uint8_t* pData;
+    size_t size;
+    if (!archive.Read(name, scratch, pData, size)) {
+        return false;
+    }
+
+    m_Filename = std::filesystem::u8path(name).wstring();
+    return CreateFromMemory(pData, size);
+}
+
+void Sprite::SetTextureRegion(uint32_t textureId, float u0, float v0, float u1, float v1) {
+    m_TextureId = textureId;
+    m_U0 = u0;
+    m_V0 = v0;
+    m_U1 = u1;
+    m_V1 = v1;
+}
+
+void Sprite::SetSize(float width, float height) {
+    m_Width = width;
+    m_Height = height;
+}
+
+void Sprite::Render(float /*x*/, float /*y*/, float /*scaleX*/, float /*scaleY*/, float /*rotation*/) {
     // Rendering is handled by the Renderer class
     // This method would be called by the renderer when drawing sprites
 }
 
 bool Sprite::CreateTextureView() {
-    // For this simplified implementation, we'll just set the dimensions
-    // A full implementation would create the actual texture from image data
-    m_Width = 64.0f;
-    m_Height = 64.0f;
-    
-    // In a real implementation, we would create the texture using the graphics device
-    // passed from outside since Sprite doesn't own the graphics device
-    
+    if (m_Image.IsEmpty()) {
+        return false;
+    }
+
+    // The GPU copy is made by whoever owns the backend, usually by inserting
+    // GetImage() into a TextureAtlas and applying the region back
+    m_Width = (float)m_Image.width;
+    m_Height = (float)m_Image.height;
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "../include/StrokeLog.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+using std::min;
+using std::max;
+
+static const char STROKE_LOG_MAGIC[4] = { 'S', 'L', 'O', 'G' };
+static const uint8_t STROKE_LOG_VERSION = 1;
+static const size_t STROKE_LOG_HEADER_SIZE = 8;
+
+static const double POSITION_SCALE = 16.0;
+static const double PRESSURE_SCALE = 1024.0;
+
+// Tag byte: event type in the low four bits, then flags for the optional fields
+static const uint8_t TAG_TYPE_MASK = 0x0f;
+static const uint8_t TAG_ERASER = 0x10;
+static const uint8_t TAG_BUTTONS = 0x20;
+static const uint8_t TAG_WHEEL = 0x40;
+
+static int32_t Quantise(double value, double scale) {
+    return (int32_t)std::lround(value * scale);
+}
+
+StrokeLogWriter::StrokeLogWriter() {
+    Clear();
+}
+
+void StrokeLogWriter::Clear() {
+    m_Data.assign(STROKE_LOG_HEADER_SIZE, 0);
+    memcpy(m_Data.data(), STROKE_LOG_MAGIC, sizeof(STROKE_LOG_MAGIC));
+    m_Data[4] = STROKE_LOG_VERSION;
+    m_EventCount = 0;
+
+    m_TimeUs = 0;
+    m_X = 0;
+    m_Y = 0;
+    m_Pressure = 0;
+    m_TiltX = 0;
+    m_TiltY = 0;
+    m_Buttons = 0;
+}
+
+void StrokeLogWriter::Add(const InputEvent& event) {
+    int64_t timeUs = (int64_t)std::llround(event.timeMs * 1000.0);
+    int32_t x = Quantise(event.x, POSITION_SCALE);
+    int32_t y = Quantise(event.y, POSITION_SCALE);
+    int32_t pressure = Quantise(max(0.0f, min(1.0f, event.pressure)), PRESSURE_SCALE);
+    int32_t tiltX = Quantise(event.tiltX, 1.0);
+    int32_t tiltY = Quantise(event.tiltY, 1.0);
+
+    uint8_t tag = (uint8_t)event.type & TAG_TYPE_MASK;
+    if (event.isEraser) tag |= TAG_ERASER;
+    if (event.buttons != m_Buttons) tag |= TAG_BUTTONS;
+    if (event.wheelDelta != 0) tag |= TAG_WHEEL;
+
+    m_Data.push_back(tag);
+    WriteSigned(timeUs - m_TimeUs);
+    WriteSigned(x - m_X);
+    WriteSigned(y - m_Y);
+    WriteSigned(pressure - m_Pressure);
+    WriteSigned(tiltX - m_TiltX);
+    WriteSigned(tiltY - m_TiltY);
+    if (tag & TAG_BUTTONS) WriteVarint(event.buttons);
+    if (tag & TAG_WHEEL) WriteSigned(event.wheelDelta);
+
+    m_TimeUs = timeUs;
+    m_X = x;
+    m_Y = y;
+    m_Pressure = pressure;
+    m_TiltX = tiltX;
+    m_TiltY = tiltY;
+    m_Buttons = event.buttons;
+    m_EventCount++;
+}
+
+void StrokeLogWriter::WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+        m_Data.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    m_Data.push_back((uint8_t)value);
+}
+
+void StrokeLogWriter::WriteSigned(int64_t value) {
+    // Zigzag so small negative deltas stay small
+    WriteVarint(((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+bool StrokeLogWriter::Save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) return false;
+    file.write((const char*)m_Data.data(), (std::streamsize)m_Data.size());
+    return (bool)file;
+}
+
+StrokeLogReader::StrokeLogReader() :
+    m_Position(0),
+    m_bError(false) {
+    Rewind();
+}
+
+bool StrokeLogReader::Load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return false;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return Load(data.data(), data.size());
+}
+
+bool StrokeLogReader::Load(const uint8_t* pData, size_t size) {
+    m_Data.clear();
+    if (size < STROKE_LOG_HEADER_SIZE ||
+        memcmp(pData, STROKE_LOG_MAGIC, sizeof(STROKE_LOG_MAGIC)) != 0 ||
+        pData[4] != STROKE_LOG_VERSION) {
+        Rewind();
+        return false;
+    }
+
+    m_Data.assign(pData, pData + size);
+    Rewind();
+    return true;
+}
+
+void StrokeLogReader::Rewind() {
+    m_Position = STROKE_LOG_HEADER_SIZE;
+    m_bError = false;
+
+    m_TimeUs = 0;
+    m_X = 0;
+    m_Y = 0;
+    m_Pressure = 0;
+    m_TiltX = 0;
+    m_TiltY = 0;
+    m_Buttons = 0;
+}
+
+bool StrokeLogReader::Next(InputEvent& event) {
+    if (m_bError || m_Position >= m_Data.size()) return false;
+
+    uint8_t tag = m_Data[m_Position++];
+    int64_t deltas[6];
+    for (int64_t& delta : deltas) {
+        if (!ReadSigned(delta)) return false;
+    }
+
+    uint64_t buttons = m_Buttons;
+    int64_t wheelDelta = 0;
+    if ((tag & TAG_BUTTONS) && !ReadVarint(buttons)) return false;
+    if ((tag & TAG_WHEEL) && !ReadSigned(wheelDelta)) return false;
+    if ((tag & TAG_TYPE_MASK) > (uint8_t)InputEventType::KEY_UP) {
+        m_bError = true;
+        return false;
+    }
+
+    m_TimeUs += deltas[0];
+    m_X += (int32_t)deltas[1];
+    m_Y += (int32_t)deltas[2];
+    m_Pressure += (int32_t)deltas[3];
+    m_TiltX += (int32_t)deltas[4];
+    m_TiltY += (int32_t)deltas[5];
+    m_Buttons = (uint32_t)buttons;
+
+    event = InputEvent();
+    event.timeMs = (double)m_TimeUs / 1000.0;
+    event.x = (float)(m_X / POSITION_SCALE);
+    event.y = (float)(m_Y / POSITION_SCALE);
+    event.pressure = (float)(m_Pressure / PRESSURE_SCALE);
+    event.tiltX = (float)m_TiltX;
+    event.tiltY = (float)m_TiltY;
+    event.buttons = m_Buttons;
+    event.wheelDelta = (int32_t)wheelDelta;
+    event.type = (InputEventType)(tag & TAG_TYPE_MASK);
+    event.isEraser = (tag & TAG_ERASER) != 0;
+    return true;
+}
+
+bool StrokeLogReader::ReadAll(std::vector<InputEvent>& events) {
+    Rewind();
+    InputEvent event;
+    while (Next(event)) {
+        events.push_back(event);
+    }
+    return !m_bError;
+}
+
+bool StrokeLogReader::ReadVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (m_Position >= m_Data.size()) break;
+        uint8_t byte = m_Data[m_Position++];
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    m_bError = true;
+    return false;
+}
+
+bool StrokeLogReader::ReadSigned(int64_t& value) {
+    uint64_t encoded;
+    if (!ReadVarint(encoded)) return false;
+    value = (int64_t)(encoded >> 1) ^ -(int64_t)(encoded & 1);
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include "../include/StrokeSmoother.h"
+#include <algorithm>
+#include <cmath>
+using std::min;
+using std::max;
+
+// Curve points are spaced about this many pixels apart
+static const float SUBDIVISION_LENGTH = 2.0f;
+static const int MAX_SUBDIVISIONS = 32;
+
+// Binomial pre-filter weights by window radius, centre first
+static const float FILTER_WEIGHTS[3][3] = {
+    { 1.0f, 0.0f, 0.0f },
+    { 2.0f / 4.0f, 1.0f / 4.0f, 0.0f },
+    { 6.0f / 16.0f, 4.0f / 16.0f, 1.0f / 16.0f }
+};
+
+static inline StrokeSample Lerp(const StrokeSample& a, const StrokeSample& b, float ta, float tb, float t) {
+    float span = tb - ta;
+    float wa = (tb - t) / span;
+    float wb = (t - ta) / span;
+
+    StrokeSample result;
+    result.x = a.x * wa + b.x * wb;
+    result.y = a.y * wa + b.y * wb;
+    result.pressure = a.pressure * wa + b.pressure * wb;
+    result.timeMs = a.timeMs * wa + b.timeMs * wb;
+    return result;
+}
+
+// Knot spacing for the centripetal parameterisation: sqrt of the chord length
+static inline float KnotInterval(const StrokeSample& a, const StrokeSample& b) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    return max(std::sqrt(std::sqrt(dx * dx + dy * dy)), 1e-3f);
+}
+
+StrokeSmoother::StrokeSmoother() : m_Lookahead(0), m_Emitted(-1), m_Latency() {
+}
+
+void StrokeSmoother::SetLookahead(uint32_t lookahead) {
+    m_Lookahead = min(lookahead, MAX_LOOKAHEAD);
+}
+
+void StrokeSmoother::Begin() {
+    m_Samples.clear();
+    m_Emitted = -1;
+    m_Latency = StrokeLatency();
+}
+
+void StrokeSmoother::AddSample(const StrokeSample& sample, std::vector<StrokeSample>& out) {
+    m_Samples.push_back(sample);
+
+    // The curve can reach filtered sample n - lookahead: its filter window
+    // and the Catmull-Rom control point after it are both known
+    int lastIndex = (int)m_Samples.size() - 1;
+    EmitUpTo(lastIndex, lastIndex - (int)m_Lookahead, sample.timeMs, true, out);
+}
+
+void StrokeSmoother::End(std::vector<StrokeSample>& out) {
+    if (m_Samples.empty()) return;
+
+    int lastIndex = (int)m_Samples.size() - 1;
+    EmitUpTo(lastIndex, lastIndex, m_Samples.back().timeMs, false, out);
+    m_Samples.clear();
+    m_Emitted = -1;
+}
+
+void StrokeSmoother::GetPending(std::vector<StrokeSample>& out) const {
+    for (size_t index = (size_t)(m_Emitted + 1); index < m_Samples.size(); index++) {
+        out.push_back(m_Samples[index]);
+    }
+}
+
+StrokeSample StrokeSmoother::GetFiltered(int index) const {
+    int lastIndex = (int)m_Samples.size() - 1;
+
+    // The window narrows near either end of the stroke so the curve starts
+    // and ends exactly on the pen. While drawing, the samples still to be
+    // filtered are always lookahead away from the end, so nothing emitted
+    // changes when the stroke later ends.
+    int radius = m_Lookahead > 0 ? (int)m_Lookahead - 1 : 0;
+    radius = min(radius, min(index, lastIndex - index));
+    const float* pWeights = FILTER_WEIGHTS[radius];
+
+    // The raw timestamp is kept so latency is measured against arrival
+    StrokeSample result = m_Samples[index];
+    result.x *= pWeights[0];
+    result.y *= pWeights[0];
+    result.pressure *= pWeights[0];
+
+    for (int offset = 1; offset <= radius; offset++) {
+        const StrokeSample& before = m_Samples[index - offset];
+        const StrokeSample& after = m_Samples[index + offset];
+        result.x += (before.x + after.x) * pWeights[offset];
+        result.y += (before.y + after.y) * pWeights[offset];
+        result.pressure += (before.pressure + after.pressure) * pWeights[offset];
+    }
+    return result;
+}
+
+StrokeSample StrokeSmoother::GetControlPoint(int index, int lastIndex) const {
+    // Beyond either end, reflect the neighbouring segment
+    if (index < 0) {
+        StrokeSample first = GetFiltered(0);
+        StrokeSample second = GetFiltered(min(1, lastIndex));
+        first.x = 2.0f * first.x - second.x;
+        first.y = 2.0f * first.y - second.y;
+        first.pressure = 2.0f * first.pressure - second.pressure;
+        return first;
+    }
+    if (index > lastIndex) {
+        StrokeSample last = GetFiltered(lastIndex);
+        StrokeSample previous = GetFiltered(max(lastIndex - 1, 0));
+        last.x = 2.0f * last.x - previous.x;
+        last.y = 2.0f * last.y - previous.y;
+        last.pressure = 2.0f * last.pressure - previous.pressure;
+        return last;
+    }
+    return GetFiltered(index);
+}
+
+void StrokeSmoother::EmitUpTo(int lastIndex, int available, double nowMs, bool bMeasure, std::vector<StrokeSample>& out) {
+    for (int index = m_Emitted + 1; index <= available; index++) {
+        StrokeSample p2 = GetFiltered(index);
+
+        if (index == 0 || m_Lookahead == 0) {
+            out.push_back(p2);
+        } else {
+            // Centripetal Catmull-Rom from p1 to p2, evaluated with the
+            // Barry-Goldman pyramid so coincident samples stay stable
+            StrokeSample p0 = GetControlPoint(index - 2, lastIndex);
+            StrokeSample p1 = GetFiltered(index - 1);
+            StrokeSample p3 = GetControlPoint(index + 1, lastIndex);
+
+            float t0 = 0.0f;
+            float t1 = t0 + KnotInterval(p0, p1);
+            float t2 = t1 + KnotInterval(p1, p2);
+            float t3 = t2 + KnotInterval(p2, p3);
+
+            float dx = p2.x - p1.x;
+            float dy = p2.y - p1.y;
+            int steps = (int)std::ceil(std::sqrt(dx * dx + dy * dy) / SUBDIVISION_LENGTH);
+            steps = max(1, min(steps, MAX_SUBDIVISIONS));
+
+            for (int step = 1; step < steps; step++) {
+                float t = t1 + (t2 - t1) * (float)step / (float)steps;
+                StrokeSample a1 = Lerp(p0, p1, t0, t1, t);
+                StrokeSample a2 = Lerp(p1, p2, t1, t2, t);
+                StrokeSample a3 = Lerp(p2, p3, t2, t3, t);
+                StrokeSample b1 = Lerp(a1, a2, t0, t2, t);
+                StrokeSample b2 = Lerp(a2, a3, t1, t3, t);
+                StrokeSample point = Lerp(b1, b2, t1, t2, t);
+                point.pressure = max(0.0f, min(1.0f, point.pressure));
+                out.push_back(point);
+            }
+            out.push_back(p2);
+        }
+
+        if (bMeasure) {
+            double latency = nowMs - m_Samples[index].timeMs;
+            m_Latency.averageMs += (latency - m_Latency.averageMs) / (double)(m_Latency.sampleCount + 1);
+            m_Latency.maxMs = max(m_Latency.maxMs, latency);
+            m_Latency.sampleCount++;
+        }
+        m_Emitted = index;
+    }
+}
\ No newline at end of file
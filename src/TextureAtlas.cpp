@@ -0,0 +1,328 @@
+#include "../include/TextureAtlas.h"
+#include "../include/RenderBackend.h"
+#include "../include/Sprite.h"
+#include "../include/ImageDecoder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+using std::min;
+using std::max;
+
+static const char ATLAS_MAGIC[4] = { 'A', 'T', 'L', 'S' };
+static const uint32_t ATLAS_VERSION = 1;
+
+// Baked files are little-endian, like every platform the engine targets
+static void WriteU32(std::ofstream& file, uint32_t value) {
+    file.write((const char*)&value, sizeof(value));
+}
+
+static bool ReadU32(std::ifstream& file, uint32_t& value) {
+    return (bool)file.read((char*)&value, sizeof(value));
+}
+
+TextureAtlas::TextureAtlas(RenderBackend* pBackend, uint32_t pageSize, uint32_t maxPages) :
+    m_pBackend(pBackend),
+    m_PageSize(max(16u, pageSize)),
+    m_MaxPages(max(1u, maxPages)) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    ReleasePages();
+}
+
+void TextureAtlas::ReleasePages() {
+    if (m_pBackend) {
+        for (Page& page : m_Pages) {
+            m_pBackend->DestroyTexture(page.textureId);
+        }
+    }
+    m_Pages.clear();
+}
+
+bool TextureAtlas::AddPage() {
+    if (m_Pages.size() >= m_MaxPages) {
+        return false;
+    }
+
+    m_Pages.emplace_back(m_PageSize);
+    Page& page = m_Pages.back();
+    page.pixels.assign((size_t)m_PageSize * m_PageSize * 4, 0);
+
+    if (m_pBackend) {
+        page.textureId = m_pBackend->CreateTexture(m_PageSize, m_PageSize, nullptr);
+        if (page.textureId == RenderBackend::WHITE_TEXTURE) {
+            m_Pages.pop_back();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextureAtlas::Insert(const std::string& name, uint32_t width, uint32_t height, const uint8_t* pPixels, uint32_t rowPitch) {
+    if (width == 0 || height == 0 || !pPixels) {
+        return false;
+    }
+
+    uint32_t paddedWidth = width + PADDING * 2;
+    uint32_t paddedHeight = height + PADDING * 2;
+    if (paddedWidth > m_PageSize || paddedHeight > m_PageSize) {
+        return false;
+    }
+
+    Evict(name);
+
+    // First fit across pages keeps new images on already-bound textures
+    AtlasRect rect;
+    uint32_t pageIndex = 0;
+    for (; pageIndex < m_Pages.size(); pageIndex++) {
+        if (m_Pages[pageIndex].packer.Insert(paddedWidth, paddedHeight, rect)) {
+            break;
+        }
+    }
+
+    if (pageIndex == m_Pages.size()) {
+        if (!AddPage() || !m_Pages.back().packer.Insert(paddedWidth, paddedHeight, rect)) {
+            return false;
+        }
+    }
+
+    Page& page = m_Pages[pageIndex];
+    CopyImage(page, rect, pPixels, rowPitch ? rowPitch : width * 4);
+    MarkDirty(page, rect);
+
+    m_Regions[name] = MakeRegion(pageIndex, rect);
+    return true;
+}
+
+bool TextureAtlas::Insert(const std::string& name, const Image& image) {
+    return Insert(name, image.width, image.height, image.pixels.data(), image.width * 4);
+}
+
+void TextureAtlas::CopyImage(Page& page, const AtlasRect& rect, const uint8_t* pPixels, uint32_t rowPitch) {
+    uint32_t width = rect.width - PADDING * 2;
+    uint32_t height = rect.height - PADDING * 2;
+    size_t pagePitch = (size_t)m_PageSize * 4;
+
+    // Each padded row: extruded left edge, image row, extruded right edge
+    for (uint32_t row = 0; row < rect.height; row++) {
+        uint32_t srcRow = (uint32_t)min(max((int)row - (int)PADDING, 0), (int)height - 1);
+        const uint8_t* pSrc = pPixels + (size_t)srcRow * rowPitch;
+        uint8_t* pDst = &page.pixels[(rect.y + row) * pagePitch + (size_t)rect.x * 4];
+
+        for (uint32_t p = 0; p < PADDING; p++) {
+            memcpy(pDst + p * 4, pSrc, 4);
+            memcpy(pDst + (PADDING + width + p) * 4, pSrc + (width - 1) * 4, 4);
+        }
+        memcpy(pDst + PADDING * 4, pSrc, (size_t)width * 4);
+    }
+}
+
+void TextureAtlas::MarkDirty(Page& page, const AtlasRect& rect) {
+    if (!page.bDirty) {
+        page.dirtyMinX = rect.x;
+        page.dirtyMinY = rect.y;
+        page.dirtyMaxX = rect.x + rect.width;
+        page.dirtyMaxY = rect.y + rect.height;
+        page.bDirty = true;
+        return;
+    }
+
+    page.dirtyMinX = min(page.dirtyMinX, rect.x);
+    page.dirtyMinY = min(page.dirtyMinY, rect.y);
+    page.dirtyMaxX = max(page.dirtyMaxX, rect.x + rect.width);
+    page.dirtyMaxY = max(page.dirtyMaxY, rect.y + rect.height);
+}
+
+AtlasRegion TextureAtlas::MakeRegion(uint32_t page, const AtlasRect& paddedRect) const {
+    AtlasRegion region;
+    region.page = page;
+    region.rect = { paddedRect.x + PADDING, paddedRect.y + PADDING,
+                    paddedRect.width - PADDING * 2, paddedRect.height - PADDING * 2 };
+
+    float invSize = 1.0f / (float)m_PageSize;
+    region.u0 = region.rect.x * invSize;
+    region.v0 = region.rect.y * invSize;
+    region.u1 = (region.rect.x + region.rect.width) * invSize;
+    region.v1 = (region.rect.y + region.rect.height) * invSize;
+    return region;
+}
+
+bool TextureAtlas::Evict(const std::string& name) {
+    auto it = m_Regions.find(name);
+    if (it == m_Regions.end()) {
+        return false;
+    }
+
+    const AtlasRegion& region = it->second;
+    AtlasRect paddedRect = { region.rect.x - PADDING, region.rect.y - PADDING,
+                             region.rect.width + PADDING * 2, region.rect.height + PADDING * 2 };
+    m_Pages[region.page].packer.Free(paddedRect);
+
+    m_Regions.erase(it);
+    return true;
+}
+
+void TextureAtlas::Clear() {
+    m_Regions.clear();
+    for (Page& page : m_Pages) {
+        page.packer.Reset();
+    }
+}
+
+const AtlasRegion* TextureAtlas::Find(const std::string& name) const {
+    auto it = m_Regions.find(name);
+    return it != m_Regions.end() ? &it->second : nullptr;
+}
+
+bool TextureAtlas::ApplyToSprite(const std::string& name, Sprite& sprite) const {
+    const AtlasRegion* pRegion = Find(name);
+    if (!pRegion) {
+        return false;
+    }
+
+    sprite.SetTextureRegion(GetTextureId(pRegion->page), pRegion->u0, pRegion->v0, pRegion->u1, pRegion->v1);
+    sprite.SetSize((float)pRegion->rect.width, (float)pRegion->rect.height);
+    return true;
+}
+
+void TextureAtlas::Upload() {
+    if (!m_pBackend) {
+        return;
+    }
+
+    for (Page& page : m_Pages) {
+        if (!page.bDirty) {
+            continue;
+        }
+
+        // One update covering everything inserted since the last upload
+        const uint8_t* pSrc = &page.pixels[((size_t)page.dirtyMinY * m_PageSize + page.dirtyMinX) * 4];
+        m_pBackend->UpdateTexture(page.textureId, page.dirtyMinX, page.dirtyMinY,
+                                  page.dirtyMaxX - page.dirtyMinX, page.dirtyMaxY - page.dirtyMinY,
+                                  pSrc, m_PageSize * 4);
+        page.bDirty = false;
+    }
+}
+
+uint32_t TextureAtlas::GetTextureId(uint32_t page) const {
+    return page < m_Pages.size() ? m_Pages[page].textureId : RenderBackend::WHITE_TEXTURE;
+}
+
+const uint8_t* TextureAtlas::GetPagePixels(uint32_t page) const {
+    return page < m_Pages.size() ? m_Pages[page].pixels.data() : nullptr;
+}
+
+float TextureAtlas::GetOccupancy() const {
+    if (m_Pages.empty()) {
+        return 0.0f;
+    }
+
+    uint64_t usedArea = 0;
+    for (const Page& page : m_Pages) {
+        usedArea += page.packer.GetUsedArea();
+    }
+    return (float)usedArea / ((float)m_PageSize * m_PageSize * m_Pages.size());
+}
+
+bool TextureAtlas::Save(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    file.write(ATLAS_MAGIC, sizeof(ATLAS_MAGIC));
+    WriteU32(file, ATLAS_VERSION);
+    WriteU32(file, m_PageSize);
+    WriteU32(file, (uint32_t)m_Pages.size());
+    WriteU32(file, (uint32_t)m_Regions.size());
+
+    for (const auto& entry : m_Regions) {
+        const AtlasRegion& region = entry.second;
+        WriteU32(file, (uint32_t)entry.first.size());
+        file.write(entry.first.data(), entry.first.size());
+        WriteU32(file, region.page);
+        WriteU32(file, region.rect.x);
+        WriteU32(file, region.rect.y);
+        WriteU32(file, region.rect.width);
+        WriteU32(file, region.rect.height);
+    }
+
+    for (const Page& page : m_Pages) {
+        file.write((const char*)page.pixels.data(), page.pixels.size());
+    }
+
+    return file.good();
+}
+
+bool TextureAtlas::Load(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version, pageSize, pageCount, regionCount;
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, ATLAS_MAGIC, sizeof(magic)) != 0 ||
+        !ReadU32(file, version) || version != ATLAS_VERSION ||
+        !ReadU32(file, pageSize) || !ReadU32(file, pageCount) || !ReadU32(file, regionCount)) {
+        return false;
+    }
+
+    if (pageSize < 16 || pageCount > m_MaxPages) {
+        return false;
+    }
+
+    ReleasePages();
+    m_Regions.clear();
+    m_PageSize = pageSize;
+
+    // Never leave a half-loaded atlas behind
+    if (!LoadContents(file, pageCount, regionCount)) {
+        ReleasePages();
+        m_Regions.clear();
+        return false;
+    }
+    return true;
+}
+
+bool TextureAtlas::LoadContents(std::ifstream& file, uint32_t pageCount, uint32_t regionCount) {
+    for (uint32_t i = 0; i < pageCount; i++) {
+        if (!AddPage()) {
+            return false;
+        }
+    }
+
+    for (uint32_t i = 0; i < regionCount; i++) {
+        uint32_t nameLength;
+        if (!ReadU32(file, nameLength) || nameLength > 4096) {
+            return false;
+        }
+
+        std::string name(nameLength, '\0');
+        AtlasRect rect;
+        uint32_t page;
+        if (!file.read(&name[0], nameLength) || !ReadU32(file, page) ||
+            !ReadU32(file, rect.x) || !ReadU32(file, rect.y) ||
+            !ReadU32(file, rect.width) || !ReadU32(file, rect.height)) {
+            return false;
+        }
+
+        // Rebuild the packer state so the atlas stays incrementally editable
+        AtlasRect paddedRect = { rect.x - PADDING, rect.y - PADDING, rect.width + PADDING * 2, rect.height + PADDING * 2 };
+        if (page >= pageCount || rect.x < PADDING || rect.y < PADDING ||
+            !m_Pages[page].packer.Reserve(paddedRect)) {
+            return false;
+        }
+
+        m_Regions[name] = MakeRegion(page, paddedRect);
+    }
+
+    for (Page& page : m_Pages) {
+        if (!file.read((char*)page.pixels.data(), page.pixels.size())) {
+            return false;
+        }
+        MarkDirty(page, { 0, 0, m_PageSize, m_PageSize });
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "../include/UndoHistory.h"
+#include "../include/Profiler.h"
+#include "../include/LZ4.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+UndoHistory::UndoHistory() :
+    m_MemoryBudget(DEFAULT_MEMORY_BUDGET),
+    m_MaxStates(DEFAULT_MAX_STATES),
+    m_MemoryUsage(0) {
+}
+
+void UndoHistory::SetMemoryBudget(size_t bytes) {
+    m_MemoryBudget = bytes;
+    EnforceBudget();
+}
+
+void UndoHistory::SetMaxStates(size_t count) {
+    m_MaxStates = max<size_t>(count, 1);
+    EnforceBudget();
+}
+
+void UndoHistory::Push(std::vector<Canvas::TileChange>& changes) {
+    PROFILE_ZONE("UndoHistory::Push");
+    if (changes.empty()) return;
+
+    for (const HistoryState& state : m_RedoStates) {
+        m_MemoryUsage -= state.bytes;
+    }
+    m_RedoStates.clear();
+
+    HistoryState state;
+    state.tiles.swap(changes);
+    state.bCompressed = false;
+    state.bytes = MeasureState(state);
+    m_MemoryUsage += state.bytes;
+    m_UndoStates.push_back(std::move(state));
+
+    EnforceBudget();
+}
+
+bool UndoHistory::Undo(Canvas& canvas) {
+    if (m_UndoStates.empty()) return false;
+
+    HistoryState state = std::move(m_UndoStates.back());
+    m_UndoStates.pop_back();
+    Apply(canvas, state);
+    m_RedoStates.push_back(std::move(state));
+
+    // Apply leaves the state decompressed, so a run of undos would otherwise
+    // grow past the budget one full-size state at a time
+    EnforceBudget();
+    return true;
+}
+
+bool UndoHistory::Redo(Canvas& canvas) {
+    if (m_RedoStates.empty()) return false;
+
+    HistoryState state = std::move(m_RedoStates.back());
+    m_RedoStates.pop_back();
+    Apply(canvas, state);
+    m_UndoStates.push_back(std::move(state));
+    EnforceBudget();
+    return true;
+}
+
+void UndoHistory::Apply(Canvas& canvas, HistoryState& state) {
+    // The state comes back holding the tiles the canvas just gave up, which
+    // are exactly what reverses this step
+    m_MemoryUsage -= state.bytes;
+    if (state.bCompressed) {
+        Decompress(state);
+    }
+    canvas.SwapTiles(state.tiles);
+    state.bytes = MeasureState(state);
+    m_MemoryUsage += state.bytes;
+}
+
+size_t UndoHistory::GetCompressedStateCount() const {
+    size_t count = 0;
+    for (const HistoryState& state : m_UndoStates) {
+        if (state.bCompressed) count++;
+    }
+    for (const HistoryState& state : m_RedoStates) {
+        if (state.bCompressed) count++;
+    }
+    return count;
+}
+
+void UndoHistory::Clear() {
+    m_UndoStates.clear();
+    m_RedoStates.clear();
+    m_MemoryUsage = 0;
+}
+
+size_t UndoHistory::MeasureState(const HistoryState& state) {
+    size_t bytes = 0;
+    for (size_t i = 0; i < state.tiles.size(); i++) {
+        if (state.tiles[i].tile) {
+            bytes += Canvas::TILE_BYTES;
+        } else if (i < state.compressed.size()) {
+            bytes += state.compressed[i].size();
+        }
+    }
+    return bytes;
+}
+
+void UndoHistory::CompressState(HistoryState& state) {
+    if (state.bCompressed) return;
+
+    m_MemoryUsage -= state.bytes;
+    Compress(state);
+    state.bytes = MeasureState(state);
+    m_MemoryUsage += state.bytes;
+}
+
+void UndoHistory::Compress(HistoryState& state) {
+    PROFILE_ZONE("UndoHistory::Compress");
+    state.compressed.resize(state.tiles.size());
+    for (size_t i = 0; i < state.tiles.size(); i++) {
+        Canvas::TilePtr& tile = state.tiles[i].tile;
+        if (!tile) continue;
+
+        // Tiles that hardly compress are kept as they are
+        std::vector<uint8_t>& packed = state.compressed[i];
+        LZ4Compress(tile.get(), Canvas::TILE_BYTES, packed);
+        if (packed.size() < Canvas::TILE_BYTES - Canvas::TILE_BYTES / 8) {
+            packed.shrink_to_fit();
+            tile.reset();
+        } else {
+            std::vector<uint8_t>().swap(packed);
+        }
+    }
+    state.bCompressed = true;
+}
+
+void UndoHistory::Decompress(HistoryState& state) {
+    PROFILE_ZONE("UndoHistory::Decompress");
+    for (size_t i = 0; i < state.compressed.size(); i++) {
+        std::vector<uint8_t>& packed = state.compressed[i];
+        if (packed.empty()) continue;
+
+        Canvas::TilePtr tile(new uint8_t[Canvas::TILE_BYTES]);
+        LZ4Decompress(packed.data(), packed.size(), tile.get(), Canvas::TILE_BYTES);
+        state.tiles[i].tile = tile;
+    }
+    state.compressed.clear();
+    state.bCompressed = false;
+}
+
+void UndoHistory::EnforceBudget() {
+    while (m_UndoStates.size() > m_MaxStates) {
+        m_MemoryUsage -= m_UndoStates.front().bytes;
+        m_UndoStates.pop_front();
+    }
+
+    // Compress from the furthest step in each direction, keeping the next
+    // undo and the next redo live so a single step stays a plain swap
+    for (size_t i = 0; m_MemoryUsage > m_MemoryBudget && i + 1 < m_UndoStates.size(); i++) {
+        CompressState(m_UndoStates[i]);
+    }
+    for (size_t i = 0; m_MemoryUsage > m_MemoryBudget && i + 1 < m_RedoStates.size(); i++) {
+        CompressState(m_RedoStates[i]);
+    }
+
+    while (m_MemoryUsage > m_MemoryBudget && m_UndoStates.size() > 1) {
+        m_MemoryUsage -= m_UndoStates.front().bytes;
+        m_UndoStates.pop_front();
+    }
+    while (m_MemoryUsage > m_MemoryBudget && m_RedoStates.size() > 1) {
+        m_MemoryUsage -= m_RedoStates.front().bytes;
+        m_RedoStates.erase(m_RedoStates.begin());
+    }
+}
\ No newline at end of file
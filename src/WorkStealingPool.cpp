@@ -0,0 +1,163 @@
+#include "../include/WorkStealingPool.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+using std::min;
+using std::max;
+
+static inline uint64_t PackRange(uint32_t begin, uint32_t end) {
+    return (uint64_t)begin << 32 | end;
+}
+
+WorkStealingPool::WorkStealingPool(uint32_t threadCount) :
+    m_ThreadCount(threadCount),
+    m_pTask(nullptr),
+    m_Steals(0),
+    m_Generation(0),
+    m_ActiveWorkers(0),
+    m_bShutdown(false) {
+    if (m_ThreadCount == 0) {
+        m_ThreadCount = max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_Ranges.reset(new TaskRange[m_ThreadCount]);
+    for (uint32_t i = 0; i < m_ThreadCount; i++) {
+        m_Ranges[i].range.store(0, std::memory_order_relaxed);
+    }
+    for (uint32_t i = 1; i < m_ThreadCount; i++) {
+        m_Workers.emplace_back(&WorkStealingPool::WorkerMain, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bShutdown = true;
+    }
+    m_WorkCondition.notify_all();
+
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::Run(uint32_t count, const std::function<void(uint32_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+
+    // Not worth waking anyone for
+    if (m_ThreadCount == 1 || count == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    // Workers are all asleep here, so the runs can be written plainly
+    for (uint32_t i = 0; i < m_ThreadCount; i++) {
+        uint32_t begin = (uint32_t)((uint64_t)count * i / m_ThreadCount);
+        uint32_t end = (uint32_t)((uint64_t)count * (i + 1) / m_ThreadCount);
+        m_Ranges[i].range.store(PackRange(begin, end), std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_pTask = &task;
+        m_Generation++;
+    }
+    m_WorkCondition.notify_all();
+
+    Work(0, task);
+
+    // A worker only leaves Work once every run is empty and its own task
+    // has finished, so no worker still active means the batch is done
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_DoneCondition.wait(lock, [this] { return m_ActiveWorkers == 0; });
+    m_pTask = nullptr;
+}
+
+void WorkStealingPool::WorkerMain(uint32_t threadIndex) {
+    Profiler::SetThreadName("Pool worker");
+    uint64_t seenGeneration = 0;
+
+    for (;;) {
+        const std::function<void(uint32_t)>* pTask;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_WorkCondition.wait(lock, [&] { return m_bShutdown || m_Generation != seenGeneration; });
+            if (m_bShutdown) {
+                return;
+            }
+            seenGeneration = m_Generation;
+
+            // Woken too late: the batch already finished without us
+            pTask = m_pTask;
+            if (!pTask) {
+                continue;
+            }
+            m_ActiveWorkers++;
+        }
+
+        Work(threadIndex, *pTask);
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ActiveWorkers--;
+        }
+        m_DoneCondition.notify_one();
+    }
+}
+
+void WorkStealingPool::Work(uint32_t threadIndex, const std::function<void(uint32_t)>& task) {
+    PROFILE_ZONE("WorkStealingPool::Work");
+    uint32_t index;
+    for (;;) {
+        while (TakeTask(threadIndex, index)) {
+            task(index);
+        }
+        if (!Steal(threadIndex)) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::TakeTask(uint32_t threadIndex, uint32_t& task) {
+    std::atomic<uint64_t>& range = m_Ranges[threadIndex].range;
+    uint64_t current = range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = (uint32_t)(current >> 32);
+        uint32_t end = (uint32_t)current;
+        if (begin >= end) {
+            return false;
+        }
+        if (range.compare_exchange_weak(current, PackRange(begin + 1, end), std::memory_order_acq_rel)) {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+bool WorkStealingPool::Steal(uint32_t threadIndex) {
+    // Try every other thread once, starting with the next one along
+    for (uint32_t offset = 1; offset < m_ThreadCount; offset++) {
+        std::atomic<uint64_t>& victim = m_Ranges[(threadIndex + offset) % m_ThreadCount].range;
+        uint64_t current = victim.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t begin = (uint32_t)(current >> 32);
+            uint32_t end = (uint32_t)current;
+            if (begin >= end) {
+                break;
+            }
+
+            // Take the back half, or the last task
+            uint32_t middle = begin + (end - begin) / 2;
+            if (victim.compare_exchange_weak(current, PackRange(begin, middle), std::memory_order_acq_rel)) {
+                // Only this thread writes its own run while it is empty
+                m_Ranges[threadIndex].range.store(PackRange(middle, end), std::memory_order_release);
+                m_Steals.fetch_add(end - middle, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "../include/EngineCore.h"
 #include "../include/BrushSystem.h"
+#include "../include/LayerStack.h"
+#include "../include/Profiler.h"
 #include <windows.h>
+#include <filesystem>
+#include <string>
 
 // Global pointer to engine for input handling
 EngineCore* g_pEngine = nullptr;
@@ -9,6 +13,15 @@ BrushSystem* g_pBrushSystem = nullptr;
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR pCmdLine, int nCmdShow) {
     EngineCore engine;
     g_pEngine = &engine;
+
+    // The document is shown as one texture, updated each frame where the
+    // composite changed
+    const uint32_t documentWidth = 1280;
+    const uint32_t documentHeight = 720;
+    uint32_t documentTexture = RenderBackend::WHITE_TEXTURE;
+    engine.RegisterRendererCallback([&documentTexture, documentWidth, documentHeight](Renderer& renderer) {
+        documentTexture = renderer.CreateTexture(documentWidth, documentHeight, nullptr);
+    });
     
     if (!engine.Initialize(hInstance, nCmdShow)) {
         return 1;
@@ -24,6 +37,41 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR pCmdLine, int nCmdShow
     if (!brushSystem.Initialize()) {
         return 1;
     }
+    brushSystem.SetJobSystem(engine.GetJobSystem());
+
+    // Layered CPU document; brushes stamp into the current layer and the
+    // changed tiles are recomposited once per frame
+    LayerStack layers(documentWidth, documentHeight);
+    layers.AddLayer("Background");
+    Canvas& canvas = layers.AddLayer("Layer 1")->GetCanvas();
+    brushSystem.SetCanvas(&canvas);
+
+    // Predicted stroke tail, redrawn every frame to hide input latency and
+    // composited over the layer it is painted into, never committed to it
+    Canvas previewCanvas(canvas.GetWidth(), canvas.GetHeight());
+    brushSystem.SetPreviewCanvas(&previewCanvas);
+    layers.SetOverlay(&previewCanvas, layers.GetLayer(1));
+    brushSystem.SetPrediction(16.0);
+    engine.RegisterFrameCallback([&engine, &layers, documentTexture]() {
+        g_pBrushSystem->UpdatePreview();
+        layers.Composite();
+        if (documentTexture == RenderBackend::WHITE_TEXTURE) return;
+
+        // Send only the recomposited area, committed strokes and predicted
+        // tail alike, then draw the document over the clear colour
+        RenderCommandList& commands = engine.GetCommandList();
+        Canvas& composite = layers.GetComposite();
+        uint32_t x, y, width, height;
+        if (composite.GetDirtyRect(x, y, width, height)) {
+            uint8_t* pPixels = commands.UpdateTexture(documentTexture, x, y, width, height);
+            composite.ReadPixels(x, y, width, height, pPixels, width * 4);
+            composite.ClearDirty();
+        }
+        commands.SetBlendMode(BlendMode::PREMULTIPLIED);
+        commands.DrawQuad(0.5f * composite.GetWidth(), 0.5f * composite.GetHeight(),
+                          (float)composite.GetWidth(), (float)composite.GetHeight(), documentTexture);
+        commands.SetBlendMode(BlendMode::ALPHA);
+    });
     
     // Register input callbacks for pressure-sensitive drawing
     inputManager->RegisterMouseCallback([](float x, float y, int button, bool isDown) {
@@ -38,25 +86,57 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE, PWSTR pCmdLine, int nCmdShow
         }
     });
     
-    // Register tablet callback for pressure-sensitive input
+    // Ctrl+Z undoes the last stroke, Ctrl+Y redoes it. F12 saves the last
+    // frames' profile as a Chrome trace.
+    inputManager->RegisterKeyboardCallback([inputManager](int key, bool isDown) {
+        if (isDown && key == VK_F12) {
+            Profiler::WriteChromeTrace("profile.json");
+            return;
+        }
+        if (!isDown || !inputManager->IsKeyDown(VK_CONTROL)) return;
+        if (key == 'Z') {
+            g_pBrushSystem->Undo();
+        } else if (key == 'Y') {
+            g_pBrushSystem->Redo();
+        }
+    });
+    
+    // Register tablet callback for pressure-sensitive input. Events arrive
+    // once per frame, every coalesced pen packet with its own timestamp.
     inputManager->RegisterTabletCallback([](const TabletData& tabletData) {
+        if (!g_pBrushSystem || !g_pBrushSystem->GetCurrentBrush()) return;
+
+        g_pBrushSystem->SetTilt(tabletData.tiltX, tabletData.tiltY);
         if (tabletData.isPenDown) {
-            // Update brush with actual pressure data from tablet
-            if (g_pBrushSystem) {
-                // Start or continue stroke based on pressure
-                if (!g_pBrushSystem->GetCurrentBrush()) return;
-                
-                // For demo purposes, use the pressure value if available, otherwise default
-                float pressure = tabletData.pressure > 0 ? tabletData.pressure : 0.5f;
-                
-                if (g_pBrushSystem->GetCurrentBrush()) {
-                    g_pBrushSystem->ContinueStroke(tabletData.x, tabletData.y, pressure);
-                }
+            // For demo purposes, use the pressure value if available, otherwise default
+            float pressure = tabletData.pressure > 0 ? tabletData.pressure : 0.5f;
+
+            if (g_pBrushSystem->IsDrawing()) {
+                g_pBrushSystem->ContinueStroke(tabletData.x, tabletData.y, pressure, tabletData.timeMs);
+            } else {
+                g_pBrushSystem->StartStroke(tabletData.x, tabletData.y, pressure, tabletData.timeMs);
             }
+        } else {
+            g_pBrushSystem->EndStroke();
         }
     });
     
+    // "-record <file>" logs the session's input for tools/StrokeReplay
+    StrokeLogWriter recorder;
+    std::wstring recordPath;
+    const std::wstring recordSwitch = L"-record ";
+    if (pCmdLine && std::wstring(pCmdLine).compare(0, recordSwitch.size(), recordSwitch) == 0) {
+        recordPath = pCmdLine + recordSwitch.size();
+        inputManager->SetRecorder(&recorder);
+    }
+    
     engine.Run();
+    
+    if (!recordPath.empty()) {
+        inputManager->SetRecorder(nullptr);
+        recorder.Save(std::filesystem::path(recordPath).string());
+    }
+    brushSystem.Cleanup();
     engine.Shutdown();
     
     return 0;
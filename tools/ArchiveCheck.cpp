@@ -0,0 +1,166 @@
+// Round-trip and corruption checks for AssetArchive.
+//
+//   ArchiveCheck
+//
+// Packs a stored entry and an LZ4 entry into a temporary archive and reads
+// both back. Then patches single table-of-contents fields the way a bad
+// disk or a truncated download would: a decompressed size no LZ4 block
+// could expand to (once as a huge value that used to throw out of GetData
+// on a loader thread), a size that is plausible but wrong, and an entry
+// count past the end of the table. Open must refuse the impossible ones and
+// GetData must fail, not throw, on the plausible one. Each prints ok or
+// FAILED.
+#include "../include/AssetArchive.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const size_t STORED_BYTES = 1000;
+static const size_t PACKED_BYTES = 4096;
+
+// Header fields, and the offsets of one TOC entry's fields
+static const size_t HEADER_ENTRY_COUNT = 8;
+static const size_t HEADER_TOC_OFFSET = 16;
+static const size_t ENTRY_STORED_SIZE = 8;
+static const size_t ENTRY_SIZE = 16;
+static const size_t ENTRY_NAME_LENGTH = 28;
+static const size_t TOC_ENTRY_SIZE = 32;
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+template <typename T>
+static T Get(const std::vector<uint8_t>& data, size_t position) {
+    T value;
+    memcpy(&value, &data[position], sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void Set(std::vector<uint8_t>& data, size_t position, T value) {
+    memcpy(&data[position], &value, sizeof(T));
+}
+
+static bool ReadFile(const fs::path& path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return false;
+    }
+    data.resize((size_t)file.tellg());
+    file.seekg(0);
+    return (bool)file.read((char*)data.data(), (std::streamsize)data.size());
+}
+
+static bool WriteFile(const fs::path& path, const std::vector<uint8_t>& data) {
+    std::ofstream file(path, std::ios::binary);
+    file.write((const char*)data.data(), (std::streamsize)data.size());
+    return file.good();
+}
+
+// Position of the TOC entry with the given index
+static size_t FindEntry(const std::vector<uint8_t>& archive, uint32_t index) {
+    size_t position = (size_t)Get<uint64_t>(archive, HEADER_TOC_OFFSET);
+    for (uint32_t i = 0; i < index; i++) {
+        position += TOC_ENTRY_SIZE + Get<uint32_t>(archive, position + ENTRY_NAME_LENGTH);
+    }
+    return position;
+}
+
+static bool Open(AssetArchive& archive, const fs::path& path, const std::vector<uint8_t>& data) {
+    return WriteFile(path, data) && archive.Open(path.wstring());
+}
+
+static bool CheckRoundTrip(const fs::path& path, const std::vector<uint8_t>& stored, const std::vector<uint8_t>& packed) {
+    AssetArchive archive;
+    bool bOk = archive.Open(path.wstring()) && archive.GetEntryCount() == 2;
+
+    std::vector<uint8_t> scratch;
+    const uint8_t* pData = nullptr;
+    size_t size = 0;
+    const ArchiveEntry* pStored = archive.Find("stored.bin");
+    bOk = bOk && pStored && !(pStored->flags & AssetArchive::FLAG_LZ4) &&
+          archive.GetData(*pStored, scratch, pData, size) && size == stored.size() &&
+          memcmp(pData, stored.data(), size) == 0;
+
+    const ArchiveEntry* pPacked = archive.Find("packed.bin");
+    bOk = bOk && pPacked && (pPacked->flags & AssetArchive::FLAG_LZ4) && pPacked->storedSize < packed.size() &&
+          archive.GetData(*pPacked, scratch, pData, size) && size == packed.size() &&
+          memcmp(pData, packed.data(), size) == 0;
+    return Report("stored and LZ4 entries read back", bOk);
+}
+
+static bool CheckCorruptSizes(const fs::path& path, const std::vector<uint8_t>& original) {
+    fs::path corruptPath = path;
+    corruptPath += ".corrupt";
+    size_t entry = FindEntry(original, 1);
+    uint64_t storedSize = Get<uint64_t>(original, entry + ENTRY_STORED_SIZE);
+
+    // One byte off in the top of the size field
+    std::vector<uint8_t> data = original;
+    Set<uint64_t>(data, entry + ENTRY_SIZE, 16140901064495862664ull);
+    AssetArchive archive;
+    bool bOk = Report("huge LZ4 size refused by Open", !Open(archive, corruptPath, data));
+
+    data = original;
+    Set<uint64_t>(data, entry + ENTRY_SIZE, storedSize * 255 + 17);
+    bOk = Report("LZ4 size past maximum expansion refused", !Open(archive, corruptPath, data)) && bOk;
+
+    // Possible as far as the TOC can tell; only decoding finds out
+    data = original;
+    Set<uint64_t>(data, entry + ENTRY_SIZE, PACKED_BYTES + 1);
+    std::vector<uint8_t> scratch;
+    const uint8_t* pData = nullptr;
+    size_t size = 0;
+    const ArchiveEntry* pEntry = nullptr;
+    bool bOpened = Open(archive, corruptPath, data);
+    pEntry = bOpened ? archive.Find("packed.bin") : nullptr;
+    bOk = Report("wrong LZ4 size fails in GetData", pEntry && !archive.GetData(*pEntry, scratch, pData, size)) && bOk;
+    archive.Close();
+
+    data = original;
+    Set<uint32_t>(data, HEADER_ENTRY_COUNT, 1000);
+    bOk = Report("entry count past the TOC refused", !Open(archive, corruptPath, data)) && bOk;
+
+    fs::remove(corruptPath);
+    return bOk;
+}
+
+int main() {
+    std::vector<uint8_t> stored(STORED_BYTES);
+    uint32_t seed = 99;
+    for (uint8_t& value : stored) {
+        seed = seed * 1664525u + 1013904223u;
+        value = (uint8_t)(seed >> 24);
+    }
+    std::vector<uint8_t> packed(PACKED_BYTES);
+    for (size_t i = 0; i < packed.size(); i++) {
+        packed[i] = (uint8_t)(i / 64);
+    }
+
+    fs::path path = fs::temp_directory_path() / "ArchiveCheck.apak";
+    AssetArchiveWriter writer;
+    writer.AddData("stored.bin", stored.data(), stored.size());
+    writer.AddData("packed.bin", packed.data(), packed.size());
+    std::vector<uint8_t> original;
+    if (!writer.Save(path.string()) || !ReadFile(path, original)) {
+        printf("Cannot write %s\nFAILED\n", path.string().c_str());
+        return 1;
+    }
+
+    bool bOk = CheckRoundTrip(path, stored, packed);
+    bOk = CheckCorruptSizes(path, original) && bOk;
+    fs::remove(path);
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,308 @@
+// AssetLoader checks and startup time, on the headless null backend.
+//
+//   AssetLoaderBench [images] [workers]
+//
+// Packs generated TGA sprites into a temporary archive and loads them the
+// way the engine does. The checks follow a sprite from LoadSprite, drawn as
+// the placeholder, through the workers and WaitAll to DECODED, and through
+// Update to RESIDENT with its own texture; Unload while an asset is still
+// queued and once it is decoded, with textures released only by the next
+// Update; and a stress run that loads and unloads on one thread while
+// another calls Update, as the main and render threads do, after which the
+// pending count, atlas regions and live textures must all balance. Each
+// prints ok or FAILED. The benchmark times startup over the whole archive:
+// until every LoadSprite has returned and placeholders can be drawn, until
+// every image is decoded, and until every sprite is resident.
+#include "../include/AssetLoader.h"
+#include "../include/AssetArchive.h"
+#include "../include/NullRenderBackend.h"
+#include "../include/Renderer.h"
+#include "../include/TextureAtlas.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static const uint32_t MIN_IMAGE_SIZE = 16;
+static const uint32_t MAX_IMAGE_SIZE = 96;
+
+static uint32_t g_Random = 99;
+static uint32_t RandomInt() {
+    g_Random = g_Random * 1664525u + 1013904223u;
+    return g_Random >> 8;
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Uncompressed 32-bit TGA, top-left origin
+static void EncodeTGA(uint32_t width, uint32_t height, uint32_t seed, std::vector<uint8_t>& out) {
+    out.assign(18, 0);
+    out[2] = 2;
+    out[12] = (uint8_t)width;
+    out[13] = (uint8_t)(width >> 8);
+    out[14] = (uint8_t)height;
+    out[15] = (uint8_t)(height >> 8);
+    out[16] = 32;
+    out[17] = 0x28;
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t shade = (uint8_t)((x * 4 + y * 2 + seed) & 0xFF);
+            out.push_back(shade);
+            out.push_back((uint8_t)(seed * 37));
+            out.push_back((uint8_t)(255 - shade));
+            out.push_back(255);
+        }
+    }
+}
+
+struct Library {
+    std::vector<std::wstring> names;
+    std::vector<uint32_t> widths;
+    std::vector<uint32_t> heights;
+    AssetArchive archive;
+};
+
+static bool BuildLibrary(const fs::path& path, uint32_t count, Library& library) {
+    AssetArchiveWriter writer;
+    std::vector<uint8_t> tga;
+    for (uint32_t i = 0; i < count; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "sprites/%04u.tga", i);
+        uint32_t width = MIN_IMAGE_SIZE + RandomInt() % (MAX_IMAGE_SIZE - MIN_IMAGE_SIZE + 1);
+        uint32_t height = MIN_IMAGE_SIZE + RandomInt() % (MAX_IMAGE_SIZE - MIN_IMAGE_SIZE + 1);
+        EncodeTGA(width, height, i, tga);
+        writer.AddData(name, tga.data(), tga.size());
+
+        library.names.push_back(fs::u8path(name).wstring());
+        library.widths.push_back(width);
+        library.heights.push_back(height);
+    }
+    return writer.Save(path.string()) && library.archive.Open(path.wstring());
+}
+
+// Renderer and loader over the null backend; the atlas is optional
+struct Fixture {
+    NullRenderBackend* pBackend;
+    std::unique_ptr<Renderer> pRenderer;
+    std::unique_ptr<TextureAtlas> pAtlas;
+    std::unique_ptr<AssetLoader> pLoader;
+
+    Fixture(const Library& library, bool bAtlas, uint32_t workers = 2) {
+        pBackend = new NullRenderBackend();
+        pRenderer.reset(new Renderer(std::unique_ptr<RenderBackend>(pBackend)));
+        pRenderer->Initialize();
+        if (bAtlas) {
+            pAtlas.reset(new TextureAtlas(pBackend, 1024, 4));
+        }
+        pLoader.reset(new AssetLoader(pRenderer.get(), pAtlas.get(), workers));
+        pLoader->SetArchive(&library.archive);
+    }
+
+    // Update until nothing is left to finalize or release
+    void Drain() {
+        pLoader->WaitAll();
+        while (pLoader->Update() > 0) {
+        }
+    }
+};
+
+static bool IsState(const std::vector<AssetHandle>& assets, AssetState state) {
+    for (const AssetHandle& asset : assets) {
+        if (asset->GetState() != state) return false;
+    }
+    return true;
+}
+
+// Placeholder until Update, then resident with its own texture
+static bool CheckLifecycle(const Library& library) {
+    Fixture fixture(library, false);
+    AssetLoader& loader = *fixture.pLoader;
+    bool bOk = loader.Initialize() && loader.GetPlaceholderTexture() != RenderBackend::WHITE_TEXTURE;
+    const uint32_t count = 8;
+
+    std::vector<AssetHandle> assets;
+    for (uint32_t i = 0; i < count; i++) {
+        assets.push_back(loader.LoadSprite(library.names[i]));
+    }
+    bOk = bOk && loader.LoadSprite(library.names[0]) == assets[0] && loader.GetPendingCount() == count;
+    for (const AssetHandle& asset : assets) {
+        bOk = bOk && asset->GetSprite()->IsPending() && !asset->IsResident();
+    }
+    bOk = Report("load shows the placeholder", bOk);
+
+    loader.WaitAll();
+    bool bDecoded = IsState(assets, AssetState::DECODED) && loader.GetPendingCount() == count &&
+                    fixture.pBackend->GetTextureCount() == 1;
+    bOk = Report("WaitAll decodes without uploading", bDecoded) && bOk;
+
+    // A budget of one byte still finishes one asset per call
+    bool bResident = loader.Update(1) == 1 && loader.Update() == count - 1 && loader.GetPendingCount() == 0 &&
+                     IsState(assets, AssetState::RESIDENT) && fixture.pBackend->GetTextureCount() == 1 + count;
+    for (uint32_t i = 0; i < count; i++) {
+        const Sprite* pSprite = assets[i]->GetSprite();
+        bResident = bResident && !pSprite->IsPending() && pSprite->GetTextureId() != RenderBackend::WHITE_TEXTURE &&
+                    pSprite->GetWidth() == (float)library.widths[i] && pSprite->GetHeight() == (float)library.heights[i];
+    }
+    bOk = Report("Update makes sprites resident", bResident) && bOk;
+
+    AssetHandle missing = loader.LoadSprite(L"sprites/missing.tga");
+    fixture.Drain();
+    bOk = Report("missing file fails", missing->IsFailed() && loader.GetPendingCount() == 0) && bOk;
+    return bOk;
+}
+
+static bool CheckUnloadQueued(const Library& library) {
+    Fixture fixture(library, false);
+    AssetLoader& loader = *fixture.pLoader;
+
+    // No workers yet, so everything is still queued
+    AssetHandle kept = loader.LoadSprite(library.names[0]);
+    AssetHandle dropped = loader.LoadSprite(library.names[1]);
+    loader.Unload(dropped);
+    bool bOk = loader.GetPendingCount() == 1 && loader.Initialize();
+
+    fixture.Drain();
+    bOk = bOk && kept->IsResident() && !dropped->IsResident() && loader.GetPendingCount() == 0 &&
+          fixture.pBackend->GetTextureCount() == 2;
+    return Report("unload while queued", bOk);
+}
+
+static bool CheckUnloadDecoded(const Library& library) {
+    Fixture fixture(library, false);
+    AssetLoader& loader = *fixture.pLoader;
+    bool bOk = loader.Initialize();
+
+    AssetHandle kept = loader.LoadSprite(library.names[0]);
+    AssetHandle dropped = loader.LoadSprite(library.names[1]);
+    loader.WaitAll();
+    bOk = bOk && dropped->GetState() == AssetState::DECODED;
+    loader.Unload(dropped);
+    bOk = bOk && loader.GetPendingCount() == 1;
+
+    bOk = bOk && loader.Update() == 1 && kept->IsResident() && !dropped->IsResident() &&
+          loader.GetPendingCount() == 0 && fixture.pBackend->GetTextureCount() == 2;
+    bOk = Report("unload once decoded", bOk) && bOk;
+
+    // The texture outlives Unload until the next Update
+    loader.Unload(kept);
+    bool bReleased = fixture.pBackend->GetTextureCount() == 2;
+    loader.Update();
+    bReleased = bReleased && fixture.pBackend->GetTextureCount() == 1 && kept->GetSprite()->IsPending();
+    return Report("unload releases on the next Update", bReleased) && bOk;
+}
+
+// Loads and unloads on this thread while another thread runs Update
+static bool CheckUnloadRace(const Library& library, uint32_t rounds) {
+    Fixture fixture(library, true, 3);
+    AssetLoader& loader = *fixture.pLoader;
+    bool bOk = loader.Initialize();
+
+    const uint32_t count = (uint32_t)std::min<size_t>(library.names.size(), 48);
+    std::atomic<bool> bStop(false);
+    std::thread renderThread([&]() {
+        while (!bStop.load(std::memory_order_relaxed)) {
+            loader.Update();
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<AssetHandle> held(count);
+    uint32_t worstPending = 0;
+    for (uint32_t round = 0; round < rounds; round++) {
+        uint32_t i = RandomInt() % count;
+        if (held[i]) {
+            loader.Unload(held[i]);
+            held[i].reset();
+        } else {
+            held[i] = loader.LoadSprite(library.names[i]);
+        }
+        worstPending = std::max(worstPending, loader.GetPendingCount());
+        if (round % 64 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    bStop.store(true);
+    renderThread.join();
+    fixture.Drain();
+
+    uint32_t resident = 0;
+    for (const AssetHandle& asset : held) {
+        resident += asset && asset->IsResident();
+        bOk = bOk && (!asset || asset->IsResident());
+    }
+    bOk = bOk && worstPending <= count && loader.GetPendingCount() == 0 &&
+          fixture.pAtlas->GetRegionCount() == resident &&
+          fixture.pBackend->GetTextureCount() == 1 + fixture.pAtlas->GetPageCount();
+    return Report("load and unload against a render thread", bOk);
+}
+
+static void RunStartup(const Library& library, uint32_t workers) {
+    Fixture fixture(library, true, workers);
+    AssetLoader& loader = *fixture.pLoader;
+
+    auto start = std::chrono::steady_clock::now();
+    loader.Initialize();
+    std::vector<AssetHandle> assets;
+    for (const std::wstring& name : library.names) {
+        assets.push_back(loader.LoadSprite(name));
+    }
+    double queuedMs = ElapsedMs(start);
+
+    loader.WaitAll();
+    double decodedMs = ElapsedMs(start);
+
+    // One Update per frame, as the render thread does
+    uint32_t frames = 0;
+    while (loader.GetPendingCount() > 0) {
+        loader.Update();
+        frames++;
+    }
+    double residentMs = ElapsedMs(start);
+
+    printf("\n%u images, %u workers, atlas of %u pages\n", (unsigned)assets.size(), loader.GetWorkerCount(),
+           fixture.pAtlas->GetPageCount());
+    printf("placeholders drawable  %8.2f ms\n", queuedMs);
+    printf("all decoded            %8.2f ms\n", decodedMs);
+    printf("all resident           %8.2f ms over %u updates (target under 1000 ms)\n", residentMs, frames);
+}
+
+int main(int argc, char** argv) {
+    uint32_t imageCount = argc >= 2 ? (uint32_t)std::max(8, atoi(argv[1])) : 512;
+    uint32_t workers = argc >= 3 ? (uint32_t)atoi(argv[2]) : 0;
+
+    fs::path path = fs::temp_directory_path() / "AssetLoaderBench.apak";
+    Library library;
+    if (!BuildLibrary(path, imageCount, library)) {
+        printf("Cannot write %s\nFAILED\n", path.string().c_str());
+        return 1;
+    }
+
+    bool bOk = CheckLifecycle(library);
+    bOk = CheckUnloadQueued(library) && bOk;
+    bOk = CheckUnloadDecoded(library) && bOk;
+    bOk = CheckUnloadRace(library, 20000) && bOk;
+
+    RunStartup(library, workers);
+    library.archive.Close();
+    fs::remove(path);
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+// Atlas packer checks and packing rate.
+//
+//   AtlasBench [page size] [rounds]
+//
+// The checks shadow every placement AtlasPacker makes: under random
+// insertion and eviction no rectangle leaves the page or overlaps another
+// live one and the used area matches, a freed rectangle is handed out
+// again, neighbours freed one by one merge, and emptying the page frees all
+// of it. A TextureAtlas is filled
+// with distinct images, baked with Save and read back with Load; regions,
+// page pixels and padding must survive the round trip, and the loaded atlas
+// must accept further insertions without overlapping baked regions. Each
+// prints ok or FAILED. The benchmark then reports insertions per second
+// filling an empty page with sprite-sized rectangles, and evict/insert
+// pairs per second on a full page with the size of the free list after.
+#include "../include/AtlasPacker.h"
+#include "../include/TextureAtlas.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+using std::min;
+using std::max;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Random {
+    uint32_t state;
+
+    explicit Random(uint32_t seed) : state(seed) {}
+
+    uint32_t Next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    uint32_t Range(uint32_t lo, uint32_t hi) { return lo + Next() % (hi - lo + 1); }
+};
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+static bool Overlaps(const AtlasRect& a, const AtlasRect& b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width &&
+           a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// A new placement must lie inside the page and clear of every live rectangle
+static bool IsValidPlacement(const AtlasPacker& packer, const std::vector<AtlasRect>& live, const AtlasRect& rect,
+                             uint32_t width, uint32_t height) {
+    if (rect.width != width || rect.height != height ||
+        rect.x + rect.width > packer.GetWidth() || rect.y + rect.height > packer.GetHeight()) {
+        return false;
+    }
+    for (const AtlasRect& other : live) {
+        if (Overlaps(rect, other)) return false;
+    }
+    return true;
+}
+
+static uint64_t Area(const std::vector<AtlasRect>& live) {
+    uint64_t area = 0;
+    for (const AtlasRect& rect : live) {
+        area += (uint64_t)rect.width * rect.height;
+    }
+    return area;
+}
+
+static bool CheckRandomChurn() {
+    AtlasPacker packer(256, 256);
+    std::vector<AtlasRect> live;
+    Random random(7);
+    bool bOk = true;
+    uint32_t inserted = 0;
+
+    for (int step = 0; step < 10000 && bOk; step++) {
+        if (!live.empty() && random.Next() % 3 == 0) {
+            size_t victim = random.Next() % live.size();
+            packer.Free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        } else {
+            uint32_t width = random.Range(1, 32);
+            uint32_t height = random.Range(1, 32);
+            AtlasRect rect;
+            if (packer.Insert(width, height, rect)) {
+                bOk = IsValidPlacement(packer, live, rect, width, height);
+                live.push_back(rect);
+                inserted++;
+            }
+        }
+        bOk = bOk && packer.GetUsedArea() == Area(live);
+    }
+    bOk = bOk && inserted > 1000;
+    return Report("placements in bounds, never overlapping", bOk);
+}
+
+// A full page of 32x32 tiles: a freed tile is the only space, so the next
+// tile must go exactly there; a freed row takes a row-sized rectangle; and a
+// cleared page fits a full-page rectangle
+static bool CheckReuseAfterEviction() {
+    AtlasPacker packer(256, 256);
+    std::vector<AtlasRect> live;
+    AtlasRect rect;
+    bool bOk = true;
+    while (packer.Insert(32, 32, rect)) {
+        bOk = bOk && IsValidPlacement(packer, live, rect, 32, 32);
+        live.push_back(rect);
+    }
+    bOk = bOk && live.size() == 64 && packer.GetOccupancy() == 1.0f && !packer.Insert(1, 1, rect);
+
+    Random random(11);
+    for (int i = 0; i < 32 && bOk; i++) {
+        size_t victim = random.Next() % live.size();
+        AtlasRect freed = live[victim];
+        packer.Free(freed);
+        live[victim] = live.back();
+        live.pop_back();
+
+        bOk = packer.Insert(32, 32, rect) && rect.x == freed.x && rect.y == freed.y;
+        bOk = bOk && IsValidPlacement(packer, live, rect, 32, 32);
+        live.push_back(rect);
+        bOk = bOk && !packer.Insert(1, 1, rect);
+    }
+
+    // Neighbouring tiles freed separately merge into one strip
+    for (size_t i = 0; i < live.size();) {
+        if (live[i].y == 0) {
+            packer.Free(live[i]);
+            live[i] = live.back();
+            live.pop_back();
+        } else {
+            i++;
+        }
+    }
+    bOk = bOk && packer.Insert(256, 32, rect) && rect.x == 0 && rect.y == 0;
+    live.push_back(rect);
+
+    for (const AtlasRect& used : live) {
+        packer.Free(used);
+    }
+    bOk = bOk && packer.GetUsedArea() == 0 && packer.Insert(256, 256, rect) && rect.x == 0 && rect.y == 0;
+    return Report("evicted space is reused", bOk);
+}
+
+// Reserve only takes free space, as Load relies on
+static bool CheckReserve() {
+    AtlasPacker packer(128, 128);
+    bool bOk = packer.Reserve({ 10, 10, 20, 20 });
+    bOk = bOk && !packer.Reserve({ 25, 25, 10, 10 }) && !packer.Reserve({ 120, 0, 16, 16 });
+    bOk = bOk && packer.Reserve({ 30, 10, 20, 20 }) && packer.GetUsedArea() == 800;
+
+    AtlasRect rect;
+    std::vector<AtlasRect> live = { { 10, 10, 20, 20 }, { 30, 10, 20, 20 } };
+    bOk = bOk && packer.Insert(60, 60, rect) && IsValidPlacement(packer, live, rect, 60, 60);
+    return Report("reserve rejects used space", bOk);
+}
+
+// Every pixel of image n is a function of n and its position
+static std::vector<uint8_t> MakeImage(uint32_t index, uint32_t width, uint32_t height) {
+    std::vector<uint8_t> pixels((size_t)width * height * 4);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t* pPixel = &pixels[((size_t)y * width + x) * 4];
+            pPixel[0] = (uint8_t)index;
+            pPixel[1] = (uint8_t)(x * 7 + y);
+            pPixel[2] = (uint8_t)(y * 5 + index * 3);
+            pPixel[3] = (uint8_t)(255 - index);
+        }
+    }
+    return pixels;
+}
+
+// Image pixels in place, and the padding ring extruded from its edges
+static bool HasImage(const TextureAtlas& atlas, const AtlasRegion& region, const std::vector<uint8_t>& pixels) {
+    const uint8_t* pPage = atlas.GetPagePixels(region.page);
+    uint32_t pageSize = atlas.GetPageSize();
+    int padding = (int)TextureAtlas::PADDING;
+    int width = (int)region.rect.width;
+    int height = (int)region.rect.height;
+
+    for (int y = -padding; y < height + padding; y++) {
+        for (int x = -padding; x < width + padding; x++) {
+            int srcX = min(max(x, 0), width - 1);
+            int srcY = min(max(y, 0), height - 1);
+            const uint8_t* pSrc = &pixels[((size_t)srcY * width + srcX) * 4];
+            const uint8_t* pDst = pPage + (((size_t)(region.rect.y + y)) * pageSize + (region.rect.x + x)) * 4;
+            if (memcmp(pSrc, pDst, 4) != 0) return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckBakeRoundTrip() {
+    const uint32_t pageSize = 256;
+    TextureAtlas atlas(nullptr, pageSize, 4);
+    std::vector<std::vector<uint8_t>> images;
+    std::vector<std::string> names;
+    Random random(23);
+    bool bOk = true;
+
+    // Enough images to spill onto a second page
+    for (uint32_t i = 0; i < 120 && bOk; i++) {
+        uint32_t width = random.Range(4, 40);
+        uint32_t height = random.Range(4, 40);
+        images.push_back(MakeImage(i, width, height));
+        names.push_back("sprite_" + std::to_string(i));
+        bOk = atlas.Insert(names.back(), width, height, images.back().data());
+    }
+    bOk = bOk && atlas.GetPageCount() > 1;
+
+    // Evict a few so the baked packer state has holes
+    for (uint32_t i = 0; i < 120 && bOk; i += 10) {
+        bOk = atlas.Evict(names[i]);
+    }
+
+    const char* path = "AtlasBench.atlas";
+    bOk = bOk && atlas.Save(path);
+    TextureAtlas loaded(nullptr, 16, 4);
+    bOk = bOk && loaded.Load(path);
+    remove(path);
+
+    bOk = bOk && loaded.GetPageSize() == pageSize && loaded.GetPageCount() == atlas.GetPageCount();
+    bOk = bOk && loaded.GetRegionCount() == atlas.GetRegionCount() && loaded.GetRegionCount() == 108;
+    for (uint32_t page = 0; page < atlas.GetPageCount() && bOk; page++) {
+        bOk = memcmp(atlas.GetPagePixels(page), loaded.GetPagePixels(page), (size_t)pageSize * pageSize * 4) == 0;
+    }
+    for (uint32_t i = 0; i < names.size() && bOk; i++) {
+        const AtlasRegion* pOriginal = atlas.Find(names[i]);
+        const AtlasRegion* pLoaded = loaded.Find(names[i]);
+        if (i % 10 == 0) {
+            bOk = !pOriginal && !pLoaded;
+            continue;
+        }
+        bOk = pOriginal && pLoaded && pLoaded->page == pOriginal->page &&
+              memcmp(&pLoaded->rect, &pOriginal->rect, sizeof(AtlasRect)) == 0 &&
+              pLoaded->u0 == pOriginal->u0 && pLoaded->v1 == pOriginal->v1 &&
+              HasImage(loaded, *pLoaded, images[i]);
+    }
+
+    // The loaded packer knows the baked regions, so new images avoid them
+    for (uint32_t i = 0; i < 12 && bOk; i++) {
+        std::string name = "extra_" + std::to_string(i);
+        std::vector<uint8_t> image = MakeImage(200 + i, 24, 24);
+        bOk = loaded.Insert(name, 24, 24, image.data());
+        const AtlasRegion* pRegion = loaded.Find(name);
+        bOk = bOk && pRegion && HasImage(loaded, *pRegion, image);
+    }
+    for (uint32_t i = 0; i < names.size() && bOk; i++) {
+        if (i % 10 != 0) {
+            bOk = HasImage(loaded, *loaded.Find(names[i]), images[i]);
+        }
+    }
+    return Report("bake and load round trip", bOk);
+}
+
+static void BenchFill(uint32_t pageSize, int rounds) {
+    uint64_t inserts = 0;
+    double seconds = 0.0;
+    float occupancy = 0.0f;
+    for (int round = 0; round < rounds; round++) {
+        AtlasPacker packer(pageSize, pageSize);
+        Random random(1000 + round);
+        AtlasRect rect;
+        uint32_t failures = 0;
+        auto start = Clock::now();
+        while (failures < 64) {
+            if (packer.Insert(random.Range(8, 64), random.Range(8, 64), rect)) {
+                inserts++;
+            } else {
+                failures++;
+            }
+        }
+        seconds += std::chrono::duration<double>(Clock::now() - start).count();
+        occupancy += packer.GetOccupancy();
+    }
+    printf("fill %ux%u, 8..64 px:   %10.0f inserts/s, %.1f%% occupancy\n", pageSize, pageSize,
+           inserts / seconds, 100.0f * occupancy / rounds);
+}
+
+static void BenchChurn(uint32_t pageSize, int rounds) {
+    AtlasPacker packer(pageSize, pageSize);
+    std::vector<AtlasRect> live;
+    Random random(31);
+    AtlasRect rect;
+    uint32_t failures = 0;
+    while (failures < 64) {
+        if (packer.Insert(random.Range(8, 64), random.Range(8, 64), rect)) {
+            live.push_back(rect);
+        } else {
+            failures++;
+        }
+    }
+
+    uint64_t pairs = 0;
+    uint64_t misses = 0;
+    const uint64_t total = (uint64_t)rounds * 2000;
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < total; i++) {
+        size_t victim = random.Next() % live.size();
+        packer.Free(live[victim]);
+        if (packer.Insert(random.Range(8, 64), random.Range(8, 64), rect)) {
+            live[victim] = rect;
+        } else {
+            live[victim] = live.back();
+            live.pop_back();
+            misses++;
+        }
+        pairs++;
+        if (live.empty()) break;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    printf("churn on a full page:     %10.0f evict+insert/s, %.1f%% misses, %.1f%% occupancy, %u free rects\n",
+           pairs / seconds, 100.0 * misses / pairs, 100.0f * packer.GetOccupancy(), packer.GetFreeRectCount());
+}
+
+int main(int argc, char** argv) {
+    uint32_t pageSize = argc > 1 ? (uint32_t)max(64, atoi(argv[1])) : TextureAtlas::DEFAULT_PAGE_SIZE;
+    int rounds = argc > 2 ? max(1, atoi(argv[2])) : 3;
+
+    bool bOk = CheckRandomChurn();
+    bOk = CheckReuseAfterEviction() && bOk;
+    bOk = CheckReserve() && bOk;
+    bOk = CheckBakeRoundTrip() && bOk;
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    printf("\n");
+    BenchFill(pageSize, rounds);
+    BenchChurn(pageSize, rounds);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+// Sort-key batching checks on the headless null backend.
+//
+//   BatchSortCheck
+//
+// Submits keyed primitives through Renderer and records what reaches the
+// backend: the sorted indices and the draw runs of each Submit. Checks that
+// primitives sharing a key merge into one run in submission order,
+// interleaved textures collapse to one draw each, blend and texture
+// switches are counted as state changes and ordered blend-major, layer and
+// depth order primitives without splitting runs, instanced draws count a
+// shader switch, and the counts carry across flushes and reset at
+// BeginFrame. Each prints ok or FAILED.
+#include "../include/NullRenderBackend.h"
+#include "../include/Renderer.h"
+#include "../include/SortKey.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+// Keeps the last batch that reached the backend
+class RecordingBackend : public NullRenderBackend {
+public:
+    void Submit(const uint16_t* pIndices, uint32_t indexCount,
+                const DrawRun* pRuns, uint32_t runCount) override {
+        m_Indices.assign(pIndices, pIndices + indexCount);
+        m_Runs.assign(pRuns, pRuns + runCount);
+        NullRenderBackend::Submit(pIndices, indexCount, pRuns, runCount);
+    }
+
+    // Submission order of the quads in the last batch, as drawn
+    std::vector<uint32_t> GetQuadOrder() const {
+        std::vector<uint32_t> order;
+        for (size_t i = 0; i < m_Indices.size(); i += 6) {
+            order.push_back(m_Indices[i] / 4);
+        }
+        return order;
+    }
+
+    const std::vector<DrawRun>& GetRuns() const { return m_Runs; }
+
+private:
+    std::vector<uint16_t> m_Indices;
+    std::vector<DrawRun> m_Runs;
+};
+
+struct Fixture {
+    RecordingBackend* pBackend;
+    std::unique_ptr<Renderer> pRenderer;
+    uint32_t textureA;
+    uint32_t textureB;
+
+    Fixture() {
+        pBackend = new RecordingBackend();
+        pRenderer.reset(new Renderer(std::unique_ptr<RenderBackend>(pBackend)));
+        pRenderer->Initialize();
+        const uint8_t pixel[4] = { 255, 255, 255, 255 };
+        textureA = pRenderer->CreateTexture(1, 1, pixel);
+        textureB = pRenderer->CreateTexture(1, 1, pixel);
+        pRenderer->BeginFrame();
+    }
+};
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Quad n of a batch starts at vertex 4n, so sorted indices identify it
+static void DrawQuad(Renderer& renderer, uint32_t textureId) {
+    GeometrySpan span;
+    if (!renderer.Append(4, 6, textureId, span)) return;
+
+    Vertex* pVertices = span.Vertices<Vertex>();
+    for (int i = 0; i < 4; i++) {
+        pVertices[i] = { (float)(i & 1), (float)(i >> 1), 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+    }
+    const uint32_t quad[6] = { 0, 1, 2, 1, 3, 2 };
+    for (int i = 0; i < 6; i++) {
+        span.pIndices[i] = (uint16_t)(span.baseVertex + quad[i]);
+    }
+}
+
+static bool HasStats(const Renderer& renderer, uint32_t drawCalls, uint32_t stateChanges) {
+    const RenderStats& stats = renderer.GetStats();
+    return stats.drawCalls == drawCalls && stats.stateChanges == stateChanges;
+}
+
+// One key throughout: one run, quads in the order they were submitted
+static bool CheckEqualKeysMerge() {
+    Fixture fixture;
+    Renderer& renderer = *fixture.pRenderer;
+    for (int i = 0; i < 100; i++) {
+        DrawQuad(renderer, fixture.textureA);
+    }
+    renderer.Flush();
+
+    std::vector<uint32_t> order = fixture.pBackend->GetQuadOrder();
+    bool bOk = order.size() == 100 && fixture.pBackend->GetRuns().size() == 1;
+    for (uint32_t i = 0; i < order.size() && bOk; i++) {
+        bOk = order[i] == i;
+    }
+    bOk = bOk && HasStats(renderer, 1, 0) && fixture.pBackend->GetDrawCount() == 1;
+    return Report("equal keys merge into one run", bOk);
+}
+
+// Alternating textures sort into two runs; within each the sort is stable
+static bool CheckInterleavedTextures() {
+    Fixture fixture;
+    Renderer& renderer = *fixture.pRenderer;
+    for (int i = 0; i < 100; i++) {
+        DrawQuad(renderer, (i & 1) ? fixture.textureB : fixture.textureA);
+    }
+    renderer.Flush();
+
+    const std::vector<DrawRun>& runs = fixture.pBackend->GetRuns();
+    std::vector<uint32_t> order = fixture.pBackend->GetQuadOrder();
+    bool bOk = runs.size() == 2 && order.size() == 100;
+    bOk = bOk && SortKey::GetTexture(runs[0].sortKey) == fixture.textureA && runs[0].indexCount == 300;
+    bOk = bOk && SortKey::GetTexture(runs[1].sortKey) == fixture.textureB && runs[1].indexCount == 300;
+    for (uint32_t i = 0; i < 50 && bOk; i++) {
+        bOk = order[i] == i * 2 && order[50 + i] == i * 2 + 1;
+    }
+    bOk = bOk && HasStats(renderer, 2, 1) && fixture.pBackend->GetDrawCount() == 2;
+    return Report("interleaved textures become two draws", bOk);
+}
+
+// Blend mode sorts above texture: ALPHA A, ALPHA B, PREMULTIPLIED A,
+// PREMULTIPLIED B, costing one, two and one state changes
+static bool CheckBlendAndTextureSwitches() {
+    Fixture fixture;
+    Renderer& renderer = *fixture.pRenderer;
+    for (int i = 0; i < 8; i++) {
+        renderer.SetBlendMode((i & 2) ? BlendMode::ALPHA : BlendMode::PREMULTIPLIED);
+        DrawQuad(renderer, (i & 1) ? fixture.textureA : fixture.textureB);
+    }
+    renderer.Flush();
+
+    const std::vector<DrawRun>& runs = fixture.pBackend->GetRuns();
+    bool bOk = runs.size() == 4;
+    const BlendMode blends[4] = { BlendMode::ALPHA, BlendMode::ALPHA, BlendMode::PREMULTIPLIED, BlendMode::PREMULTIPLIED };
+    const uint32_t textures[4] = { fixture.textureA, fixture.textureB, fixture.textureA, fixture.textureB };
+    for (size_t i = 0; i < runs.size() && bOk; i++) {
+        bOk = SortKey::GetBlendMode(runs[i].sortKey) == (uint32_t)blends[i];
+        bOk = bOk && SortKey::GetTexture(runs[i].sortKey) == textures[i] && runs[i].indexCount == 12;
+    }
+    bOk = bOk && HasStats(renderer, 4, 4);
+    return Report("blend and texture switches counted", bOk);
+}
+
+// Layer and depth reorder primitives but do not break a run
+static bool CheckLayerAndDepthOrder() {
+    Fixture fixture;
+    Renderer& renderer = *fixture.pRenderer;
+    renderer.SetLayer(1);
+    renderer.SetDepth(0.25f);
+    DrawQuad(renderer, fixture.textureA);   // 0
+    renderer.SetLayer(0);
+    renderer.SetDepth(0.75f);
+    DrawQuad(renderer, fixture.textureA);   // 1
+    renderer.SetDepth(0.5f);
+    DrawQuad(renderer, fixture.textureA);   // 2
+    renderer.SetDepth(0.75f);
+    DrawQuad(renderer, fixture.textureA);   // 3, ties with 1
+    renderer.Flush();
+
+    std::vector<uint32_t> order = fixture.pBackend->GetQuadOrder();
+    const uint32_t expected[4] = { 2, 1, 3, 0 };
+    bool bOk = order.size() == 4 && fixture.pBackend->GetRuns().size() == 1;
+    for (uint32_t i = 0; i < order.size() && bOk; i++) {
+        bOk = order[i] == expected[i];
+    }
+    bOk = bOk && HasStats(renderer, 1, 0);
+    return Report("layer and depth order within one run", bOk);
+}
+
+// Counts continue from one flush to the next within a frame, instancing is
+// a shader switch, and BeginFrame starts again from zero
+static bool CheckAcrossFlushes() {
+    Fixture fixture;
+    Renderer& renderer = *fixture.pRenderer;
+    DrawQuad(renderer, fixture.textureA);
+    renderer.Flush();
+    DrawQuad(renderer, fixture.textureB);
+    renderer.Flush();
+    bool bOk = HasStats(renderer, 2, 1);
+
+    SpriteInstance* pInstances = nullptr;
+    bOk = bOk && renderer.AppendInstances(3, fixture.textureB, pInstances);
+    renderer.Flush();
+    bOk = bOk && HasStats(renderer, 3, 2) && fixture.pBackend->GetInstanceCount() == 3;
+
+    renderer.BeginFrame();
+    bOk = bOk && HasStats(renderer, 0, 0);
+    DrawQuad(renderer, fixture.textureA);
+    renderer.Flush();
+    bOk = bOk && HasStats(renderer, 1, 0) && fixture.pBackend->GetDrawCount() == 1;
+    return Report("state changes carry across flushes", bOk);
+}
+
+int main() {
+    bool bOk = CheckEqualKeysMerge();
+    bOk = CheckInterleavedTextures() && bOk;
+    bOk = CheckBlendAndTextureSwitches() && bOk;
+    bOk = CheckLayerAndDepthOrder() && bOk;
+    bOk = CheckAcrossFlushes() && bOk;
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,181 @@
+// Dab rasteriser throughput on the CPU canvas.
+//
+//   BrushBench [canvas size] [seconds per case]
+//
+// Stamps dabs at pseudo-random positions for each radius and hardness and
+// reports dabs per second and covered pixels per second, then times stroke
+// interpolation alone on long, densely sampled strokes, and finally strokes
+// with each brush kernel: round, textured, smudge and eraser.
+#include "../include/Canvas.h"
+#include "../include/DabRasterizer.h"
+#include "../include/PressureBrush.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+
+// Spiral sampled every pointStep pixels with pressure oscillating along it
+static void BenchInterpolation(float spacing, float pointStep) {
+    const uint32_t pointCount = 200000;
+
+    PressureBrush brush("bench", 2.0f, 40.0f);
+    brush.SetSpacing(spacing);
+
+    std::vector<Dab> dabs;
+    dabs.reserve(4096);
+    uint64_t dabCount = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    float angle = 0.0f;
+    for (uint32_t i = 0; i < pointCount; i++) {
+        float radius = 50.0f + angle * 4.0f;
+        float x = 2048.0f + radius * std::cos(angle);
+        float y = 2048.0f + radius * std::sin(angle);
+        float pressure = 0.5f + 0.5f * std::sin((float)i * 0.01f);
+        angle += pointStep / radius;
+
+        // Batch per input point, as ApplyStroke does
+        dabs.clear();
+        brush.EmitDabs(x, y, pressure, 0.0f, 0.0f, 0.0f, 1.0f, dabs);
+        dabCount += dabs.size();
+    }
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    printf("%7.2f  %9.2f  %8u  %9llu  %10.0f\n", spacing, pointStep, pointCount,
+           (unsigned long long)dabCount, (double)dabCount / elapsedMs);
+}
+
+// Grain tip: a soft disc broken up by noise, as a scanned tip would be
+static std::vector<uint8_t> MakeGrainTip(uint32_t size) {
+    std::vector<uint8_t> pixels((size_t)size * size * 4);
+    uint32_t seed = 777;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            float dx = ((float)x + 0.5f) / (float)size * 2.0f - 1.0f;
+            float dy = ((float)y + 0.5f) / (float)size * 2.0f - 1.0f;
+            float disc = std::fmax(0.0f, 1.0f - std::sqrt(dx * dx + dy * dy));
+            seed = seed * 1664525u + 1013904223u;
+            float grain = 0.5f + 0.5f * (float)(seed >> 24) / 255.0f;
+
+            uint8_t* pPixel = &pixels[((size_t)y * size + x) * 4];
+            pPixel[0] = pPixel[1] = pPixel[2] = 0;
+            pPixel[3] = (uint8_t)(std::fmin(1.0f, disc * 2.0f) * grain * 255.0f);
+        }
+    }
+    return pixels;
+}
+
+// Stroke the spiral with one brush kernel; the pen turns as it goes so the
+// textured tip is seen at every angle
+static void BenchKernel(const char* pName, BrushType type, float size, double seconds) {
+    const uint32_t tipSize = 256;
+    std::vector<uint8_t> tip = MakeGrainTip(tipSize);
+
+    Canvas canvas(4096, 4096);
+    PressureBrush brush(pName, size * 0.5f, size);
+    brush.SetType(type);
+    brush.SetTipTexture(tip.data(), tipSize, tipSize);
+
+    // Something to smudge and erase
+    if (type == BrushType::SMUDGE || type == BrushType::ERASER) {
+        Dab dab = { 2048.0f, 2048.0f, 1200.0f, 0.5f, 1.0f, 0.8f, 0.3f, 0.1f, 1.0f };
+        RasterizeDab(canvas, dab);
+    }
+
+    std::vector<Dab> dabs;
+    uint64_t dabCount = 0;
+    float angle = 0.0f;
+    uint32_t i = 0;
+    auto start = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    while (elapsed < seconds) {
+        for (int j = 0; j < 64; j++, i++) {
+            float radius = 50.0f + std::fmod(angle, 250.0f) * 4.0f;
+            float x = 2048.0f + radius * std::cos(angle);
+            float y = 2048.0f + radius * std::sin(angle);
+            angle += 2.0f / radius;
+            brush.SetTilt(std::cos(angle * 3.0f), std::sin(angle * 3.0f));
+
+            dabs.clear();
+            brush.EmitDabs(x, y, 0.5f + 0.5f * std::sin((float)i * 0.01f), 0.2f, 0.4f, 0.8f, 1.0f, dabs);
+            brush.StampDabs(canvas, dabs.data(), dabs.size());
+            dabCount += dabs.size();
+        }
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const BrushTip& cache = brush.GetTip();
+    uint64_t lookups = cache.GetHitCount() + cache.GetMissCount();
+    printf("%-8s  %5.0f  %10.0f  %7.1f%%  %7u  %8.2f\n", pName, size, (double)dabCount / elapsed,
+           lookups ? 100.0 * (double)cache.GetHitCount() / (double)lookups : 0.0,
+           (unsigned)cache.GetCachedMaskCount(), (double)cache.GetCacheBytes() / (1024.0 * 1024.0));
+}
+
+int main(int argc, char** argv) {
+    uint32_t canvasSize = argc >= 2 ? (uint32_t)atoi(argv[1]) : 4096;
+    double secondsPerCase = argc >= 3 ? atof(argv[2]) : 0.5;
+    if (canvasSize < Canvas::TILE_SIZE) canvasSize = Canvas::TILE_SIZE;
+
+    const float radii[] = { 2.0f, 8.0f, 32.0f, 128.0f, 512.0f };
+    const float hardnesses[] = { 0.0f, 0.8f };
+
+    printf("canvas %ux%u\n", canvasSize, canvasSize);
+    printf("radius  hardness      dabs/s     Mpix/s  tiles\n");
+
+    for (float radius : radii) {
+        for (float hardness : hardnesses) {
+            Canvas canvas(canvasSize, canvasSize);
+
+            Dab dab;
+            dab.radius = radius;
+            dab.hardness = hardness;
+            dab.opacity = 0.3f;
+            dab.r = 0.2f;
+            dab.g = 0.4f;
+            dab.b = 0.8f;
+            dab.a = 1.0f;
+
+            // Fixed-seed LCG so every run stamps the same sequence
+            uint32_t seed = 12345;
+            uint64_t dabs = 0;
+            auto start = std::chrono::steady_clock::now();
+            double elapsed = 0.0;
+            while (elapsed < secondsPerCase) {
+                for (int i = 0; i < 64; i++) {
+                    seed = seed * 1664525u + 1013904223u;
+                    dab.x = (float)(seed >> 8) / (float)(1 << 24) * (float)canvasSize;
+                    seed = seed * 1664525u + 1013904223u;
+                    dab.y = (float)(seed >> 8) / (float)(1 << 24) * (float)canvasSize;
+                    RasterizeDab(canvas, dab);
+                }
+                dabs += 64;
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+
+            double dabsPerSecond = (double)dabs / elapsed;
+            double pixelsPerDab = 3.14159265 * (radius + 1.0) * (radius + 1.0);
+            printf("%6.0f  %8.1f  %10.0f  %9.1f  %5u\n", radius, hardness, dabsPerSecond,
+                   dabsPerSecond * pixelsPerDab / 1e6, canvas.GetAllocatedTileCount());
+        }
+    }
+
+    printf("\nstroke interpolation\n");
+    printf("spacing  point step    points       dabs     dabs/ms\n");
+    BenchInterpolation(0.1f, 0.5f);
+    BenchInterpolation(0.1f, 4.0f);
+    BenchInterpolation(0.02f, 0.5f);
+    BenchInterpolation(0.5f, 16.0f);
+
+    printf("\nbrush kernels\n");
+    printf("kernel     size      dabs/s  tip hits    masks  cache MB\n");
+    const float sizes[] = { 16.0f, 64.0f, 256.0f };
+    for (float size : sizes) {
+        BenchKernel("round", BrushType::STANDARD, size, secondsPerCase);
+        BenchKernel("textured", BrushType::TEXTURED, size, secondsPerCase);
+        BenchKernel("smudge", BrushType::SMUDGE, size, secondsPerCase);
+        BenchKernel("eraser", BrushType::ERASER, size, secondsPerCase);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+// Parallel dab stamping across thread counts.
+//
+//   DabScalingBench [max threads] [seconds per case]
+//
+// Paints the same synthetic strokes at several brush sizes with 1 up to
+// max threads (default: every hardware thread) and reports dabs and pixels
+// per second and the speed-up over one thread. Every canvas is hashed and
+// compared with the serial one: parallel stamping must be bit-identical.
+// Each thread count runs twice, on the renderer's own work-stealing pool
+// and as jobs on a JobSystem, as the app stamps.
+#include "../include/Canvas.h"
+#include "../include/PressureBrush.h"
+#include "../include/ParallelDabRenderer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+struct StrokePoint {
+    float x, y, pressure;
+};
+
+// A handful of long wavy strokes across the canvas, sampled every 2 pixels
+// as a 240 Hz pen would be at moderate speed
+static std::vector<std::vector<StrokePoint>> MakeStrokes(uint32_t canvasSize) {
+    std::vector<std::vector<StrokePoint>> strokes;
+    uint32_t seed = 4242;
+    for (int stroke = 0; stroke < 8; stroke++) {
+        seed = seed * 1664525u + 1013904223u;
+        float baseY = (float)canvasSize * (0.1f + 0.8f * (float)(seed >> 8) / 16777216.0f);
+        float amplitude = (float)canvasSize * 0.1f;
+        std::vector<StrokePoint> points;
+        for (float x = (float)canvasSize * 0.05f; x < (float)canvasSize * 0.95f; x += 2.0f) {
+            float u = x / (float)canvasSize;
+            StrokePoint point;
+            point.x = x;
+            point.y = baseY + amplitude * std::sin(u * 12.0f + (float)stroke);
+            point.pressure = 0.6f + 0.4f * std::sin(u * 31.0f);
+            points.push_back(point);
+        }
+        strokes.push_back(points);
+    }
+    return strokes;
+}
+
+static uint64_t HashCanvas(const Canvas& canvas) {
+    uint64_t hash = 14695981039346656037ull;
+    std::vector<uint8_t> row((size_t)canvas.GetWidth() * 4);
+    for (uint32_t y = 0; y < canvas.GetHeight(); y++) {
+        canvas.ReadPixels(0, y, canvas.GetWidth(), 1, row.data(), (uint32_t)row.size());
+        for (uint8_t byte : row) {
+            hash = (hash ^ byte) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+struct CaseResult {
+    double seconds;
+    uint64_t dabs;
+    uint64_t pixels;
+    uint64_t hash;
+};
+
+// Paint every stroke once per pass until the time is up; the hash is of the
+// first pass, so all thread counts paint exactly the same thing
+static CaseResult RunCase(const std::vector<std::vector<StrokePoint>>& strokes, uint32_t canvasSize,
+                          float size, float hardness, uint32_t threads, bool bJobSystem, double seconds) {
+    std::unique_ptr<JobSystem> pJobSystem;
+    std::unique_ptr<ParallelDabRenderer> pRenderer;
+    if (threads > 1 && bJobSystem) {
+        pJobSystem.reset(new JobSystem(threads));
+        pRenderer.reset(new ParallelDabRenderer(pJobSystem.get()));
+    } else if (threads > 1) {
+        pRenderer.reset(new ParallelDabRenderer(threads));
+    }
+
+    PressureBrush brush("bench", size * 0.5f, size);
+    brush.SetHardness(hardness);
+    brush.SetSpacing(0.1f);
+    brush.SetFlow(0.3f);
+    brush.SetRenderer(pRenderer.get());
+
+    CaseResult result = {};
+    std::vector<Dab> dabs;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass == 0 || result.seconds < seconds; pass++) {
+        Canvas canvas(canvasSize, canvasSize);
+        for (const std::vector<StrokePoint>& stroke : strokes) {
+            brush.ResetStroke();
+            for (const StrokePoint& point : stroke) {
+                // One batch per input point, as BrushSystem stamps them
+                dabs.clear();
+                brush.EmitDabs(point.x, point.y, point.pressure, 0.2f, 0.4f, 0.8f, 1.0f, dabs);
+                brush.StampDabs(canvas, dabs.data(), dabs.size());
+                result.dabs += dabs.size();
+                for (const Dab& dab : dabs) {
+                    result.pixels += (uint64_t)(3.14159265f * (dab.radius + 1.0f) * (dab.radius + 1.0f));
+                }
+            }
+        }
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (pass == 0) {
+            result.hash = HashCanvas(canvas);
+            start = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double>(result.seconds));
+        }
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    uint32_t maxThreads = argc >= 2 ? (uint32_t)atoi(argv[1]) : std::thread::hardware_concurrency();
+    double secondsPerCase = argc >= 3 ? atof(argv[2]) : 1.0;
+    if (maxThreads < 1) maxThreads = 1;
+
+    const uint32_t canvasSize = 2048;
+    std::vector<std::vector<StrokePoint>> strokes = MakeStrokes(canvasSize);
+
+    printf("canvas %ux%u, %u hardware threads\n", canvasSize, canvasSize, std::thread::hardware_concurrency());
+    printf("  size  threads  runs on      dabs/s     Mpix/s  speed-up  identical\n");
+
+    const float sizes[] = { 16.0f, 64.0f, 256.0f, 500.0f };
+    bool bAllIdentical = true;
+    for (float size : sizes) {
+        CaseResult serial = {};
+        for (uint32_t threads = 1; threads <= maxThreads; threads = threads < maxThreads ? std::min(threads * 2, maxThreads) : threads + 1) {
+            for (int jobSystem = 0; jobSystem < (threads > 1 ? 2 : 1); jobSystem++) {
+                CaseResult result = RunCase(strokes, canvasSize, size, 0.0f, threads, jobSystem != 0, secondsPerCase);
+                if (threads == 1) {
+                    serial = result;
+                }
+                bool bIdentical = result.hash == serial.hash;
+                bAllIdentical = bAllIdentical && bIdentical;
+
+                double dabsPerSecond = (double)result.dabs / result.seconds;
+                double serialDabsPerSecond = (double)serial.dabs / serial.seconds;
+                printf("%6.0f  %7u  %-7s  %10.0f  %9.1f  %8.2f  %9s\n", size, threads,
+                       threads == 1 ? "serial" : jobSystem ? "jobs" : "pool", dabsPerSecond,
+                       (double)result.pixels / result.seconds / 1e6, dabsPerSecond / serialDabsPerSecond,
+                       bIdentical ? "yes" : "NO");
+            }
+        }
+    }
+    return bAllIdentical ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,555 @@
+// Image decode throughput and pixel kernel checks.
+//
+//   DecodeBench [width] [height] [iterations]
+//
+// Encodes one synthetic photo-like RGBA image as PNG (RGBA and RGB, every
+// row filter, fixed-Huffman deflate with LZ77 matches), TGA (32-bit, 24-bit
+// and 32-bit RLE) and BMP (32-bit and 24-bit). Each must decode back to the
+// source pixels. The checks then compare the bulk pixel kernels, whose SSE2
+// paths take blocks of four pixels, against their scalar tails (called one
+// pixel at a time) and against reference formulas: every colour and alpha
+// pair for premultiplication, and odd and even sizes for the box
+// downsample. Each prints ok or FAILED. The benchmark reports decode
+// throughput per format in MB/s of file read and of RGBA written, and
+// kernel throughput in MB/s of RGBA processed.
+#include "../include/ImageDecoder.h"
+#include "../include/PixelConvert.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+using std::min;
+using std::max;
+
+typedef std::chrono::steady_clock Clock;
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Smooth gradients with a little noise, so the PNG compresses like a
+// photograph or painted sprite rather than flat colour
+static Image MakeSourceImage(uint32_t width, uint32_t height) {
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize((size_t)width * height * 4);
+    uint32_t seed = 12345;
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            seed = seed * 1664525u + 1013904223u;
+            uint32_t noise = (seed >> 24) & 7;
+            uint8_t* pPixel = &image.pixels[((size_t)y * width + x) * 4];
+            pPixel[0] = (uint8_t)(x * 255 / max(1u, width - 1) + noise);
+            pPixel[1] = (uint8_t)(y * 255 / max(1u, height - 1) + noise);
+            pPixel[2] = (uint8_t)(((x + y) * 3) + noise);
+            pPixel[3] = (uint8_t)(((x / 16 + y / 16) & 1) ? 255 : (x * 7 + y) & 0xFF);
+        }
+    }
+    return image;
+}
+
+// ---------------------------------------------------------------------------
+// Encoders
+
+static void PutLE16(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t)value);
+    out.push_back((uint8_t)(value >> 8));
+}
+
+static void PutLE32(std::vector<uint8_t>& out, uint32_t value) {
+    PutLE16(out, value & 0xFFFF);
+    PutLE16(out, value >> 16);
+}
+
+static void PutBE32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : m_Out(out), m_Bits(0), m_Count(0) {}
+
+    void Write(uint32_t value, uint32_t count) {
+        m_Bits |= (uint64_t)value << m_Count;
+        m_Count += count;
+        while (m_Count >= 8) {
+            m_Out.push_back((uint8_t)m_Bits);
+            m_Bits >>= 8;
+            m_Count -= 8;
+        }
+    }
+
+    // Huffman codes are defined most significant bit first
+    void WriteCode(uint32_t code, uint32_t length) {
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        }
+        Write(reversed, length);
+    }
+
+    void Finish() {
+        if (m_Count > 0) {
+            m_Out.push_back((uint8_t)m_Bits);
+        }
+        m_Bits = 0;
+        m_Count = 0;
+    }
+
+private:
+    std::vector<uint8_t>& m_Out;
+    uint64_t m_Bits;
+    uint32_t m_Count;
+};
+
+static const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                          35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                          3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                            8193, 12289, 16385, 24577 };
+static const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+// Fixed literal/length code of RFC 1951 section 3.2.6
+static void WriteSymbol(BitWriter& writer, uint32_t symbol) {
+    if (symbol < 144) {
+        writer.WriteCode(0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        writer.WriteCode(0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        writer.WriteCode(symbol - 256, 7);
+    } else {
+        writer.WriteCode(0xC0 + symbol - 280, 8);
+    }
+}
+
+static void WriteMatch(BitWriter& writer, uint32_t length, uint32_t distance) {
+    int lengthCode = 28;
+    while (LENGTH_BASE[lengthCode] > length) lengthCode--;
+    WriteSymbol(writer, 257 + lengthCode);
+    writer.Write(length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+
+    int distanceCode = 29;
+    while (DISTANCE_BASE[distanceCode] > distance) distanceCode--;
+    writer.WriteCode(distanceCode, 5);
+    writer.Write(distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+}
+
+// zlib stream of one fixed-Huffman block, greedy LZ77 with a hash of the
+// last position of each three-byte prefix
+static std::vector<uint8_t> CompressZlib(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> out = { 0x78, 0x01 };
+    BitWriter writer(out);
+    writer.Write(1, 1);     // BFINAL
+    writer.Write(1, 2);     // Fixed Huffman
+
+    const size_t WINDOW = 32768;
+    const uint32_t HASH_SIZE = 1 << 15;
+    std::vector<int64_t> head(HASH_SIZE, -1);
+    auto hash = [&data](size_t i) {
+        return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (HASH_SIZE - 1);
+    };
+
+    size_t i = 0;
+    while (i < data.size()) {
+        uint32_t bestLength = 0;
+        size_t bestDistance = 0;
+        if (i + 3 <= data.size()) {
+            uint32_t h = hash(i);
+            int64_t candidate = head[h];
+            head[h] = (int64_t)i;
+            if (candidate >= 0 && i - (size_t)candidate <= WINDOW) {
+                size_t maxLength = min((size_t)258, data.size() - i);
+                uint32_t length = 0;
+                while (length < maxLength && data[candidate + length] == data[i + length]) length++;
+                if (length >= 3) {
+                    bestLength = length;
+                    bestDistance = i - (size_t)candidate;
+                }
+            }
+        }
+
+        if (bestLength) {
+            WriteMatch(writer, bestLength, (uint32_t)bestDistance);
+            for (size_t j = i + 1; j < i + bestLength && j + 3 <= data.size(); j++) {
+                head[hash(j)] = (int64_t)j;
+            }
+            i += bestLength;
+        } else {
+            WriteSymbol(writer, data[i]);
+            i++;
+        }
+    }
+    WriteSymbol(writer, 256);
+    writer.Finish();
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    PutBE32(out, (b << 16) | a);
+    return out;
+}
+
+static uint32_t Crc32(const uint8_t* pData, size_t size, uint32_t crc = 0) {
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= pData[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void PutChunk(std::vector<uint8_t>& out, const char* pType, const std::vector<uint8_t>& data) {
+    PutBE32(out, (uint32_t)data.size());
+    size_t start = out.size();
+    out.insert(out.end(), pType, pType + 4);
+    out.insert(out.end(), data.begin(), data.end());
+    PutBE32(out, Crc32(&out[start], out.size() - start));
+}
+
+static uint8_t Paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    return (uint8_t)(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+// 8-bit RGBA or RGB; row y uses filter y % 5 so every unfilter runs
+static std::vector<uint8_t> EncodePNG(const Image& image, bool bAlpha) {
+    const size_t bytesPerPixel = bAlpha ? 4 : 3;
+    const size_t rowBytes = image.width * bytesPerPixel;
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> row(rowBytes), prior(rowBytes, 0);
+    for (uint32_t y = 0; y < image.height; y++) {
+        for (uint32_t x = 0; x < image.width; x++) {
+            memcpy(&row[x * bytesPerPixel], &image.pixels[((size_t)y * image.width + x) * 4], bytesPerPixel);
+        }
+        uint8_t filter = (uint8_t)(y % 5);
+        raw.push_back(filter);
+        for (size_t i = 0; i < rowBytes; i++) {
+            int a = i >= bytesPerPixel ? row[i - bytesPerPixel] : 0;
+            int b = prior[i];
+            int c = i >= bytesPerPixel ? prior[i - bytesPerPixel] : 0;
+            int predictor = filter == 1 ? a : filter == 2 ? b : filter == 3 ? (a + b) / 2 : filter == 4 ? Paeth(a, b, c) : 0;
+            raw.push_back((uint8_t)(row[i] - predictor));
+        }
+        prior.swap(row);
+    }
+
+    std::vector<uint8_t> out = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    std::vector<uint8_t> header;
+    PutBE32(header, image.width);
+    PutBE32(header, image.height);
+    header.push_back(8);
+    header.push_back(bAlpha ? 6 : 2);
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    PutChunk(out, "IHDR", header);
+    PutChunk(out, "IDAT", CompressZlib(raw));
+    PutChunk(out, "IEND", std::vector<uint8_t>());
+    return out;
+}
+
+// Bottom-up BGR(A); RLE packs runs of equal pixels and literal stretches
+static std::vector<uint8_t> EncodeTGA(const Image& image, uint32_t bitsPerPixel, bool bRle) {
+    const size_t bytesPerPixel = bitsPerPixel / 8;
+    std::vector<uint8_t> out(18, 0);
+    out[2] = bRle ? 10 : 2;
+    out[12] = (uint8_t)image.width;
+    out[13] = (uint8_t)(image.width >> 8);
+    out[14] = (uint8_t)image.height;
+    out[15] = (uint8_t)(image.height >> 8);
+    out[16] = (uint8_t)bitsPerPixel;
+    out[17] = bitsPerPixel == 32 ? 8 : 0;
+
+    std::vector<uint8_t> pixels;
+    for (uint32_t y = image.height; y-- > 0;) {
+        for (uint32_t x = 0; x < image.width; x++) {
+            const uint8_t* p = &image.pixels[((size_t)y * image.width + x) * 4];
+            const uint8_t bgra[4] = { p[2], p[1], p[0], p[3] };
+            pixels.insert(pixels.end(), bgra, bgra + bytesPerPixel);
+        }
+    }
+    if (!bRle) {
+        out.insert(out.end(), pixels.begin(), pixels.end());
+        return out;
+    }
+
+    const size_t count = pixels.size() / bytesPerPixel;
+    auto same = [&](size_t a, size_t b) {
+        return memcmp(&pixels[a * bytesPerPixel], &pixels[b * bytesPerPixel], bytesPerPixel) == 0;
+    };
+    size_t i = 0;
+    while (i < count) {
+        size_t run = 1;
+        while (i + run < count && run < 128 && same(i, i + run)) run++;
+        if (run > 1) {
+            out.push_back((uint8_t)(0x80 | (run - 1)));
+            out.insert(out.end(), &pixels[i * bytesPerPixel], &pixels[i * bytesPerPixel] + bytesPerPixel);
+            i += run;
+            continue;
+        }
+        size_t literal = 1;
+        while (i + literal < count && literal < 128 && !(i + literal + 1 < count && same(i + literal, i + literal + 1))) literal++;
+        out.push_back((uint8_t)(literal - 1));
+        out.insert(out.end(), &pixels[i * bytesPerPixel], &pixels[(i + literal) * bytesPerPixel]);
+        i += literal;
+    }
+    return out;
+}
+
+// Bottom-up BI_RGB with rows padded to four bytes
+static std::vector<uint8_t> EncodeBMP(const Image& image, uint32_t bitsPerPixel) {
+    const size_t bytesPerPixel = bitsPerPixel / 8;
+    const size_t rowBytes = (image.width * bytesPerPixel + 3) & ~(size_t)3;
+    std::vector<uint8_t> out = { 'B', 'M' };
+    PutLE32(out, (uint32_t)(54 + rowBytes * image.height));
+    PutLE32(out, 0);
+    PutLE32(out, 54);
+    PutLE32(out, 40);
+    PutLE32(out, image.width);
+    PutLE32(out, image.height);
+    PutLE16(out, 1);
+    PutLE16(out, bitsPerPixel);
+    for (int i = 0; i < 6; i++) {
+        PutLE32(out, 0);
+    }
+    for (uint32_t y = image.height; y-- > 0;) {
+        size_t start = out.size();
+        for (uint32_t x = 0; x < image.width; x++) {
+            const uint8_t* p = &image.pixels[((size_t)y * image.width + x) * 4];
+            const uint8_t bgra[4] = { p[2], p[1], p[0], p[3] };
+            out.insert(out.end(), bgra, bgra + bytesPerPixel);
+        }
+        out.resize(start + rowBytes, 0);
+    }
+    return out;
+}
+
+// ---------------------------------------------------------------------------
+// Decode checks and throughput
+
+struct EncodedImage {
+    const char* name;
+    std::vector<uint8_t> data;
+    bool bOpaque;   // Source alpha was dropped, so decoded alpha is 255
+};
+
+static bool Matches(const Image& source, const Image& decoded, bool bOpaque) {
+    if (decoded.width != source.width || decoded.height != source.height ||
+        decoded.pixels.size() != source.pixels.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < source.pixels.size(); i += 4) {
+        if (memcmp(&source.pixels[i], &decoded.pixels[i], 3) != 0 ||
+            decoded.pixels[i + 3] != (bOpaque ? 255 : source.pixels[i + 3])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool CheckDecoders(const Image& source, const std::vector<EncodedImage>& encoded) {
+    bool bOk = true;
+    for (const EncodedImage& file : encoded) {
+        Image decoded;
+        char name[64];
+        snprintf(name, sizeof(name), "decode %s", file.name);
+        bOk = Report(name, DecodeImage(file.data.data(), file.data.size(), decoded) &&
+                           Matches(source, decoded, file.bOpaque)) && bOk;
+    }
+    return bOk;
+}
+
+static void BenchDecoders(const std::vector<EncodedImage>& encoded, int iterations) {
+    printf("\n%-16s %10s %12s %12s\n", "format", "file KiB", "file MB/s", "RGBA MB/s");
+    for (const EncodedImage& file : encoded) {
+        Image decoded;
+        DecodeImage(file.data.data(), file.data.size(), decoded);
+        double best = 1e30;
+        for (int i = 0; i < iterations; i++) {
+            auto start = Clock::now();
+            DecodeImage(file.data.data(), file.data.size(), decoded);
+            best = min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        printf("%-16s %10.1f %12.1f %12.1f\n", file.name, file.data.size() / 1024.0,
+               file.data.size() / best / 1e6, decoded.pixels.size() / best / 1e6);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Kernel checks and throughput
+
+static std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed) {
+    std::vector<uint8_t> bytes(size);
+    for (uint8_t& byte : bytes) {
+        seed = seed * 1664525u + 1013904223u;
+        byte = (uint8_t)(seed >> 24);
+    }
+    return bytes;
+}
+
+// Blocks of four go through SSE2 where it is built in; single pixels
+// always take the scalar tail
+static bool CheckSwizzleAndExpand() {
+    const size_t count = 1027;
+    std::vector<uint8_t> rgba = RandomBytes(count * 4, 1);
+    std::vector<uint8_t> bulk(count * 4), single(count * 4);
+    bool bOk = true;
+
+    SwizzleBGRAToRGBA(rgba.data(), bulk.data(), count);
+    for (size_t i = 0; i < count; i++) {
+        SwizzleBGRAToRGBA(&rgba[i * 4], &single[i * 4], 1);
+        const uint8_t expected[4] = { rgba[i * 4 + 2], rgba[i * 4 + 1], rgba[i * 4], rgba[i * 4 + 3] };
+        bOk = bOk && memcmp(&bulk[i * 4], expected, 4) == 0;
+    }
+    bOk = bOk && bulk == single;
+
+    // In place, as the decoders may call it
+    std::vector<uint8_t> inPlace = rgba;
+    SwizzleBGRAToRGBA(inPlace.data(), inPlace.data(), count);
+    bOk = bOk && inPlace == bulk;
+
+    std::vector<uint8_t> rgb = RandomBytes(count * 3, 2);
+    for (int swap = 0; swap < 2 && bOk; swap++) {
+        ExpandRGBToRGBA(rgb.data(), bulk.data(), count, swap != 0);
+        for (size_t i = 0; i < count && bOk; i++) {
+            const uint8_t* p = &rgb[i * 3];
+            const uint8_t expected[4] = { swap ? p[2] : p[0], p[1], swap ? p[0] : p[2], 255 };
+            bOk = memcmp(&bulk[i * 4], expected, 4) == 0;
+        }
+    }
+    return Report("swizzle and RGB expand, SSE2 vs scalar", bOk);
+}
+
+// Every colour value against every alpha, exact rounding of c * a / 255
+static bool CheckPremultiply() {
+    std::vector<uint8_t> bulk(256 * 256 * 4), single;
+    for (uint32_t alpha = 0; alpha < 256; alpha++) {
+        for (uint32_t value = 0; value < 256; value++) {
+            uint8_t* p = &bulk[(alpha * 256 + value) * 4];
+            p[0] = (uint8_t)value;
+            p[1] = (uint8_t)(255 - value);
+            p[2] = (uint8_t)(value ^ 0x5A);
+            p[3] = (uint8_t)alpha;
+        }
+    }
+    single = bulk;
+    const std::vector<uint8_t> source = bulk;
+
+    PremultiplyAlpha(bulk.data(), 256 * 256);
+    for (size_t i = 0; i < 256 * 256; i++) {
+        PremultiplyAlpha(&single[i * 4], 1);
+    }
+
+    bool bOk = bulk == single;
+    for (size_t i = 0; i < bulk.size() && bOk; i++) {
+        uint32_t alpha = source[(i & ~(size_t)3) + 3];
+        uint32_t expected = (i & 3) == 3 ? alpha : (2 * source[i] * alpha + 255) / 510;
+        bOk = bulk[i] == expected;
+    }
+    return Report("premultiply, SSE2 vs scalar vs exact", bOk);
+}
+
+static bool CheckDownsample() {
+    const uint32_t sizes[][2] = { { 1, 1 }, { 2, 1 }, { 3, 3 }, { 4, 2 }, { 7, 5 }, { 8, 8 }, { 13, 6 }, { 64, 33 }, { 129, 2 } };
+    bool bOk = true;
+    for (const auto& size : sizes) {
+        uint32_t width = size[0], height = size[1];
+        uint32_t dstWidth = max(1u, width / 2), dstHeight = max(1u, height / 2);
+        std::vector<uint8_t> source = RandomBytes((size_t)width * height * 4, width * 31 + height);
+        std::vector<uint8_t> result((size_t)dstWidth * dstHeight * 4);
+        DownsampleBox(source.data(), width, height, result.data());
+
+        for (uint32_t y = 0; y < dstHeight && bOk; y++) {
+            for (uint32_t x = 0; x < dstWidth && bOk; x++) {
+                uint32_t x0 = min(x * 2, width - 1), x1 = min(x * 2 + 1, width - 1);
+                uint32_t y0 = min(y * 2, height - 1), y1 = min(y * 2 + 1, height - 1);
+                for (int c = 0; c < 4 && bOk; c++) {
+                    uint32_t sum = source[((size_t)y0 * width + x0) * 4 + c] + source[((size_t)y0 * width + x1) * 4 + c] +
+                                   source[((size_t)y1 * width + x0) * 4 + c] + source[((size_t)y1 * width + x1) * 4 + c];
+                    bOk = result[((size_t)y * dstWidth + x) * 4 + c] == (sum + 2) / 4;
+                }
+            }
+        }
+    }
+    return Report("box downsample, odd and even sizes", bOk);
+}
+
+template <typename TKernel>
+static void BenchKernel(const char* name, size_t bytes, int iterations, TKernel kernel) {
+    kernel();
+    double best = 1e30;
+    for (int i = 0; i < iterations; i++) {
+        auto start = Clock::now();
+        kernel();
+        best = min(best, std::chrono::duration<double>(Clock::now() - start).count());
+    }
+    printf("%-24s %12.1f\n", name, bytes / best / 1e6);
+}
+
+static void BenchKernels(const Image& source, int iterations) {
+    const size_t count = (size_t)source.width * source.height;
+    const size_t bytes = count * 4;
+    std::vector<uint8_t> rgb(count * 3), out(bytes);
+    std::vector<uint8_t> work = source.pixels;
+
+    printf("\n%-24s %12s\n", "kernel", "RGBA MB/s");
+    BenchKernel("ExpandRGBToRGBA", bytes, iterations, [&]() { ExpandRGBToRGBA(rgb.data(), out.data(), count, true); });
+    BenchKernel("SwizzleBGRAToRGBA", bytes, iterations, [&]() { SwizzleBGRAToRGBA(source.pixels.data(), out.data(), count); });
+    BenchKernel("PremultiplyAlpha", bytes, iterations, [&]() {
+        memcpy(work.data(), source.pixels.data(), bytes);
+        PremultiplyAlpha(work.data(), count);
+    });
+    BenchKernel("DownsampleBox", bytes, iterations, [&]() { DownsampleBox(source.pixels.data(), source.width, source.height, out.data()); });
+    std::vector<Image> mips;
+    BenchKernel("GenerateMipChain", bytes, iterations, [&]() { GenerateMipChain(source, mips); });
+}
+
+int main(int argc, char** argv) {
+    uint32_t width = argc > 1 ? (uint32_t)max(1, atoi(argv[1])) : 1024;
+    uint32_t height = argc > 2 ? (uint32_t)max(1, atoi(argv[2])) : 1024;
+    int iterations = argc > 3 ? max(1, atoi(argv[3])) : 5;
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    printf("%ux%u image, SSE2 kernels\n\n", width, height);
+#else
+    printf("%ux%u image, scalar kernels\n\n", width, height);
+#endif
+
+    Image source = MakeSourceImage(width, height);
+    std::vector<EncodedImage> encoded;
+    encoded.push_back({ "PNG RGBA", EncodePNG(source, true), false });
+    encoded.push_back({ "PNG RGB", EncodePNG(source, false), true });
+    encoded.push_back({ "TGA 32-bit", EncodeTGA(source, 32, false), false });
+    encoded.push_back({ "TGA 24-bit", EncodeTGA(source, 24, false), true });
+    encoded.push_back({ "TGA 32-bit RLE", EncodeTGA(source, 32, true), false });
+    encoded.push_back({ "BMP 32-bit", EncodeBMP(source, 32), false });
+    encoded.push_back({ "BMP 24-bit", EncodeBMP(source, 24), true });
+
+    bool bOk = CheckDecoders(source, encoded);
+    bOk = CheckSwizzleAndExpand() && bOk;
+    bOk = CheckPremultiply() && bOk;
+    bOk = CheckDownsample() && bOk;
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+
+    BenchDecoders(encoded, iterations);
+    BenchKernels(source, iterations);
+    return 0;
+}
\ No newline at end of file
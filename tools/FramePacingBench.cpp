@@ -0,0 +1,84 @@
+// Frame pacing and fixed-timestep accuracy of FrameTimer, without a window.
+//
+//   FramePacingBench [seconds per case] [min work ms] [max work ms]
+//
+// Runs a headless frame loop at several frame-rate caps and uncapped. Each
+// frame does a pseudo-random amount of busy work and a 120 Hz fixed-step
+// simulation of a body moving at constant speed, rendered interpolated.
+// Reports frame time, jitter (standard deviation), 99th percentile and
+// worst frame, time spent waiting and how much of it was spent spinning,
+// CPU use of the loop (a pacer that spins shows near 100%), the simulation
+// rate, and how far the interpolated position strays from where real time
+// says it should be.
+#include "../include/FrameTimer.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+static void BusyWork(double ms) {
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(ms);
+    while (std::chrono::steady_clock::now() < end) {
+    }
+}
+
+static void RunCase(double fps, double seconds, double minWorkMs, double maxWorkMs) {
+    FrameTimer timer;
+    timer.SetTargetFps(fps);
+    timer.SetFixedStep(1.0 / 120.0);
+
+    // Body at 1 unit per second: the simulated position is the simulated
+    // time, so the rendered position should trail real time by one step
+    const double step = timer.GetFixedStep();
+    double previous = 0.0;
+    double current = 0.0;
+    double elapsed = 0.0;
+    double worstError = 0.0;
+
+    uint32_t seed = 99;
+    std::clock_t cpuStart = std::clock();
+    auto wallStart = std::chrono::steady_clock::now();
+    timer.Reset();
+    while (std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count() < seconds) {
+        uint32_t updates = timer.BeginFrame();
+        elapsed += timer.GetDeltaSeconds();
+        for (uint32_t i = 0; i < updates; i++) {
+            previous = current;
+            current += step;
+        }
+
+        double rendered = previous + (current - previous) * timer.GetAlpha();
+        if (timer.GetStepCount() > 0) {
+            worstError = fmax(worstError, fabs(rendered - (elapsed - step)));
+        }
+
+        seed = seed * 1664525u + 1013904223u;
+        BusyWork(minWorkMs + (maxWorkMs - minWorkMs) * (double)(seed >> 8) / 16777216.0);
+        timer.EndFrame();
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double cpuSeconds = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    FrameStats stats = timer.GetStats();
+    char target[16];
+    snprintf(target, sizeof(target), fps > 0.0 ? "%.0f" : "uncapped", fps);
+    printf("%-9s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f %6.0f%% %9.1f %10.2g\n", target, stats.meanMs, stats.jitterMs,
+           stats.p99Ms, stats.maxMs, stats.meanWaitMs, stats.meanSpinMs, 100.0 * cpuSeconds / wallSeconds,
+           (double)timer.GetStepCount() / wallSeconds, worstError * 1000.0);
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc >= 2 ? atof(argv[1]) : 2.0;
+    double minWorkMs = argc >= 3 ? atof(argv[2]) : 1.0;
+    double maxWorkMs = argc >= 4 ? atof(argv[3]) : 3.0;
+
+    printf("%.1f s per case, %.1f-%.1f ms work per frame, 120 Hz simulation\n", seconds, minWorkMs, maxWorkMs);
+    printf("target    mean ms  jitter   p99 ms   max ms  wait ms  spin ms    cpu  steps/s  interp err ms\n");
+
+    const double caps[] = { 30.0, 60.0, 144.0, 240.0, 0.0 };
+    for (double fps : caps) {
+        RunCase(fps, seconds, minWorkMs, maxWorkMs);
+    }
+    return 0;
+}
\ No newline at end of file
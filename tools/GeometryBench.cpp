@@ -0,0 +1,236 @@
+// Batch geometry generation: staging vectors versus writing in place.
+//
+//   GeometryBench [frames]
+//
+// Builds frames of 10k, 100k and 1M quads three ways. "push_back" is how
+// Renderer used to work: every vertex and index is pushed into member
+// vectors, and the flush maps the vertex and index rings and memcpy's both
+// vectors in. "in place" is the current path: GeometryArena hands out spans
+// of the mapped vertex ring, quads are written straight into it, and only
+// the 16-bit indices are copied at submit, as D3D11RenderBackend does.
+// Both flush every GeometryArena::MAX_BATCH_VERTICES vertices into
+// CpuRingBufferStorage rings, so the difference is the staging copy alone.
+// "Renderer" is the whole headless Renderer::Append path over the null
+// backend, including sort keys and index emission. Before timing, the two
+// ring paths are checked to upload identical vertices and indices.
+#include "../include/GeometryArena.h"
+#include "../include/NullRenderBackend.h"
+#include "../include/Renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+using std::min;
+using std::max;
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint32_t MAX_BATCH_QUADS = GeometryArena::MAX_BATCH_VERTICES / 4;
+static const uint32_t QUAD_INDICES[6] = { 0, 1, 2, 1, 3, 2 };
+
+static inline void WriteQuad(Vertex* pVertices, uint32_t quad) {
+    float x = (float)(quad % 1024);
+    float y = (float)((quad / 1024) % 1024);
+    float shade = (float)(quad & 255) * (1.0f / 255.0f);
+    pVertices[0] = { x, y, 0.0f, 0.0f, 0.0f, shade, 0.5f, 1.0f, 1.0f };
+    pVertices[1] = { x + 8.0f, y, 0.0f, 1.0f, 0.0f, shade, 0.5f, 1.0f, 1.0f };
+    pVertices[2] = { x, y + 8.0f, 0.0f, 0.0f, 1.0f, shade, 0.5f, 1.0f, 1.0f };
+    pVertices[3] = { x + 8.0f, y + 8.0f, 0.0f, 1.0f, 1.0f, shade, 0.5f, 1.0f, 1.0f };
+}
+
+// FNV-1a over uploaded data, only while checking
+static void Hash(uint64_t& hash, const void* pData, size_t size) {
+    const uint8_t* pBytes = (const uint8_t*)pData;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ pBytes[i]) * 1099511628211ull;
+    }
+}
+
+struct Rings {
+    CpuRingBufferStorage vertexStorage;
+    CpuRingBufferStorage indexStorage;
+    RingBufferAllocator vertexRing;
+    RingBufferAllocator indexRing;
+
+    Rings(uint32_t indexStride) :
+        vertexRing(&vertexStorage, sizeof(Vertex), GeometryArena::MAX_BATCH_VERTICES * 2),
+        indexRing(&indexStorage, indexStride, MAX_BATCH_QUADS * 6 * 2) {
+        vertexRing.Initialize();
+        indexRing.Initialize();
+    }
+};
+
+// The old Renderer: members cleared each flush, so they keep their capacity
+class PushBackPath {
+public:
+    PushBackPath() : m_Rings(sizeof(uint32_t)) {}
+
+    void Frame(uint32_t quadCount, uint64_t* pHash) {
+        m_Rings.vertexRing.BeginFrame();
+        m_Rings.indexRing.BeginFrame();
+        for (uint32_t quad = 0; quad < quadCount; quad++) {
+            if (m_Vertices.size() + 4 > GeometryArena::MAX_BATCH_VERTICES) {
+                Flush(pHash);
+            }
+            Vertex vertices[4];
+            WriteQuad(vertices, quad);
+            uint32_t baseVertex = (uint32_t)m_Vertices.size();
+            for (int i = 0; i < 4; i++) {
+                m_Vertices.push_back(vertices[i]);
+            }
+            for (int i = 0; i < 6; i++) {
+                m_Indices.push_back(baseVertex + QUAD_INDICES[i]);
+            }
+        }
+        Flush(pHash);
+    }
+
+private:
+    void Flush(uint64_t* pHash) {
+        if (m_Vertices.empty()) return;
+
+        uint32_t first = 0;
+        void* pData = m_Rings.vertexRing.Map((uint32_t)m_Vertices.size(), first);
+        memcpy(pData, m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
+        m_Rings.vertexRing.Unmap();
+        pData = m_Rings.indexRing.Map((uint32_t)m_Indices.size(), first);
+        memcpy(pData, m_Indices.data(), m_Indices.size() * sizeof(uint32_t));
+        m_Rings.indexRing.Unmap();
+
+        if (pHash) {
+            Hash(*pHash, m_Vertices.data(), m_Vertices.size() * sizeof(Vertex));
+            Hash(*pHash, m_Indices.data(), m_Indices.size() * sizeof(uint32_t));
+        }
+        m_Vertices.clear();
+        m_Indices.clear();
+    }
+
+    Rings m_Rings;
+    std::vector<Vertex> m_Vertices;
+    std::vector<uint32_t> m_Indices;
+};
+
+// Vertices go straight into the mapped ring; indices are batch-relative
+// 16-bit values copied once at submit
+class InPlacePath {
+public:
+    InPlacePath() : m_Rings(sizeof(uint16_t)), m_Arena(&m_Rings.vertexRing), m_IndexCount(0) {
+        m_Indices.resize(MAX_BATCH_QUADS * 6);
+    }
+
+    void Frame(uint32_t quadCount, uint64_t* pHash) {
+        m_Rings.vertexRing.BeginFrame();
+        m_Rings.indexRing.BeginFrame();
+        for (uint32_t quad = 0; quad < quadCount; quad++) {
+            void* pVertices = nullptr;
+            uint32_t baseVertex = 0;
+            if (!m_Arena.Append(4, pVertices, baseVertex)) {
+                Submit(pHash);
+                if (!m_Arena.Append(4, pVertices, baseVertex)) return;
+            }
+            WriteQuad((Vertex*)pVertices, quad);
+            uint16_t* pIndices = &m_Indices[m_IndexCount];
+            for (int i = 0; i < 6; i++) {
+                pIndices[i] = (uint16_t)(baseVertex + QUAD_INDICES[i]);
+            }
+            m_IndexCount += 6;
+        }
+        Submit(pHash);
+    }
+
+private:
+    void Submit(uint64_t* pHash) {
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+        if (!m_Arena.Close(firstVertex, vertexCount)) return;
+
+        uint32_t firstIndex = 0;
+        void* pData = m_Rings.indexRing.Map(m_IndexCount, firstIndex);
+        memcpy(pData, m_Indices.data(), m_IndexCount * sizeof(uint16_t));
+        m_Rings.indexRing.Unmap();
+
+        if (pHash) {
+            Hash(*pHash, m_Rings.vertexStorage.GetData() + (size_t)firstVertex * sizeof(Vertex),
+                 (size_t)vertexCount * sizeof(Vertex));
+            for (uint32_t i = 0; i < m_IndexCount; i++) {
+                uint32_t index = m_Indices[i];
+                Hash(*pHash, &index, sizeof(index));
+            }
+        }
+        m_IndexCount = 0;
+    }
+
+    Rings m_Rings;
+    GeometryArena m_Arena;
+    std::vector<uint16_t> m_Indices;
+    uint32_t m_IndexCount;
+};
+
+static void RendererFrame(Renderer& renderer, uint32_t quadCount) {
+    renderer.BeginFrame();
+    for (uint32_t quad = 0; quad < quadCount; quad++) {
+        GeometrySpan span;
+        if (!renderer.Append(4, 6, span)) return;
+        WriteQuad(span.Vertices<Vertex>(), quad);
+        for (int i = 0; i < 6; i++) {
+            span.pIndices[i] = (uint16_t)(span.baseVertex + QUAD_INDICES[i]);
+        }
+    }
+    renderer.Flush();
+}
+
+// Best of several frames after one warm-up frame, in milliseconds
+template <typename TFrame>
+static double Time(int frames, TFrame frame) {
+    frame();
+    double best = 1e30;
+    for (int i = 0; i < frames; i++) {
+        auto start = Clock::now();
+        frame();
+        best = min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? max(1, atoi(argv[1])) : 10;
+
+    // Batches of 65536 vertices split identically on both paths
+    uint64_t pushBackHash = 14695981039346656037ull;
+    uint64_t inPlaceHash = 14695981039346656037ull;
+    {
+        PushBackPath pushBack;
+        InPlacePath inPlace;
+        pushBack.Frame(MAX_BATCH_QUADS * 2 + 123, &pushBackHash);
+        inPlace.Frame(MAX_BATCH_QUADS * 2 + 123, &inPlaceHash);
+    }
+    bool bSame = pushBackHash == inPlaceHash;
+    printf("%-44s %s\n", "both paths upload the same geometry", bSame ? "ok" : "FAILED");
+    if (!bSame) {
+        return 1;
+    }
+
+    Renderer renderer(std::unique_ptr<RenderBackend>(new NullRenderBackend(VertexFormat::STANDARD)));
+    if (!renderer.Initialize()) {
+        printf("Renderer failed to initialize\n");
+        return 1;
+    }
+
+    printf("\n%10s %14s %14s %14s %10s\n", "quads", "push_back ms", "in place ms", "Renderer ms", "speedup");
+    const uint32_t counts[] = { 10000, 100000, 1000000 };
+    for (uint32_t quadCount : counts) {
+        PushBackPath pushBack;
+        InPlacePath inPlace;
+        double pushBackMs = Time(frames, [&]() { pushBack.Frame(quadCount, nullptr); });
+        double inPlaceMs = Time(frames, [&]() { inPlace.Frame(quadCount, nullptr); });
+        double rendererMs = Time(frames, [&]() { RendererFrame(renderer, quadCount); });
+        printf("%10u %14.3f %14.3f %14.3f %9.2fx\n", quadCount, pushBackMs, inPlaceMs, rendererMs,
+               pushBackMs / inPlaceMs);
+    }
+
+    renderer.Cleanup();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,249 @@
+// Correctness checks and scheduling overhead benchmark for JobSystem.
+//
+//   JobBench [threads] [rounds]
+//
+// The checks run every job exactly once, hold dependent jobs back until
+// what they depend on has finished, keep main-thread jobs on the main
+// thread, and survive jobs that wait on jobs of their own and threads from
+// outside the system queuing work; each prints ok or FAILED. The benchmark
+// fans a batch of jobs out and waits for all of them, for several batch
+// sizes and job lengths, and reports the wall time per job against running
+// the same work in a plain loop: with no work that is the scheduling
+// overhead, with longer jobs the speed-up shows how well the threads are used.
+#include "../include/JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-34s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Every job of a large batch runs once, whichever thread takes it
+static bool CheckFanOut(JobSystem& jobs) {
+    const uint32_t count = 100000;
+    std::vector<std::atomic<uint32_t>> runs(count);
+    for (auto& run : runs) {
+        run.store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<Job> batch(count);
+    for (uint32_t i = 0; i < count; i++) {
+        batch[i].function = [](void* pData) {
+            ((std::atomic<uint32_t>*)pData)->fetch_add(1, std::memory_order_relaxed);
+        };
+        batch[i].pData = &runs[i];
+    }
+
+    JobCounter counter;
+    jobs.Run(batch.data(), count, &counter);
+    jobs.Wait(counter);
+
+    bool bOk = counter.IsDone();
+    for (auto& run : runs) {
+        bOk = bOk && run.load(std::memory_order_relaxed) == 1;
+    }
+    return Report("fan-out/fan-in, 100000 jobs", bOk);
+}
+
+// Three stages, each depending on the one before: no job of a stage may
+// start until every job of the previous one has finished
+struct StageData {
+    std::atomic<uint32_t>* pFinished;   // Per stage
+    uint32_t stage;
+    uint32_t width;
+    std::atomic<uint32_t>* pErrors;
+};
+
+static bool CheckDependencies(JobSystem& jobs) {
+    const uint32_t width = 64;
+    const uint32_t stages = 3;
+    std::atomic<uint32_t> finished[stages];
+    std::atomic<uint32_t> errors(0);
+    for (auto& stage : finished) {
+        stage.store(0, std::memory_order_relaxed);
+    }
+
+    std::vector<StageData> data(stages);
+    std::vector<Job> batches[stages];
+    JobCounter counters[stages];
+    for (uint32_t stage = 0; stage < stages; stage++) {
+        data[stage] = { finished, stage, width, &errors };
+        batches[stage].assign(width, Job{ [](void* pData) {
+            StageData& stageData = *(StageData*)pData;
+            if (stageData.stage > 0 &&
+                stageData.pFinished[stageData.stage - 1].load(std::memory_order_acquire) != stageData.width) {
+                stageData.pErrors->fetch_add(1, std::memory_order_relaxed);
+            }
+            // Long enough that later stages would overtake if let loose
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            stageData.pFinished[stageData.stage].fetch_add(1, std::memory_order_acq_rel);
+        }, &data[stage] });
+    }
+
+    // All queued up front; only the dependencies keep them in order
+    for (uint32_t stage = 0; stage < stages; stage++) {
+        jobs.Run(batches[stage].data(), width, &counters[stage], stage > 0 ? &counters[stage - 1] : nullptr);
+    }
+    jobs.Wait(counters[stages - 1]);
+
+    bool bOk = errors.load() == 0 && finished[stages - 1].load() == width;
+    for (uint32_t stage = 0; stage < stages - 1; stage++) {
+        jobs.Wait(counters[stage]);
+    }
+    return Report("dependency chain, 3 x 64 jobs", bOk);
+}
+
+// Workers queue main-thread jobs; they run only on the thread that built
+// the system, when it drains them or waits
+struct MainThreadData {
+    JobSystem* pJobs;
+    JobCounter* pMainCounter;
+    std::thread::id mainThread;
+    std::atomic<uint32_t>* pWrongThread;
+    std::atomic<uint32_t>* pRuns;
+};
+
+static bool CheckMainThreadJobs(JobSystem& jobs) {
+    const uint32_t count = 256;
+    std::atomic<uint32_t> wrongThread(0);
+    std::atomic<uint32_t> runs(0);
+    JobCounter mainCounter;
+    MainThreadData data = { &jobs, &mainCounter, std::this_thread::get_id(), &wrongThread, &runs };
+
+    std::vector<Job> batch(count, Job{ [](void* pData) {
+        MainThreadData& data = *(MainThreadData*)pData;
+        data.pJobs->RunOnMainThread(Job{ [](void* pData) {
+            MainThreadData& data = *(MainThreadData*)pData;
+            if (std::this_thread::get_id() != data.mainThread) {
+                data.pWrongThread->fetch_add(1, std::memory_order_relaxed);
+            }
+            data.pRuns->fetch_add(1, std::memory_order_relaxed);
+        }, pData }, data.pMainCounter);
+    }, &data });
+
+    JobCounter counter;
+    jobs.Run(batch.data(), count, &counter);
+    jobs.Wait(counter);
+
+    // Half drained as a frame would, the rest by waiting
+    jobs.RunMainThreadJobs();
+    jobs.Wait(mainCounter);
+
+    return Report("main-thread jobs", wrongThread.load() == 0 && runs.load() == count);
+}
+
+// Jobs that split their own work and wait for it, two levels deep
+static bool CheckNestedWaits(JobSystem& jobs) {
+    std::atomic<uint32_t> leaves(0);
+    jobs.ParallelFor(16, 1, [&](uint32_t, uint32_t) {
+        jobs.ParallelFor(16, 1, [&](uint32_t, uint32_t) {
+            jobs.ParallelFor(16, 4, [&](uint32_t begin, uint32_t end) {
+                leaves.fetch_add(end - begin, std::memory_order_relaxed);
+            });
+        });
+    });
+    return Report("nested waits, 16^3 leaves", leaves.load() == 16 * 16 * 16);
+}
+
+// Threads outside the system queue and wait on work of their own
+static bool CheckOutsideThreads(JobSystem& jobs) {
+    const uint32_t threadCount = 4;
+    const uint32_t count = 5000;
+    std::atomic<uint32_t> runs(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < threadCount; t++) {
+        threads.emplace_back([&]() {
+            std::vector<Job> batch(count, Job{ [](void* pData) {
+                ((std::atomic<uint32_t>*)pData)->fetch_add(1, std::memory_order_relaxed);
+            }, &runs });
+            JobCounter counter;
+            jobs.Run(batch.data(), count, &counter);
+            jobs.Wait(counter);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return Report("jobs queued from 4 outside threads", runs.load() == threadCount * count);
+}
+
+// Spin for roughly the given number of iterations; the job body for the
+// benchmark, so job length does not depend on the clock
+static void Spin(uint32_t iterations) {
+    volatile uint32_t sink = 0;
+    for (uint32_t i = 0; i < iterations; i++) {
+        sink = sink + i;
+    }
+}
+
+struct BenchJob {
+    uint32_t iterations;
+};
+
+static void RunBench(JobSystem& jobs, uint32_t rounds) {
+    printf("\n  batch   work   ns/job (serial)   ns/job (jobs)   speed-up\n");
+
+    const uint32_t batchSizes[] = { 1, 16, 256, 4096 };
+    const uint32_t workSizes[] = { 0, 100, 1000 };
+    for (uint32_t work : workSizes) {
+        BenchJob benchJob = { work };
+        for (uint32_t batchSize : batchSizes) {
+            std::vector<Job> batch(batchSize, Job{ [](void* pData) {
+                Spin(((BenchJob*)pData)->iterations);
+            }, &benchJob });
+
+            // Enough rounds to amount to a good number of jobs either way
+            uint32_t roundCount = std::max(rounds, 1u) * std::max(1u, 4096u / batchSize);
+
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t round = 0; round < roundCount; round++) {
+                for (uint32_t i = 0; i < batchSize; i++) {
+                    Spin(work);
+                }
+            }
+            double serialNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            start = std::chrono::steady_clock::now();
+            for (uint32_t round = 0; round < roundCount; round++) {
+                JobCounter counter;
+                jobs.Run(batch.data(), batchSize, &counter);
+                jobs.Wait(counter);
+            }
+            double jobNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+            double totalJobs = (double)roundCount * batchSize;
+            printf("  %5u  %5u   %15.1f   %13.1f   %8.2f\n", batchSize, work, serialNs / totalJobs,
+                   jobNs / totalJobs, serialNs / jobNs);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t threadCount = argc >= 2 ? (uint32_t)atoi(argv[1]) : 0;
+    uint32_t rounds = argc >= 3 ? (uint32_t)atoi(argv[2]) : 200;
+
+    JobSystem jobs(threadCount);
+    printf("%u threads (%u hardware)\n", jobs.GetThreadCount(), std::thread::hardware_concurrency());
+
+    bool bOk = CheckFanOut(jobs);
+    bOk = CheckDependencies(jobs) && bOk;
+    bOk = CheckMainThreadJobs(jobs) && bOk;
+    bOk = CheckNestedWaits(jobs) && bOk;
+    bOk = CheckOutsideThreads(jobs) && bOk;
+
+    RunBench(jobs, rounds);
+    printf("\n%llu jobs run, %llu stolen\n", (unsigned long long)jobs.GetJobCount(),
+           (unsigned long long)jobs.GetStealCount());
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
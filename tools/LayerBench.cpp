@@ -0,0 +1,268 @@
+// Layer compositing throughput, and the composite's path to the screen.
+//
+//   LayerBench [document size] [layers] [layer coverage %]
+//
+// Builds a document with an opaque background and sparse layers in every
+// blend mode, then times a full recomposite against recompositing after a
+// small stroke on a middle layer, which should only redo the tiles the
+// stroke touched. Also reports each blend kernel's raw throughput.
+//
+// First it checks the upload the app does each frame: the composite's
+// dirty rect recorded as a texture update and replayed by RenderThread.
+// The texture must match the composite after the first frame, after a
+// stroke, which must send only the area it changed, and while a
+// prediction overlay is drawn and cleared again. Each prints ok or FAILED.
+#include "../include/LayerStack.h"
+#include "../include/DabRasterizer.h"
+#include "../include/NullRenderBackend.h"
+#include "../include/Renderer.h"
+#include "../include/RenderThread.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+using std::min;
+using std::max;
+
+static uint32_t g_Random = 99;
+static uint32_t RandomInt() {
+    g_Random = g_Random * 1664525u + 1013904223u;
+    return g_Random >> 8;
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Premultiplied noise with the given alpha range
+static void FillTile(uint8_t* pTile, uint32_t minAlpha) {
+    for (uint32_t i = 0; i < Canvas::TILE_SIZE * Canvas::TILE_SIZE; i++) {
+        uint32_t alpha = minAlpha + RandomInt() % (256 - minAlpha);
+        pTile[i * 4 + 0] = (uint8_t)(RandomInt() % (alpha + 1));
+        pTile[i * 4 + 1] = (uint8_t)(RandomInt() % (alpha + 1));
+        pTile[i * 4 + 2] = (uint8_t)(RandomInt() % (alpha + 1));
+        pTile[i * 4 + 3] = (uint8_t)alpha;
+    }
+}
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Keeps a CPU copy of every texture and counts the bytes updated
+class ShadowBackend : public NullRenderBackend {
+public:
+    uint32_t CreateTexture(uint32_t width, uint32_t height, const uint8_t* pPixels) override {
+        uint32_t textureId = NullRenderBackend::CreateTexture(width, height, pPixels);
+        Texture& texture = m_Textures[textureId];
+        texture.width = width;
+        texture.pixels.assign((size_t)width * height * 4, 0);
+        if (pPixels) {
+            memcpy(texture.pixels.data(), pPixels, texture.pixels.size());
+        }
+        return textureId;
+    }
+
+    bool UpdateTexture(uint32_t textureId, uint32_t x, uint32_t y, uint32_t width, uint32_t height,
+                       const uint8_t* pPixels, uint32_t rowPitch) override {
+        Texture& texture = m_Textures[textureId];
+        for (uint32_t row = 0; row < height; row++) {
+            memcpy(&texture.pixels[((size_t)(y + row) * texture.width + x) * 4], pPixels + (size_t)row * rowPitch,
+                   (size_t)width * 4);
+        }
+        m_UpdatedBytes += (size_t)width * height * 4;
+        return NullRenderBackend::UpdateTexture(textureId, x, y, width, height, pPixels, rowPitch);
+    }
+
+    const std::vector<uint8_t>& GetPixels(uint32_t textureId) { return m_Textures[textureId].pixels; }
+    size_t TakeUpdatedBytes() { size_t bytes = m_UpdatedBytes; m_UpdatedBytes = 0; return bytes; }
+
+private:
+    struct Texture {
+        uint32_t width;
+        std::vector<uint8_t> pixels;
+    };
+    std::vector<Texture> m_Textures = std::vector<Texture>(16);
+    size_t m_UpdatedBytes = 0;
+};
+
+// One frame as the app records it: composite, send the dirty rect, draw
+static void RunFrame(LayerStack& stack, RenderThread& renderThread, uint32_t textureId) {
+    stack.Composite();
+    RenderCommandList& commands = renderThread.GetCommandList();
+    Canvas& composite = stack.GetComposite();
+    uint32_t x, y, width, height;
+    if (composite.GetDirtyRect(x, y, width, height)) {
+        uint8_t* pPixels = commands.UpdateTexture(textureId, x, y, width, height);
+        composite.ReadPixels(x, y, width, height, pPixels, width * 4);
+        composite.ClearDirty();
+    }
+    commands.SetBlendMode(BlendMode::PREMULTIPLIED);
+    commands.DrawQuad(0.5f * composite.GetWidth(), 0.5f * composite.GetHeight(),
+                      (float)composite.GetWidth(), (float)composite.GetHeight(), textureId);
+    commands.Present();
+    renderThread.SubmitFrame();
+}
+
+static bool Matches(ShadowBackend& backend, uint32_t textureId, const Canvas& composite) {
+    std::vector<uint8_t> expected((size_t)composite.GetWidth() * composite.GetHeight() * 4);
+    composite.ReadPixels(0, 0, composite.GetWidth(), composite.GetHeight(), expected.data(), composite.GetWidth() * 4);
+    return backend.GetPixels(textureId) == expected;
+}
+
+static bool CheckUpload() {
+    // Not a whole number of tiles, so edge tiles are clipped
+    const uint32_t width = 300;
+    const uint32_t height = 200;
+    const size_t fullBytes = (size_t)width * height * 4;
+
+    ShadowBackend* pBackend = new ShadowBackend();
+    Renderer renderer((std::unique_ptr<RenderBackend>(pBackend)));
+    renderer.Initialize();
+    uint32_t textureId = renderer.CreateTexture(width, height, nullptr);
+    RenderThread renderThread(&renderer);
+    renderThread.Start(false);
+
+    LayerStack stack(width, height);
+    Canvas& background = stack.AddLayer("Background")->GetCanvas();
+    Canvas& canvas = stack.AddLayer("Layer 1")->GetCanvas();
+    for (uint32_t tileY = 0; tileY < background.GetTilesY(); tileY++) {
+        for (uint32_t tileX = 0; tileX < background.GetTilesX(); tileX++) {
+            FillTile(background.GetOrCreateTile(tileX, tileY), 255);
+        }
+    }
+    background.MarkDirty(0, 0, (int)width, (int)height);
+    Canvas overlay(width, height);
+    stack.SetOverlay(&overlay, stack.GetLayer(1));
+
+    RunFrame(stack, renderThread, textureId);
+    bool bOk = Report("first frame uploads the whole composite",
+                      pBackend->TakeUpdatedBytes() == fullBytes && Matches(*pBackend, textureId, stack.GetComposite()));
+
+    // A stroke in one corner sends a tile or two, not the document
+    for (int i = 0; i < 5; i++) {
+        Dab dab = { 20.0f + (float)i * 4.0f, 20.0f, 8.0f, 1.0f, 1.0f, 0.9f, 0.1f, 0.1f, 1.0f };
+        RasterizeDab(canvas, dab);
+    }
+    RunFrame(stack, renderThread, textureId);
+    size_t strokeBytes = pBackend->TakeUpdatedBytes();
+    bOk = Report("stroke uploads only its dirty rect", strokeBytes > 0 && strokeBytes <= Canvas::TILE_BYTES * 2 &&
+                 Matches(*pBackend, textureId, stack.GetComposite())) && bOk;
+
+    // The overlay shows for a frame, then its clear is sent too
+    Dab tail = { 250.0f, 150.0f, 10.0f, 1.0f, 1.0f, 0.1f, 0.1f, 0.9f, 1.0f };
+    RasterizeDab(overlay, tail);
+    RunFrame(stack, renderThread, textureId);
+    std::vector<uint8_t> shown = pBackend->GetPixels(textureId);
+    bool bShown = Matches(*pBackend, textureId, stack.GetComposite());
+    overlay.Clear();
+    RunFrame(stack, renderThread, textureId);
+    bOk = Report("overlay shown, then cleared", bShown && shown != pBackend->GetPixels(textureId) &&
+                 Matches(*pBackend, textureId, stack.GetComposite())) && bOk;
+
+    // Nothing changed, nothing sent
+    pBackend->TakeUpdatedBytes();
+    RunFrame(stack, renderThread, textureId);
+    bOk = Report("idle frame uploads nothing", pBackend->TakeUpdatedBytes() == 0) && bOk;
+
+    renderThread.Stop();
+    return bOk;
+}
+
+static void BenchKernels() {
+    const size_t pixelCount = Canvas::TILE_SIZE * Canvas::TILE_SIZE;
+    std::vector<uint8_t> src(Canvas::TILE_BYTES), dst(Canvas::TILE_BYTES);
+    FillTile(src.data(), 0);
+    FillTile(dst.data(), 128);
+
+    printf("mode       Mpix/s (opacity 0.8)\n");
+    for (int mode = (int)LayerBlendMode::NORMAL; mode <= (int)LayerBlendMode::ERASE; mode++) {
+        const int passes = 2000;
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; pass++) {
+            BlendPixels((LayerBlendMode)mode, 0.8f, src.data(), dst.data(), pixelCount);
+        }
+        double elapsedMs = ElapsedMs(start);
+        printf("%-9s  %8.1f\n", GetBlendModeName((LayerBlendMode)mode), (double)passes * pixelCount / elapsedMs / 1000.0);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t size = argc >= 2 ? (uint32_t)atoi(argv[1]) : 8192;
+    uint32_t layerCount = argc >= 3 ? (uint32_t)max(atoi(argv[2]), 1) : 50;
+    uint32_t coverage = argc >= 4 ? (uint32_t)atoi(argv[3]) : 2;
+
+    bool bOk = CheckUpload();
+    printf("\n");
+    BenchKernels();
+
+    LayerStack stack(size, size);
+    uint32_t tilesX = stack.GetComposite().GetTilesX();
+    uint32_t tilesY = stack.GetComposite().GetTilesY();
+    uint32_t tileCount = tilesX * tilesY;
+
+    // Opaque background everywhere, then sparse layers cycling blend modes
+    Canvas& background = stack.AddLayer("Background")->GetCanvas();
+    for (uint32_t tileY = 0; tileY < tilesY; tileY++) {
+        for (uint32_t tileX = 0; tileX < tilesX; tileX++) {
+            FillTile(background.GetOrCreateTile(tileX, tileY), 255);
+        }
+    }
+    uint64_t layerTiles = tileCount;
+    for (uint32_t i = 1; i < layerCount; i++) {
+        stack.AddLayer("Layer");
+        stack.SetBlendMode(i, (LayerBlendMode)(i % ((int)LayerBlendMode::ERASE + 1)));
+        stack.SetOpacity(i, 0.5f + 0.5f * (float)(i % 3) / 2.0f);
+
+        Canvas& canvas = stack.GetLayer(i)->GetCanvas();
+        uint32_t tiles = tileCount * coverage / 100;
+        for (uint32_t t = 0; t < tiles; t++) {
+            uint32_t index = RandomInt() % tileCount;
+            uint8_t* pTile = canvas.GetOrCreateTile(index % tilesX, index / tilesX);
+            FillTile(pTile, 0);
+        }
+        layerTiles += canvas.GetAllocatedTileCount();
+    }
+
+    printf("document %ux%u, %u layers, %llu layer tiles (%.1f per composite tile)\n", size, size, layerCount,
+           (unsigned long long)layerTiles, (double)layerTiles / tileCount);
+
+    // Full recomposite, after the setup's dirty rects are consumed
+    stack.Composite();
+    stack.InvalidateAll();
+    auto start = std::chrono::steady_clock::now();
+    uint32_t fullTiles = stack.Composite();
+    double fullMs = ElapsedMs(start);
+    printf("full:        %6u tiles  %9.2f ms  %8.1f Mpix/s\n", fullTiles, fullMs,
+           (double)fullTiles * Canvas::TILE_SIZE * Canvas::TILE_SIZE / fullMs / 1000.0);
+
+    // Small strokes on a middle layer
+    Canvas& middle = stack.GetLayer(layerCount / 2)->GetCanvas();
+    const int strokes = 100;
+    uint64_t incrementalTiles = 0;
+    double incrementalMs = 0.0;
+    for (int stroke = 0; stroke < strokes; stroke++) {
+        float x = (float)(RandomInt() % size);
+        float y = (float)(RandomInt() % size);
+        for (int i = 0; i < 20; i++) {
+            Dab dab = { x + (float)i * 3.0f, y + (float)i * 2.0f, 12.0f, 0.8f, 1.0f, 0.2f, 0.4f, 0.9f, 1.0f };
+            RasterizeDab(middle, dab);
+        }
+
+        start = std::chrono::steady_clock::now();
+        incrementalTiles += stack.Composite();
+        incrementalMs += ElapsedMs(start);
+    }
+    printf("incremental: %6.1f tiles  %9.3f ms per stroke (%d strokes)\n",
+           (double)incrementalTiles / strokes, incrementalMs / strokes, strokes);
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
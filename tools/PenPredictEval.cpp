@@ -0,0 +1,200 @@
+// Offline evaluation of PenPredictor.
+//
+//   PenPredictEval [--history ms] [trace files...]
+//
+// A trace is text, one sample per line: "timeMs x y pressure". Blank lines
+// separate strokes and lines starting with '#' are ignored. Without trace
+// files a set of synthetic 240 Hz strokes is used instead.
+//
+// Each stroke is replayed sample by sample. After every sample the position
+// is predicted each horizon ahead and compared with where the pen really was
+// at that time (interpolated from the trace). "lag" is the error of showing
+// the newest sample with no prediction, which is what each horizon of
+// prediction sets out to hide.
+#include "../include/PenPredictor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+typedef std::vector<StrokeSample> Stroke;
+
+struct ErrorStats {
+    std::vector<double> predicted;
+    std::vector<double> lag;
+};
+
+static bool LoadTrace(const char* path, std::vector<Stroke>& strokes) {
+    std::ifstream file(path);
+    if (!file) return false;
+
+    Stroke stroke;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        StrokeSample sample;
+        if (fields >> sample.timeMs >> sample.x >> sample.y >> sample.pressure) {
+            stroke.push_back(sample);
+        } else if (!stroke.empty()) {
+            strokes.push_back(stroke);
+            stroke.clear();
+        }
+    }
+    if (!stroke.empty()) {
+        strokes.push_back(stroke);
+    }
+    return true;
+}
+
+// Small deterministic generator so runs are comparable
+static uint32_t g_Random = 12345;
+static float RandomFloat() {
+    g_Random = g_Random * 1664525u + 1013904223u;
+    return (float)(g_Random >> 8) / 16777216.0f;
+}
+
+// Sample path(u), u in [0, 1], at about 240 Hz with timing and position jitter
+template <typename Path>
+static Stroke SampleStroke(double durationMs, Path path) {
+    Stroke stroke;
+    const double intervalMs = 1000.0 / 240.0;
+    for (double t = 0.0; t <= durationMs; t += intervalMs) {
+        double jitteredT = std::max(0.0, std::min(durationMs, t + (RandomFloat() - 0.5) * 1.0));
+        StrokeSample sample;
+        path(jitteredT / durationMs, sample.x, sample.y);
+        sample.x += (RandomFloat() - 0.5f) * 0.4f;
+        sample.y += (RandomFloat() - 0.5f) * 0.4f;
+        sample.pressure = 0.5f + 0.3f * (float)std::sin(jitteredT * 0.01);
+        sample.timeMs = jitteredT;
+        stroke.push_back(sample);
+    }
+    return stroke;
+}
+
+static void BuildSyntheticStrokes(std::vector<Stroke>& strokes) {
+    const double pi = 3.14159265358979;
+
+    // Circle drawn with easing in and out
+    strokes.push_back(SampleStroke(800.0, [pi](double u, float& x, float& y) {
+        double eased = u * u * (3.0 - 2.0 * u);
+        x = (float)(400.0 + 150.0 * std::cos(eased * 2.0 * pi));
+        y = (float)(300.0 + 150.0 * std::sin(eased * 2.0 * pi));
+    }));
+
+    // Handwriting-like loops
+    strokes.push_back(SampleStroke(1500.0, [pi](double u, float& x, float& y) {
+        x = (float)(100.0 + 600.0 * u + 25.0 * std::cos(u * 14.0 * pi));
+        y = (float)(300.0 + 40.0 * std::sin(u * 14.0 * pi) + 15.0 * std::sin(u * 5.0 * pi));
+    }));
+
+    // Zigzag with sharp corners at constant speed
+    strokes.push_back(SampleStroke(1000.0, [](double u, float& x, float& y) {
+        double phase = u * 8.0;
+        double within = phase - std::floor(phase);
+        double triangle = ((int)phase & 1) ? 1.0 - within : within;
+        x = (float)(100.0 + 600.0 * u);
+        y = (float)(200.0 + 200.0 * triangle);
+    }));
+
+    // Fast flick that stops dead
+    strokes.push_back(SampleStroke(300.0, [](double u, float& x, float& y) {
+        double travel = u < 0.6 ? u / 0.6 : 1.0;
+        x = (float)(100.0 + 500.0 * travel * travel * (3.0 - 2.0 * travel));
+        y = (float)(400.0 - 100.0 * travel);
+    }));
+}
+
+// Trace position at timeMs, false past the end of the stroke
+static bool Interpolate(const Stroke& stroke, size_t from, double timeMs, float& x, float& y) {
+    for (size_t i = from; i + 1 < stroke.size(); i++) {
+        const StrokeSample& a = stroke[i];
+        const StrokeSample& b = stroke[i + 1];
+        if (timeMs <= b.timeMs) {
+            double span = b.timeMs - a.timeMs;
+            float t = span > 0.0 ? (float)((timeMs - a.timeMs) / span) : 1.0f;
+            x = a.x + (b.x - a.x) * t;
+            y = a.y + (b.y - a.y) * t;
+            return true;
+        }
+    }
+    return false;
+}
+
+static double Percentile(std::vector<double>& values, double fraction) {
+    if (values.empty()) return 0.0;
+    size_t index = std::min(values.size() - 1, (size_t)(fraction * (double)values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static double Mean(const std::vector<double>& values) {
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    return values.empty() ? 0.0 : sum / (double)values.size();
+}
+
+int main(int argc, char** argv) {
+    double historyMs = PenPredictor().GetHistory();
+    std::vector<Stroke> strokes;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--history") == 0 && i + 1 < argc) {
+            historyMs = atof(argv[++i]);
+        } else if (!LoadTrace(argv[i], strokes)) {
+            fprintf(stderr, "Cannot read trace %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    bool bSynthetic = strokes.empty();
+    if (bSynthetic) {
+        BuildSyntheticStrokes(strokes);
+    }
+
+    size_t sampleCount = 0;
+    for (const Stroke& stroke : strokes) sampleCount += stroke.size();
+    printf("%s: %zu strokes, %zu samples, history %.0f ms\n",
+           bSynthetic ? "synthetic" : "traces", strokes.size(), sampleCount, historyMs);
+
+    const double horizons[] = { 4.0, 8.0, 12.0, 16.0, 24.0, 32.0, 48.0 };
+    printf("saved ms   lag mean   lag p95   pred mean  pred p95   pred max\n");
+
+    for (double horizonMs : horizons) {
+        ErrorStats stats;
+        for (const Stroke& stroke : strokes) {
+            PenPredictor predictor;
+            predictor.SetHistory(historyMs);
+
+            for (size_t i = 0; i < stroke.size(); i++) {
+                const StrokeSample& newest = stroke[i];
+                predictor.AddSample(newest);
+
+                float trueX, trueY;
+                if (!Interpolate(stroke, i, newest.timeMs + horizonMs, trueX, trueY)) break;
+
+                StrokeSample predicted = newest;
+                predictor.Predict(horizonMs, predicted);
+
+                stats.predicted.push_back(std::hypot(predicted.x - trueX, predicted.y - trueY));
+                stats.lag.push_back(std::hypot(newest.x - trueX, newest.y - trueY));
+            }
+        }
+
+        double lagMean = Mean(stats.lag);
+        double predictedMean = Mean(stats.predicted);
+        double lagP95 = Percentile(stats.lag, 0.95);
+        double predictedP95 = Percentile(stats.predicted, 0.95);
+        double predictedMax = stats.predicted.empty() ? 0.0 :
+            *std::max_element(stats.predicted.begin(), stats.predicted.end());
+        printf("%8.0f  %9.2f  %8.2f  %10.2f  %8.2f  %9.2f\n",
+               horizonMs, lagMean, lagP95, predictedMean, predictedP95, predictedMax);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+// Main-thread frame time with and without the render thread.
+//
+//   RenderThreadBench [frames] [quads per frame] [game work us]
+//
+// Each frame the main thread moves a field of particles, spends the given
+// time on stand-in game work and records the particles as quads plus some
+// lines and circles, then submits the frame. The frame is replayed either
+// on the calling thread or on the render thread, against the null backend,
+// which measures the main thread in isolation, and the software backend,
+// where replaying costs real time. Reports main-thread frame time, render
+// time and the wait at the swap, and checks that the software backend's
+// last frame is identical either way.
+#include "../include/Renderer.h"
+#include "../include/RenderThread.h"
+#include "../include/NullRenderBackend.h"
+#include "../include/SoftwareRenderBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+static const uint32_t WIDTH = 640;
+static const uint32_t HEIGHT = 360;
+
+struct Particle {
+    float x, y, vx, vy;
+    uint32_t color;
+};
+
+static double GetTimeMs() {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static std::vector<Particle> MakeParticles(uint32_t count) {
+    std::vector<Particle> particles(count);
+    uint32_t seed = 1234;
+    for (Particle& particle : particles) {
+        seed = seed * 1664525u + 1013904223u;
+        particle.x = (float)(seed >> 8 & 0xffff) / 65535.0f * WIDTH;
+        seed = seed * 1664525u + 1013904223u;
+        particle.y = (float)(seed >> 8 & 0xffff) / 65535.0f * HEIGHT;
+        seed = seed * 1664525u + 1013904223u;
+        particle.vx = ((float)(seed >> 8 & 0xff) - 127.5f) / 64.0f;
+        seed = seed * 1664525u + 1013904223u;
+        particle.vy = ((float)(seed >> 8 & 0xff) - 127.5f) / 64.0f;
+        particle.color = seed | 0xFF000000u;
+    }
+    return particles;
+}
+
+static uint64_t HashPixels(const uint8_t* pPixels, size_t size) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ pPixels[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+struct CaseResult {
+    double mainP50, mainP95;
+    double renderMs;
+    double waitMs;
+    double fps;
+    uint64_t hash;
+};
+
+static CaseResult RunCase(bool bSoftware, bool bThreaded, uint32_t frames, uint32_t quadCount, double workUs) {
+    SoftwareRenderBackend* pSoftware = nullptr;
+    std::unique_ptr<RenderBackend> pBackend;
+    if (bSoftware) {
+        pSoftware = new SoftwareRenderBackend(WIDTH, HEIGHT, 1);
+        pBackend.reset(pSoftware);
+    } else {
+        pBackend.reset(new NullRenderBackend());
+    }
+
+    Renderer renderer(std::move(pBackend));
+    CaseResult result = {};
+    if (!renderer.Initialize()) {
+        return result;
+    }
+
+    RenderThread renderThread(&renderer);
+    if (pSoftware) {
+        renderThread.SetClearCallback([pSoftware](float r, float g, float b, float a) {
+            pSoftware->Clear(r, g, b, a);
+        });
+    }
+    renderThread.Start(bThreaded);
+
+    std::vector<Particle> particles = MakeParticles(quadCount);
+    std::vector<double> mainTimes;
+    double renderMs = 0.0;
+    double waitMs = 0.0;
+
+    double start = GetTimeMs();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        double frameStart = GetTimeMs();
+
+        for (Particle& particle : particles) {
+            particle.x += particle.vx;
+            particle.y += particle.vy;
+            if (particle.x < 0.0f || particle.x > WIDTH) particle.vx = -particle.vx;
+            if (particle.y < 0.0f || particle.y > HEIGHT) particle.vy = -particle.vy;
+        }
+        while ((GetTimeMs() - frameStart) * 1000.0 < workUs) {
+        }
+
+        RenderCommandList& commands = renderThread.GetCommandList();
+        commands.Clear(0.1f, 0.1f, 0.1f, 1.0f);
+        commands.SetBlendMode(BlendMode::ALPHA);
+        for (const Particle& particle : particles) {
+            commands.DrawQuad(particle.x, particle.y, 6.0f, 6.0f, RenderBackend::WHITE_TEXTURE, particle.color,
+                              particle.x * 0.01f);
+        }
+        for (uint32_t i = 0; i < 16; i++) {
+            float t = (float)(frame + i * 8) * 0.05f;
+            commands.DrawLine(WIDTH * 0.5f, HEIGHT * 0.5f, WIDTH * 0.5f + cosf(t) * 150.0f,
+                              HEIGHT * 0.5f + sinf(t) * 150.0f, 2.0f, 1.0f, 1.0f, 1.0f, 0.5f);
+            commands.DrawCircle(20.0f + i * 38.0f, 20.0f, 12.0f, 0.2f, 0.6f, 1.0f, 0.8f);
+        }
+        commands.Present();
+
+        // Main-thread frame time excludes the wait, which is render time
+        // that did not overlap
+        double recordedMs = GetTimeMs() - frameStart;
+        renderThread.SubmitFrame();
+        mainTimes.push_back(bThreaded ? recordedMs : GetTimeMs() - frameStart - renderThread.GetLastWaitMs());
+        renderMs += renderThread.GetLastRenderMs();
+        waitMs += renderThread.GetLastWaitMs();
+    }
+    renderThread.Stop();
+    double elapsedMs = GetTimeMs() - start;
+
+    std::sort(mainTimes.begin(), mainTimes.end());
+    result.mainP50 = mainTimes[mainTimes.size() / 2];
+    result.mainP95 = mainTimes[std::min(mainTimes.size() - 1, mainTimes.size() * 95 / 100)];
+    result.renderMs = renderMs / frames;
+    result.waitMs = waitMs / frames;
+    result.fps = frames * 1000.0 / elapsedMs;
+    result.hash = pSoftware ? HashPixels(pSoftware->GetPixels(), (size_t)WIDTH * HEIGHT * 4) : 0;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    uint32_t frames = argc >= 2 ? (uint32_t)atoi(argv[1]) : 300;
+    uint32_t quadCount = argc >= 3 ? (uint32_t)atoi(argv[2]) : 20000;
+    double workUs = argc >= 4 ? atof(argv[3]) : 2000.0;
+    frames = std::max(frames, 2u);
+
+    printf("%u frames, %u quads, %.0f us game work per frame, %ux%u\n", frames, quadCount, workUs, WIDTH, HEIGHT);
+    printf("backend   mode        main p50   main p95   render ms   wait ms      fps\n");
+
+    uint64_t hashes[2] = {};
+    for (int software = 0; software < 2; software++) {
+        for (int threaded = 0; threaded < 2; threaded++) {
+            CaseResult result = RunCase(software != 0, threaded != 0, frames, quadCount, workUs);
+            printf("%-8s  %-10s  %8.3f   %8.3f   %9.3f   %7.3f  %7.1f\n", software ? "software" : "null",
+                   threaded ? "threaded" : "inline", result.mainP50, result.mainP95, result.renderMs,
+                   result.waitMs, result.fps);
+            if (software) {
+                hashes[threaded] = result.hash;
+            }
+        }
+    }
+
+    if (hashes[0] != hashes[1]) {
+        printf("FAILED: the render thread drew a different frame\n");
+        return 1;
+    }
+    printf("last software frame identical: %016llx\n", (unsigned long long)hashes[1]);
+    return 0;
+}
\ No newline at end of file
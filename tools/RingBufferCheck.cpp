@@ -0,0 +1,213 @@
+// Capacity and overflow checks for RingBufferAllocator, without a device.
+//
+//   RingBufferCheck
+//
+// Runs the allocator over CpuRingBufferStorage, whose create, map and
+// discard counters show exactly what a D3D11 dynamic buffer would have been
+// asked to do: appends within a frame map with NO_OVERWRITE and land one
+// after another, running off the end wraps to the start with a DISCARD,
+// spans advance the head only by what was written, a batch larger than the
+// ring is split by NextBatchRange into whole-triangle ranges that each fit,
+// and BeginFrame grows the ring to the frame's high-water mark so a steady
+// frame no longer wraps. Each prints ok or FAILED.
+#include "../include/RingBufferAllocator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+using std::min;
+using std::max;
+
+static const uint32_t STRIDE = 16;
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Map count elements, fill them with value and unmap; returns the first
+// element, or UINT32_MAX if the map failed
+static uint32_t Write(RingBufferAllocator& ring, uint32_t count, uint8_t value) {
+    uint32_t first = 0;
+    void* pData = ring.Map(count, first);
+    if (!pData) {
+        return UINT32_MAX;
+    }
+    memset(pData, value, (size_t)count * STRIDE);
+    ring.Unmap();
+    return first;
+}
+
+static bool IsFilled(const CpuRingBufferStorage& storage, uint32_t first, uint32_t count, uint8_t value) {
+    const uint8_t* pData = storage.GetData() + (size_t)first * STRIDE;
+    for (size_t i = 0; i < (size_t)count * STRIDE; i++) {
+        if (pData[i] != value) return false;
+    }
+    return true;
+}
+
+// Appends follow one another; only the very first map of a new buffer
+// discards
+static bool CheckNoOverwrite() {
+    CpuRingBufferStorage storage;
+    RingBufferAllocator ring(&storage, STRIDE, 100);
+    bool bOk = ring.Initialize() && storage.GetSize() == 100 * STRIDE;
+
+    uint32_t firsts[3];
+    for (uint32_t i = 0; i < 3; i++) {
+        firsts[i] = Write(ring, 30, (uint8_t)(i + 1));
+    }
+    bOk = bOk && firsts[0] == 0 && firsts[1] == 30 && firsts[2] == 60;
+    for (uint32_t i = 0; i < 3; i++) {
+        bOk = bOk && IsFilled(storage, firsts[i], 30, (uint8_t)(i + 1));
+    }
+    bOk = bOk && storage.GetCreateCount() == 1 && storage.GetMapCount() == 3 && storage.GetDiscardCount() == 1;
+    bOk = bOk && ring.GetWrapCount() == 0 && ring.GetFrameUsage() == 90 && !storage.IsMapped();
+    return Report("NO_OVERWRITE sub-allocation", bOk);
+}
+
+// An append that does not fit before the end starts again at 0 with a
+// discard; one that can never fit fails without touching the buffer
+static bool CheckWrap() {
+    CpuRingBufferStorage storage;
+    RingBufferAllocator ring(&storage, STRIDE, 100);
+    bool bOk = ring.Initialize();
+
+    Write(ring, 40, 1);
+    Write(ring, 40, 2);
+    uint32_t wrapped = Write(ring, 40, 3);
+    bOk = bOk && wrapped == 0 && ring.GetWrapCount() == 1 && storage.GetDiscardCount() == 2;
+    bOk = bOk && IsFilled(storage, 0, 40, 3) && IsFilled(storage, 40, 40, 2);
+
+    uint32_t after = Write(ring, 10, 4);
+    bOk = bOk && after == 40 && storage.GetDiscardCount() == 2;
+
+    uint32_t mapsBefore = storage.GetMapCount();
+    bOk = bOk && Write(ring, 101, 5) == UINT32_MAX && Write(ring, 0, 5) == UINT32_MAX;
+    bOk = bOk && storage.GetMapCount() == mapsBefore && storage.GetCreateCount() == 1;
+    return Report("wrap with DISCARD, oversize map refused", bOk);
+}
+
+// MapSpan offers the rest of the ring and the head moves by what was used
+static bool CheckSpans() {
+    CpuRingBufferStorage storage;
+    RingBufferAllocator ring(&storage, STRIDE, 100);
+    bool bOk = ring.Initialize();
+
+    uint32_t first = 0;
+    uint32_t available = 0;
+    bOk = bOk && ring.MapSpan(10, first, available) != nullptr && first == 0 && available == 100;
+    ring.UnmapSpan(25);
+    bOk = bOk && ring.MapSpan(10, first, available) != nullptr && first == 25 && available == 75;
+    ring.UnmapSpan(70);
+
+    // Five left: a span of at least ten wraps
+    bOk = bOk && ring.MapSpan(10, first, available) != nullptr && first == 0 && available == 100;
+    ring.UnmapSpan(0);
+    bOk = bOk && ring.GetWrapCount() == 1 && storage.GetDiscardCount() == 2 && ring.GetFrameUsage() == 95;
+    return Report("spans advance by what was written", bOk);
+}
+
+// A grid mesh too big for the ring goes up in whole-triangle ranges, each
+// within both limits, covering every index exactly once in order
+static bool CheckBatchSplit() {
+    const uint32_t columns = 40;
+    const uint32_t rows = 30;
+    std::vector<uint32_t> indices;
+    for (uint32_t y = 0; y < rows; y++) {
+        for (uint32_t x = 0; x < columns; x++) {
+            uint32_t v = y * (columns + 1) + x;
+            uint32_t quad[6] = { v, v + 1, v + columns + 1, v + 1, v + columns + 2, v + columns + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+    uint32_t vertexCount = (columns + 1) * (rows + 1);
+
+    const uint32_t maxVertices = 128;
+    const uint32_t maxIndices = 300;
+    CpuRingBufferStorage vertexStorage;
+    CpuRingBufferStorage indexStorage;
+    RingBufferAllocator vertexRing(&vertexStorage, STRIDE, maxVertices);
+    RingBufferAllocator indexRing(&indexStorage, sizeof(uint32_t), maxIndices);
+    bool bOk = vertexRing.Initialize() && indexRing.Initialize();
+    bOk = bOk && vertexCount > maxVertices && indices.size() > maxIndices;
+
+    uint32_t next = 0;
+    uint32_t ranges = 0;
+    BatchRange range;
+    while (bOk && NextBatchRange(indices.data(), (uint32_t)indices.size(), next, maxVertices, maxIndices, range)) {
+        uint32_t span = range.maxVertex - range.minVertex + 1;
+        bOk = range.firstIndex == next && range.indexCount > 0 && range.indexCount % 3 == 0;
+        bOk = bOk && range.indexCount <= maxIndices && span <= maxVertices;
+        for (uint32_t i = 0; i < range.indexCount && bOk; i++) {
+            uint32_t index = indices[range.firstIndex + i];
+            bOk = index >= range.minVertex && index <= range.maxVertex;
+        }
+
+        // Each range uploads without growing either ring
+        uint32_t firstVertex = 0;
+        uint32_t firstIndex = 0;
+        bOk = bOk && vertexRing.Map(span, firstVertex) != nullptr;
+        vertexRing.Unmap();
+        bOk = bOk && indexRing.Map(range.indexCount, firstIndex) != nullptr;
+        indexRing.Unmap();
+
+        next = range.firstIndex + range.indexCount;
+        ranges++;
+    }
+    bOk = bOk && next == indices.size() && ranges > 1;
+    bOk = bOk && vertexStorage.GetCreateCount() == 1 && indexStorage.GetCreateCount() == 1;
+    return Report("oversize batch split by NextBatchRange", bOk);
+}
+
+// A frame that used more than the ring grows it at the next BeginFrame,
+// after which the same frame fits without wrapping
+static bool CheckHighWaterGrowth() {
+    CpuRingBufferStorage storage;
+    RingBufferAllocator ring(&storage, STRIDE, 100);
+    bool bOk = ring.Initialize();
+
+    auto frame = [&ring]() {
+        ring.BeginFrame();
+        for (int i = 0; i < 6; i++) {
+            Write(ring, 30, (uint8_t)i);
+        }
+    };
+
+    frame();
+    bOk = bOk && ring.GetWrapCount() > 0 && ring.GetFrameUsage() == 180 && ring.GetCapacity() == 100;
+
+    ring.BeginFrame();
+    bOk = bOk && ring.GetHighWaterMark() == 180 && ring.GetCapacity() >= 180;
+    bOk = bOk && storage.GetCreateCount() == 2 && storage.GetSize() == (size_t)ring.GetCapacity() * STRIDE;
+
+    uint32_t wraps = ring.GetWrapCount();
+    uint32_t discards = storage.GetDiscardCount();
+    for (int i = 0; i < 6; i++) {
+        Write(ring, 30, (uint8_t)i);
+    }
+    // Only the recreated buffer's first map discards
+    bOk = bOk && ring.GetWrapCount() == wraps && storage.GetDiscardCount() == discards + 1;
+
+    // The mark only rises, so a quieter frame does not shrink the ring
+    uint32_t capacity = ring.GetCapacity();
+    ring.BeginFrame();
+    Write(ring, 10, 9);
+    ring.BeginFrame();
+    bOk = bOk && ring.GetCapacity() == capacity && storage.GetCreateCount() == 2;
+    return Report("BeginFrame grows to the high-water mark", bOk);
+}
+
+int main() {
+    bool bOk = CheckNoOverwrite();
+    bOk = CheckWrap() && bOk;
+    bOk = CheckSpans() && bOk;
+    bOk = CheckBatchSplit() && bOk;
+    bOk = CheckHighWaterGrowth() && bOk;
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
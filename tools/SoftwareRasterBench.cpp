@@ -0,0 +1,248 @@
+// Output checks and quad throughput for the headless software rasteriser.
+//
+//   SoftwareRasterBench [quads per frame] [frames] [threads]
+//
+// The checks draw scenes whose every pixel is known in advance and compare
+// the framebuffer against that expectation: opaque rectangles on pixel
+// boundaries, straddling tile borders and down to a single pixel, must cover
+// exactly their pixels in exactly their colour; translucent quads that meet
+// along edges at fractional coordinates must blend every pixel once, with
+// no gaps or double hits along the shared edges; and the output must not
+// change with the thread count. Each prints ok or FAILED, with the first
+// mismatching pixel. The benchmark then draws a frame of randomly placed
+// alpha-blended quads repeatedly and reports quads per second for one
+// thread and for the requested count (0, the default, uses every hardware
+// thread).
+#include "../include/Renderer.h"
+#include "../include/SoftwareRenderBackend.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+using std::min;
+using std::max;
+
+static const uint32_t WIDTH = 640;
+static const uint32_t HEIGHT = 360;
+
+struct Rect {
+    float x0, y0, x1, y1;
+    float r, g, b, a;
+};
+
+static bool Report(const char* name, bool bOk) {
+    printf("%-44s %s\n", name, bOk ? "ok" : "FAILED");
+    return bOk;
+}
+
+// Same rounding as the rasteriser's output
+static uint8_t ToUNorm8(float value) {
+    value = max(0.0f, min(1.0f, value));
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+static void DrawRect(Renderer& renderer, const Rect& rect) {
+    GeometrySpan span;
+    if (!renderer.Append(4, 6, RenderBackend::WHITE_TEXTURE, span)) return;
+
+    Vertex* pVertices = span.Vertices<Vertex>();
+    const float x[4] = { rect.x0, rect.x1, rect.x0, rect.x1 };
+    const float y[4] = { rect.y0, rect.y0, rect.y1, rect.y1 };
+    for (int i = 0; i < 4; i++) {
+        pVertices[i] = { x[i], y[i], 0.0f, 0.0f, 0.0f, rect.r, rect.g, rect.b, rect.a };
+    }
+    const uint32_t quad[6] = { 0, 1, 2, 1, 3, 2 };
+    for (int i = 0; i < 6; i++) {
+        span.pIndices[i] = (uint16_t)(span.baseVertex + quad[i]);
+    }
+}
+
+// Clear to opaque black, draw the rectangles in order as one frame
+static void RenderFrame(Renderer& renderer, SoftwareRenderBackend& backend, const std::vector<Rect>& rects) {
+    backend.Clear(0.0f, 0.0f, 0.0f, 1.0f);
+    renderer.BeginFrame();
+    renderer.SetBlendMode(BlendMode::ALPHA);
+    for (const Rect& rect : rects) {
+        DrawRect(renderer, rect);
+    }
+    renderer.Flush();
+}
+
+// Straight-alpha blend of each rectangle over the pixels whose centres it
+// covers, half-open on the right and bottom as the top-left rule gives
+static std::vector<uint8_t> Expect(const std::vector<Rect>& rects) {
+    std::vector<uint8_t> pixels((size_t)WIDTH * HEIGHT * 4);
+    for (size_t i = 0; i < pixels.size(); i += 4) {
+        pixels[i + 3] = 255;
+    }
+    for (const Rect& rect : rects) {
+        for (uint32_t y = 0; y < HEIGHT; y++) {
+            float py = y + 0.5f;
+            if (py < rect.y0 || py >= rect.y1) continue;
+            for (uint32_t x = 0; x < WIDTH; x++) {
+                float px = x + 0.5f;
+                if (px < rect.x0 || px >= rect.x1) continue;
+
+                uint8_t* p = &pixels[((size_t)y * WIDTH + x) * 4];
+                const float src[3] = { rect.r, rect.g, rect.b };
+                for (int c = 0; c < 3; c++) {
+                    p[c] = ToUNorm8(src[c] * rect.a + p[c] / 255.0f * (1.0f - rect.a));
+                }
+                p[3] = ToUNorm8(rect.a);
+            }
+        }
+    }
+    return pixels;
+}
+
+static bool Compare(const uint8_t* pActual, const std::vector<uint8_t>& expected, int tolerance) {
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (abs((int)pActual[i] - (int)expected[i]) > tolerance) {
+            size_t pixel = i / 4;
+            printf("  pixel (%zu, %zu) channel %zu: %u, expected %u\n", pixel % WIDTH, pixel / WIDTH, i % 4,
+                   pActual[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::unique_ptr<Renderer> MakeRenderer(uint32_t threads, SoftwareRenderBackend*& pBackend) {
+    pBackend = new SoftwareRenderBackend(WIDTH, HEIGHT, threads);
+    std::unique_ptr<Renderer> pRenderer(new Renderer(std::unique_ptr<RenderBackend>(pBackend)));
+    if (!pRenderer->Initialize()) {
+        pRenderer.reset();
+    }
+    return pRenderer;
+}
+
+// Colours are multiples of 1/255 so opaque pixels come out exact
+static float Level(uint32_t value) {
+    return (float)(value % 256) / 255.0f;
+}
+
+static bool CheckOpaqueRects() {
+    std::vector<Rect> rects;
+    uint32_t index = 0;
+    for (uint32_t y = 2; y + 40 < HEIGHT; y += 45) {
+        for (uint32_t x = 3; x + 40 < WIDTH; x += 47) {
+            // 1x1 up to 40x40, so some straddle the 64-pixel tile borders
+            float size = (float)(1 + (index * 7) % 40);
+            rects.push_back({ (float)x, (float)y, x + size, y + size,
+                              Level(index * 37 + 11), Level(index * 91 + 5), Level(index * 53 + 200), 1.0f });
+            index++;
+        }
+    }
+
+    SoftwareRenderBackend* pBackend;
+    std::unique_ptr<Renderer> pRenderer = MakeRenderer(0, pBackend);
+    bool bOk = pRenderer != nullptr;
+    if (bOk) {
+        RenderFrame(*pRenderer, *pBackend, rects);
+        bOk = Compare(pBackend->GetPixels(), Expect(rects), 0);
+    }
+    return Report("opaque rects cover exactly their pixels", bOk);
+}
+
+static bool CheckSharedEdges() {
+    // A 3x3 mosaic of half-transparent quads cut at fractional coordinates
+    const float xs[4] = { 100.0f, 187.3f, 251.75f, 330.0f };
+    const float ys[4] = { 40.0f, 128.5f, 190.2f, 300.0f };
+    std::vector<Rect> rects;
+    for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < 3; i++) {
+            rects.push_back({ xs[i], ys[j], xs[i + 1], ys[j + 1], 1.0f, 0.5f, 0.25f, 0.5f });
+        }
+    }
+
+    SoftwareRenderBackend* pBackend;
+    std::unique_ptr<Renderer> pRenderer = MakeRenderer(0, pBackend);
+    bool bOk = pRenderer != nullptr;
+    if (bOk) {
+        RenderFrame(*pRenderer, *pBackend, rects);
+        bOk = Compare(pBackend->GetPixels(), Expect(rects), 1);
+    }
+    return Report("shared edges blend each pixel once", bOk);
+}
+
+static std::vector<Rect> MakeQuads(uint32_t count) {
+    std::vector<Rect> rects(count);
+    uint32_t seed = 77;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / 16777216.0f;
+    };
+    for (Rect& rect : rects) {
+        float size = 4.0f + next() * 28.0f;
+        rect.x0 = next() * (WIDTH - size);
+        rect.y0 = next() * (HEIGHT - size);
+        rect.x1 = rect.x0 + size;
+        rect.y1 = rect.y0 + size;
+        rect.r = next();
+        rect.g = next();
+        rect.b = next();
+        rect.a = 0.25f + next() * 0.75f;
+    }
+    return rects;
+}
+
+static uint64_t HashPixels(const uint8_t* pPixels) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < (size_t)WIDTH * HEIGHT * 4; i++) {
+        hash = (hash ^ pPixels[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Quads per second drawing the same frame repeatedly; also returns the hash
+static double Bench(const std::vector<Rect>& quads, uint32_t frames, uint32_t threads, uint64_t& hash) {
+    SoftwareRenderBackend* pBackend;
+    std::unique_ptr<Renderer> pRenderer = MakeRenderer(threads, pBackend);
+    if (!pRenderer) {
+        return 0.0;
+    }
+
+    RenderFrame(*pRenderer, *pBackend, quads);     // Grow the rings first
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t frame = 0; frame < frames; frame++) {
+        RenderFrame(*pRenderer, *pBackend, quads);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    hash = HashPixels(pBackend->GetPixels());
+    return (double)quads.size() * frames / seconds;
+}
+
+int main(int argc, char** argv) {
+    uint32_t quadCount = argc >= 2 ? (uint32_t)atoi(argv[1]) : 20000;
+    uint32_t frames = argc >= 3 ? (uint32_t)atoi(argv[2]) : 20;
+    uint32_t threads = argc >= 4 ? (uint32_t)atoi(argv[3]) : 0;
+    if (threads == 0) {
+        threads = max(1u, std::thread::hardware_concurrency());
+    }
+    frames = max(frames, 1u);
+
+    bool bOk = CheckOpaqueRects();
+    bOk = CheckSharedEdges() && bOk;
+
+    std::vector<Rect> quads = MakeQuads(quadCount);
+    uint64_t serialHash = 0;
+    uint64_t parallelHash = 0;
+    double serialRate = Bench(quads, frames, 1, serialHash);
+    double parallelRate = Bench(quads, frames, max(threads, 2u), parallelHash);
+    bOk = Report("same output for any thread count", serialHash == parallelHash) && bOk;
+
+    printf("\n%u quads per frame, %u frames, %ux%u\n", quadCount, frames, WIDTH, HEIGHT);
+    printf("%-10s %14s\n", "threads", "quads/s");
+    printf("%-10u %14.0f\n", 1u, serialRate);
+    printf("%-10u %14.0f\n", max(threads, 2u), parallelRate);
+    printf("frame hash %016llx\n", (unsigned long long)serialHash);
+
+    if (!bOk) {
+        printf("FAILED\n");
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
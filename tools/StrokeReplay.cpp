@@ -0,0 +1,328 @@
+// Records and replays stroke logs through BrushSystem without a window.
+//
+//   StrokeReplay synth <output log> [strokes]
+//   StrokeReplay info <log>
+//   StrokeReplay run <log> [--realtime] [--canvas <width> <height>]
+//                    [--smoothing <0-3>] [--prediction <ms>] [--frame <ms>]
+//                    [--brush <name>] [--size <min> <max>] [--no-mask-cache]
+//                    [--threads <n>] [--trace <file>]
+//
+// Logs come from the app started with "-record <file>", or synth writes a
+// deterministic set of 240 Hz pen strokes. run feeds the pen events to the
+// brush engine one frame at a time, as the app does, either as fast as
+// possible or at the recorded pace with --realtime. It reports dabs per
+// second and per-frame CPU time, and hashes the final canvas: the same log
+// and settings always give the same hash, so a change that alters what gets
+// painted shows up. --brush picks one of BrushSystem's brushes, --size
+// replaces its size range, and --no-mask-cache rasterises every round dab
+// exactly instead of stamping cached masks. --threads sets how many threads
+// stamp each batch of dabs (0, the default, uses every hardware thread); the
+// hash must not change with it. --trace profiles every frame, prints the
+// zones that took longest and writes a Chrome trace of the whole replay.
+#include "../include/StrokeLog.h"
+#include "../include/BrushSystem.h"
+#include "../include/Canvas.h"
+#include "../include/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+using std::min;
+using std::max;
+
+// Small deterministic generator so synthetic logs are identical every run
+static uint32_t g_Random = 2024;
+static float RandomFloat() {
+    g_Random = g_Random * 1664525u + 1013904223u;
+    return (float)(g_Random >> 8) / 16777216.0f;
+}
+
+static int Synthesise(const std::string& outputFile, int strokeCount) {
+    const double pi = 3.14159265358979;
+    const double intervalMs = 1000.0 / 240.0;
+
+    StrokeLogWriter writer;
+    InputEvent event = {};
+    double timeMs = 1000.0;
+
+    for (int stroke = 0; stroke < strokeCount; stroke++) {
+        // Each stroke is a loop-de-loop of random size, direction and speed
+        float startX = 200.0f + RandomFloat() * 1500.0f;
+        float startY = 150.0f + RandomFloat() * 800.0f;
+        float length = 200.0f + RandomFloat() * 600.0f;
+        float angle = RandomFloat() * 2.0f * (float)pi;
+        float loopRadius = 10.0f + RandomFloat() * 40.0f;
+        float loops = 2.0f + RandomFloat() * 6.0f;
+        double durationMs = 300.0 + RandomFloat() * 900.0;
+        int sampleCount = (int)(durationMs / intervalMs);
+
+        for (int i = 0; i <= sampleCount; i++) {
+            double u = (double)i / (double)sampleCount;
+            double along = length * u;
+            double loopPhase = u * loops * 2.0 * pi;
+
+            event.timeMs = timeMs + (RandomFloat() - 0.5) * 0.5;
+            event.x = startX + (float)(along * std::cos(angle) + loopRadius * std::cos(loopPhase));
+            event.y = startY + (float)(along * std::sin(angle) + loopRadius * std::sin(loopPhase));
+            event.pressure = (float)(0.2 + 0.7 * std::sin(u * pi));
+            event.tiltX = (float)(30.0 * std::cos(angle));
+            event.tiltY = (float)(30.0 * std::sin(angle));
+            event.buttons = i < sampleCount ? InputEvent::PEN_CONTACT : 0;
+            event.type = i == 0 ? InputEventType::PEN_DOWN :
+                         i == sampleCount ? InputEventType::PEN_UP : InputEventType::PEN_MOVE;
+            writer.Add(event);
+            timeMs += intervalMs;
+        }
+
+        // Hover to the next stroke
+        timeMs += 100.0 + RandomFloat() * 300.0;
+    }
+
+    if (!writer.Save(outputFile)) {
+        fprintf(stderr, "Cannot write %s\n", outputFile.c_str());
+        return 1;
+    }
+    printf("%d strokes, %zu events, %zu bytes (%.1f bytes/event)\n", strokeCount, writer.GetEventCount(),
+           writer.GetData().size(), (double)writer.GetData().size() / (double)max<size_t>(writer.GetEventCount(), 1));
+    return 0;
+}
+
+static bool LoadEvents(const std::string& filename, std::vector<InputEvent>& events) {
+    StrokeLogReader reader;
+    if (!reader.Load(filename)) {
+        fprintf(stderr, "Cannot read stroke log %s\n", filename.c_str());
+        return false;
+    }
+    if (!reader.ReadAll(events)) {
+        fprintf(stderr, "%s is truncated or corrupt after %zu events\n", filename.c_str(), events.size());
+        return false;
+    }
+    return true;
+}
+
+static int Info(const std::string& filename) {
+    std::vector<InputEvent> events;
+    if (!LoadEvents(filename, events)) return 1;
+
+    size_t penEvents = 0;
+    size_t strokes = 0;
+    bool bContact = false;
+    for (const InputEvent& event : events) {
+        bool bPen = event.type == InputEventType::PEN_DOWN || event.type == InputEventType::PEN_MOVE ||
+                    event.type == InputEventType::PEN_UP;
+        if (!bPen) continue;
+        penEvents++;
+        bool bNowContact = (event.buttons & InputEvent::PEN_CONTACT) != 0;
+        if (bNowContact && !bContact) strokes++;
+        bContact = bNowContact;
+    }
+
+    double durationMs = events.empty() ? 0.0 : events.back().timeMs - events.front().timeMs;
+    printf("%zu events (%zu pen), %zu strokes, %.2f s\n", events.size(), penEvents, strokes, durationMs / 1000.0);
+    return 0;
+}
+
+static uint64_t HashCanvas(const Canvas& canvas) {
+    // FNV-1a over the pixels row by row, so tile allocation does not matter
+    std::vector<uint8_t> row((size_t)canvas.GetWidth() * 4);
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t y = 0; y < canvas.GetHeight(); y++) {
+        canvas.ReadPixels(0, y, canvas.GetWidth(), 1, row.data(), (uint32_t)row.size());
+        for (uint8_t value : row) {
+            hash = (hash ^ value) * 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+static int Run(const std::string& filename, int argc, char** argv) {
+    bool bRealtime = false;
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t smoothing = 0;
+    double predictionMs = 0.0;
+    double frameMs = 1000.0 / 60.0;
+    std::string brushName = "Default";
+    float minSize = 0.0f;
+    float maxSize = 0.0f;
+    bool bMaskCache = true;
+    uint32_t threads = 0;
+    std::string traceFile;
+
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--realtime") == 0) {
+            bRealtime = true;
+        } else if (strcmp(argv[i], "--canvas") == 0 && i + 2 < argc) {
+            width = (uint32_t)atoi(argv[++i]);
+            height = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--smoothing") == 0 && i + 1 < argc) {
+            smoothing = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--prediction") == 0 && i + 1 < argc) {
+            predictionMs = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--frame") == 0 && i + 1 < argc) {
+            frameMs = max(atof(argv[++i]), 0.1);
+        } else if (strcmp(argv[i], "--brush") == 0 && i + 1 < argc) {
+            brushName = argv[++i];
+        } else if (strcmp(argv[i], "--size") == 0 && i + 2 < argc) {
+            minSize = (float)atof(argv[++i]);
+            maxSize = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--no-mask-cache") == 0) {
+            bMaskCache = false;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (uint32_t)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceFile = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::vector<InputEvent> events;
+    if (!LoadEvents(filename, events)) return 1;
+    if (events.empty()) {
+        printf("empty log\n");
+        return 0;
+    }
+
+    // Keep every frame of the replay
+    if (!traceFile.empty()) {
+        double durationMs = events.back().timeMs - events.front().timeMs;
+        Profiler::SetFrameHistory((uint32_t)(durationMs / frameMs) + 2);
+        Profiler::SetThreadName("Main");
+        Profiler::SetEnabled(true);
+    }
+
+    Canvas canvas(width, height);
+    Canvas previewCanvas(width, height);
+    BrushSystem brushSystem;
+    if (!brushSystem.Initialize()) return 1;
+    brushSystem.SetDabThreads(threads);
+
+    PressureBrush* pBrush = brushSystem.GetBrush(brushName);
+    if (!pBrush) {
+        fprintf(stderr, "No brush named %s\n", brushName.c_str());
+        return 1;
+    }
+    if (maxSize > 0.0f) {
+        // Same settings, new size range
+        PressureBrush* pSized = brushSystem.CreateBrush(brushName + " (resized)", max(minSize, 0.5f), max(maxSize, minSize));
+        pSized->SetType(pBrush->GetType());
+        pSized->SetHardness(pBrush->GetHardness());
+        pSized->SetSpacing(pBrush->GetSpacing());
+        pSized->SetFlow(pBrush->GetFlow());
+        pSized->SetSmudgeRate(pBrush->GetSmudgeRate());
+        pBrush = pSized;
+    }
+    pBrush->SetMaskCacheEnabled(bMaskCache);
+    brushSystem.SetCurrentBrush(pBrush->GetName());
+    brushSystem.SetCanvas(&canvas);
+    brushSystem.SetSmoothing(smoothing);
+    if (predictionMs > 0.0) {
+        brushSystem.SetPreviewCanvas(&previewCanvas);
+        brushSystem.SetPrediction(predictionMs);
+    }
+
+    // Events are handed over in frame-sized batches, as DispatchEvents does
+    std::vector<double> frameTimes;
+    double firstTimeMs = events.front().timeMs;
+    auto replayStart = std::chrono::steady_clock::now();
+    size_t next = 0;
+
+    for (double frameEndMs = firstTimeMs + frameMs; next < events.size(); frameEndMs += frameMs) {
+        if (bRealtime) {
+            std::this_thread::sleep_until(replayStart + std::chrono::duration<double, std::milli>(frameEndMs - firstTimeMs));
+        }
+
+        auto frameStart = std::chrono::steady_clock::now();
+        bool bAny = false;
+        while (next < events.size() && events[next].timeMs < frameEndMs) {
+            brushSystem.ProcessInput(events[next++]);
+            bAny = true;
+        }
+        brushSystem.UpdatePreview();
+
+        // Idle frames between strokes would only dilute the statistics
+        if (bAny) {
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+        }
+        Profiler::EndFrame();
+    }
+    brushSystem.EndStroke();
+    Profiler::EndFrame();
+
+    double wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replayStart).count();
+    double busyMs = 0.0;
+    for (double time : frameTimes) busyMs += time;
+
+    std::vector<double> sorted = frameTimes;
+    std::sort(sorted.begin(), sorted.end());
+    double p50 = sorted.empty() ? 0.0 : sorted[sorted.size() / 2];
+    double p95 = sorted.empty() ? 0.0 : sorted[min(sorted.size() - 1, sorted.size() * 95 / 100)];
+    double worst = sorted.empty() ? 0.0 : sorted.back();
+
+    uint64_t dabs = brushSystem.GetDabCount();
+    printf("%zu events, %llu dabs, %zu active frames, %.1f ms wall, %.1f ms painting\n", events.size(),
+           (unsigned long long)dabs, frameTimes.size(), wallMs, busyMs);
+    printf("dabs/s %.0f\n", busyMs > 0.0 ? (double)dabs * 1000.0 / busyMs : 0.0);
+    printf("frame ms  p50 %.3f  p95 %.3f  max %.3f\n", p50, p95, worst);
+    if (const ParallelDabRenderer* pRenderer = brushSystem.GetDabRenderer()) {
+        printf("dab threads %u  parallel batches %llu  serial batches %llu  steals %llu\n",
+               pRenderer->GetThreadCount(), (unsigned long long)pRenderer->GetParallelBatchCount(),
+               (unsigned long long)pRenderer->GetSerialBatchCount(), (unsigned long long)pRenderer->GetStealCount());
+    }
+    if (bMaskCache) {
+        const DabMaskCache& cache = pBrush->GetMaskCache();
+        uint64_t lookups = cache.GetHitCount() + cache.GetMissCount();
+        printf("mask cache  hits %.1f%% (%llu of %llu)  %zu masks  %.2f MB\n",
+               lookups ? 100.0 * (double)cache.GetHitCount() / (double)lookups : 0.0,
+               (unsigned long long)cache.GetHitCount(), (unsigned long long)lookups,
+               cache.GetCachedMaskCount(), (double)cache.GetCacheBytes() / (1024.0 * 1024.0));
+    }
+    printf("canvas hash %016llx\n", (unsigned long long)HashCanvas(canvas));
+
+    if (!traceFile.empty()) {
+        std::vector<ProfileZoneSummary> zones;
+        Profiler::Summarize(zones);
+        printf("%-30s %9s %11s %9s\n", "zone", "calls", "total ms", "max ms");
+        for (size_t i = 0; i < min(zones.size(), (size_t)12); i++) {
+            printf("%-30s %9llu %11.2f %9.3f\n", zones[i].pName, (unsigned long long)zones[i].calls,
+                   zones[i].totalMs, zones[i].maxMs);
+        }
+        if (Profiler::GetDroppedCount() > 0) {
+            printf("%llu zones dropped\n", (unsigned long long)Profiler::GetDroppedCount());
+        }
+        if (!Profiler::WriteChromeTrace(traceFile)) {
+            fprintf(stderr, "Cannot write %s\n", traceFile.c_str());
+            return 1;
+        }
+        printf("trace written to %s\n", traceFile.c_str());
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "synth") == 0) {
+        return Synthesise(argv[2], argc >= 4 ? max(atoi(argv[3]), 1) : 50);
+    }
+    if (argc == 3 && strcmp(argv[1], "info") == 0) {
+        return Info(argv[2]);
+    }
+    if (argc >= 3 && strcmp(argv[1], "run") == 0) {
+        return Run(argv[2], argc - 3, argv + 3);
+    }
+
+    fprintf(stderr,
+            "usage: StrokeReplay synth <output log> [strokes]\n"
+            "       StrokeReplay info <log>\n"
+            "       StrokeReplay run <log> [--realtime] [--canvas <width> <height>]\n"
+            "                        [--smoothing <0-3>] [--prediction <ms>] [--frame <ms>]\n"
+            "                        [--brush <name>] [--size <min> <max>] [--no-mask-cache]\n"
+            "                        [--threads <n>] [--trace <file>]\n");
+    return 1;
+}
\ No newline at end of file
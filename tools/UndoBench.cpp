@@ -0,0 +1,168 @@
+// Memory and latency of UndoHistory on the tiled canvas.
+//
+//   UndoBench [strokes] [budget MB]
+//
+// Paints the same random strokes on canvases from 2.5k to 16k square and
+// times committing each stroke to history, undoing and redoing it: all
+// three should track the tiles a stroke touched, not the canvas size.
+// Then repeats on the largest canvas with a small memory budget so older
+// states get compressed or dropped. Undoing everything and redoing it again
+// is checked against the canvas contents at each end, and the history must
+// stay within its budget after every step, with only the next undo and redo
+// allowed to hold it over.
+#include "../include/Canvas.h"
+#include "../include/DabRasterizer.h"
+#include "../include/PressureBrush.h"
+#include "../include/UndoHistory.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static uint32_t g_Random = 7;
+static float RandomFloat() {
+    g_Random = g_Random * 1664525u + 1013904223u;
+    return (float)(g_Random >> 8) / 16777216.0f;
+}
+
+static double ElapsedUs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A wavy stroke inside a 2048 px square near the canvas centre, so every
+// canvas size gets the same strokes
+static void PaintStroke(Canvas& canvas, PressureBrush& brush, std::vector<Dab>& dabs) {
+    float originX = (float)canvas.GetWidth() * 0.5f - 1024.0f;
+    float originY = (float)canvas.GetHeight() * 0.5f - 1024.0f;
+    float x = originX + RandomFloat() * 2048.0f;
+    float y = originY + RandomFloat() * 2048.0f;
+    float angle = RandomFloat() * 6.2832f;
+    float r = RandomFloat(), g = RandomFloat(), b = RandomFloat();
+
+    brush.ResetStroke();
+    dabs.clear();
+    for (int i = 0; i < 100; i++) {
+        angle += (RandomFloat() - 0.5f) * 0.3f;
+        x += std::cos(angle) * 6.0f;
+        y += std::sin(angle) * 6.0f;
+        brush.EmitDabs(x, y, 0.3f + 0.7f * RandomFloat(), r, g, b, 1.0f, dabs);
+    }
+    RasterizeDabs(canvas, dabs.data(), dabs.size());
+}
+
+static uint64_t HashCanvas(const Canvas& canvas) {
+    uint64_t hash = 14695981039346656037ull;
+    for (uint32_t tileY = 0; tileY < canvas.GetTilesY(); tileY++) {
+        for (uint32_t tileX = 0; tileX < canvas.GetTilesX(); tileX++) {
+            const uint8_t* pTile = canvas.GetTile(tileX, tileY);
+            if (!pTile) continue;
+            hash = (hash ^ (tileY * canvas.GetTilesX() + tileX)) * 1099511628211ull;
+            for (uint32_t i = 0; i < Canvas::TILE_BYTES; i++) {
+                hash = (hash ^ pTile[i]) * 1099511628211ull;
+            }
+        }
+    }
+    return hash;
+}
+
+// Over budget is only allowed once nothing is left to compress or drop
+static bool WithinBudget(const UndoHistory& history) {
+    return history.GetMemoryUsage() <= history.GetMemoryBudget() ||
+           (history.GetUndoCount() <= 1 && history.GetRedoCount() <= 1);
+}
+
+static bool RunCase(uint32_t canvasSize, int strokeCount, size_t budget) {
+    Canvas canvas(canvasSize, canvasSize);
+    PressureBrush brush("bench", 8.0f, 60.0f);
+    brush.SetSpacing(0.1f);
+    UndoHistory history;
+    history.SetMemoryBudget(budget);
+    history.SetMaxStates((size_t)strokeCount);
+
+    std::vector<Dab> dabs;
+    std::vector<Canvas::TileChange> changes;
+    uint64_t emptyHash = HashCanvas(canvas);
+    size_t dirtyTiles = 0;
+    double commitUs = 0.0;
+
+    g_Random = 7;
+    for (int stroke = 0; stroke < strokeCount; stroke++) {
+        canvas.BeginChange();
+        PaintStroke(canvas, brush, dabs);
+
+        auto start = std::chrono::steady_clock::now();
+        canvas.EndChange(changes);
+        dirtyTiles += changes.size();
+        history.Push(changes);
+        commitUs += ElapsedUs(start);
+    }
+    uint64_t paintedHash = HashCanvas(canvas);
+    size_t kept = history.GetUndoCount();
+    size_t memory = history.GetMemoryUsage();
+    size_t compressed = history.GetCompressedStateCount();
+
+    // Undo everything kept, timing the first (newest, live) and the worst
+    double undoUs = 0.0, firstUndoUs = 0.0, worstUndoUs = 0.0;
+    // Undoing may drop the oldest states on the way, too
+    size_t undone = 0;
+    size_t peakMemory = memory;
+    bool bBudget = WithinBudget(history);
+    for (size_t i = 0; i < kept; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!history.Undo(canvas)) break;
+        double elapsed = ElapsedUs(start);
+        undone++;
+        peakMemory = std::max(peakMemory, history.GetMemoryUsage());
+        bBudget = WithinBudget(history) && bBudget;
+        if (i == 0) firstUndoUs = elapsed;
+        worstUndoUs = std::max(worstUndoUs, elapsed);
+        undoUs += elapsed;
+    }
+    uint64_t undoneHash = HashCanvas(canvas);
+
+    // The budget may drop the furthest redo states, so only a full redo
+    // has to get back to the painted canvas
+    size_t redone = 0;
+    double redoUs = 0.0;
+    for (size_t i = 0; i < undone; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (!history.Redo(canvas)) break;
+        redoUs += ElapsedUs(start);
+        redone++;
+        peakMemory = std::max(peakMemory, history.GetMemoryUsage());
+        bBudget = WithinBudget(history) && bBudget;
+    }
+    uint64_t redoneHash = HashCanvas(canvas);
+
+    // With every state kept, undoing them all must give back the empty canvas
+    bool bOk = bBudget && (redone < undone || redoneHash == paintedHash) &&
+               (undone < (size_t)strokeCount || undoneHash == emptyHash);
+
+    printf("%6u  %6.1f  %9.1f  %6zu  %6zu  %6zu  %8.1f  %8.1f  %8.1f  %8.1f  %7.1f  %7.1f  %s\n",
+           canvasSize, (double)dirtyTiles / strokeCount, commitUs / strokeCount,
+           kept, compressed, redone, firstUndoUs, undone ? undoUs / undone : 0.0, worstUndoUs,
+           redone ? redoUs / redone : 0.0, (double)memory / (1024.0 * 1024.0),
+           (double)peakMemory / (1024.0 * 1024.0),
+           !bBudget ? "OVER BUDGET" : bOk ? "ok" : "MISMATCH");
+    return bOk;
+}
+
+int main(int argc, char** argv) {
+    int strokeCount = argc >= 2 ? std::max(atoi(argv[1]), 1) : 200;
+    size_t budgetMb = argc >= 3 ? (size_t)atoi(argv[2]) : 16;
+
+    printf("%d strokes; times in microseconds, memory in MB\n", strokeCount);
+    printf("canvas   tiles  commit us   kept  packed  redone  undo 1st  undo avg  undo max  redo avg  hist MB  peak MB\n");
+
+    bool bOk = true;
+    const uint32_t sizes[] = { 2560, 4096, 16384 };
+    for (uint32_t size : sizes) {
+        bOk = RunCase(size, strokeCount, (size_t)-1) && bOk;
+    }
+
+    printf("budget %zu MB:\n", budgetMb);
+    bOk = RunCase(16384, strokeCount, budgetMb * 1024 * 1024) && bOk;
+    return bOk ? 0 : 1;
+}
\ No newline at end of file
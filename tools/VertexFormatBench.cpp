@@ -0,0 +1,106 @@
+// Upload size and batch build time of the STANDARD and COMPACT vertex formats.
+//
+//   VertexFormatBench [sprites] [lines] [circles] [frames]
+//
+// Builds the same scene (textured quads through Renderer::Append, lines and
+// circles through DrawLine and DrawCircle) with a Renderer over the null
+// backend in each format. Reports vertex and index bytes per frame from
+// RenderStats, the index bytes the same batches would take with 32-bit
+// indices, the per-frame total against the original layout (36-byte
+// vertices, 32-bit indices), and the best batch build time over the frames.
+#include "../include/NullRenderBackend.h"
+#include "../include/Renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+using std::min;
+using std::max;
+
+typedef std::chrono::steady_clock Clock;
+
+struct SceneSize {
+    uint32_t sprites;
+    uint32_t lines;
+    uint32_t circles;
+};
+
+template <typename TVertex>
+static void DrawQuad(Renderer& renderer, float x, float y, float size, uint32_t color) {
+    GeometrySpan span;
+    if (!renderer.Append(4, 6, span)) return;
+
+    TVertex* pVertices = span.Vertices<TVertex>();
+    VertexTraits<TVertex>::WritePacked(pVertices[0], x, y, 0.0f, 0.0f, color);
+    VertexTraits<TVertex>::WritePacked(pVertices[1], x + size, y, 1.0f, 0.0f, color);
+    VertexTraits<TVertex>::WritePacked(pVertices[2], x, y + size, 0.0f, 1.0f, color);
+    VertexTraits<TVertex>::WritePacked(pVertices[3], x + size, y + size, 1.0f, 1.0f, color);
+    const uint32_t quad[6] = { 0, 1, 2, 1, 3, 2 };
+    for (int i = 0; i < 6; i++) {
+        span.pIndices[i] = (uint16_t)(span.baseVertex + quad[i]);
+    }
+}
+
+template <typename TVertex>
+static void BuildScene(Renderer& renderer, const SceneSize& scene) {
+    renderer.BeginFrame();
+    for (uint32_t i = 0; i < scene.sprites; i++) {
+        float x = (float)((i * 37) % 1920);
+        float y = (float)((i * 91) % 1080);
+        DrawQuad<TVertex>(renderer, x, y, 16.0f, 0xFF000000u | (i * 2654435761u >> 8));
+    }
+    for (uint32_t i = 0; i < scene.lines; i++) {
+        float x = (float)((i * 53) % 1920);
+        float y = (float)((i * 29) % 1080);
+        renderer.DrawLine(x, y, x + 40.0f, y + 25.0f, 2.0f, 1.0f, 0.5f, 0.25f, 1.0f);
+    }
+    for (uint32_t i = 0; i < scene.circles; i++) {
+        float x = (float)((i * 71) % 1920);
+        float y = (float)((i * 43) % 1080);
+        renderer.DrawCircle(x, y, 12.0f, 0.25f, 0.5f, 1.0f, 0.75f);
+    }
+    renderer.Flush();
+}
+
+template <typename TVertex>
+static void RunFormat(const char* name, const SceneSize& scene, int frames) {
+    Renderer renderer(std::unique_ptr<RenderBackend>(new NullRenderBackend(VertexTraits<TVertex>::Format)));
+    if (!renderer.Initialize()) {
+        printf("%s: Renderer failed to initialize\n", name);
+        return;
+    }
+
+    BuildScene<TVertex>(renderer, scene);
+    double bestMs = 1e30;
+    for (int i = 0; i < frames; i++) {
+        auto start = Clock::now();
+        BuildScene<TVertex>(renderer, scene);
+        bestMs = min(bestMs, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+
+    const RenderStats& stats = renderer.GetStats();
+    uint64_t wideIndexBytes = (uint64_t)stats.indices * sizeof(uint32_t);
+    uint64_t originalBytes = (uint64_t)stats.vertices * sizeof(Vertex) + wideIndexBytes;
+    uint64_t totalBytes = stats.vertexBytes + stats.indexBytes;
+    printf("%-10s %9u %12.1f %12.1f %12.1f %12.1f %9.0f%% %9.3f\n", name, stats.vertices,
+           stats.vertexBytes / 1024.0, stats.indexBytes / 1024.0, wideIndexBytes / 1024.0,
+           totalBytes / 1024.0, 100.0 * totalBytes / originalBytes, bestMs);
+
+    renderer.Cleanup();
+}
+
+int main(int argc, char** argv) {
+    SceneSize scene;
+    scene.sprites = argc > 1 ? (uint32_t)atoi(argv[1]) : 50000;
+    scene.lines = argc > 2 ? (uint32_t)atoi(argv[2]) : 10000;
+    scene.circles = argc > 3 ? (uint32_t)atoi(argv[3]) : 2000;
+    int frames = argc > 4 ? max(1, atoi(argv[4])) : 20;
+
+    printf("%u sprites, %u lines, %u circles per frame\n\n", scene.sprites, scene.lines, scene.circles);
+    printf("%-10s %9s %12s %12s %12s %12s %10s %9s\n", "format", "vertices", "vertex KiB",
+           "index16 KiB", "index32 KiB", "total KiB", "vs orig", "build ms");
+    RunFormat<Vertex>("STANDARD", scene, frames);
+    RunFormat<CompactVertex>("COMPACT", scene, frames);
+    return 0;
+}
\ No newline at end of file